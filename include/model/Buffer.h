@@ -32,6 +32,7 @@ typedef enum {
 	INPUT_NONE,
 	DECIMAL_CSV,
 	BINARY,
+	NUMPY,
 } buffer_input_type;
 
 /** A buffer object.
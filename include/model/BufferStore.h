@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MODEL_BUFFERSTORE_H
+#define MODEL_BUFFERSTORE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model/Buffer.h"
+#include "util/compare.h"
+
+namespace simd_model {
+
+/** Backing store of DRAM buffer contents.
+ *
+ * Implements upload, download and comparison of ProgramBuffers against input
+ * and golden files on top of bulk_copy(). Both the cycle-accurate Backend and
+ * the functional simulator's FlatMemory derive from this, such that they
+ * accept the same input and golden files and produce the same output files. */
+class BufferStore {
+private:
+	/** Read a binary file of 32-bit words in one go.
+	 * @param filename Name of the file to read.
+	 * @param buf Vector to store the words in.
+	 * @param max_words Maximum number of words to read.
+	 * @return False iff the file could not be opened. */
+	bool read_bin_file(std::string filename, std::vector<uint32_t> &buf,
+			size_t max_words);
+
+	/** Compare a buffer against golden values.
+	 *
+	 * The buffer is extracted in one bulk pass, after which it is compared
+	 * on multiple threads by cmp_float_buffers().
+	 * @param pb ProgramBuffer to compare against.
+	 * @param gold Golden values.
+	 * @param words Number of golden values.
+	 * @param delta Tolerable delta.
+	 * @param dfrac True iff delta should be interpreted as a fractional
+	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
+	 * @return True iff the buffer matches the golden values. */
+	bool compare_buffer(const ProgramBuffer &pb, const float *gold,
+			size_t words, float delta, bool dfrac, cmp_stats *stats);
+
+protected:
+	/** Copy a consecutive range of words from or to the store.
+	 * @param addr Start address, word-aligned.
+	 * @param buf Host buffer.
+	 * @param words Number of words to copy.
+	 * @param upload True iff words are copied from buf to the store, false
+	 * 		 iff copied from the store to buf. */
+	virtual void bulk_copy(uint32_t addr, uint32_t *buf, size_t words,
+			bool upload) = 0;
+
+public:
+	/** Virtual destructor. */
+	virtual ~BufferStore(void);
+
+	/** Upload the data input file of a ProgramBuffer into the store.
+	 * @param pb Program buffer. */
+	void upload_buffer(const ProgramBuffer &pb);
+
+	/** Download a buffer into a binary file.
+	 * @param pb Program Buffer to download data from.
+	 * @param filename File to download results into. */
+	void download_buffer_bin(const ProgramBuffer &pb, std::string filename);
+
+	/** Download a buffer into a NumPy .npy file.
+	 *
+	 * The output file is created at its final size, mapped, and filled
+	 * straight from the store.
+	 * @param pb Program Buffer to download data from.
+	 * @param filename File to download results into. */
+	void download_buffer_npy(const ProgramBuffer &pb, std::string filename);
+
+	/** Download a buffer into a CSV file.
+	 * @param pb Program Buffer to download data from.
+	 * @param filename File to download results into. */
+	void download_buffer_csv(const ProgramBuffer &pb, std::string filename);
+
+	/** Compare a buffer against a golden output in binary form.
+	 * @param pb ProgramBuffer to compare against.
+	 * @param filename Name of file that contains golden values.
+	 * @param delta Tolerable delta.
+	 * @param dfrac True iff delta should be interpreted as a fractional
+	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
+	 * @return True iff the buffer matches the golden values. */
+	bool compare_buffer_bin(const ProgramBuffer &pb, std::string filename,
+			float delta = 0.001f, bool dfrac = false,
+			cmp_stats *stats = nullptr);
+
+	/** Compare a buffer against a golden output in NumPy .npy form.
+	 *
+	 * The shape of the file must match the buffer dimensions.
+	 * @param pb ProgramBuffer to compare against.
+	 * @param filename Name of file that contains golden values.
+	 * @param delta Tolerable delta.
+	 * @param dfrac True iff delta should be interpreted as a fractional
+	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
+	 * @return True iff the buffer matches the golden values. */
+	bool compare_buffer_npy(const ProgramBuffer &pb, std::string filename,
+			float delta = 0.001f, bool dfrac = false,
+			cmp_stats *stats = nullptr);
+
+	/** Compare a buffer against a golden output in CSV form.
+	 * @param pb ProgramBuffer to compare against.
+	 * @param filename Name of file that contains golden values.
+	 * @param delta Tolerable delta.
+	 * @param dfrac True iff delta should be interpreted as a fractional
+	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
+	 * @return True iff the buffer matches the golden values. */
+	bool compare_buffer_csv(const ProgramBuffer &pb, std::string filename,
+			float delta = 0.001f, bool dfrac = false,
+			cmp_stats *stats = nullptr);
+};
+
+}
+
+#endif /* MODEL_BUFFERSTORE_H */
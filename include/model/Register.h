@@ -22,6 +22,7 @@
 #include <systemc>
 
 #include "util/constmath.h"
+#include "util/defaults.h"
 #include "util/parse.h"
 
 using namespace sc_dt;
@@ -113,7 +114,7 @@ public:
 	RegisterType type;
 
 	/** Which workgroup is active. */
-	sc_uint<1> wg;
+	sc_uint<COMPUTE_WG_WIDTH> wg;
 
 	/** Which row to write to. */
 	sc_uint<const_log2(64)> row;
@@ -122,7 +123,7 @@ public:
 	AbstractRegister();
 
 	/** Constructor. */
-	AbstractRegister(sc_uint<1> workgroup, RegisterType t,
+	AbstractRegister(sc_uint<COMPUTE_WG_WIDTH> workgroup, RegisterType t,
 			sc_uint<const_log2(64)> r);
 
 	/** Virtual destructor. */
@@ -290,7 +291,7 @@ public:
 	 * @return True iff these abstract registers are equal.
 	 */
 	inline bool
-	operator==(const AbstractRegister &r)
+	operator==(const AbstractRegister &r) const
 	{
 		if (type == REGISTER_NONE)
 			return r.type == REGISTER_NONE;
@@ -303,7 +304,7 @@ public:
 	 * @return False iff these abstract registers are equal.
 	 */
 	inline bool
-	operator!=(const AbstractRegister &r)
+	operator!=(const AbstractRegister &r) const
 	{
 		return !(*this == r);
 	}
@@ -336,14 +337,14 @@ public:
 
 	/** Constructor providing just workgroup.
 	 * @param w Workgroup. */
-	Register(sc_uint<1> w) : AbstractRegister(w, REGISTER_NONE, 0), col(0) {}
+	Register(sc_uint<COMPUTE_WG_WIDTH> w) : AbstractRegister(w, REGISTER_NONE, 0), col(0) {}
 
 	/** Full constructor.
 	 * @param w Workgroup
 	 * @param t Type of register.
 	 * @param r Row.
 	 * @param c Column, forced to 0 for scalar registers. */
-	Register(sc_uint<1> w, RegisterType t, sc_uint<const_log2(64)> r,
+	Register(sc_uint<COMPUTE_WG_WIDTH> w, RegisterType t, sc_uint<const_log2(64)> r,
 			sc_uint<const_log2(COLS)> c) : AbstractRegister(w, t, r)
 	{
 		switch (type) {
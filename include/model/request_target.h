@@ -22,6 +22,7 @@
 #include <systemc>
 
 #include "util/constmath.h"
+#include "util/defaults.h"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -36,12 +37,14 @@ typedef enum {
 	TARGET_CAM = 2,
 } req_dest_type_t;
 
+/** SimdCluster interfaces. Scratchpad interfaces for work-group slots beyond
+ * the first two are addressed as IF_SP_WG0 + slot. */
 typedef enum {
 	IF_SP_WG0 = 0,
 	IF_SP_WG1 = 1,
-	IF_RF = 2,
-	IF_DRAM = 2,
-	IF_SENTINEL = 3,
+	IF_RF = COMPUTE_WG_SLOTS,
+	IF_DRAM = COMPUTE_WG_SLOTS,
+	IF_SENTINEL = COMPUTE_WG_SLOTS + 1,
 } req_if_t;
 
 /** Data class for the DRAM/SP controller to inform the register file which
@@ -50,16 +53,16 @@ class RequestTarget
 {
 public:
 	/** @todo To support multiple SimD clusters, add the cluster ID */
-	sc_uint<1> wg; /**< Work-group. */
+	sc_uint<COMPUTE_WG_WIDTH> wg; /**< Work-group. */
 	req_dest_type_t type; /**< Destination type. */
 
 	/** Default empty contstructor. */
 	RequestTarget() : wg(0), type(TARGET_NONE) {}
 
 	/** Constructor
-	 * @param w Work-group slot to target (0,1).
+	 * @param w Work-group slot to target.
 	 * @param d Destination type. */
-	RequestTarget(sc_uint<1> w, req_dest_type_t d)
+	RequestTarget(sc_uint<COMPUTE_WG_WIDTH> w, req_dest_type_t d)
 	: wg(w), type(d) {}
 
 	/** Return the SimdCluster interface for this register
@@ -71,7 +74,7 @@ public:
 		if (type == TARGET_REG || type == TARGET_CAM)
 			return IF_RF;
 
-		return wg == 0 ? IF_SP_WG0 : IF_SP_WG1;
+		return req_if_t(IF_SP_WG0 + wg);
 	}
 
 	/** Stream print operator */
@@ -45,8 +45,10 @@ typedef enum {
  */
 class stride_descriptor {
 private:
-	/** Destination register */
-	AbstractRegister *dst_reg;
+	/** Destination register. Held by value rather than as a polymorphic
+	 * clone, such that descriptors can be copied through FIFOs and signals
+	 * without heap allocations. Type REGISTER_NONE if unset. */
+	AbstractRegister dst_reg;
 
 public:
 	/** Ticket number.
@@ -97,41 +99,6 @@ public:
 	 * @param reg The abstract register base target for this transfer. */
 	stride_descriptor(AbstractRegister &reg);
 
-	/** Copy constructor.
-	 * @param v Object to copy values from. */
-	stride_descriptor(const stride_descriptor &v);
-
-	/** Destructor. */
-	~stride_descriptor();
-
-	/** Assignment costructor.
-	 * @param v Object to deep-copy values from.
-	 * @return Reference to new object &this. */
-	inline stride_descriptor &
-	operator=(const stride_descriptor &v)
-	{
-		if (v.dst_reg != nullptr)
-			dst_reg = v.dst_reg->clone();
-		else
-			dst_reg = nullptr;
-
-		type = v.type;
-		dst = v.dst;
-		addr = v.addr;
-		words = v.words;
-		period = v.period;
-		period_count = v.period_count;
-		dst_offset = v.dst_offset;
-		dst_period = v.dst_period;
-		dst_off_x = v.dst_off_x;
-		dst_off_y = v.dst_off_y;
-		write = v.write;
-		idx_transform = v.idx_transform;
-		ticket = v.ticket;
-
-		return *this;
-	}
-
 	/** Return the register target type for this descriptor.
 	 * @return The destination target type for this descriptor. */
 	req_dest_type_t getTargetType(void) const;
@@ -144,7 +111,7 @@ public:
 	 * work-items and warps in a work-group). Somewhere down the line this
 	 * might not have worked out.
 	 * @return The target base register for this transfer.  */
-	AbstractRegister *getTargetReg(void) const;
+	const AbstractRegister &getTargetReg(void) const;
 
 	/** SystemC mandatory print stream operation.
 	 * @param os Output stream.
@@ -193,11 +160,7 @@ public:
 		switch (dst.type){
 		case TARGET_REG:
 		case TARGET_CAM:
-			if ((dst_reg == nullptr && v.dst_reg != nullptr) ||
-			    (dst_reg != nullptr && v.dst_reg == nullptr))
-				return false;
-
-			if (dst_reg && *dst_reg != *v.dst_reg)
+			if (dst_reg != v.dst_reg)
 				return false;
 			break;
 		case TARGET_SP:
@@ -0,0 +1,362 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTIL_CHECKPOINT_H
+#define UTIL_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace simd_util {
+
+/** Checkpoint file format version. Bump on any incompatible change. */
+#define CKPT_VERSION 2
+
+/** Alignment of checkpoint sections in bytes. A multiple of the page size,
+ * such that sections can be used in-place from a mapped checkpoint. */
+#define CKPT_ALIGN 4096ul
+
+/** Section types of a checkpoint. Sections of the same type are told apart by
+ * an index, e.g. the DRAM channel or scratchpad. */
+typedef enum {
+	CKPT_CONFIG = 0,	/**< Build configuration and kernel. */
+	CKPT_WS,		/**< WorkScheduler enumeration position. */
+	CKPT_COMPUTE_STATS,	/**< compute_stats per cluster. */
+	CKPT_CMDARB_STATS,	/**< cmdarb_stats of all channels. */
+	CKPT_REFRESH,		/**< ckpt_refresh per DRAM channel. */
+	CKPT_SP,		/**< Scratchpad contents. */
+	CKPT_DRAM_ROWS,		/**< (bank, row) of each stored DRAM row. */
+	CKPT_DRAM_DATA,		/**< Data of each stored DRAM row. */
+	CKPT_SENTINEL
+} ckpt_tag;
+
+/** Refresh state of a DRAM channel. */
+typedef struct {
+	/** DRAM cycles since the last refresh interval elapsed. */
+	uint64_t counter;
+	/** Refreshes enqueued but not yet issued. */
+	uint32_t pending;
+	/** Padding. */
+	uint32_t pad;
+} ckpt_refresh;
+
+/** Checkpoint file header, stored at offset 0. */
+typedef struct {
+	/** "SIMDCKPT". */
+	char magic[8];
+	/** CKPT_VERSION. */
+	uint32_t version;
+	/** Number of sections. */
+	uint32_t sections;
+	/** Offset of the section table. */
+	uint64_t table;
+} ckpt_header;
+
+/** Checkpoint section table entry. */
+typedef struct {
+	/** Section type, a ckpt_tag. */
+	uint32_t tag;
+	/** Index among sections of the same type. */
+	uint32_t idx;
+	/** Offset of the section data, a multiple of CKPT_ALIGN. */
+	uint64_t offset;
+	/** Size of the section data in bytes. */
+	uint64_t bytes;
+} ckpt_section;
+
+/** Write a checkpoint file.
+ *
+ * A checkpoint is a header, followed by CKPT_ALIGN-aligned sections and a
+ * section table. Sections are streamed to the file, such that multi-GB DRAM
+ * images never need to be duplicated in memory. */
+class CheckpointWriter
+{
+private:
+	/** File descriptor, -1 if not open. */
+	int fd;
+
+	/** Current write offset. */
+	uint64_t pos;
+
+	/** Section table. */
+	vector<ckpt_section> table;
+
+	/** True iff a write failed. */
+	bool err;
+
+	/** Write data at the current offset.
+	 * @param data Data to write.
+	 * @param bytes Number of bytes to write. */
+	void
+	write_raw(const void *data, size_t bytes)
+	{
+		const char *p = (const char *) data;
+		ssize_t n;
+
+		while (bytes && !err) {
+			n = ::write(fd, p, bytes);
+			if (n <= 0) {
+				err = true;
+				break;
+			}
+
+			p += n;
+			bytes -= n;
+			pos += n;
+		}
+	}
+
+	/** Pad the file with zeroes up to the next multiple of CKPT_ALIGN. */
+	void
+	align(void)
+	{
+		static const char zero[CKPT_ALIGN] = {0};
+
+		if (pos % CKPT_ALIGN)
+			write_raw(zero, CKPT_ALIGN - (pos % CKPT_ALIGN));
+	}
+
+public:
+	/** Constructor. */
+	CheckpointWriter() : fd(-1), pos(0ul), err(false) {}
+
+	/** Checkpoint writers own a file descriptor, no copying. */
+	CheckpointWriter(const CheckpointWriter &) = delete;
+
+	/** Destructor. Abandons a checkpoint that was not closed. */
+	~CheckpointWriter()
+	{
+		if (fd >= 0)
+			::close(fd);
+	}
+
+	/** Create a checkpoint file, truncating an existing file.
+	 * @param path Path of the checkpoint file.
+	 * @return False iff the file could not be created. */
+	bool
+	open(const string &path)
+	{
+		ckpt_header h;
+
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			return false;
+
+		/* Placeholder, rewritten upon close(). */
+		memset(&h, 0, sizeof(h));
+		write_raw(&h, sizeof(h));
+
+		return !err;
+	}
+
+	/** Start a new section. Data written up to the next begin_section()
+	 * or close() is part of this section.
+	 * @param tag Section type.
+	 * @param idx Index among sections of the same type. */
+	void
+	begin_section(ckpt_tag tag, uint32_t idx)
+	{
+		align();
+		table.push_back({uint32_t(tag), idx, pos, 0ul});
+	}
+
+	/** Append data to the current section.
+	 * @param data Data to append.
+	 * @param bytes Number of bytes to append. */
+	void
+	write(const void *data, size_t bytes)
+	{
+		write_raw(data, bytes);
+		table.back().bytes += bytes;
+	}
+
+	/** Write a section in one go.
+	 * @param tag Section type.
+	 * @param idx Index among sections of the same type.
+	 * @param data Section data.
+	 * @param bytes Size of the section data in bytes. */
+	void
+	add_section(ckpt_tag tag, uint32_t idx, const void *data, size_t bytes)
+	{
+		begin_section(tag, idx);
+		write(data, bytes);
+	}
+
+	/** Write the section table and header, and close the file.
+	 * @return False iff any write to the checkpoint failed. */
+	bool
+	close(void)
+	{
+		ckpt_header h;
+
+		align();
+
+		memcpy(h.magic, "SIMDCKPT", 8);
+		h.version = CKPT_VERSION;
+		h.sections = table.size();
+		h.table = pos;
+
+		write_raw(table.data(), table.size() * sizeof(ckpt_section));
+
+		if (!err && pwrite(fd, &h, sizeof(h), 0) != sizeof(h))
+			err = true;
+
+		if (::close(fd))
+			err = true;
+		fd = -1;
+
+		return !err;
+	}
+};
+
+/** Read a checkpoint file.
+ *
+ * The file is mapped privately, copy-on-write. Sections can thus be used
+ * in-place and modified without affecting the file, and are only paged in
+ * when touched. Pointers into sections stay valid for the lifetime of this
+ * object. */
+class CheckpointReader
+{
+private:
+	/** Start of the mapping, nullptr if not open. */
+	char *base;
+
+	/** Size of the mapping in bytes. */
+	size_t size;
+
+	/** Section table. */
+	const ckpt_section *table;
+
+	/** Number of sections. */
+	uint32_t sections;
+
+public:
+	/** Constructor. */
+	CheckpointReader() : base(nullptr), size(0ul), table(nullptr),
+			sections(0u) {}
+
+	/** Checkpoint readers own a mapping, no copying. */
+	CheckpointReader(const CheckpointReader &) = delete;
+
+	/** Destructor. */
+	~CheckpointReader()
+	{
+		if (base)
+			munmap(base, size);
+	}
+
+	/** Map a checkpoint file.
+	 * @param path Path of the checkpoint file.
+	 * @return False iff the file could not be mapped or is not a valid
+	 * 	   checkpoint. */
+	bool
+	open(const string &path)
+	{
+		struct stat st;
+		const ckpt_header *h;
+		void *m;
+		int fd;
+
+		fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		if (fstat(fd, &st) || size_t(st.st_size) < sizeof(ckpt_header)) {
+			::close(fd);
+			return false;
+		}
+
+		m = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+				fd, 0);
+		::close(fd);
+		if (m == MAP_FAILED)
+			return false;
+
+		base = (char *) m;
+		size = st.st_size;
+
+		h = (const ckpt_header *) base;
+		if (memcmp(h->magic, "SIMDCKPT", 8) || h->version != CKPT_VERSION ||
+		    h->table + h->sections * sizeof(ckpt_section) > size)
+			return false;
+
+		table = (const ckpt_section *) &base[h->table];
+		sections = h->sections;
+
+		return true;
+	}
+
+	/** Look up a section.
+	 * @param tag Section type.
+	 * @param idx Index among sections of the same type.
+	 * @param bytes Size of the section in bytes, 0 if not found.
+	 * @return Pointer to the section data, nullptr if not found. */
+	void *
+	section(ckpt_tag tag, uint32_t idx, size_t &bytes) const
+	{
+		uint32_t i;
+
+		bytes = 0ul;
+
+		for (i = 0; i < sections; i++) {
+			if (table[i].tag != uint32_t(tag) || table[i].idx != idx)
+				continue;
+
+			if (table[i].offset + table[i].bytes > size)
+				return nullptr;
+
+			bytes = table[i].bytes;
+			return &base[table[i].offset];
+		}
+
+		return nullptr;
+	}
+
+	/** Copy a fixed-size section.
+	 * @param tag Section type.
+	 * @param idx Index among sections of the same type.
+	 * @param data Destination.
+	 * @param bytes Expected size of the section in bytes.
+	 * @return False iff the section does not exist or its size
+	 * 	   mismatches. */
+	bool
+	read(ckpt_tag tag, uint32_t idx, void *data, size_t bytes) const
+	{
+		size_t b;
+		void *s;
+
+		s = section(tag, idx, b);
+		if (!s || b != bytes)
+			return false;
+
+		memcpy(data, s, bytes);
+		return true;
+	}
+};
+
+}
+
+#endif /* UTIL_CHECKPOINT_H */
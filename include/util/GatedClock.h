@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTIL_GATEDCLOCK_H
+#define UTIL_GATEDCLOCK_H
+
+#include <systemc>
+
+#include "util/Quiescence.h"
+
+using namespace sc_core;
+
+namespace simd_util {
+
+/** Clock generator that skips edges in which the design is quiescent.
+ *
+ * Behaves like an sc_clock with a 50% duty cycle starting with a rising edge
+ * at time 0, until the Quiescence registry is enabled. From then on, at every
+ * falling edge the clock consults the registry. If every clock domain ticked
+ * since the latest activity and the earliest wake-up lies far enough in the
+ * future, the rising edges up to the wake-up are skipped.
+ *
+ * Counters that pass skipped edges unnoticed must add get_skipped() deltas to
+ * stay exact. Modules reading such a counter through a signal see it one edge
+ * late. For this reason the final two edges before a wake-up are never
+ * skipped: the first one updates the counter signal, the second one is the
+ * first at which modules observe the exact cycle again. */
+class GatedClock : public sc_module
+{
+public:
+	/** Clock output. Bind clock inputs to this signal. */
+	sc_signal<bool> out;
+
+private:
+	/** Clock period. */
+	sc_time period;
+
+	/** Time the clock is high. */
+	sc_time high;
+
+	/** Time of the most recent rising edge. */
+	sc_time last_rise;
+
+	/** Total number of rising edges skipped. */
+	unsigned long skipped;
+
+	/** Number of rising edges the design can safely skip from the falling
+	 * edge following last_rise.
+	 * @return Number of rising edges to skip. */
+	unsigned long
+	skippable(void)
+	{
+		Quiescence &q = Quiescence::get();
+		sc_time t;
+		sc_dt::uint64 edges;
+
+		if (!q.is_enabled() || !(q.last_activity() < last_rise))
+			return 0ul;
+
+		t = q.earliest();
+		if (t == sc_max_time() || t <= last_rise)
+			return 0ul;
+
+		edges = (t - last_rise).value() / period.value();
+		if (edges <= 2)
+			return 0ul;
+
+		return edges - 2;
+	}
+
+	/** Toggle the clock output, skipping idle rising edges. */
+	void
+	method_toggle(void)
+	{
+		unsigned long skip;
+
+		if (!out.read()) {
+			last_rise = sc_time_stamp();
+			out.write(true);
+			next_trigger(high);
+			return;
+		}
+
+		out.write(false);
+
+		skip = skippable();
+		skipped += skip;
+		next_trigger((period - high) + (period * double(skip)));
+	}
+
+public:
+	SC_HAS_PROCESS(GatedClock);
+
+	/** Constructor.
+	 * @param name Name of this clock.
+	 * @param p Clock period. */
+	GatedClock(sc_module_name name, const sc_time &p)
+	: sc_module(name), out("out"), period(p), high(p / 2.),
+	  last_rise(SC_ZERO_TIME), skipped(0ul)
+	{
+		SC_METHOD(method_toggle);
+	}
+
+	/** Return the clock period.
+	 * @return The clock period. */
+	const sc_time &
+	get_period(void) const
+	{
+		return period;
+	}
+
+	/** Return the total number of rising edges skipped so far.
+	 *
+	 * Clients keep track of the last value they observed, and add the
+	 * difference to their cycle counters.
+	 * @return Total number of rising edges skipped. */
+	unsigned long
+	get_skipped(void) const
+	{
+		return skipped;
+	}
+};
+
+}
+
+#endif /* UTIL_GATEDCLOCK_H */
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTIL_QUIESCENCE_H
+#define UTIL_QUIESCENCE_H
+
+#include <systemc>
+#include <vector>
+
+using namespace sc_core;
+using namespace std;
+
+namespace simd_util {
+
+/** Registry of quiescence declarations.
+ *
+ * Modules that can predict their own future register themselves as a client.
+ * On every clock edge each client declares either that it is busy, or that
+ * none of its state or outputs change before a given point in simulated time
+ * unless one of its inputs changes first. A GatedClock uses the earliest of
+ * these wake-up times to skip clock edges in which nothing would happen.
+ *
+ * Any client declaring itself busy marks the current time as the latest
+ * activity. Clocks only skip edges after having ticked at least once past the
+ * latest activity, giving every clock domain the opportunity to observe the
+ * outputs of a busy module before going quiet. Hence a client may only declare
+ * itself idle if it did not alter any of its outputs in the current cycle.
+ *
+ * The protocol is disabled by default, in which case no clock edges are ever
+ * skipped. */
+class Quiescence
+{
+private:
+	/** Earliest wake-up time for each client. */
+	vector<sc_time> wake;
+
+	/** Time of the latest busy declaration. */
+	sc_time activity;
+
+	/** True iff clocks may skip edges. */
+	bool enabled;
+
+	/** Constructor. */
+	Quiescence() : activity(SC_ZERO_TIME), enabled(false) {}
+
+public:
+	/** Return the global quiescence registry.
+	 * @return Reference to the registry shared by all clocks and
+	 * 	   clients. */
+	static Quiescence &
+	get(void)
+	{
+		static Quiescence q;
+
+		return q;
+	}
+
+	/** Enable or disable skipping of idle clock edges.
+	 * @param e True iff clocks may skip idle edges. */
+	void
+	enable(bool e)
+	{
+		enabled = e;
+	}
+
+	/** Return whether skipping of idle clock edges is enabled.
+	 * @return True iff clocks may skip idle edges. */
+	bool
+	is_enabled(void) const
+	{
+		return enabled;
+	}
+
+	/** Register a new client. A client is considered busy until its first
+	 * declaration.
+	 * @return Identifier of the new client. */
+	unsigned int
+	add_client(void)
+	{
+		wake.push_back(SC_ZERO_TIME);
+
+		return wake.size() - 1;
+	}
+
+	/** Declare client id busy in the current cycle.
+	 * @param id Client identifier. */
+	void
+	busy(unsigned int id)
+	{
+		wake[id] = sc_time_stamp();
+		activity = sc_time_stamp();
+	}
+
+	/** Declare that client id does not change until time t.
+	 * @param id Client identifier.
+	 * @param t Time of the clock edge at which the client must be evaluated
+	 * 	    again. */
+	void
+	idle_until(unsigned int id, const sc_time &t)
+	{
+		wake[id] = t;
+	}
+
+	/** Declare that client id does not change until one of its inputs
+	 * changes.
+	 * @param id Client identifier. */
+	void
+	idle(unsigned int id)
+	{
+		wake[id] = sc_max_time();
+	}
+
+	/** Return the earliest wake-up time over all clients.
+	 * @return Earliest wake-up time, sc_max_time() if all clients are idle
+	 * 	   indefinitely. */
+	sc_time
+	earliest(void) const
+	{
+		sc_time t = sc_max_time();
+
+		for (const sc_time &w : wake) {
+			if (w < t)
+				t = w;
+		}
+
+		return t;
+	}
+
+	/** Return the time of the latest busy declaration.
+	 * @return Time of the latest busy declaration. */
+	const sc_time &
+	last_activity(void) const
+	{
+		return activity;
+	}
+};
+
+}
+
+#endif /* UTIL_QUIESCENCE_H */
@@ -0,0 +1,324 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTIL_RINGCHANNEL_H
+#define UTIL_RINGCHANNEL_H
+
+#include <systemc>
+
+#include "util/Ringbuffer.h"
+
+using namespace sc_core;
+using namespace std;
+
+namespace simd_util {
+
+/** Read interface of a RingChannel.
+ *
+ * Extends sc_fifo_in_if with the tlm_fifo style used(), size(), get() and
+ * nb_peek() methods, such that ports can inspect queued elements without
+ * binding to the concrete channel. */
+template <class T>
+class RingChannel_in_if : public sc_fifo_in_if<T>
+{
+public:
+	/** Return the number of elements available for reading.
+	 * @return Number of elements available for reading. */
+	virtual int used(void) const = 0;
+
+	/** Return the depth of this FIFO.
+	 * @return Number of slots. */
+	virtual int size(void) const = 0;
+
+	/** Blocking read, tlm_fifo style.
+	 * @return The head element. */
+	virtual T get(void) = 0;
+
+	/** Inspect an element without removing it from the FIFO.
+	 * @param v Reference to store a copy of the element in.
+	 * @param n Position of the element, 0 being the head.
+	 * @return True iff the FIFO holds at least n + 1 readable elements. */
+	virtual bool nb_peek(T &v, int n = 0) const = 0;
+};
+
+/** Write interface of a RingChannel.
+ *
+ * Extends sc_fifo_out_if with the tlm_fifo style put() and nb_can_put()
+ * methods. */
+template <class T>
+class RingChannel_out_if : public sc_fifo_out_if<T>
+{
+public:
+	/** Blocking write, tlm_fifo style.
+	 * @param v Element to copy into the FIFO. */
+	virtual void put(const T &v) = 0;
+
+	/** Return whether a write would succeed, tlm_fifo style.
+	 * @return True iff at least one slot is free. */
+	virtual bool nb_can_put(void) const = 0;
+};
+
+/** Bounded single-producer single-consumer FIFO channel.
+ *
+ * Drop-in replacement for sc_fifo, binding to sc_fifo_in and sc_fifo_out
+ * ports, that additionally provides the tlm_fifo style used(), get(), put(),
+ * nb_can_put() and nb_peek() methods. Like sc_fifo, elements written become
+ * readable and space freed by reads becomes writable only after the update
+ * phase of the current delta cycle, so a design behaves identically with
+ * either channel.
+ *
+ * Elements are stored in a Ringbuffer and copied into their slot. The element
+ * types in this tree hold plain arrays only, so there is nothing to gain from
+ * moving them. The data written and data read events are only notified when a blocked reader
+ * or writer may be waiting for them, that is when the FIFO turns non-empty or
+ * non-full respectively. Processes must thus not be statically sensitive to
+ * these events. Ports that need the tlm_fifo style methods bind to
+ * RingChannel_in_if or RingChannel_out_if. */
+template <class T>
+class RingChannel : public sc_prim_channel, public RingChannel_in_if<T>,
+		public RingChannel_out_if<T>
+{
+private:
+	/** Element storage. */
+	Ringbuffer<T> buf;
+
+	/** Number of slots. */
+	int depth;
+
+	/** Slot of the next element to read. */
+	unsigned int rd;
+
+	/** Slot of the next element to write. */
+	unsigned int wr;
+
+	/** Number of elements readable in the current delta cycle. */
+	int readable;
+
+	/** Number of elements read in the current delta cycle. */
+	int num_read;
+
+	/** Number of elements written in the current delta cycle. */
+	int num_written;
+
+	/** Notified when data was written to an empty FIFO. */
+	sc_event written_event;
+
+	/** Notified when data was read from a full FIFO. */
+	sc_event read_event;
+
+public:
+	/** Constructor.
+	 * @param d Depth of the FIFO in number of elements. */
+	explicit RingChannel(int d = 16)
+	: sc_prim_channel(sc_gen_unique_name("ring_channel")), buf(d), depth(d),
+	  rd(0u), wr(0u), readable(0), num_read(0), num_written(0)
+	{
+	}
+
+	/** Constructor.
+	 * @param name Name of this channel.
+	 * @param d Depth of the FIFO in number of elements. */
+	RingChannel(const char *name, int d = 16)
+	: sc_prim_channel(name), buf(d), depth(d), rd(0u), wr(0u),
+	  readable(0), num_read(0), num_written(0)
+	{
+	}
+
+	/** Return the number of elements available for reading.
+	 * @return Number of elements available for reading. */
+	int
+	num_available(void) const override
+	{
+		return readable - num_read;
+	}
+
+	/** Return the number of free slots.
+	 * @return Number of slots available for writing. */
+	int
+	num_free(void) const override
+	{
+		return depth - readable - num_written;
+	}
+
+	/** Return the number of elements available for reading.
+	 * @return Number of elements available for reading. */
+	int
+	used(void) const override
+	{
+		return num_available();
+	}
+
+	/** Return the depth of this FIFO.
+	 * @return Number of slots. */
+	int
+	size(void) const override
+	{
+		return depth;
+	}
+
+	/** Non-blocking read.
+	 * @param v Reference to store the head element in.
+	 * @return True iff an element was read. */
+	bool
+	nb_read(T &v) override
+	{
+		if (num_available() == 0)
+			return false;
+
+		v = buf.getStage(rd);
+		rd = (rd + 1) % depth;
+		num_read++;
+		request_update();
+
+		return true;
+	}
+
+	/** Blocking read.
+	 * @param v Reference to store the head element in. */
+	void
+	read(T &v) override
+	{
+		while (num_available() == 0)
+			wait(written_event);
+
+		nb_read(v);
+	}
+
+	/** Blocking read.
+	 * @return The head element. */
+	T
+	read(void) override
+	{
+		T v;
+
+		read(v);
+		return v;
+	}
+
+	/** Blocking read, tlm_fifo style.
+	 * @return The head element. */
+	T
+	get(void) override
+	{
+		return read();
+	}
+
+	/** Inspect an element without removing it from the FIFO.
+	 * @param v Reference to store a copy of the element in.
+	 * @param n Position of the element, 0 being the head.
+	 * @return True iff the FIFO holds at least n + 1 readable elements. */
+	bool
+	nb_peek(T &v, int n = 0) const override
+	{
+		if (n < 0 || n >= num_available())
+			return false;
+
+		v = buf.getStage((rd + n) % depth);
+
+		return true;
+	}
+
+	/** Non-blocking write.
+	 * @param v Element to copy into the FIFO.
+	 * @return True iff the element was written. */
+	bool
+	nb_write(const T &v) override
+	{
+		if (num_free() == 0)
+			return false;
+
+		buf.getStage(wr) = v;
+		wr = (wr + 1) % depth;
+		num_written++;
+		request_update();
+
+		return true;
+	}
+
+	/** Blocking write.
+	 * @param v Element to copy into the FIFO. */
+	void
+	write(const T &v) override
+	{
+		while (num_free() == 0)
+			wait(read_event);
+
+		nb_write(v);
+	}
+
+	/** Blocking write, tlm_fifo style.
+	 * @param v Element to copy into the FIFO. */
+	void
+	put(const T &v) override
+	{
+		write(v);
+	}
+
+	/** Return whether a write would succeed, tlm_fifo style.
+	 * @return True iff at least one slot is free. */
+	bool
+	nb_can_put(void) const override
+	{
+		return num_free() > 0;
+	}
+
+	/** Event notified when data is written into an empty FIFO.
+	 * @return The data written event. */
+	const sc_event &
+	data_written_event(void) const override
+	{
+		return written_event;
+	}
+
+	/** Event notified when data is read from a full FIFO.
+	 * @return The data read event. */
+	const sc_event &
+	data_read_event(void) const override
+	{
+		return read_event;
+	}
+
+	/** Return the kind of this channel.
+	 * @return String identifying the channel type. */
+	const char *
+	kind(void) const override
+	{
+		return "RingChannel";
+	}
+
+protected:
+	/** Make the elements written in this delta cycle readable, and the
+	 * slots read in this delta cycle writable. */
+	void
+	update(void) override
+	{
+		if (num_written > 0 && readable - num_read == 0)
+			written_event.notify(SC_ZERO_TIME);
+
+		if (num_read > 0 && depth - readable - num_written == 0)
+			read_event.notify(SC_ZERO_TIME);
+
+		readable += num_written - num_read;
+		num_read = 0;
+		num_written = 0;
+	}
+};
+
+}
+
+#endif /* UTIL_RINGCHANNEL_H */
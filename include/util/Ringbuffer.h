@@ -20,6 +20,8 @@
 #define UTIL_RINGBUFFER_H
 
 #include <exception>
+#include <stdexcept>
+#include <string>
 
 using namespace std;
 
@@ -129,6 +131,22 @@ public:
 		return buf[stage];
 	}
 
+	/** Return a const reference to the requested pipeline stage.
+	 *
+	 * @param stage Desired pipeline stage (0 .. #entries).
+	 * @return The requested pipeline stage entry. */
+	const T &
+	getStage(unsigned int stage) const
+	{
+		if (stage >= entries)
+			throw invalid_argument("Stage must be between 0 and "
+				+ to_string(entries-1) + ", " + to_string(stage) + "provided.");
+
+		stage = (head + stage) % entries;
+
+		return buf[stage];
+	}
+
 	/** Obtain the entry for the last stage of the pipeline.
 	 * @return The entry for the last stage of the pipeline. */
 	T &
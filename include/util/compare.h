@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef UTIL_COMPARE_H
+#define UTIL_COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/** Number of ULP-distance histogram buckets. Bucket 0 counts exact matches,
+ * bucket i > 0 counts distances in [2^(i-1), 2^i). The last bucket also
+ * counts NaN mismatches. */
+#define CMP_ULP_BUCKETS 34
+
+/** Maximum number of mismatching indexes recorded. */
+#define CMP_MAX_REPORT 10
+
+/** Error statistics of a comparison between a result and a golden buffer. */
+typedef struct {
+	/** Number of words compared. */
+	size_t words;
+	/** Number of words exceeding the tolerated error. */
+	size_t mismatches;
+	/** Maximum absolute error. */
+	double max_abs;
+	/** Maximum relative error. */
+	double max_rel;
+	/** ULP-distance histogram. */
+	size_t ulp_hist[CMP_ULP_BUCKETS];
+	/** Number of valid entries in mismatch_idx. */
+	unsigned int reported;
+	/** Lowest indexes of mismatching words. */
+	size_t mismatch_idx[CMP_MAX_REPORT];
+	/** Reason the comparison could not be performed, nullptr if it was. */
+	const char *error;
+} cmp_stats;
+
+/** Compare a buffer of floats against golden values.
+ *
+ * The buffer is split in chunks that are compared on separate threads. Each
+ * chunk is processed with branch-free loops amenable to vectorisation.
+ * @param res Result buffer.
+ * @param gold Golden values.
+ * @param words Number of words in both buffers.
+ * @param delta Tolerated error.
+ * @param dfrac True iff delta is a fraction of the golden value rather than
+ * 		an absolute error.
+ * @param s Statistics object to store the results in.
+ * @param threads Number of threads, 0 for the number of online CPUs. */
+void cmp_float_buffers(const float *res, const float *gold, size_t words,
+		float delta, bool dfrac, cmp_stats *s, unsigned int threads = 0);
+
+/** Print a human-readable summary of comparison statistics.
+ * @param os Output stream.
+ * @param s Statistics to print. */
+void cmp_print(std::ostream &os, const cmp_stats &s);
+
+/** Record why a comparison could not be performed.
+ * @param s Statistics object, may be nullptr.
+ * @param error Reason, a string literal. */
+inline void
+cmp_set_error(cmp_stats *s, const char *error)
+{
+	if (s)
+		s->error = error;
+}
+
+/** Print comparison statistics as a JSON object.
+ *
+ * Non-finite errors are printed as null. The "ok" member is true iff the
+ * comparison was performed and found no mismatches.
+ * @param os Output stream.
+ * @param s Statistics to print.
+ * @param name Name of the compared buffer/file, for identification. */
+void cmp_print_json(std::ostream &os, const cmp_stats &s,
+		const std::string &name);
+
+#endif /* UTIL_COMPARE_H */
@@ -71,6 +71,19 @@ const dram_timing *getTiming(const std::string speed, const std::string org,
  */
 size_t bursts(const dram_timing *dram, size_t request_length, int aligned);
 
+/** Determine the number of bursts the busiest DRAM channel serves for a
+ * transfer that is interleaved over multiple channels.
+ * @param dram Pointer to set of timing parameters.
+ * @param request_length Request size in bytes.
+ * @param aligned 1 If this transfer is aligned to the start of a bank-pair.
+ * @param chans Number of DRAM channels.
+ * @param interleave Channel interleaving granularity in bytes.
+ * @return Upper bound on the number of bursts issued to a single channel.
+ */
+size_t chan_bursts(const dram_timing *dram, size_t request_length, int aligned,
+		unsigned int chans = MC_DRAM_CHANS,
+		unsigned int interleave = MC_DRAM_CHAN_INTERLEAVE);
+
 /** Determine the least issue delay for a read of given bursts.
  * @param dram Pointer to set of timing parameters.
  * @param bursts Number of bursts required.
@@ -28,6 +28,8 @@
 /* Memory controller definitions */
 #ifndef MC_DRAM_CHANS
 #define MC_DRAM_CHANS 1
+#elif (MC_DRAM_CHANS & (MC_DRAM_CHANS - 1)) != 0
+#error "Configuration error: MC_DRAM_CHANS must be power of two."
 #endif
 
 #ifndef MC_BIND_BUFS
@@ -76,6 +78,17 @@
 	"restriction might be lifted in the future."
 #endif
 
+/* Consecutive blocks of this many bytes are distributed round-robin over the
+ * DRAM channels. */
+#ifndef MC_DRAM_CHAN_INTERLEAVE
+#define MC_DRAM_CHAN_INTERLEAVE 256
+#elif (MC_DRAM_CHAN_INTERLEAVE & (MC_DRAM_CHAN_INTERLEAVE - 1)) != 0
+#error "Configuration error: MC_DRAM_CHAN_INTERLEAVE must be power of two."
+#elif MC_DRAM_CHAN_INTERLEAVE < (MC_BUS_WIDTH * 4)
+#error "Configuration error: MC_DRAM_CHAN_INTERLEAVE must be at least one " \
+	"burst (MC_BUS_WIDTH * 4 bytes)."
+#endif
+
 /* Scratchpad definitions */
 #ifndef SP_BYTES
 #define SP_BYTES 131072
@@ -87,8 +100,9 @@
 #define SP_BUS_WIDTH 4
 #elif (SP_BUS_WIDTH & (SP_BUS_WIDTH - 1)) != 0
 #error "Configuration error: SP_BUS_WIDTH must be power of two."
-#elif SP_BUS_WIDTH < (MC_BUS_WIDTH/4)
-#error "Configuration error: SP_BUS_WIDTH must be larger or equal to MC_BUS_WIDTH/4."
+#elif SP_BUS_WIDTH < (MC_DRAM_CHANS * MC_BUS_WIDTH/4)
+#error "Configuration error: SP_BUS_WIDTH must be larger or equal to " \
+	"MC_DRAM_CHANS * MC_BUS_WIDTH/4."
 #endif
 
 /* Compute definitions. */
@@ -116,10 +130,31 @@
 #error "Configuration error: COMPUTE_IMEM_INSNS must be power of two."
 #endif
 
+#ifndef COMPUTE_CLUSTERS
+#define COMPUTE_CLUSTERS 1
+#elif COMPUTE_CLUSTERS < 1
+#error "Configuration error: COMPUTE_CLUSTERS must be at least 1."
+#endif
+
+/* Number of resident work-group slots per SimdCluster. Each slot has its own
+ * register file partition and scratchpad. */
+#ifndef COMPUTE_WG_SLOTS
+#define COMPUTE_WG_SLOTS 2
+#elif COMPUTE_WG_SLOTS < 2 || COMPUTE_WG_SLOTS > 4
+#error "Configuration error: COMPUTE_WG_SLOTS must be 2, 3 or 4."
+#endif
+
 #ifndef COMPUTE_CSTACK_ENTRIES
 #define COMPUTE_CSTACK_ENTRIES 16
 #endif
 
+/* Number of cycles all work-groups must be blocked on DRAM, on top of the
+ * pipeline depth, before a SimdCluster declares itself quiescent. */
+#ifndef COMPUTE_QUIESCE_CYCLES
+#define COMPUTE_QUIESCE_CYCLES 32
+#endif
+
 #define COMPUTE_PC_WIDTH const_log2(COMPUTE_IMEM_INSNS)
+#define COMPUTE_WG_WIDTH (const_log2(COMPUTE_WG_SLOTS - 1) + 1)
 
 #endif /* UTIL_DEFAULTS_H */
@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef UTIL_NPY_H
+#define UTIL_NPY_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** Memory-mapped view of a NumPy .npy (v1/v2) file holding 32-bit elements.
+ *
+ * Only C-order arrays of 4-byte little-endian elements ('<f4', '<i4', '<u4')
+ * of one or two dimensions are supported, which covers all Sim-D buffers. */
+typedef struct {
+	/** Base of the mapping, including header. */
+	void *map;
+	/** Length of the mapping in bytes. */
+	size_t map_len;
+	/** First data element. */
+	uint32_t *data;
+	/** Number of dimensions in the file, 1 or 2. */
+	unsigned int ndims;
+	/** Dimensions in the order stored in the file (rows, cols). */
+	size_t shape[2];
+	/** Total number of elements. */
+	size_t elems;
+	/** True iff the data is of type '<f4'. */
+	bool is_float;
+} npy_view;
+
+/** Map an existing .npy file read-only.
+ * @param file Path to the file.
+ * @param v View to initialise.
+ * @return 0 on success, negative errno on failure. */
+int npy_map(const char *file, npy_view *v);
+
+/** Create a .npy file of dim_y rows of dim_x '<f4' elements and map it
+ * read-write. Element data is zero-initialised.
+ * @param file Path to the file.
+ * @param dim_x Number of columns.
+ * @param dim_y Number of rows.
+ * @param v View to initialise.
+ * @return 0 on success, negative errno on failure. */
+int npy_create(const char *file, size_t dim_x, size_t dim_y, npy_view *v);
+
+/** Return whether a view matches the dimensions of a buffer.
+ *
+ * A (dim_y, dim_x) array matches, as does a flat array of dim_x * dim_y
+ * elements.
+ * @param v View.
+ * @param dim_x Number of columns of the buffer.
+ * @param dim_y Number of rows of the buffer.
+ * @return True iff the dimensions match. */
+bool npy_match_dims(const npy_view *v, size_t dim_x, size_t dim_y);
+
+/** Unmap a view, flushing any modifications to disk.
+ * @param v View to unmap. */
+void npy_unmap(npy_view *v);
+
+#endif /* UTIL_NPY_H */
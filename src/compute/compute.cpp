@@ -147,7 +147,7 @@ elaborate()
 	workscheduler.in_clk(clk);
 	workscheduler.in_work(test_work);
 	workscheduler.in_kick(test_kick);
-	workscheduler.out_wg(workscheduler_wg);
+	workscheduler.out_wg[0](workscheduler_wg);
 	workscheduler.out_imem_op[0](workscheduler_op_w[0]);
 	workscheduler.out_imem_op[1](workscheduler_op_w[1]);
 	workscheduler.out_imem_pc(workscheduler_pc_w);
@@ -156,7 +156,7 @@ elaborate()
 	workscheduler.out_dim[0](workscheduler_dim[0]);
 	workscheduler.out_dim[1](workscheduler_dim[1]);
 	workscheduler.out_end_prg(workscheduler_end_prg);
-	workscheduler.in_exec_fini(simdcluster_exec_fini);
+	workscheduler.in_exec_fini[0](simdcluster_exec_fini);
 	workscheduler.out_xlat_w(workscheduler_xlat_w);
 	workscheduler.out_xlat_idx_w(workscheduler_xlat_idx_w);
 	workscheduler.out_xlat_phys_w(workscheduler_xlat_phys_w);
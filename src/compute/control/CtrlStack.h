@@ -25,6 +25,8 @@
 
 #include "util/constmath.h"
 #include "util/debug_output.h"
+#include "util/defaults.h"
+#include "compute/model/ctrlstack.h"
 #include "compute/model/ctrlstack_entry.h"
 
 using namespace sc_core;
@@ -40,17 +42,15 @@ namespace compute_control {
  * @param LANES number of execution lanes (subwarp length).
  * @param PC_WIDTH Width of the program counter in bits.
  * @param ENTRIES Max. number of stack entries.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int THREADS, unsigned int LANES, unsigned int PC_WIDTH,
-	  unsigned int ENTRIES>
+	  unsigned int ENTRIES, unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class CtrlStack : public sc_module
 {
 private:
-	/** Storage for stack entries */
-	ctrlstack_entry<THREADS,PC_WIDTH> stack[2][ENTRIES];
-
-	/** Stack pointer */
-	sc_uint<const_log2(ENTRIES) + 1> sp[2];
+	/** Stack per work-group slot. */
+	ctrlstack<THREADS,PC_WIDTH,ENTRIES> stack[WG_SLOTS];
 
 public:
 	/** Compute clock. */
@@ -60,7 +60,7 @@ public:
 	sc_in<bool> in_rst{"in_rst"};
 
 	/** Work-group slot for the current action. */
-	sc_in<sc_uint<1> > in_wg{"in_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg{"in_wg"};
 
 	/** Action to perform this cycle (push, pop). */
 	sc_in<ctrlstack_action> in_action{"in_action"};
@@ -83,9 +83,6 @@ public:
 	/** Construct thread. */
 	SC_CTOR(CtrlStack)
 	{
-		sp[0] = 0;
-		sp[1] = 0;
-
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
 	}
@@ -94,9 +91,9 @@ public:
 	 * @param e Control stack entry to push.
 	 * @param wg Work-group slot number. */
 	void
-	debug_push(ctrlstack_entry<THREADS,PC_WIDTH> e, sc_uint<1> wg)
+	debug_push(ctrlstack_entry<THREADS,PC_WIDTH> e, sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
-		stack[wg][sp++] = e;
+		stack[wg].push(e);
 	}
 
 private:
@@ -114,7 +111,7 @@ private:
 	void
 	thread_lt(void)
 	{
-		sc_uint<1> wg;
+		sc_uint<COMPUTE_WG_WIDTH> wg;
 
 		do_rst();
 
@@ -123,27 +120,23 @@ private:
 				do_rst();
 			} else {
 				wg = in_wg.read();
-				assert(sp[wg] <= ENTRIES);
+				ctrlstack<THREADS,PC_WIDTH,ENTRIES> &s = stack[wg];
 
 				switch (in_action.read()) {
 				case CTRLSTACK_PUSH:
-					if (sp[wg] == ENTRIES) {
+					if (!s.push(in_entry.read())) {
 						out_ex_overflow.write(1);
 					} else {
 						out_ex_overflow.write(0);
-						stack[wg][sp[wg]] = in_entry.read();
-
-						sp[wg]++;
-						out_sp.write(sp[wg]);
+						out_sp.write(s.size());
 					}
 					break;
 				case CTRLSTACK_POP:
-					if (sp[wg] == 0) {
+					if (!s.pop()) {
 						out_ex_overflow.write(1);
 					} else {
 						out_ex_overflow.write(0);
-						sp[wg]--;
-						out_sp.write(sp[wg]);
+						out_sp.write(s.size());
 					}
 					break;
 				case CTRLSTACK_IDLE:
@@ -152,16 +145,16 @@ private:
 					break;
 				}
 
-				out_full.write((sp[wg] == ENTRIES ? 1 : 0));
+				out_full.write(s.full());
 
 				if (debug_output[DEBUG_COMPUTE_TRACE])
 					cout << sc_time_stamp() <<
-						" CtrlStack: SP=" << sp[wg] << " ";
+						" CtrlStack: SP=" << s.size() << " ";
 
-				if (sp[wg] > 0) {
-					out_top.write(stack[wg][sp[wg]-1]);
+				if (!s.empty()) {
+					out_top.write(s.top());
 					if (debug_output[DEBUG_COMPUTE_TRACE])
-						cout << stack[wg][sp[wg]-1] << endl;
+						cout << s.top() << endl;
 				} else {
 					out_top.write(ctrlstack_entry<THREADS,PC_WIDTH>());
 					if (debug_output[DEBUG_COMPUTE_TRACE])
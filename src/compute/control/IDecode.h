@@ -27,6 +27,7 @@
 #include "model/workgroup_width.h"
 #include "util/constmath.h"
 #include "util/debug_output.h"
+#include "util/defaults.h"
 
 using namespace std;
 using namespace sc_dt;
@@ -48,10 +49,12 @@ typedef enum {
  * @param FPUS number of FPUs/lanes in the execute phase.
  * @param RCPUS number of reciprocal units.
  * @param XLAT_ENTRIES Maximum number of buffers that can be mapped.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int PC_WIDTH, unsigned int THREADS = 1024,
 		unsigned int FPUS = 128, unsigned int RCPUS = 32,
-		unsigned int XLAT_ENTRIES = 32>
+		unsigned int XLAT_ENTRIES = 32,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class IDecode : public sc_module
 {
 protected:
@@ -99,20 +102,20 @@ public:
 	sc_in<sc_uint<PC_WIDTH> > in_pc{"in_pc"};
 
 	/** Currently active workgroup. */
-	sc_in<sc_uint<1> > in_wg{"in_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg{"in_wg"};
 
 	/** Width of each work group. */
 	sc_in<workgroup_width> in_wg_width{"in_wg_width"};
 
 	/** Identifier of last warp (number of active warps - 1). */
-	sc_in<sc_uint<const_log2(THREADS/FPUS)> > in_last_warp[2];
+	sc_in<sc_uint<const_log2(THREADS/FPUS)> > in_last_warp[WG_SLOTS];
 
 	/** True if a cstack pop should be issued. PC will change, so IMem
 	 * input can be disregarded as invalid. */
-	sc_in<sc_bv<2> > in_thread_active{"in_thread_active"};
+	sc_in<sc_bv<WG_SLOTS> > in_thread_active{"in_thread_active"};
 
 	/** Finished bit, comes slightly earlier than state. */
-	sc_in<sc_bv<2> > in_wg_finished{"in_wg_finished"};
+	sc_in<sc_bv<WG_SLOTS> > in_wg_finished{"in_wg_finished"};
 
 	/** Pass PC down the pipeline. */
 	sc_inout<sc_uint<PC_WIDTH> > out_pc{"out_pc"};
@@ -137,21 +140,21 @@ public:
 				{"out_enqueue_sb_cstack_write"};
 
 	/** Enqueue a control stack write to the scoreboard. */
-	sc_inout<sc_uint<1> > out_enqueue_sb_cstack_wg
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_enqueue_sb_cstack_wg
 				{"out_enqueue_sb_cstack_wg"};
 
 	/** True iff CPOPs must stall (until all scoreboard entries have been
 	 * committed). */
-	sc_in<bool> in_sb_cpop_stall[2];
+	sc_in<bool> in_sb_cpop_stall[WG_SLOTS];
 
 	/** Read requests mirrored to the scoreboard. Async. */
 	sc_inout<Register<THREADS/FPUS> > out_req_w_sb{"out_req_w_sb"};
 
 	/** Bitmap of currently populated Scoreboard CAM slots. */
-	sc_in<sc_bv<32> > in_entries_pop[2];
+	sc_in<sc_bv<32> > in_entries_pop[WG_SLOTS];
 
 	/** Currently active workgroup. */
-	sc_inout<sc_uint<1> > out_wg{"out_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg{"out_wg"};
 
 	/** Column to write result of instruction to. Used for IExecute and
 	 * write mask retrieval. */
@@ -417,7 +420,7 @@ protected:
 	 * @param wg  Active work-group slot. */
 	void
 	forward_read_req(unsigned int i, reg_read_req<THREADS/FPUS> &req,
-			Instruction &op, unsigned int col, sc_uint<1> wg)
+			Instruction &op, unsigned int col, sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		/* Only issue this read operation once for all subcolumns. */
 		if (opCategory(op.getOp()) == CAT_ARITH_RCPU && getSubcol(op) != 0)
@@ -620,7 +623,7 @@ protected:
 	 * @return true iff this instruction can advance from IDecode to
 	 * 	   IExecute. */
 	bool
-	op_can_issue(Instruction &op, sc_uint<1> wg)
+	op_can_issue(Instruction &op, sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		if (op.getOp() == OP_CPOP && !op.isDead() && in_sb_cpop_stall[wg].read())
 			return false;
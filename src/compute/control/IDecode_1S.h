@@ -40,61 +40,63 @@ namespace compute_control {
  * @param PC_WIDTH Number of bits in a PC.
  * @param THREADS Total number of threads in a workgroup.
  * @param LANES Number of vector lanes in each SIMD cluster.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int PC_WIDTH, unsigned int THREADS = 1024,
 		unsigned int FPUS = 128, unsigned int RCPUS = 32,
-		unsigned int XLAT_ENTRIES = 32>
-class IDecode_1S : public IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>
+		unsigned int XLAT_ENTRIES = 32,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
+class IDecode_1S : public IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>
 {
 protected:
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::active_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::raw_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::read_bank_conflict_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::resource_busy_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::last_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::getCol;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::getSubcol;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_add_implicit_src;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_process_implicit_dst;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::forward_read_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::sb_write_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_ldst_xlat_idx;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::select_op;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::first_conflict;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::debug_print_stall;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::set_sidiv_stall_counters;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::decrement_sidiv_stall_counters;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_can_issue;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::active_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::raw_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::read_bank_conflict_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::resource_busy_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::last_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::getCol;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::getSubcol;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_add_implicit_src;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_process_implicit_dst;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::forward_read_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::sb_write_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_ldst_xlat_idx;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::select_op;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::first_conflict;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::debug_print_stall;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::set_sidiv_stall_counters;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::decrement_sidiv_stall_counters;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_can_issue;
 	using sc_module::sensitive;
 	using sc_module::wait;
 
 public:
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_clk;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_insn;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_pc;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_wg;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_last_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_thread_active;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_wg_finished;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_pc;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_insn;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_ssp_match;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_enqueue_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req_w_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_wg;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_col_w;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_subcol_w;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_stall_f;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_raw;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_req_conflicts;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_pipe_flush;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_xlat_idx;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_clk;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_insn;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_pc;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_wg;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_last_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_thread_active;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_wg_finished;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_pc;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_insn;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_ssp_match;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_enqueue_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req_w_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_wg;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_col_w;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_subcol_w;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_stall_f;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_raw;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_req_conflicts;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_pipe_flush;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_xlat_idx;
 
 	/** Construct thread. */
 	SC_CTOR(IDecode_1S)
-	: IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>()
+	: IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>()
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
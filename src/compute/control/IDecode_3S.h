@@ -20,6 +20,7 @@
 #define COMPUTE_CONTROL_IDECODE_3S_H
 
 #include "compute/control/IDecode.h"
+#include "compute/model/operand_bus.h"
 
 using namespace std;
 using namespace sc_dt;
@@ -42,7 +43,7 @@ class IDecode_pipe
 {
 public:
 	Instruction insn; /**< Instruction. */
-	sc_uint<1> wg; /**< Associated work-group. */
+	sc_uint<COMPUTE_WG_WIDTH> wg; /**< Associated work-group. */
 	sc_uint<PC_WIDTH> pc; /**< Program counter for this instruction. */
 	sc_uint<const_log2(THREADS/FPUS)> col_w; /**< Column for write-back. */
 	sc_uint<const_log2(FPUS/RCPUS)> subcol_w; /**< Sub-column for write-back */
@@ -55,7 +56,7 @@ public:
 	}
 
 	/** New entry constructor. */
-	IDecode_pipe(Instruction i, sc_uint<1> w, sc_uint<PC_WIDTH> p,
+	IDecode_pipe(Instruction i, sc_uint<COMPUTE_WG_WIDTH> w, sc_uint<PC_WIDTH> p,
 			sc_uint<const_log2(THREADS/FPUS)> c,
 			sc_uint<const_log2(FPUS/RCPUS)> sc)
 	: insn(i), wg(w), pc(p), col_w(c), subcol_w(sc)
@@ -110,60 +111,62 @@ public:
  * @param THREADS Total number of threads in a workgroup.
  * @param LANES Number of vector lanes in each SIMD cluster.
  * @param XLAT_ENTRIES Number of supported mapped buffers.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int PC_WIDTH, unsigned int THREADS = 1024,
 		unsigned int FPUS = 128, unsigned int RCPUS = 32,
-		unsigned int XLAT_ENTRIES = 32>
-class IDecode_3S : public IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>
+		unsigned int XLAT_ENTRIES = 32,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
+class IDecode_3S : public IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>
 {
 protected:
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::active_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::raw_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::read_bank_conflict_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::resource_busy_stalls;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::last_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::getCol;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::getSubcol;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_add_implicit_src;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_process_implicit_dst;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::forward_read_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::sb_write_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_ldst_xlat_idx;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_entries_pop;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::select_op;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::first_conflict;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::debug_print_stall;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::set_sidiv_stall_counters;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::decrement_sidiv_stall_counters;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::op_can_issue;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::active_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::raw_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::read_bank_conflict_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::resource_busy_stalls;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::last_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::getCol;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::getSubcol;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_add_implicit_src;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_process_implicit_dst;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::forward_read_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::sb_write_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_ldst_xlat_idx;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_entries_pop;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::select_op;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::first_conflict;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::debug_print_stall;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::set_sidiv_stall_counters;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::decrement_sidiv_stall_counters;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::op_can_issue;
 	using sc_module::sensitive;
 	using sc_module::wait;
 
 public:
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_clk;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_insn;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_pc;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_wg;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_wg_width;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_last_warp;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_thread_active;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_wg_finished;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_pc;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_insn;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_ssp_match;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_enqueue_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_enqueue_sb_cstack_write;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_req_w_sb;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_wg;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_col_w;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_subcol_w;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_stall_f;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_raw;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_req_conflicts;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::in_pipe_flush;
-	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>::out_xlat_idx;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_clk;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_insn;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_pc;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_wg;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_wg_width;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_last_warp;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_thread_active;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_wg_finished;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_pc;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_insn;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_ssp_match;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_enqueue_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_enqueue_sb_cstack_write;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_req_w_sb;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_wg;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_col_w;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_subcol_w;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_stall_f;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_raw;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_req_conflicts;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::in_pipe_flush;
+	using IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>::out_xlat_idx;
 
 	/** Incoming operands from register file. */
 	sc_in<sc_uint<32> > in_operand[2][FPUS];
@@ -172,6 +175,16 @@ public:
 	 * straight from the register file. */
 	sc_inout<sc_uint<32> > out_operand[2][FPUS];
 
+	/** Incoming operands from register file, all lanes on a single bus.
+	 * Optional. If bound, in_operand is ignored. */
+	sc_port<sc_signal_in_if<operand_bus<FPUS> >, 1,
+			SC_ZERO_OR_MORE_BOUND> in_operand_bus[2];
+
+	/** Outgoing operands to IExecute, all lanes on a single bus.
+	 * Optional. If bound, out_operand is left untouched. */
+	sc_port<sc_signal_inout_if<operand_bus<FPUS> >, 1,
+			SC_ZERO_OR_MORE_BOUND> out_operand_bus[2];
+
 	/** Population for each read request. */
 	sc_inout<sc_bv<32> > out_req_sb_pop[3];
 
@@ -180,7 +193,7 @@ public:
 
 	/** Construct thread. */
 	SC_CTOR(IDecode_3S)
-	: IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES>(), op_retry(7)
+	: IDecode<PC_WIDTH,THREADS,FPUS,RCPUS,XLAT_ENTRIES,WG_SLOTS>(), op_retry(7)
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
@@ -197,7 +210,43 @@ private:
 	IDecode_pipe<PC_WIDTH,THREADS,FPUS,RCPUS> pipe[3];
 
 	/** Operand fetched in stage 1, stored in stage 2. */
-	sc_uint<32> operand_0[FPUS];
+	operand_bus<FPUS> operand_0;
+
+	/** Read an incoming operand from the register file.
+	 * @param i Index of the operand.
+	 * @return The operand, from in_operand_bus if bound, otherwise
+	 *	   gathered from the per-lane in_operand ports. */
+	operand_bus<FPUS>
+	read_operand(unsigned int i)
+	{
+		operand_bus<FPUS> bus;
+		unsigned int l;
+
+		if (in_operand_bus[i].size())
+			return in_operand_bus[i]->read();
+
+		for (l = 0; l < FPUS; l++)
+			bus[l] = in_operand[i][l].read();
+
+		return bus;
+	}
+
+	/** Drive an outgoing operand to IExecute.
+	 * @param i Index of the operand.
+	 * @param bus Operand value, one word per lane. */
+	void
+	write_operand(unsigned int i, const operand_bus<FPUS> &bus)
+	{
+		unsigned int l;
+
+		if (out_operand_bus[i].size()) {
+			out_operand_bus[i]->write(bus);
+			return;
+		}
+
+		for (l = 0; l < FPUS; l++)
+			out_operand[i][l].write(bus[l]);
+	}
 
 	/** Prepare the read request struct for RegFile.
 	 * @param req Reference to set of read requests.
@@ -248,7 +297,7 @@ private:
 	 * @param wg Workgroup for which the pipeline must be invalidated.
 	 */
 	void
-	pipe_invalidate(sc_uint<1> wg)
+	pipe_invalidate(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		unsigned int i;
 
@@ -267,10 +316,11 @@ private:
 		reg_read_req<THREADS/FPUS> req;
 		sc_bv<3> raw;
 		sc_bv<3> conflicts;
-		sc_bv<32> entries_pop[2];
+		sc_bv<32> entries_pop[WG_SLOTS];
 		sc_bv<32> entries_pop_all;
-		unsigned int l;
+		sc_bv<WG_SLOTS> finished;
 		unsigned int i;
+		unsigned int w;
 		int fc;
 		bool iexec_resource_free;
 
@@ -282,27 +332,26 @@ private:
 
 			/* Idle. Once a WG finishes, the pipeline will simply
 			 * be full of rubbish for that WG. */
-			if (in_wg_finished.read()[0])
-				pipe_invalidate(0);
-			if (in_wg_finished.read()[1])
-				pipe_invalidate(1);
+			finished = in_wg_finished.read();
+			for (w = 0; w < WG_SLOTS; w++) {
+				if (finished[w])
+					pipe_invalidate(w);
+			}
 
 			/* Determine OP */
 			select_op(op, pc);
 
 			/* Update SB entry population registers in pipeline */
-			entries_pop[0] = in_entries_pop[0].read();
-			entries_pop[1] = in_entries_pop[1].read();
+			for (w = 0; w < WG_SLOTS; w++)
+				entries_pop[w] = in_entries_pop[w].read();
 			pipe[0].req_sb_pop &= entries_pop[pipe[0].wg.to_uint()];
 			pipe[1].req_sb_pop &= entries_pop[pipe[1].wg.to_uint()];
 			pipe[2].req_sb_pop &= entries_pop[pipe[2].wg.to_uint()];
 
 			/* Pipeline progression */
 			if (pipe[2].isEmpty() && !op_retry[1]) {
-				for (l = 0; l < FPUS; l++) {
-					out_operand[0][l].write(operand_0[l]);
-					out_operand[1][l].write(in_operand[1][l].read());
-				}
+				write_operand(0, operand_0);
+				write_operand(1, read_operand(1));
 
 				pipe[2] = pipe[1];
 				pipe[1].reset();
@@ -320,9 +369,7 @@ private:
 				pipe[1] = pipe[0];
 
 				/* XXX: criteria? */
-				for (l = 0; l < FPUS; l++) {
-					operand_0[l] = in_operand[0][l].read();
-				}
+				operand_0 = read_operand(0);
 
 				pipe[0].reset();
 				op_retry[1] = Log_1;
@@ -19,6 +19,8 @@
 #ifndef COMPUTE_CONTROL_IEXECUTE_H
 #define COMPUTE_CONTROL_IEXECUTE_H
 
+#include <cstdint>
+#include <cstring>
 #include <systemc>
 
 #include "model/Register.h"
@@ -26,10 +28,15 @@
 #include "compute/model/work.h"
 #include "compute/model/ctrlstack_entry.h"
 #include "compute/model/compute_stats.h"
+#include "compute/model/operand_bus.h"
 #include "compute/control/Scoreboard.h"
 #include "isa/model/Instruction.h"
+#include "isa/model/lane_ops.h"
+#include "isa/model/ldst_ops.h"
 #include "util/constmath.h"
 #include "util/debug_output.h"
+#include "util/defaults.h"
+#include "util/GatedClock.h"
 #include "util/Ringbuffer.h"
 
 using namespace std;
@@ -56,9 +63,11 @@ typedef enum {
  * @param THREADS Number of threads in a work-group.
  * @param LANES Number of FPUs in a SimdCluster.
  * @param RCPUS Number of ReCiProcal units in a SimdCluster.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int PC_WIDTH, unsigned int THREADS,
-		unsigned int LANES, unsigned int RCPUS>
+		unsigned int LANES, unsigned int RCPUS,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class IExecute_pipe
 {
 public:
@@ -74,9 +83,9 @@ public:
 	/** Active sub-warp for this write-operation. */
 	sc_uint<const_log2(LANES/RCPUS)> subcol_w;
 	/** Workgroup for this register. Seems duplicate, but used for...*/
-	sc_uint<1> wg_w;
+	sc_uint<COMPUTE_WG_WIDTH> wg_w;
 	/** Data to write */
-	sc_uint<32> data_w[LANES];
+	uint32_t data_w[LANES];
 	/** Column to write results to. */
 	sc_uint<const_log2(THREADS/LANES)> col_mask_w;
 
@@ -102,10 +111,10 @@ public:
 	stride_descriptor desc_fifo;
 
 	/** Per-workgroup blocking reason (if any). */
-	workgroup_state wg_state_next[2];
+	workgroup_state wg_state_next[WG_SLOTS];
 
 	/** Workgroup that commits an exit. */
-	sc_bv<2> wg_exit_commit;
+	sc_bv<WG_SLOTS> wg_exit_commit;
 
 	/** Instruction for this pipeline entry. */
 	Instruction op;
@@ -124,27 +133,31 @@ public:
 
 	/** Constructor.
 	 * @param wg Active work-group slot for this pipeline stage.*/
-	IExecute_pipe(sc_uint<1> wg)
+	IExecute_pipe(sc_uint<COMPUTE_WG_WIDTH> wg)
 	: pc_do_w(false), pc_w(0),
 	  out_w(false), req_w(Register<THREADS/LANES>(wg)), wg_w(wg),
 	  col_mask_w(0), dequeue_sb(false), dequeue_sb_cstack_entry(false),
 	  ignore_mask_w(false), cstack_action(CTRLSTACK_IDLE),
 	  store_target(IF_SENTINEL), print(PRINT_NONE)
 	{
-		wg_state_next[0] = WG_STATE_NONE;
-		wg_state_next[1] = WG_STATE_NONE;
+		unsigned int w;
+
+		for (w = 0; w < WG_SLOTS; w++)
+			wg_state_next[w] = WG_STATE_NONE;
 	}
 
 	/** Invalidate this pipeline stage. */
 	void
 	invalidate(void)
 	{
+		unsigned int w;
+
 		pc_do_w = false;
 		out_w = false;
 		store_target = IF_SENTINEL;
 		print = PRINT_NONE;
-		wg_state_next[0] = WG_STATE_NONE;
-		wg_state_next[1] = WG_STATE_NONE;
+		for (w = 0; w < WG_SLOTS; w++)
+			wg_state_next[w] = WG_STATE_NONE;
 		cstack_action = CTRLSTACK_IDLE;
 		op.kill();
 	}
@@ -159,10 +172,12 @@ public:
  * @param THREADS Number of threads in a warp.
  * @param LANES Number of parallel lanes in one SIMD cluster.
  * @param CSTACK_ENTRIES Max. number of entries in the control stack.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
 template <unsigned int PC_WIDTH, unsigned int THREADS = 1024,
 		unsigned int LANES = 128, unsigned int RCPUS = 32,
-		unsigned int CSTACK_ENTRIES = 16>
+		unsigned int CSTACK_ENTRIES = 16,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class IExecute : public sc_core::sc_module
 {
 private:
@@ -171,21 +186,21 @@ private:
 	ctrlstack_entry<THREADS,PC_WIDTH> cstack_entry;
 
 	/** Pipeline stages */
-	Ringbuffer<IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> > pipe;
+	Ringbuffer<IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> > pipe;
 
 	/** A side-buffer in case the entry needs to be withheld from the
 	 * pipeline.
 	 * Used for SIDIV/SIMOD, which occupies the divider for 8 cycles.
 	 * Keeping it on the side for a number of cycles will allow to drain
 	 * the rest of the pipeline without flushing the div result too early. */
-	IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> pipe_sidebuf;
+	IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> pipe_sidebuf;
 
 	/** Counter that indicates when the sidebuf can enter the pipeline */
 	int pipe_sidebuf_hold_counter;
 
 	/** Pointer to the scoreboard. Used to validate CPOPs in a debugging
 	 * build. */
-	Scoreboard<THREADS,LANES> *sb;
+	Scoreboard<THREADS,LANES,WG_SLOTS> *sb;
 
 	/** Performance counter. Committed vector sub-instructions. */
 	unsigned long commit_vec[CAT_SENTINEL];
@@ -196,6 +211,12 @@ private:
 	/** Performance counter. Number of NOPs and pipeline bubbles. */
 	unsigned long commit_nop;
 
+	/** Gated compute clock, nullptr if the clock never skips edges. */
+	GatedClock *clk;
+
+	/** Number of skipped clock edges accounted for in commit_nop. */
+	unsigned long clk_skipped;
+
 	/** Ticket counter for stride descriptors.
 	 *
 	 * XXX: When exploring multiple SimdCluster set-ups, a counter-based
@@ -203,6 +224,30 @@ private:
 	 * the counter to a shared location like the WorkScheduler. */
 	sc_uint<4> ticket_push;
 
+	/** Progress of committing commit_elem. */
+	enum {
+		COMMIT_ST_SIGNALS = 0,
+		COMMIT_ST_COL_MASK,
+		COMMIT_ST_DESC
+	} commit_state;
+
+	/** Pipeline element being committed. Held across invocations of
+	 * method_lt() while an output FIFO is full. */
+	IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> commit_elem;
+
+	/** Instruction executed in the cycle commit_elem was committed. */
+	Instruction commit_insn;
+
+	/** Contiguous copy of the operand buses, taken once per executed
+	 * instruction by load_operands(). Lane-parallel operations work on
+	 * these rather than on the signal values, such that their loops
+	 * can be auto-vectorised. */
+	alignas(64) uint32_t opnd[3][LANES];
+
+	/** Operands gathered from the per-lane in_operand ports, for when
+	 * in_operand_bus is not bound. */
+	operand_bus<LANES> opnd_lanes[3];
+
 public:
 	/** Compute clock. */
 	sc_in<bool> in_clk{"in_clk"};
@@ -214,7 +259,7 @@ public:
 	sc_in<Instruction> in_insn{"in_insn"};
 
 	/** Work-group associated with this instruction. */
-	sc_in<sc_uint<1> > in_wg{"in_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg{"in_wg"};
 
 	/** Identifier of currently active warp - important for write-back. */
 	sc_in<sc_uint<const_log2(THREADS/LANES)> > in_col_w{"in_col_w"};
@@ -226,12 +271,18 @@ public:
 	 * vector + scalar -> vector/pred, scalar replicated in all lanes.*/
 	sc_in<sc_uint<32> > in_operand[3][LANES];
 
+	/** Inputs for instruction, all lanes of an operand on a single bus.
+	 * Optional. If bound, operands are read from this bus and in_operand
+	 * is ignored, saving LANES port reads per operand. */
+	sc_port<sc_signal_in_if<operand_bus<LANES> >, 1,
+			SC_ZERO_OR_MORE_BOUND> in_operand_bus[3];
+
 	/** Stride descriptor special register values. */
-	sc_in<stride_descriptor> in_sd[2];
+	sc_in<stride_descriptor> in_sd[WG_SLOTS];
 
 	/** At least one thread is active according to the active thread
 	 * mask. */
-	sc_in<sc_bv<2> > in_thread_active{"in_thread_active"};
+	sc_in<sc_bv<WG_SLOTS> > in_thread_active{"in_thread_active"};
 
 	/** Physical address associated with incoming ld/st instruction */
 	sc_in<Buffer> in_xlat_phys{"in_xlat_phys"};
@@ -253,7 +304,7 @@ public:
 	sc_inout<Register<THREADS/LANES> > out_req_w{"out_req_w"};
 
 	/** Workgroup associated with this request. */
-	sc_inout<sc_uint<1> > out_wg_w{"out_wg_w"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg_w{"out_wg_w"};
 
 	/** Output of instruction. For scalar, result in lane 0. */
 	sc_inout<sc_uint<32> > out_data_w[LANES];
@@ -300,7 +351,7 @@ public:
 
 	/*********************** Work parameters **************************/
 	/** Workgroup offsets (X, Y) */
-	sc_in<sc_uint<32> > in_wg_off[2][2];
+	sc_in<sc_uint<32> > in_wg_off[WG_SLOTS][2];
 
 	/** Work dimensions (X, Y) */
 	sc_in<sc_uint<32> > in_dim[2];
@@ -316,7 +367,7 @@ public:
 	sc_fifo_out<bool> out_store_kick[IF_SENTINEL];
 
 	/** Per-workgroup blocking reason, if any. */
-	sc_inout<workgroup_state> out_wg_state_next[2];
+	sc_inout<workgroup_state> out_wg_state_next[WG_SLOTS];
 
 	/** Per_WG exit commit signal.
 	 *
@@ -326,11 +377,12 @@ public:
 	 * exit sub-instructions that will interfere with the cmask reset of
 	 * the next workgroup.
 	 */
-	sc_inout<sc_bv<2> > out_wg_exit_commit{"out_wg_exit_commit"};
+	sc_inout<sc_bv<WG_SLOTS> > out_wg_exit_commit{"out_wg_exit_commit"};
 
 	/** Construct thread. */
 	SC_CTOR(IExecute) : pipe(3), pipe_sidebuf_hold_counter(0), sb(nullptr),
-			commit_nop(0ul), ticket_push(0)
+			commit_nop(0ul), clk(nullptr), clk_skipped(0ul),
+			ticket_push(0), commit_state(COMMIT_ST_SIGNALS)
 	{
 		unsigned int i;
 
@@ -341,7 +393,7 @@ public:
 			commit_sc[i] = 0ul;
 		}
 
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_lt);
 		sensitive << in_clk.pos();
 	}
 
@@ -364,11 +416,23 @@ public:
 	/** Set a reference to the scoreboard object, for debugging purposes.
 	 * @param s Pointer to the active scoreboard component. */
 	void
-	set_scoreboard(Scoreboard<THREADS,LANES> *s)
+	set_scoreboard(Scoreboard<THREADS,LANES,WG_SLOTS> *s)
 	{
 		sb = s;
 	}
 
+	/** Attach the gated clock driving in_clk.
+	 *
+	 * The pipeline is drained while edges are skipped, so each skipped
+	 * edge is credited as a committed NOP, keeping commit_nop exact.
+	 * @param c Gated compute clock. */
+	void
+	set_gated_clock(GatedClock *c)
+	{
+		clk = c;
+		clk_skipped = c->get_skipped();
+	}
+
 	/** Debug: obtain run statistics and store them in s
 	 * @param s Reference to compute_stats object that will hold new run
 	 * 	    statistics. */
@@ -394,120 +458,154 @@ private:
 		cstack_entry.pc = 0;
 	}
 
+	/** Return true iff op is a lane-parallel operation that reads its
+	 * operands from opnd.
+	 * @param op Operation.
+	 * @return True iff load_operands() must precede execution of op. */
+	static bool
+	is_lane_op(ISAOp op)
+	{
+		switch (op) {
+		case OP_TEST:
+		case OP_ITEST:
+		case OP_PBOOL:
+		case OP_MAD:
+		case OP_ADD:
+		case OP_MUL:
+		case OP_MIN:
+		case OP_MAX:
+		case OP_ABS:
+		case OP_MOV:
+		case OP_MOVVSP:
+		case OP_CVT:
+		case OP_IADD:
+		case OP_ISUB:
+		case OP_IMUL:
+		case OP_IMAD:
+		case OP_IMIN:
+		case OP_IMAX:
+		case OP_SHL:
+		case OP_SHR:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_NOT:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/** Return the value of an operand for all lanes.
+	 * @param i Index of the operand.
+	 * @return The operand, from in_operand_bus if bound, otherwise
+	 *	   gathered from the per-lane in_operand ports. */
+	const operand_bus<LANES> &
+	operand(unsigned int i)
+	{
+		unsigned int l;
+
+		if (in_operand_bus[i].size())
+			return in_operand_bus[i]->read();
+
+		for (l = 0; l < LANES; l++)
+			opnd_lanes[i][l] = in_operand[i][l].read();
+
+		return opnd_lanes[i];
+	}
+
+	/** Copy the first srcs operand buses into opnd.
+	 * @param srcs Number of source operands of the instruction. */
+	void
+	load_operands(unsigned int srcs)
+	{
+		unsigned int i;
+
+		for (i = 0; i < srcs && i < 3; i++)
+			memcpy(opnd[i], operand(i).data,
+					sizeof(opnd[i]));
+	}
+
 	/** Execute MAD.
 	 * @param mod Instruction modifier.
 	 * @param ps Pipeline stage. */
 	void
-	do_VMAD(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VMAD(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat m1, m2, a, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1.b = in_operand[0][i].read();
-			m2.b = in_operand[1][i].read();
-			a.b = in_operand[2][i].read();
-
-			if (mod == FPU_NEG)
-				m2.f = -m2.f;
+		uint32_t neg;
 
-			res.f = m1.f*m2.f+a.f;
+		/* Negation is a sign flip, hoisted out of the lane loop. */
+		neg = lane_ops::fpu_neg(mod);
 
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::mad(opnd[0][i],
+					opnd[1][i] ^ neg, opnd[2][i]);
 	}
 
 	/** Execute ADD.
 	 * @param mod Instruction modifier.
 	 * @param ps Pipeline stage. */
 	void
-	do_VADD(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VADD(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat a, b, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a.b = in_operand[0][i].read();
-			b.b = in_operand[1][i].read();
+		uint32_t neg;
 
-			if (mod == FPU_NEG)
-				b.f = -b.f;
+		neg = lane_ops::fpu_neg(mod);
 
-			res.f = a.f+b.f;
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::add(opnd[0][i],
+					opnd[1][i] ^ neg);
 	}
 
 	/** Execute MUL.
 	 * @param mod Instruction modifier.
 	 * @param ps Pipeline stage. */
 	void
-	do_VMUL(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VMUL(ISASubOpFPUMod mod, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat m1, m2, res;
+		uint32_t neg;
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1.b = in_operand[0][i].read();
-			m2.b = in_operand[1][i].read();
-			if (mod == FPU_NEG)
-				m2.f = -m2.f;
+		neg = lane_ops::fpu_neg(mod);
 
-			res.f = m1.f*m2.f;
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::mul(opnd[0][i],
+					opnd[1][i] ^ neg);
 	}
 
 	/** Execute MIN.
 	 * @param ps Pipeline stage. */
 	void
-	do_VMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat m1, m2, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1.b = in_operand[0][i].read();
-			m2.b = in_operand[1][i].read();
-
-			res.f = min(m1.f,m2.f);
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::fmin(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute MAX.
 	 * @param ps Pipeline stage. */
 	void
-	do_VMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat m1, m2, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1.b = in_operand[0][i].read();
-			m2.b = in_operand[1][i].read();
-
-			res.f = max(m1.f,m2.f);
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::fmax(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute ABS.
 	 * @param ps Pipeline stage. */
 	void
-	do_VABS(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_VABS(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		for (unsigned int i = 0; i < LANES; i++) {
-			ps.data_w[i] = in_operand[0][i].read() & (~0x80000000u);
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::abs(opnd[0][i]);
 	}
 
 	/** Untyped MOV.
 	 * @param ps Pipeline stage. */
 	void
-	do_MOV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_MOV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		for (unsigned int l = 0; l < LANES; l++)
-			ps.data_w[l] = in_operand[0][l].read();
+			ps.data_w[l] = opnd[0][l];
 	}
 
 	/** Typed MOV.
@@ -515,21 +613,10 @@ private:
 	 * conversion.
 	 * @param ps Pipeline stage. */
 	void
-	do_CVT(ISASubOpCVT subop, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_CVT(ISASubOpCVT subop, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat intm;
-
-		if (subop == CVT_I2F) {
-			for (unsigned int l = 0; l < LANES; l++) {
-				intm.f = in_operand[0][l].read();
-				ps.data_w[l] = intm.b;
-			}
-		} else {
-			for (unsigned int l = 0; l < LANES; l++) {
-				intm.b = in_operand[0][l].read();
-				ps.data_w[l] = intm.f;
-			}
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::cvt(subop, opnd[0][i]);
 	}
 
 	/** Typed MOV.
@@ -537,17 +624,9 @@ private:
 	 * conversion.
 	 * @param ps Pipeline stage. */
 	void
-	do_SCVT(ISASubOpCVT subop, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SCVT(ISASubOpCVT subop, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat intm;
-
-		if (subop == CVT_I2F) {
-			intm.f = in_operand[0][0].read();
-			ps.data_w[0] = intm.b;
-		} else {
-			intm.b = in_operand[0][0].read();
-			ps.data_w[0] = intm.f;
-		}
+		ps.data_w[0] = lane_ops::cvt(subop, operand(0)[0]);
 	}
 
 	/**
@@ -557,7 +636,7 @@ private:
 	 */
 	void
 	do_BUFQUERY(ISASubOpBUFQUERY subop,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		Buffer b;
 
@@ -589,36 +668,10 @@ private:
 	 * @param ps Pipeline stage "register" to store result in.
 	 */
 	void
-	do_TEST(ISASubOpTEST test, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
-	{
-		bfloat in;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			in.b = in_operand[0][i].read();
-
-			switch (test) {
-			case TEST_EZ:
-				ps.data_w[i] = (in.f == 0.f || in.f == -0.f);
-				break;
-			case TEST_NZ:
-				ps.data_w[i] = (in.f != 0.f && in.f != -0.f);
-				break;
-			case TEST_L:
-				ps.data_w[i] = (in.f < 0.f);
-				break;
-			case TEST_LE:
-				ps.data_w[i] = (in.f <= 0.f || in.f == -0.f);
-				break;
-			case TEST_G:
-				ps.data_w[i] = (in.f > 0.f);
-				break;
-			case TEST_GE:
-				ps.data_w[i] = (in.f >= 0.f || in.f == -0.f);
-				break;
-			default:
-				break;
-			}
-		}
+	do_TEST(ISASubOpTEST test, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
+	{
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::test(test, opnd[0][i]);
 	}
 
 	/**
@@ -629,36 +682,10 @@ private:
 	 * @param test Subop for this test operation.
 	 * @param ps Pipeline stage. */
 	void
-	do_ITEST(ISASubOpTEST test, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
-	{
-		int in;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			in = in_operand[0][i].read();
-
-			switch (test) {
-			case TEST_EZ:
-				ps.data_w[i] = (in == 0);
-				break;
-			case TEST_NZ:
-				ps.data_w[i] = (in != 0);
-				break;
-			case TEST_L:
-				ps.data_w[i] = (in < 0);
-				break;
-			case TEST_LE:
-				ps.data_w[i] = (in <= 0);
-				break;
-			case TEST_G:
-				ps.data_w[i] = (in > 0);
-				break;
-			case TEST_GE:
-				ps.data_w[i] = (in >= 0);
-				break;
-			default:
-				break;
-			}
-		}
+	do_ITEST(ISASubOpTEST test, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
+	{
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::itest(test, opnd[0][i]);
 	}
 
 	/**
@@ -670,39 +697,19 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_PBOOL(ISASubOpPBOOL subop,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
-	{
-		unsigned int b1, b2;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			b1 = in_operand[0][i].read() & 0x1;
-			b2 = in_operand[1][i].read() & 0x1;
-
-			switch(subop) {
-			case PBOOL_AND:
-				ps.data_w[i] = b1 & b2;
-				break;
-			case PBOOL_OR:
-				ps.data_w[i] = b1 | b2;
-				break;
-			case PBOOL_NAND:
-				ps.data_w[i] = !(b1 & b2);
-				break;
-			case PBOOL_NOR:
-				ps.data_w[i] = !(b1 | b2);
-				break;
-			default:
-				break;
-			}
-		}
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
+	{
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::pbool(subop, opnd[0][i],
+					opnd[1][i]);
 	}
 
 	/** Scalar Jump with IMM parameter.
 	 * @param ps Pipeline stage. */
 	void
-	do_J(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_J(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		ps.pc_w = in_operand[0][0].read();
+		ps.pc_w = operand(0)[0];
 		ps.pc_do_w = true;
 	}
 
@@ -711,38 +718,10 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_SICJ(ISASubOpTEST test,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int in;
-		bool res = false;
-
-		in = in_operand[1][0].read();
-
-		switch (test) {
-		case TEST_EZ:
-			res = (in == 0);
-			break;
-		case TEST_NZ:
-			res = (in != 0);
-			break;
-		case TEST_L:
-			res = (in < 0);
-			break;
-		case TEST_LE:
-			res = (in <= 0);
-			break;
-		case TEST_G:
-			res = (in > 0);
-			break;
-		case TEST_GE:
-			res = (in >= 0);
-			break;
-		default:
-			break;
-		}
-
-		if (res) {
-			ps.pc_w = in_operand[0][0].read();
+		if (lane_ops::itest(test, operand(1)[0])) {
+			ps.pc_w = operand(0)[0];
 			ps.pc_do_w = true;
 		}
 	}
@@ -761,18 +740,14 @@ private:
 	 * @param commit True iff the pop must be commited to the cstack.
 	 * @param ps Pipeline stage. */
 	void
-	do_CPOP(bool commit, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_CPOP(bool commit, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		unsigned int l;
 		unsigned int col = in_col_w.read();
-		unsigned int offset = col * LANES;
 
 		ctrlstack_entry<THREADS,PC_WIDTH> cstack_entry;
 
 		cstack_entry = in_cstack_top.read();
-
-		for (l = 0; l < LANES; l++, offset++)
-			ps.data_w[l] = cstack_entry.pred_mask[offset] ? 1 : 0;
+		cstack_entry.get_pred(col * LANES, ps.data_w, LANES);
 
 		ps.req_w = Register<THREADS/LANES>(in_wg.read(), REGISTER_VSP,
 				cstack_entry.mask_type, col);
@@ -800,32 +775,15 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_CPUSH(ISASubOpCPUSH subop, sc_uint<PC_WIDTH> pc, bool commit,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		unsigned int l;
+		const operand_bus<LANES> &mask = operand(1);
 		unsigned int col = in_col_w.read();
-		unsigned int offset = col * LANES;
-
-		for (l = 0; l < LANES; l++, offset++)
-			cstack_entry.pred_mask[offset] =
-					(in_operand[1][l].read() ? 1 : 0);
 
+		cstack_entry.set_pred(col * LANES, mask.data, LANES);
 		cstack_entry.pc = pc;
-
-		switch (subop) {
-		case CPUSH_IF:
-			cstack_entry.mask_type = VSP_CTRL_RUN;
-			break;
-		case CPUSH_BRK:
-			cstack_entry.mask_type = VSP_CTRL_BREAK;
-			break;
-		case CPUSH_RET:
-			cstack_entry.mask_type = VSP_CTRL_RET;
-			break;
-		default:
-			assert(false);
-			break;
-		}
+		cstack_entry.mask_type =
+			ctrlstack_entry<THREADS,PC_WIDTH>::cpush_mask_type(subop);
 
 		if (commit) {
 			ps.cstack_action = CTRLSTACK_PUSH;
@@ -838,13 +796,14 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_CMASK(unsigned int src_idx,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
+		const operand_bus<LANES> &mask = operand(src_idx);
 		unsigned int l;
 
 		/* Invert predicate register to output and write to ctrl reg */
 		for (l = 0; l < LANES; l++)
-			ps.data_w[l] = in_operand[src_idx][l].read() ? 0 : 1;
+			ps.data_w[l] = mask[l] ? 0 : 1;
 	}
 
 	/** (Conditional) mask for calls.
@@ -852,361 +811,240 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_CALL_MASK(unsigned int src_idx,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
+		const operand_bus<LANES> &mask = operand(src_idx);
 		unsigned int l;
 
 		/* Predicate register to output and write to ctrl reg */
 		for (l = 0; l < LANES; l++)
-			ps.data_w[l] = in_operand[src_idx][l].read() ? 1 : 0;
+			ps.data_w[l] = mask[l] ? 1 : 0;
 	}
 
 	/** Execute IADD.
 	 * @param ps Pipeline stage. */
 	void
-	do_IADD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_IADD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a + b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::iadd(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute ISUB.
 	 * @param ps Pipeline stage. */
 	void
-	do_ISUB(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_ISUB(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a - b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::isub(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute IMUL.
 	 * @param ps Pipeline stage. */
 	void
-	do_IMUL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_IMUL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a * b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::imul(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute IMAD.
 	 * @param ps Pipeline stage. */
 	void
-	do_IMAD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_IMAD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b, c;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-			c = in_operand[2][i].read();
-
-			ps.data_w[i] = a * b + c;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::imad(opnd[0][i], opnd[1][i],
+					opnd[2][i]);
 	}
 
 	/** Execute IMIN.
 	 * @param ps Pipeline stage. */
 	void
-	do_IMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_IMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1, m2, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1 = in_operand[0][i].read();
-			m2 = in_operand[1][i].read();
-
-			res = min(m1,m2);
-
-			ps.data_w[i] = res;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::imin(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute IMAX.
 	 * @param ps Pipeline stage. */
 	void
-	do_IMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_IMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1, m2, res;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			m1 = in_operand[0][i].read();
-			m2 = in_operand[1][i].read();
-
-			res = max(m1,m2);
-
-			ps.data_w[i] = res;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::imax(opnd[0][i], opnd[1][i]);
 	}
 
 
 	/** Execute SSHL.
 	 * @param ps Pipeline stage. */
 	void
-	do_SHL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SHL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
+		uint32_t b;
 
 		// b is a scalar
-		b = in_operand[1][0].read();
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
+		b = operand(1)[0];
 
-			ps.data_w[i] = a << b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::shl(opnd[0][i], b);
 	}
 
 	/** Execute SSHR.
 	 * @param ps Pipeline stage. */
 	void
-	do_SHR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SHR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
+		uint32_t b;
 
 		// b is a scalar
-		b = in_operand[1][0].read();
+		b = operand(1)[0];
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-
-			ps.data_w[i] = a >> b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::shr(opnd[0][i], b);
 	}
 
 	/** Execute AND.
 	 * @param ps Pipeline stage. */
 	void
-	do_AND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_AND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a & b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::band(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute OR.
 	 * @param ps Pipeline stage. */
 	void
-	do_OR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_OR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a | b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::bor(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute XOR.
 	 * @param ps Pipeline stage. */
 	void
-	do_XOR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_XOR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-			b = in_operand[1][i].read();
-
-			ps.data_w[i] = a ^ b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::bxor(opnd[0][i], opnd[1][i]);
 	}
 
 	/** Execute NOT.
 	 * @param ps Pipeline stage. */
 	void
-	do_NOT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_NOT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a;
-
-		for (unsigned int i = 0; i < LANES; i++) {
-			a = in_operand[0][i].read();
-
-			ps.data_w[i] = ~a;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::bnot(opnd[0][i]);
 	}
 
 	/** Execute SMOV.
 	 * @param ps Pipeline stage. */
 	void
-	do_SMOV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SMOV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		ps.data_w[0] = in_operand[0][0].read();
+		ps.data_w[0] = operand(0)[0];
 	}
 
 	/** Execute SIADD.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIADD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIADD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a + b;
+		ps.data_w[0] = lane_ops::iadd(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SISUB.
 	 * @param ps Pipeline stage. */
 	void
-	do_SISUB(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SISUB(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a - b;
+		ps.data_w[0] = lane_ops::isub(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SIMUL.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIMUL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIMUL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a * b;
+		ps.data_w[0] = lane_ops::imul(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SIMAD.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIMAD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIMAD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1, m2, a3;
-
-		m1 = in_operand[0][0].read();
-		m2 = in_operand[1][0].read();
-		a3 = in_operand[2][0].read();
-
-		ps.data_w[0] = m1 * m2 + a3;
+		ps.data_w[0] = lane_ops::imad(operand(0)[0],
+				operand(1)[0],
+				operand(2)[0]);
 	}
 
 	/** Execute SIMIN.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIMIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1, m2, res;
-
-		m1 = in_operand[0][0].read();
-		m2 = in_operand[1][0].read();
-
-		res = min(m1,m2);
-
-		ps.data_w[0] = res;
+		ps.data_w[0] = lane_ops::imin(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SIMAX.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIMAX(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1, m2, res;
-
-		m1 = in_operand[0][0].read();
-		m2 = in_operand[1][0].read();
-
-		res = max(m1,m2);
-
-		ps.data_w[0] = res;
+		ps.data_w[0] = lane_ops::imax(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SINEG.
 	 * @param ps Pipeline stage. */
 	void
-	do_SINEG(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SINEG(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int m1;
-
-		m1 = in_operand[0][0].read();
-
-		ps.data_w[0] = -m1;
+		ps.data_w[0] = lane_ops::ineg(operand(0)[0]);
 	}
 
 	/** Execute SIBFIND.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIBFIND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIBFIND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		unsigned int a;
-
-		a = in_operand[0][0].read();
-
-		if (a & 0x80000000)
-			a = ~a;
-
-		a = (a << 1) | 1;
-
-		ps.data_w[0] = 30 - __builtin_clz(a);
+		ps.data_w[0] = lane_ops::ibfind(operand(0)[0]);
 	}
 
 	/** Execute SSHL.
 	 * @param ps Pipeline stage. */
 	void
-	do_SSHL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SSHL(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a << b;
+		ps.data_w[0] = lane_ops::shl(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Execute SSHR.
 	 * @param ps Pipeline stage. */
 	void
-	do_SSHR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SSHR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a >> b;
+		ps.data_w[0] = lane_ops::shr(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Perform scalar integer division.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIDIV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIDIV(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a / b;
+		ps.data_w[0] = lane_ops::idiv(operand(0)[0],
+				operand(1)[0]);
 
 		pipe_sidebuf_hold_counter = max((int)(8 - pipe.getEntries()), 0);
 	}
@@ -1214,14 +1052,10 @@ private:
 	/** Perform scalar integer modulo.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIMOD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIMOD(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a % b; /**< @todo % or mod? */
+		ps.data_w[0] = lane_ops::imod(operand(0)[0],
+				operand(1)[0]);
 
 		pipe_sidebuf_hold_counter = max((int)(8 - pipe.getEntries()), 0);
 	}
@@ -1229,46 +1063,36 @@ private:
 	/** Perform scalar boolean AND.
 	 * @param ps Pipeline stage. */
 	void
-	do_SAND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SAND(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a & b;
+		ps.data_w[0] = lane_ops::band(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Perform scalar boolean OR.
 	 * @param ps Pipeline stage. */
 	void
-	do_SOR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SOR(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a, b;
-
-		a = in_operand[0][0].read();
-		b = in_operand[1][0].read();
-
-		ps.data_w[0] = a | b;
+		ps.data_w[0] = lane_ops::bor(operand(0)[0],
+				operand(1)[0]);
 	}
 
 	/** Perform scalar boolean NOT.
 	 * @param ps Pipeline stage. */
 	void
-	do_SNOT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SNOT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		int a;
-
-		a = in_operand[0][0].read();
-
-		ps.data_w[0] = ~a;
+		ps.data_w[0] = lane_ops::bnot(operand(0)[0]);
 	}
 
 	/** Execute RCP.
 	 * @param ps Pipeline stage. */
 	void
-	do_RCP(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_RCP(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
+		const operand_bus<LANES> &a = operand(0);
+
 		/* We cheat a little here for the sake of simulation speed.
 		 * Rather than doing RCPUS subcolumns in every cycle, we perform
 		 * the calculation of *all* lanes upon commit. This saves
@@ -1276,77 +1100,55 @@ private:
 		 * to more aggressively optimise the inner loop using SIMD
 		 * techniques.
 		 */
-		bfloat a, res;
-
 		if (!ps.out_w)
 			return;
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			a.b = in_operand[0][i].read();
-
-			res.f = 1.f/a.f;
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::rcp(a[i]);
 	}
 
 	/** Execute RSQRT.
 	 * @param ps Pipeline stage. */
 	void
-	do_RSQRT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_RSQRT(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		/* And here too we simplify. */
-		bfloat a, res;
+		const operand_bus<LANES> &a = operand(0);
 
+		/* And here too we simplify. */
 		if (!ps.out_w)
 			return;
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			a.b = in_operand[0][i].read();
-
-			res.f = 1.f/sqrt(a.f);
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::rsqrt(a[i]);
 	}
 
 	/** Execute SIN.
 	 * @param ps Pipeline stage. */
 	void
-	do_SIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SIN(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		bfloat a, res;
+		const operand_bus<LANES> &a = operand(0);
 
 		if (!ps.out_w)
 			return;
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			a.b = in_operand[0][i].read();
-
-			res.f = sin(a.f);
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::sin(a[i]);
 	}
 
 	/** Execute COS.
 	 * @param ps Pipeline stage. */
 	void
-	do_COS(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_COS(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		/* And here too we simplify. */
-		bfloat a, res;
+		const operand_bus<LANES> &a = operand(0);
 
+		/* And here too we simplify. */
 		if (!ps.out_w)
 			return;
 
-		for (unsigned int i = 0; i < LANES; i++) {
-			a.b = in_operand[0][i].read();
-
-			res.f = cos(a.f);
-
-			ps.data_w[i] = res.b;
-		}
+		for (unsigned int i = 0; i < LANES; i++)
+			ps.data_w[i] = lane_ops::cos(a[i]);
 	}
 
 	/** Perform a global load/store "linear", following dimensions of the
@@ -1355,71 +1157,22 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTLIN(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		sc_uint<32> wg_width;
-		sc_int<32> offset_x;
-		sc_int<32> offset_y;
-		Buffer b;
-		sc_uint<32> wl;
-
-		ISASubOpLDSTLIN subop = op.getSubOp().ldstlin;
 
 		wg = in_wg.read();
-		wg_width = 32 << in_wg_width.read();
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_xlat_phys.read();
-
-		offset_x = (in_wg_off[wg][0].read() << 5) +
-				((sc_int<32>)in_operand[1][0].read());
-		offset_y = in_wg_off[wg][1].read() +
-				((sc_int<32>)in_operand[2][0].read());
 
 		stride_descriptor sd(dst);
 
-		switch (subop) {
-		case LIN_VEC2:
-			wl = 2;
-			sd.idx_transform = IDX_TRANSFORM_VEC2;
-			break;
-		case LIN_VEC4:
-			wl = 4;
-			sd.idx_transform = IDX_TRANSFORM_VEC4;
-			break;
-		case LIN_UNIT:
-		default:
-			wl = 1;
-			sd.idx_transform = IDX_TRANSFORM_UNIT;
-			break;
-		}
-
-		sd.write = (op.getOp() == OP_STGLIN);
-		sd.period = b.get_dim_x();
-		sd.period_count = min(sc_uint<32>(THREADS/wg_width),
-				(sc_uint<32>) (in_dim[1].read() - in_wg_off[wg][1].read()));
-		sd.words = min(sc_uint<32>(wl * wg_width),
-				(sc_uint<32>) (b.get_dim_x() - (offset_x * wl)));
-		sd.dst_period = 32 << in_wg_width.read();
-
-		sd.dst_offset = 0;
-		if (offset_y < 0) {
-			sd.dst_off_y = -offset_y;
-			sd.period_count += offset_y;
-			offset_y = 0;
-		}
-
-		if (offset_x < 0) {
-			sd.dst_off_x = -offset_x;
-			sd.words += offset_x;
-			offset_x = 0;
-		}
-		sd.addr = b.getAddress() +
-			((offset_y * b.get_dim_x() + offset_x * wl) << 2);
-
-		if (dst.type == REGISTER_VSP)
-			sd.dst_offset = (offset_y * b.get_dim_x() + offset_x * wl);
+		ldst_ops::lin(sd, op.getOp() == OP_STGLIN, op.getSubOp().ldstlin,
+				in_xlat_phys.read(), THREADS,
+				32 << in_wg_width.read(),
+				in_wg_off[wg][0].read(), in_wg_off[wg][1].read(),
+				in_dim[1].read(), operand(1)[0],
+				operand(2)[0], dst.type);
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1430,50 +1183,21 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTSPLIN(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		sc_uint<32> wg_width;
-		sc_int<32> offset_x;
-		sc_int<32> offset_y;
-		Buffer b;
 
 		wg = in_wg.read();
-		wg_width = 32 << in_wg_width.read();
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_sp_xlat_phys.read();
-
-		offset_x = (sc_int<32>)in_operand[1][0].read();
-		offset_y = (sc_int<32>)in_operand[2][0].read();
 
 		stride_descriptor sd(dst);
 
-		sd.write = (op.getOp() == OP_STSPLIN);
-		sd.period = b.get_dim_x();
-		sd.period_count = min(sc_uint<32>(THREADS/wg_width),
-				(sc_uint<32>) (b.get_dim_y() - offset_y));
-		sd.words = min(sc_uint<32>(wg_width),
-				(sc_uint<32>) (b.get_dim_x() - offset_x));
-		sd.dst_period = 32 << in_wg_width.read();
-
-		sd.dst_offset = 0;
-		if (offset_y < 0) {
-			sd.dst_off_y = -offset_y;
-			sd.period_count += offset_y;
-			offset_y = 0;
-		}
-
-		if (offset_x < 0) {
-			sd.dst_off_x = -offset_x;
-			sd.words += offset_x;
-			offset_x = 0;
-		}
-		sd.addr = b.getAddress() +
-			((offset_y * b.get_dim_x() + offset_x) << 2);
-
-		if (dst.type == REGISTER_VSP)
-			sd.dst_offset = (offset_y * b.get_dim_x() + offset_x);
+		ldst_ops::splin(sd, op.getOp() == OP_STSPLIN,
+				in_sp_xlat_phys.read(), THREADS,
+				32 << in_wg_width.read(),
+				operand(1)[0],
+				operand(2)[0], dst.type);
 
 		ldst_kick(op, req_if_t(wg), sd, ps);
 	}
@@ -1484,27 +1208,18 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTBIDX(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		Buffer b;
 
 		wg = in_wg.read();
-
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_xlat_phys.read();
 
 		stride_descriptor sd(dst);
 
-		sd.write = (op.getOp() == OP_STGBIDX);
-		sd.period = b.dims[0];
-		sd.period_count = b.dims[1];
-		sd.words = b.dims[0];
-		sd.dst_period = 32 << in_wg_width.read();
-
-		sd.dst_offset = 0;
-		sd.addr = b.getAddress();
+		ldst_ops::bidx(sd, op.getOp() == OP_STGBIDX,
+				in_xlat_phys.read(), 32 << in_wg_width.read());
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1515,45 +1230,23 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTCIDX(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		sc_int<32> offset_x;
-		sc_int<32> offset_y;
-		Buffer b;
 		stride_descriptor params;
 
 		wg = in_wg.read();
 		params = in_sd[wg].read();
-
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_xlat_phys.read();
-
-		offset_x = (sc_int<32>)in_operand[1][0].read();
-		offset_y = (sc_int<32>)in_operand[2][0].read();
 
 		stride_descriptor sd(dst);
 
-		sd.write = (op.getOp() == OP_STGCIDX);
-		sd.period = params.period;
-		sd.period_count = params.period_count;
-		sd.words = params.words;
-		sd.dst_period = 0;
-
-		if (offset_y < 0) {
-			sd.period_count += offset_y;
-			offset_y = 0;
-		}
-
-		if (offset_x < 0) {
-			sd.words += offset_x;
-			offset_x = 0;
-		}
-		sd.addr = b.getAddress() +
-			((offset_y * b.get_dim_x() + offset_x) << 2);
-
-		sd.dst_offset = (offset_y * b.get_dim_x() + offset_x);
+		ldst_ops::cidx(sd, op.getOp() == OP_STGCIDX,
+				in_xlat_phys.read(), params.period,
+				params.period_count, params.words,
+				operand(1)[0],
+				operand(2)[0]);
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1563,24 +1256,18 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTGIDXIT(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		Buffer b;
 
 		wg = in_wg.read();
-
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_xlat_phys.read();
 
 		stride_descriptor sd(dst);
 
-		sd.type = stride_descriptor::IDXIT;
-		sd.write = (op.getOp() == OP_STGIDXIT);
-
-		sd.dst_offset = 0;
-		sd.addr = b.getAddress();
+		ldst_ops::gidxit(sd, op.getOp() == OP_STGIDXIT,
+				in_xlat_phys.read());
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1590,46 +1277,19 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSPG2SPTILE(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
-		sc_int<32> offset_x;
-		sc_int<32> offset_y;
-		Buffer b, spb;
 
 		wg = in_wg.read();
-		b = in_xlat_phys.read();
-		spb = in_sp_xlat_phys.read();
-
-		offset_x = (sc_int<32>)in_operand[1][0].read();
-		offset_y = (sc_int<32>)in_operand[2][0].read();
 
 		stride_descriptor sd;
 		sd.dst = RequestTarget(wg,TARGET_SP);
 
-		sd.write = (op.getOp() == OP_STG2SPTILE);
-		sd.period = b.get_dim_x();
-		sd.period_count = min(sc_uint<32>(spb.get_dim_y()),
-				(sc_uint<32>) (b.get_dim_y() - (offset_y)));
-		sd.words = min(sc_uint<32>(spb.get_dim_x()),
-				(sc_uint<32>) (b.get_dim_x() - (offset_x)));
-		sd.dst_period = spb.get_dim_x();
-
-		sd.dst_offset = spb.addr;
-
-		/** Negative edge cases. */
-		if (offset_y < 0) {
-			sd.dst_offset += (sd.dst_period * (-offset_y) * 4);
-			sd.period_count += offset_y;
-			offset_y = 0;
-		}
-		if (offset_x < 0) {
-			sd.dst_offset -= offset_x * 4;
-			sd.words += offset_x;
-			offset_x = 0;
-		}
-		sd.addr = b.getAddress() +
-			((offset_y * b.get_dim_x() + offset_x) << 2);
+		ldst_ops::g2sptile(sd, op.getOp() == OP_STG2SPTILE,
+				in_xlat_phys.read(), in_sp_xlat_phys.read(),
+				operand(1)[0],
+				operand(2)[0]);
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1640,27 +1300,19 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	do_LDSTSPBIDX(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
 		Buffer b;
 
 		wg = in_wg.read();
-
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
 		b = in_sp_xlat_phys.read();
 
 		stride_descriptor sd(dst);
 
-		sd.write = (op.getOp() == OP_STSPBIDX);
-		sd.period = b.dims[0];
-		sd.period_count = b.dims[1];
-		sd.words = b.dims[0];
-		sd.dst_period = b.dims[0]; // XXX?
-
-		sd.dst_offset = 0;
-		sd.addr = b.getAddress();
+		ldst_ops::bidx(sd, op.getOp() == OP_STSPBIDX, b, b.dims[0]);
 
 		ldst_kick(op, req_if_t(wg), sd, ps);
 	}
@@ -1669,29 +1321,17 @@ private:
 	 * @param op Instruction containing this scalar DRAM load
 	 * @param ps Pipeline stage.*/
 	void
-	do_SLD(Instruction &op, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_SLD(Instruction &op, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
-		sc_uint<32> wg_width;
-		sc_uint<32> offset_x;
-		sc_uint<32> offset_y;
-		Buffer b;
 
 		wg = in_wg.read();
-		wg_width = 32 << in_wg_width.read();
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
-		b = in_xlat_phys.read();
-
-		offset_x = 0;/*in_operand[1][0] << 2;*/
 
 		stride_descriptor sd(dst);
 
-		sd.write = false;
-		sd.addr = b.getAddress() + offset_x;
-		sd.period = in_operand[1][0].read();
-		sd.period_count = 1;
-		sd.words = in_operand[1][0].read();
+		ldst_ops::sld(sd, in_xlat_phys.read(), operand(1)[0]);
 
 		ldst_kick(op, IF_DRAM, sd, ps);
 	}
@@ -1701,30 +1341,21 @@ private:
 	 * @param ps Pipeline stage.*/
 	void
 	do_SLDSP(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int wg;
 		Register<THREADS/LANES> dst;
 		stride_descriptor params;
-		sc_uint<32> offset_x;
-		sc_uint<32> offset_y;
-		Buffer b;
 
 		wg = in_wg.read();
 		params = in_sd[wg].read();
-		b = in_sp_xlat_phys.read();
-
-		offset_x = in_operand[1][0].read() << 2;
-		offset_y = (in_operand[2][0].read() * b.dims[0]) << 2;
-
 		dst = op.getDst().getRegister<THREADS/LANES>(wg, 0);
+
 		stride_descriptor sd(dst);
 
-		sd.write = false;
-		sd.addr = b.getAddress() + offset_x + offset_y;
-		sd.period = params.words;
-		sd.period_count = 1;
-		sd.words = params.words;
+		ldst_ops::sldsp(sd, in_sp_xlat_phys.read(),
+				operand(1)[0],
+				operand(2)[0], params.words);
 
 		ldst_kick(op, req_if_t(wg), sd, ps);
 	}
@@ -1736,9 +1367,9 @@ private:
 	 * @param ps Pipeline stage. */
 	void
 	ldst_kick(Instruction &op, req_if_t target, stride_descriptor &sd,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		sc_uint<1> wg;
+		sc_uint<COMPUTE_WG_WIDTH> wg;
 
 		wg = in_wg.read();
 
@@ -1770,9 +1401,9 @@ private:
 	 * We're being a bit imprecise with committing this.
 	 * @param ps Pipeline stage. */
 	void
-	do_PRINTTRACE(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	do_PRINTTRACE(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		ps.data_w[0] = !!in_operand[0][0].read();
+		ps.data_w[0] = !!operand(0)[0];
 		ps.print = PRINT_TRACE;
 	}
 
@@ -1780,13 +1411,16 @@ private:
 	 * @param op Operation to perform.
 	 * @param ps Pipeline stage. */
 	void
-	doExecute(Instruction op, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	doExecute(Instruction op, IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		unsigned int i;
 
 		if (op.isDead())
 			return;
 
+		if (is_lane_op(op.getOp()))
+			load_operands(op.getSrcs());
+
 		switch (op.getOp()) {
 		case OP_TEST:
 			do_TEST(op.getSubOp().test, ps);
@@ -1804,7 +1438,7 @@ private:
 			do_SICJ(op.getSubOp().test, ps);
 			break;
 		case OP_BRA:
-			do_CPUSH(CPUSH_IF, in_operand[0][0].read(),
+			do_CPUSH(CPUSH_IF, operand(0)[0],
 					op.getCommit(), ps);
 			do_CMASK(1, ps);
 			break;
@@ -1818,7 +1452,7 @@ private:
 			do_CPOP(op.getCommit(), ps);
 			break;
 		case OP_CPUSH:
-			do_CPUSH(op.getSubOp().cpush,in_operand[0][0].read(),
+			do_CPUSH(op.getSubOp().cpush,operand(0)[0],
 					op.getCommit(), ps);
 			break;
 		case OP_EXIT:
@@ -1992,22 +1626,23 @@ private:
 			do_LDSTSPBIDX(op, ps);
 			break;
 		case OP_DBG_PRINTSGPR:
-			ps.data_w[0] = in_operand[0][0].read();
+			ps.data_w[0] = operand(0)[0];
 			ps.print = PRINT_SGPR;
 			break;
 		case OP_DBG_PRINTVGPR:
-			assert(in_operand[1][0].read() < THREADS);
-			ps.data_w[0] = in_operand[0][in_operand[1][0].read() & (LANES - 1)].read();
+			assert(operand(1)[0] < THREADS);
+			ps.data_w[0] = operand(0)
+					[operand(1)[0] & (LANES - 1)];
 			ps.print = PRINT_VGPR;
 			break;
 		case OP_DBG_PRINTPR:
-			for (i = 0; i < LANES; i++)
-				ps.data_w[i] = in_operand[0][i].read();
+			memcpy(ps.data_w, operand(0).data,
+					sizeof(ps.data_w));
 			ps.print = PRINT_PR;
 			break;
 		case OP_DBG_PRINTCMASK:
-			for (i = 0; i < LANES; i++)
-				ps.data_w[i] = in_operand[0][i].read();
+			memcpy(ps.data_w, operand(0).data,
+					sizeof(ps.data_w));
 			ps.print = PRINT_CMASK;
 			break;
 		case OP_DBG_PRINTTRACE:
@@ -2034,10 +1669,10 @@ private:
 	  */
 	void
 	setWrite(Instruction &op,
-			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+			IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		Operand dst;
-		sc_uint<1> wg;
+		sc_uint<COMPUTE_WG_WIDTH> wg;
 
 		ps.dequeue_sb = op.getOnSb();
 		ps.dequeue_sb_cstack_entry = op.getOnCStackSb();
@@ -2081,7 +1716,7 @@ private:
 	/** Update performance counters.
 	 * @param ps Committed pipeline stage. */
 	void
-	commit_pcount(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	commit_pcount(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
 		if (ps.op.isDead() || ps.op.getOp() == NOP)
 			commit_nop++;
@@ -2092,14 +1727,28 @@ private:
 	}
 
 	/** Commit a pipeline stage to the IExecute outputs.
+	 *
+	 * If an output FIFO is full, the commit is suspended and the process
+	 * made sensitive to that FIFO. Calling commit() again with the same
+	 * pipeline stage resumes where it left off.
 	 * @param ps Pipeline stage.
+	 * @return True iff the pipeline stage is fully committed.
 	 */
-	void
-	commit(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> &ps)
+	bool
+	commit(IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS> &ps)
 	{
-		unsigned int l;
+		unsigned int l, w;
 		bfloat item;
 
+		switch (commit_state) {
+		case COMMIT_ST_SIGNALS:
+			break;
+		case COMMIT_ST_COL_MASK:
+			goto commit_col_mask;
+		case COMMIT_ST_DESC:
+			goto commit_desc;
+		}
+
 		out_pc_w.write(ps.pc_w);
 		out_pc_do_w.write(ps.pc_do_w);
 
@@ -2121,19 +1770,34 @@ private:
 #endif
 
 		out_ignore_mask_w.write(ps.ignore_mask_w);
-		if (ps.out_w && ps.req_w.isVectorType() && !ps.ignore_mask_w)
-			out_col_mask_w.write(ps.col_mask_w);
+
+	commit_col_mask:
+		if (ps.out_w && ps.req_w.isVectorType() && !ps.ignore_mask_w &&
+		    !out_col_mask_w.nb_write(ps.col_mask_w)) {
+			commit_state = COMMIT_ST_COL_MASK;
+			next_trigger(out_col_mask_w.data_read_event());
+			return false;
+		}
 
 		out_cstack_action.write(ps.cstack_action);
 		out_cstack_entry.write(ps.cstack_entry);
 
+	commit_desc:
 		if (ps.store_target != IF_SENTINEL) {
-			out_desc_fifo[ps.store_target].write(ps.desc_fifo);
+			if (!out_desc_fifo[ps.store_target].nb_write(ps.desc_fifo)) {
+				commit_state = COMMIT_ST_DESC;
+				next_trigger(out_desc_fifo[ps.store_target]
+						.data_read_event());
+				return false;
+			}
+
 			out_store_kick[ps.store_target].nb_write(true);
 			ticket_push++;
 		}
-		out_wg_state_next[0].write(ps.wg_state_next[0]);
-		out_wg_state_next[1].write(ps.wg_state_next[1]);
+
+		commit_state = COMMIT_ST_SIGNALS;
+		for (w = 0; w < WG_SLOTS; w++)
+			out_wg_state_next[w].write(ps.wg_state_next[w]);
 		out_wg_exit_commit.write(ps.wg_exit_commit);
 
 		switch (ps.print)
@@ -2178,6 +1842,8 @@ private:
 
 		if (sc_is_running())
 			commit_pcount(ps);
+
+		return true;
 	}
 
 	/** Invalidate current pipeline contents. */
@@ -2219,58 +1885,77 @@ private:
 				max(pipe_sidebuf_hold_counter - 1, 0);
 	}
 
-	/** Main thread. */
+	/** Account for skipped clock edges and print the debug trace of a
+	 * committed cycle. */
 	void
-	thread_lt(void)
+	commit_finish(void)
 	{
-		Instruction op;
-		IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS> pipe_elem;
+		if (clk) {
+			commit_nop += clk->get_skipped() - clk_skipped;
+			clk_skipped = clk->get_skipped();
+		}
 
-		while (true) {
-			if (pipe_sidebuf_hold_counter == 0) {
-				pipe_sidebuf =
-					IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS>(in_wg.read());
+		if (debug_output[DEBUG_COMPUTE_TRACE]) {
+			cout << sc_time_stamp() << " IExecute: " <<
+				in_pc.read() << in_col_w.read() << " " <<
+				commit_insn << " " << operand(0)[0] <<
+				" " << operand(1)[0] <<
+				" " << operand(2)[0] << endl;
+			cout << sc_time_stamp() << " IExecute: COMMITTING WG" <<
+				commit_elem.wg_w << ": " << commit_elem.op << endl;
 
-				op = in_insn.read();
-				pipe_elem = pipe.top();
+		}
+	}
 
-				/* Insert a post-branch bubble. */
-				if (out_pc_do_w.read() ||
-				    !in_thread_active.read()[in_wg.read()]) {
+	/** Main process, evaluated on every clock edge.
+	 *
+	 * When committing blocks on a full output FIFO, the next invocation
+	 * is triggered by that FIFO instead and only resumes the commit. */
+	void
+	method_lt(void)
+	{
+		Instruction op;
 
-					op.kill();
-					pipe_invalidate();
-				}
+		if (commit_state != COMMIT_ST_SIGNALS) {
+			if (commit(commit_elem))
+				commit_finish();
+			return;
+		}
 
-				pipe_sidebuf.op = op;
+		if (pipe_sidebuf_hold_counter == 0) {
+			pipe_sidebuf =
+				IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS>(in_wg.read());
 
-				setWrite(op, pipe_sidebuf);
-				doExecute(op, pipe_sidebuf);
-			}
+			op = in_insn.read();
 
-			decrement_pipe_sidebuf_hold_counter();
+			/* Insert a post-branch bubble. */
+			if (out_pc_do_w.read() ||
+			    !in_thread_active.read()[in_wg.read()]) {
 
-			if (pipe_sidebuf_hold_counter == 0) {
-				pipe_elem = pipe.swapHead(pipe_sidebuf);
-			} else {
-				/* NOP */
-				pipe_elem = IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS>(in_wg.read());
-				pipe_elem = pipe.swapHead(pipe_elem);
+				op.kill();
+				pipe_invalidate();
 			}
 
-			commit(pipe_elem);
+			pipe_sidebuf.op = op;
 
-			if (debug_output[DEBUG_COMPUTE_TRACE]) {
-				cout << sc_time_stamp() << " IExecute: " <<
-					in_pc.read() << in_col_w.read() << " " << op <<
-					" " << in_operand[0][0].read() << " " << in_operand[1][0].read() <<
-					" " << in_operand[2][0].read() << endl;
-				cout << sc_time_stamp() << " IExecute: COMMITTING WG" <<
-					pipe_elem.wg_w << ": " << pipe_elem.op << endl;
+			setWrite(op, pipe_sidebuf);
+			doExecute(op, pipe_sidebuf);
+		}
 
-			}
-			wait();
+		decrement_pipe_sidebuf_hold_counter();
+
+		if (pipe_sidebuf_hold_counter == 0) {
+			commit_elem = pipe.swapHead(pipe_sidebuf);
+		} else {
+			/* NOP */
+			commit_elem = IExecute_pipe<PC_WIDTH,THREADS,LANES,RCPUS,WG_SLOTS>(in_wg.read());
+			commit_elem = pipe.swapHead(commit_elem);
 		}
+
+		commit_insn = op;
+
+		if (commit(commit_elem))
+			commit_finish();
 	}
 };
 
@@ -25,6 +25,7 @@
 #include "compute/model/imem_request.h"
 #include "util/constmath.h"
 #include "util/debug_output.h"
+#include "util/defaults.h"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -33,6 +34,8 @@ using namespace compute_model;
 
 namespace compute_control {
 
+/** Work-group selected for fetch. Slots beyond the first two are represented
+ * as IFETCH_WG_0 + slot. */
 typedef enum {
 	IFETCH_WG_NONE = -1,
 	IFETCH_WG_0 = 0,
@@ -40,13 +43,15 @@ typedef enum {
 } ifetch_wg_select;
 
 /** Instruction fetch pipeline stage.
- * @todo Should IFetch be the ``workgroup master'', or is that a level up? */
-template <unsigned int PC_WIDTH>
+ * @todo Should IFetch be the ``workgroup master'', or is that a level up?
+ * @param PC_WIDTH Number of bits in the program counter.
+ * @param WG_SLOTS Number of resident work-group slots. */
+template <unsigned int PC_WIDTH, unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class IFetch : public sc_core::sc_module
 {
 private:
 	/** Compute-wide PC, per-workgroup. */
-	sc_uint<PC_WIDTH> pc[2];
+	sc_uint<PC_WIDTH> pc[WG_SLOTS];
 
 	/** Active work-group slot. */
 	unsigned int wg;
@@ -67,10 +72,10 @@ public:
 	sc_in<bool> in_stall_d{"in_stall"};
 
 	/** State of the workgroups for this cluster */
-	sc_in<workgroup_state> in_wg_state[2];
+	sc_in<workgroup_state> in_wg_state[WG_SLOTS];
 
 	/** Finished bit, comes slightly earlier than state. */
-	sc_in<sc_bv<2> > in_wg_finished{"in_wg_finished"};
+	sc_in<sc_bv<WG_SLOTS> > in_wg_finished{"in_wg_finished"};
 
 	/** Boolean, true iff PC should be overwritten (branch). */
 	sc_in<bool> in_pc_write{"in_pc_write"};
@@ -84,16 +89,16 @@ public:
 	sc_in<sc_uint<PC_WIDTH> > in_pc_w{"in_pc_w"};
 
 	/** Workgroup for PC write */
-	sc_in<sc_uint<1> > in_pc_wg_w{"in_pc_wg_w"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_pc_wg_w{"in_pc_wg_w"};
 
 	/** Out PC, connecting to IMem input. */
 	sc_fifo_out<imem_request<PC_WIDTH> > out_insn_r{"out_insn_r"};
 
 	/** Workgroup currently active. */
-	sc_inout<sc_uint<1> > out_wg{"out_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg{"out_wg"};
 
 	/** Workgroup to reset PC for. */
-	sc_in<sc_uint<1> > in_pc_rst_wg{"pc_rst_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_pc_rst_wg{"pc_rst_wg"};
 
 	/** Boolean: true iff PC for wg in in_pc_rst_wg must be reset. */
 	sc_in<bool> in_pc_rst{"pc_rst"};
@@ -104,33 +109,42 @@ public:
 	/** Construct thread. */
 	SC_CTOR(IFetch) : wg(0)
 	{
-		pc[0] = 0;
-		pc[1] = 0;
+		unsigned int w;
+
+		for (w = 0; w < WG_SLOTS; w++)
+			pc[w] = 0;
 
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
 	}
 
-	/** Select the workgroup to execute ths cycle */
+	/** Select the workgroup to execute ths cycle.
+	 *
+	 * Biased towards the active work-group. Otherwise the first runnable
+	 * work-group following the active one is selected, round-robin. */
 	ifetch_wg_select
 	select_wg(void)
 	{
 		sc_bv<WSS_SENTINEL> sched_opts;
+		sc_bv<WG_SLOTS> finished;
+		unsigned int i, w;
 
 		sched_opts = in_sched_opts.read();
 
 		/** Don't issue instructions along with SP r/w. */
-		if (sched_opts[WSS_NO_PARALLEL_COMPUTE_SP] &&
-		      (in_wg_state[0] == WG_STATE_BLOCKED_SP ||
-		       in_wg_state[1] == WG_STATE_BLOCKED_SP))
-				return IFETCH_WG_NONE;
-
-		if (in_wg_state[wg] == WG_STATE_RUN &&
-				!in_wg_finished.read()[wg])
-			return ifetch_wg_select(wg);
-		else if (in_wg_state[1-wg] == WG_STATE_RUN &&
-				!in_wg_finished.read()[1-wg])
-			return ifetch_wg_select(1-wg);
+		if (sched_opts[WSS_NO_PARALLEL_COMPUTE_SP]) {
+			for (w = 0; w < WG_SLOTS; w++) {
+				if (in_wg_state[w] == WG_STATE_BLOCKED_SP)
+					return IFETCH_WG_NONE;
+			}
+		}
+
+		finished = in_wg_finished.read();
+		for (i = 0; i < WG_SLOTS; i++) {
+			w = (wg + i) % WG_SLOTS;
+			if (in_wg_state[w] == WG_STATE_RUN && !finished[w])
+				return ifetch_wg_select(w);
+		}
 
 		return IFETCH_WG_NONE;
 	}
@@ -139,7 +153,7 @@ private:
 	/** Main thread
 	 * @todo This logic feels a tad ad-hoc. Perhaps rethink and simplify.
 	 *
-	 * We are managing two PC registers and an output. Ideally the output
+	 * We are managing WG_SLOTS PC registers and an output. Ideally the output
 	 * is just a selection of either PC, but auto-increment is tricky in
 	 * the light of switching threads. Here's what we know:
 	 * - Any command that causes blocking (e.g. DRAM) writes a PC in the
@@ -20,10 +20,15 @@
 #define COMPUTE_CONTROL_REGFILE_H
 
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <array>
+#include <bitset>
+#include <new>
 
 #include "compute/model/work.h"
 #include "compute/model/compute_stats.h"
+#include "compute/model/operand_bus.h"
 #include "compute/control/RegHazardDetect_3R1W.h"
 #include "isa/model/Operand.h"
 #include "model/request_target.h"
@@ -49,34 +54,43 @@ namespace compute_control {
  * implementation for a different hazard detection policy.
  * @param THREADS Number of threads in a work-group. Must be a power of two.
  * @param LANES Number of physical SIMD lanes. Must be a power of two.
+ * @param DRAM_CHANS Number of DRAM channels, each transferring BUS_WIDTH/4
+ * 		     words per cycle.
+ * @param WG_SLOTS Number of resident work-group slots, each with their own
+ * 		   register file partition and scratchpad interface.
  */
 template <unsigned int THREADS, unsigned int LANES, unsigned int BUS_WIDTH,
-		unsigned int BUS_WIDTH_SP>
+		unsigned int BUS_WIDTH_SP,
+		unsigned int DRAM_CHANS = MC_DRAM_CHANS,
+		unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class RegFile : public sc_module
 {
 private:
-	/** Reference to storage for register data for Vector Register File. */
-	sc_uint<32> *VRF[2];
+	/** Reference to storage for register data for Vector Register File.
+	 *
+	 * Register file storage uses native words rather than SystemC data
+	 * types. Conversion happens once at the port boundary. */
+	uint32_t *VRF[WG_SLOTS];
 	/** Reference to storage for register data for Scalar Register File. */
-	sc_uint<32> *SRF[2];
+	uint32_t *SRF[WG_SLOTS];
 	/** Reference to storage for data for Predicate Register File. */
-	sc_uint<1> *PRF[2];
+	uint8_t *PRF[WG_SLOTS];
 
-	/** Cam index values */
-	sc_uint<30> *cam_idx[2];
+	/** Cam index values, 30 bits wide. */
+	uint32_t *cam_idx[WG_SLOTS];
 
 	/** Cam buffer values */
-	sc_uint<32> *cam_val[2];
+	uint32_t *cam_val[WG_SLOTS];
 
 	/**
 	 * Storage for Control Mask Register File.
 	 * We need to assume that these registers are independent flip-flops
 	 * rather than SRAMs, so cheap to read for special purposes.
 	 */
-	sc_bv<LANES> CMRF[2][4][THREADS/LANES];
+	bitset<LANES> CMRF[WG_SLOTS][4][THREADS/LANES];
 
 	/** Signal that indicates for each thread whether it's active. */
-	sc_bv<LANES> lanes_en[2][THREADS/LANES];
+	bitset<LANES> lanes_en[WG_SLOTS][THREADS/LANES];
 
 	/** Hazard (bank conflict) detection logic. */
 	RegHazardDetect<THREADS,LANES> *hazard_detect;
@@ -104,10 +118,42 @@ private:
 	bool *vrf_bank_word_hit_map;
 
 	/** Shadow register: at least one thread is active. */
-	sc_bv<2> thread_active;
+	sc_bv<WG_SLOTS> thread_active;
 
 	/** Shadow register: all threads are finished. */
-	sc_bv<2> threads_fini;
+	sc_bv<WG_SLOTS> threads_fini;
+
+	/** Column of the active thread mask requested this cycle. */
+	sc_uint<const_log2(THREADS/LANES)> mask_w_col;
+
+	/** Work-group of the active thread mask requested this cycle. */
+	unsigned int mask_w_wg;
+
+	/** True iff method_rd_mask_w() waits for the delta cycle in which it
+	 * outputs the requested mask. */
+	bool mask_w_delta;
+
+	/** True iff method_wr() has yet to reset the outputs. */
+	bool wr_rst;
+
+	/** Read request picked up by method_rd(). */
+	reg_read_req<THREADS/LANES> rd_req;
+
+	/** True iff method_rd() waits for the delta cycle in which it
+	 * performs the reads of rd_req. */
+	bool rd_delta;
+
+	/** State of the CAM index push process. */
+	enum {
+		IDX_PUSH_ST_IDLE,
+		IDX_PUSH_ST_PUSH
+	} idx_push_state;
+
+	/** Register whose CAM indexes are being pushed. */
+	AbstractRegister idx_push_reg;
+
+	/** Next thread to push the CAM index of. */
+	unsigned int idx_push_thread;
 
 public:
 	/** Compute clock. */
@@ -129,6 +175,12 @@ public:
 	/** Data read from registers */
 	sc_inout<sc_uint<32> > out_data_r[3][LANES];
 
+	/** Data read from registers, all lanes of a read port on a single bus.
+	 * Optional. If bound, the read data is written to this bus only and
+	 * out_data_r is left untouched, saving LANES signal writes per read. */
+	sc_port<sc_signal_inout_if<operand_bus<LANES> >, 1,
+			SC_ZERO_OR_MORE_BOUND> out_data_bus_r[3];
+
 	/** Bank conflicts for read ops. */
 	sc_fifo_out<sc_bv<3> > out_req_conflicts{"out_req_conflicts"};
 
@@ -146,10 +198,10 @@ public:
 
 	/** Last warp executing for the active workgroup.
 	 * XXX: use information from the source instead. */
-	sc_in<sc_uint<const_log2(THREADS/LANES)> > in_last_warp[2];
+	sc_in<sc_uint<const_log2(THREADS/LANES)> > in_last_warp[WG_SLOTS];
 
 	/** Workgroup for mask register output. */
-	sc_in<sc_uint<1> > in_wg_mask_w{"in_wg_mask_w"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg_mask_w{"in_wg_mask_w"};
 
 	/** Column for mask register output */
 	sc_fifo_in<sc_uint<const_log2(THREADS/LANES)> >
@@ -163,10 +215,10 @@ public:
 	sc_in<bool> in_ignore_mask_w{"in_ignore_mask_w"};
 
 	/** At least one thread is active. */
-	sc_inout<sc_bv<2> > out_thread_active{"out_thread_active"};
+	sc_inout<sc_bv<WG_SLOTS> > out_thread_active{"out_thread_active"};
 
 	/** Workgroup finished execution. */
-	sc_inout<sc_bv<2> > out_wg_finished{"out_wg_finished"};
+	sc_inout<sc_bv<WG_SLOTS> > out_wg_finished{"out_wg_finished"};
 
 	/***************** Write channel for "inactive" WG *****************/
 	/** @todo Where are these signals coming from */
@@ -174,10 +226,10 @@ public:
 	sc_in<bool> in_cmask_rst{"in_cmask_rst"};
 
 	/** Workgroup to reset CMASK for */
-	sc_in<sc_uint<1> > in_cmask_rst_wg{"in_cmask_rst_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_cmask_rst_wg{"in_cmask_rst_wg"};
 
 	/** Workgroup offsets (X, Y) */
-	sc_in<sc_uint<32> > in_wg_off[2][2];
+	sc_in<sc_uint<32> > in_wg_off[WG_SLOTS][2];
 
 	/** Work dimensions (X, Y) */
 	sc_in<sc_uint<32> > in_dim[2];
@@ -195,35 +247,37 @@ public:
 	/** Register description of (first) data word element */
 	sc_in<AbstractRegister> in_store_reg[IF_SENTINEL];
 
-	/** Write mask. */
-	sc_in<sc_bv<BUS_WIDTH/4> > in_dram_store_mask{"in_dram_store_mask"};
+	/** Write mask, per DRAM channel. */
+	sc_in<sc_bv<BUS_WIDTH/4> > in_dram_store_mask[DRAM_CHANS];
 
-	/** Indexes for each incoming data word */
-	sc_in<reg_offset_t<THREADS> > in_dram_store_idx[BUS_WIDTH/4];
+	/** Indexes for each incoming data word, BUS_WIDTH/4 lanes per DRAM
+	 * channel. */
+	sc_in<reg_offset_t<THREADS> > in_dram_store_idx[DRAM_CHANS*BUS_WIDTH/4];
 
 	/** Data from different storage systems (SP, DRAM). */
-	sc_in<sc_uint<32> > in_dram_store_data[BUS_WIDTH/4];
+	sc_in<sc_uint<32> > in_dram_store_data[DRAM_CHANS*BUS_WIDTH/4];
 
 	/** Outgoing data to DRAM */
-	sc_inout<sc_uint<32> > out_dram_store_data[BUS_WIDTH/4];
+	sc_inout<sc_uint<32> > out_dram_store_data[DRAM_CHANS*BUS_WIDTH/4];
 
-	/** Write mask taking into account individual lane status */
-	sc_inout<sc_bv<BUS_WIDTH/4> > out_dram_store_mask{"out_dram_store_mask"};
+	/** Write mask taking into account individual lane status, per DRAM
+	 * channel. */
+	sc_inout<sc_bv<BUS_WIDTH/4> > out_dram_store_mask[DRAM_CHANS];
 
 	/** Write mask. */
-	sc_in<sc_bv<BUS_WIDTH_SP> > in_sp_store_mask[2];
+	sc_in<sc_bv<BUS_WIDTH_SP> > in_sp_store_mask[WG_SLOTS];
 
 	/** Indexes for each incoming data word */
-	sc_in<reg_offset_t<THREADS> > in_sp_store_idx[2][BUS_WIDTH_SP];
+	sc_in<reg_offset_t<THREADS> > in_sp_store_idx[WG_SLOTS][BUS_WIDTH_SP];
 
 	/** Data from different storage systems (SP, DRAM). */
-	sc_in<sc_uint<32> > in_sp_store_data[2][BUS_WIDTH_SP];
+	sc_in<sc_uint<32> > in_sp_store_data[WG_SLOTS][BUS_WIDTH_SP];
 
 	/** Outgoing data to DRAM */
-	sc_inout<sc_uint<32> > out_sp_store_data[2][BUS_WIDTH_SP];
+	sc_inout<sc_uint<32> > out_sp_store_data[WG_SLOTS][BUS_WIDTH_SP];
 
 	/** Write mask taking into account individual lane status */
-	sc_inout<sc_bv<BUS_WIDTH_SP> > out_sp_store_mask[2];
+	sc_inout<sc_bv<BUS_WIDTH_SP> > out_sp_store_mask[WG_SLOTS];
 
 	/** Trigger an index push. */
 	sc_in<bool> in_store_idx_push_trigger{"in_store_idx_push_trigger"};
@@ -240,32 +294,28 @@ public:
 	 * @todo Wasteful in terms of memory. Also, if we convey offsets as
 	 * (x,y) pairs rather than a single counter, we might need a dedicated
 	 * struct. */
-	sc_inout<stride_descriptor> out_sd[2];
+	sc_inout<stride_descriptor> out_sd[WG_SLOTS];
 
 	/** Construct thread. */
 	SC_CTOR(RegFile)
 	: hazard_detect(new RegHazardDetect_3R1W<THREADS,LANES>()),
 	  dram_vrf_words_r(0ul), dram_vrf_words_w(0ul),
 	  dram_vrf_net_words_r(0ul), dram_vrf_net_words_w(0ul),
-	  vrf_bank_word_hit_map(nullptr)
+	  vrf_bank_word_hit_map(nullptr), mask_w_col(0), mask_w_wg(0),
+	  mask_w_delta(false), wr_rst(true), rd_delta(false),
+	  idx_push_state(IDX_PUSH_ST_IDLE), idx_push_thread(0u)
 	{
-		sc_bv<LANES> bv = 0;
-		bv.b_not();
-
-		VRF[0] = new sc_uint<32>[THREADS*64];
-		VRF[1] = new sc_uint<32>[THREADS*64];
-		SRF[0] = new sc_uint<32>[32];
-		SRF[1] = new sc_uint<32>[32];
-		PRF[0] = new sc_uint<1>[THREADS*4];
-		PRF[1] = new sc_uint<1>[THREADS*4];
+		unsigned int w;
 
-		cam_idx[0] = new sc_uint<30>[THREADS];
-		cam_idx[1] = new sc_uint<30>[THREADS];
-		cam_val[0] = new sc_uint<32>[THREADS];
-		cam_val[1] = new sc_uint<32>[THREADS];
+		for (w = 0; w < WG_SLOTS; w++) {
+			VRF[w] = alloc_regs<uint32_t>(THREADS*64);
+			SRF[w] = alloc_regs<uint32_t>(32);
+			PRF[w] = alloc_regs<uint8_t>(THREADS*4);
+			cam_idx[w] = alloc_regs<uint32_t>(THREADS);
+			cam_val[w] = alloc_regs<uint32_t>(THREADS);
 
-		reset_cmasks(0);
-		reset_cmasks(1);
+			reset_cmasks(w);
+		}
 
 		for (unsigned int l = 0; l < THREADS; l++) {
 			PRF[0][l] = (l == 0);
@@ -274,49 +324,99 @@ public:
 
 		set_vrf_bank_words(4);
 
-		SC_THREAD(thread_wr);
+		SC_METHOD(method_wr);
 		sensitive << in_clk.pos();
 
-		SC_THREAD(thread_rd);
+		SC_METHOD(method_rd);
 		sensitive << in_clk.pos();
 
-		SC_THREAD(thread_rd_mask_w);
+		SC_METHOD(method_rd_mask_w);
 		sensitive << in_clk.pos();
 
-		SC_THREAD(thread_store);
+		SC_METHOD(method_store);
 		sensitive << in_clk_dram.pos();
+		dont_initialize();
 
-		SC_THREAD(thread_idx_push);
+		SC_METHOD(method_idx_push);
 		sensitive << in_clk_dram.pos();
+		dont_initialize();
 	}
 
 	/** Destroy register backing storage. */
 	~RegFile() {
-		delete[] VRF[0];
-		delete[] VRF[1];
-		delete[] SRF[0];
-		delete[] SRF[1];
-		delete[] PRF[0];
-		delete[] PRF[1];
-		delete[] cam_idx[0];
-		delete[] cam_idx[1];
-		delete[] cam_val[0];
-		delete[] cam_val[1];
-		delete[] vrf_bank_word_hit_map;
+		unsigned int w;
+
+		for (w = 0; w < WG_SLOTS; w++) {
+			free(VRF[w]);
+			free(SRF[w]);
+			free(PRF[w]);
+			free(cam_idx[w]);
+			free(cam_val[w]);
+
+			VRF[w] = nullptr;
+			SRF[w] = nullptr;
+			PRF[w] = nullptr;
+			cam_idx[w] = nullptr;
+			cam_val[w] = nullptr;
+		}
 
-		VRF[0] = nullptr;
-		VRF[1] = nullptr;
-		SRF[0] = nullptr;
-		SRF[1] = nullptr;
-		PRF[0] = nullptr;
-		PRF[1] = nullptr;
-		cam_idx[0] = nullptr;
-		cam_idx[1] = nullptr;
-		cam_val[0] = nullptr;
-		cam_val[1] = nullptr;
+		delete[] vrf_bank_word_hit_map;
 		vrf_bank_word_hit_map = nullptr;
 	}
 
+	/** Allocate zero-initialised, cache-line aligned register storage.
+	 * @param n Number of elements.
+	 * @return Pointer to storage, to be released with free(). */
+	template <typename T>
+	static T *
+	alloc_regs(size_t n)
+	{
+		size_t bytes;
+		T *p;
+
+		bytes = ((n * sizeof(T) + 63) / 64) * 64;
+		p = static_cast<T *>(aligned_alloc(64, bytes));
+		if (!p)
+			throw bad_alloc();
+
+		memset(p, 0, bytes);
+
+		return p;
+	}
+
+	/** Convert a lane mask to the bit-vector type used on ports, one
+	 * 32-bit word at a time.
+	 * @param m Lane mask.
+	 * @return m as an sc_bv. */
+	static sc_bv<LANES>
+	mask_to_bv(const bitset<LANES> &m)
+	{
+		sc_bv<LANES> bv;
+		unsigned int w;
+
+		for (w = 0; w < (LANES + 31) / 32; w++)
+			bv.set_word(w, ((m >> (w * 32)) &
+					bitset<LANES>(0xffffffffu)).to_ulong());
+
+		return bv;
+	}
+
+	/** Convert a bit-vector read from a port to a lane mask, one 32-bit
+	 * word at a time.
+	 * @param bv Bit-vector.
+	 * @return bv as a lane mask. */
+	static bitset<LANES>
+	bv_to_mask(const sc_bv<LANES> &bv)
+	{
+		bitset<LANES> m;
+		unsigned int w;
+
+		for (w = 0; w < (LANES + 31) / 32; w++)
+			m |= bitset<LANES>(bv.get_word(w)) << (w * 32);
+
+		return m;
+	}
+
 	/** Set the RegHazardDetector state class.
 	 * @param hd Hazard detector object. */
 	void
@@ -390,17 +490,33 @@ private:
 		return c;
 	}
 
+	/** Drive the data read for a read port onto the outputs.
+	 * @param read_port Read port.
+	 * @param bus Data read, one word per lane. */
+	void
+	write_operand(unsigned int read_port, const operand_bus<LANES> &bus)
+	{
+		unsigned int l;
+
+		if (out_data_bus_r[read_port].size()) {
+			out_data_bus_r[read_port]->write(bus);
+			return;
+		}
+
+		for (l = 0; l < LANES; l++)
+			out_data_r[read_port][l].write(bus[l]);
+	}
+
 	/** Broadcast a value on all output lanes.
 	 * @param value 32-bit value to broadcast.
 	 * @param read_port Port to broadcast this value on. */
 	void
-	broadcast_value(sc_uint<32> value, unsigned int read_port)
+	broadcast_value(uint32_t value, unsigned int read_port)
 	{
-		unsigned int l;
+		operand_bus<LANES> bus;
 
-		for (l = 0; l < LANES; l++) {
-			out_data_r[read_port][l].write(value);
-		}
+		bus.broadcast(value);
+		write_operand(read_port, bus);
 	}
 
 	/** Perform a read from the VRF.
@@ -409,7 +525,7 @@ private:
 	void
 	read_vgpr(Register<THREADS/LANES> reg, unsigned int read_port)
 	{
-		unsigned int l;
+		operand_bus<LANES> bus;
 		unsigned int offset;
 
 		assert(reg.row < 64);
@@ -417,9 +533,8 @@ private:
 
 		offset = reg.row * THREADS + reg.col * LANES;
 
-		for (l = 0; l < LANES; l++) {
-			out_data_r[read_port][l].write(VRF[reg.wg][offset+l]);
-		}
+		memcpy(bus.data, &VRF[reg.wg][offset], sizeof(bus.data));
+		write_operand(read_port, bus);
 
 		if (debug_output[DEBUG_COMPUTE_TRACE])
 			cout << sc_time_stamp() << " RegFile r " << reg << endl;
@@ -447,6 +562,7 @@ private:
 	void
 	read_pr(Register<THREADS/LANES> reg, unsigned int read_port)
 	{
+		operand_bus<LANES> bus;
 		unsigned int l;
 		unsigned int offset;
 
@@ -455,10 +571,10 @@ private:
 
 		offset = reg.row * THREADS + reg.col * LANES;
 
-		for (l = 0; l < LANES; l++) {
-			out_data_r[read_port][l].write(
-					PRF[reg.wg][offset+l] ? 1 : 0);
-		}
+		for (l = 0; l < LANES; l++)
+			bus[l] = PRF[reg.wg][offset+l] ? 1 : 0;
+
+		write_operand(read_port, bus);
 
 		if (debug_output[DEBUG_COMPUTE_TRACE])
 			cout << sc_time_stamp() << " RegFile r " << reg << endl;
@@ -470,6 +586,7 @@ private:
 	void
 	read_vsp(Register<THREADS/LANES> reg, unsigned int read_port)
 	{
+		operand_bus<LANES> bus;
 		unsigned int l;
 
 		int wg_width;
@@ -510,8 +627,9 @@ private:
 
 			/* Mask in the bottom halves */
 			for (l = 0; l < LANES; l++)
-				out_data_r[read_port][l].
-					write(val | (l & l_mask));
+				bus[l] = val | (l & l_mask);
+
+			write_operand(read_port, bus);
 			break;
 		case VSP_TID_Y:
 			off = in_wg_off[reg.wg][1].read();
@@ -542,24 +660,27 @@ private:
 
 			/* Mask in the bottom halves */
 			for (l = 0; l < LANES; l++)
-				out_data_r[read_port][l].
-					write(val | ((l >> l_shift) & l_mask));
+				bus[l] = val | ((l >> l_shift) & l_mask);
+
+			write_operand(read_port, bus);
 			break;
 		case VSP_CTRL_BREAK:
 		case VSP_CTRL_EXIT:
 		case VSP_CTRL_RUN:
 		case VSP_CTRL_RET:
 			for (l = 0; l < LANES; l++)
-				out_data_r[read_port][l].write(
-					CMRF[reg.wg][reg.row][reg.col][l] ?
-							1 : 0);
+				bus[l] = CMRF[reg.wg][reg.row][reg.col][l] ?
+						1u : 0u;
+
+			write_operand(read_port, bus);
 			break;
 		case VSP_MEM_DATA:
 			off = reg.col * LANES;
 
-			for (l = 0; l < LANES; l++)
-				out_data_r[read_port][l].write(
-						cam_val[reg.wg][off+l]);
+			memcpy(bus.data, &cam_val[reg.wg][off],
+					sizeof(bus.data));
+
+			write_operand(read_port, bus);
 			break;
 		default:
 			assert(false);
@@ -619,7 +740,7 @@ private:
 	 * @param req Requested register.
 	 * @param mask Write mask, 1 if write should succeed for this lane. */
 	void
-	write_vgpr(Register<THREADS/LANES> req, sc_bv<LANES> mask)
+	write_vgpr(Register<THREADS/LANES> req, const bitset<LANES> &mask)
 	{
 		unsigned int offset;
 		unsigned int l;
@@ -629,13 +750,13 @@ private:
 		assert(req.col < (THREADS/LANES));
 
 		/* Anything to write at all? */
-		if (mask.or_reduce() == Log_0)
+		if (mask.none())
 			return;
 
 		offset = req.row * THREADS + req.col * LANES;
 
 		for (l = 0; l < LANES; l++) {
-			if (mask.get_bit(l) == Log_1)
+			if (mask[l])
 				VRF[req.wg][offset+l] = in_data_w[l].read();
 		}
 
@@ -666,7 +787,7 @@ private:
 	 * @param req Requested register.
 	 * @param mask Write mask, 1 if write should succeed for this lane. */
 	void
-	write_pr(Register<THREADS/LANES> req, sc_bv<LANES> mask)
+	write_pr(Register<THREADS/LANES> req, const bitset<LANES> &mask)
 	{
 		unsigned int offset;
 		unsigned int l;
@@ -675,13 +796,13 @@ private:
 		assert(req.col < (THREADS/LANES));
 
 		/* Anything to write at all? */
-		if (mask.or_reduce() == Log_0)
+		if (mask.none())
 			return;
 
 		offset = req.row * THREADS + req.col * LANES;
 
 		for (l = 0; l < LANES; l++, offset++) {
-			if (mask.get_bit(l) == Log_1)
+			if (mask[l])
 				PRF[req.wg][offset] = in_data_w[l].read() & 1;
 		}
 	}
@@ -690,7 +811,7 @@ private:
 	 * @param req Requested register.
 	 * @param mask Write mask, 1 if write should succeed for this lane. */
 	void
-	write_vsp(Register<THREADS/LANES> &req, sc_bv<LANES> mask)
+	write_vsp(Register<THREADS/LANES> &req, const bitset<LANES> &mask)
 	{
 		unsigned int l;
 		unsigned int offset;
@@ -699,7 +820,7 @@ private:
 		assert(req.col < (THREADS/LANES));
 
 		/* Anything to write at all? */
-		if (mask.or_reduce() == Log_0)
+		if (mask.none())
 			return;
 
 		for (l = 0; l < LANES; l++) {
@@ -708,21 +829,21 @@ private:
 			case VSP_CTRL_BREAK:
 			case VSP_CTRL_RET:
 			case VSP_CTRL_EXIT:
-				if (mask.get_bit(l) == Log_1)
+				if (mask[l])
 					CMRF[req.wg][req.row][req.col][l] =
-						in_data_w[l].read() ? Log_1 : Log_0;
+						in_data_w[l].read() != 0;
 				break;
 			case VSP_MEM_IDX:
 				offset = req.col * LANES;
 
-				if (mask.get_bit(l) == Log_1)
+				if (mask[l])
 					cam_idx[req.wg][offset+l] =
-						in_data_w[l].read();
+						in_data_w[l].read() & 0x3fffffffu;
 				break;
 			case VSP_MEM_DATA:
 				offset = req.col * LANES;
 
-				if (mask.get_bit(l) == Log_1)
+				if (mask[l])
 					cam_val[req.wg][offset+l] =
 						in_data_w[l].read();
 				break;
@@ -776,23 +897,19 @@ private:
 	/** Reset all the cmasks for given workgroup.
 	 * @param wg Workgroup to reset execution masks for. */
 	void
-	reset_cmasks(sc_uint<1> wg)
+	reset_cmasks(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		unsigned int i, l;
-		sc_bv<LANES> mask;
-
-		mask = 0;
-		mask.b_not();
 
 		for (i = 0; i < 4; i++)
 			for (l = 0; l < THREADS/LANES; l++)
-				CMRF[wg][i][l] = mask;
+				CMRF[wg][i][l].set();
 	}
 
 	/** Reset outputs for given workgroup.
 	 * @param wg Workgroup to reset outputs for. */
 	void
-	reset_outputs(sc_uint<1> wg)
+	reset_outputs(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		stride_descriptor sd;
 
@@ -833,11 +950,12 @@ private:
 	}
 
 	/** Perform a VGPR write coming from the DRAM interface.
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Vector register number (row).
 	 * @param mask Write-mask. */
 	void
-	dram_write_vgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_write_vgpr(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -849,7 +967,7 @@ private:
 		sc_bv<BUS_WIDTH/4> conflicts;
 
 		for (i = 0; i < BUS_WIDTH/4; i++)
-			idx[i] = in_dram_store_idx[i].read();
+			idx[i] = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 
 		conflicts = hazard_detect->access_vrf_bank_conflict(idx, mask);
 
@@ -870,7 +988,7 @@ private:
 			off = idx[i].row * THREADS + idx[i].lane;
 			bw = off / vrf_bank_words;
 			off += line;
-			VRF[wg][off] = in_dram_store_data[i].read();
+			VRF[wg][off] = in_dram_store_data[c * (BUS_WIDTH/4) + i].read();
 
 			dram_vrf_net_words_w++;
 			vrf_bank_word_hit_map[bw] = true;
@@ -881,11 +999,12 @@ private:
 	}
 
 	/** Perform a VGPR read (DRAM write).
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Vector register number (row).
 	 * @param mask Read-mask. */
 	void
-	dram_read_vgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_read_vgpr(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -893,14 +1012,12 @@ private:
 		unsigned int off;
 		unsigned int bw;
 
-		reg_offset_t<THREADS> idx[4];
-		sc_bv<4> conflicts;
+		reg_offset_t<THREADS> idx[BUS_WIDTH/4];
+		sc_bv<BUS_WIDTH/4> conflicts;
 		sc_bv<BUS_WIDTH/4> wmask = 0;
 
-		idx[0] = in_dram_store_idx[0].read();
-		idx[1] = in_dram_store_idx[1].read();
-		idx[2] = in_dram_store_idx[2].read();
-		idx[3] = in_dram_store_idx[3].read();
+		for (i = 0; i < BUS_WIDTH/4; i++)
+			idx[i] = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 
 		conflicts = hazard_detect->access_vrf_bank_conflict(idx, mask);
 
@@ -925,7 +1042,7 @@ private:
 			off = idx[i].row * THREADS + idx[i].lane;
 			bw = off / vrf_bank_words;
 			off += line;
-			out_dram_store_data[i].write(VRF[wg][off]);
+			out_dram_store_data[c * (BUS_WIDTH/4) + i].write(VRF[wg][off]);
 
 			dram_vrf_net_words_r++;
 			vrf_bank_word_hit_map[bw] = true;
@@ -934,15 +1051,16 @@ private:
 		dram_vrf_words_r += count_vrf_bank_word_hit_map() *
 				vrf_bank_words;
 
-		out_dram_store_mask.write(wmask);
+		out_dram_store_mask[c].write(wmask);
 	}
 
 	/** Write to CAM registers from DRAM.
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Vector register number (row).
 	 * @param mask Write-mask. */
 	void
-	dram_write_cam(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_write_cam(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -955,7 +1073,7 @@ private:
 			if (!mask[i])
 				continue;
 
-			idx = in_dram_store_idx[i].read();
+			idx = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 
 			/** Update each value for which idx corresponds with the
 			 * CAM value. IDX being the offset in 32-bit words
@@ -963,17 +1081,18 @@ private:
 			for (l = 0; l < THREADS; l++) {
 				if (lanes_en[wg][l >> const_log2(LANES)][l & (LANES-1)] &&
 				    cam_idx[wg][l] == idx.idx)
-					cam_val[wg][l] = in_dram_store_data[i].read();
+					cam_val[wg][l] = in_dram_store_data[c * (BUS_WIDTH/4) + i].read();
 			}
 		}
 	}
 
 	/** Read from CAM registers to DRAM.
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Vector register number (row).
 	 * @param mask Read-mask. */
 	void
-	dram_read_cam(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_read_cam(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -987,28 +1106,29 @@ private:
 			if (!mask[i])
 				continue;
 
-			idx = in_dram_store_idx[i].read();
+			idx = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 
 			/* Just perform the first write that matches. */
 			for (l = 0; l < THREADS; l++) {
 				if (lanes_en[wg][l >> const_log2(LANES)][l & (LANES-1)] &&
 				    cam_idx[wg][l] == idx.idx) {
-					out_dram_store_data[i].write(cam_val[wg][l]);
+					out_dram_store_data[c * (BUS_WIDTH/4) + i].write(cam_val[wg][l]);
 					wmask[i] = 1;
 					break;
 				}
 			}
 		}
 
-		out_dram_store_mask.write(wmask);
+		out_dram_store_mask[c].write(wmask);
 	}
 
 	/** Write from DRAM into consecutive SGPRs.
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Scalar register number (row).
 	 * @param mask Write-mask. */
 	void
-	dram_write_sgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_write_sgpr(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -1019,19 +1139,20 @@ private:
 			if (!mask[i])
 				continue;
 
-			idx = in_dram_store_idx[i].read();
+			idx = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 			off = (row + idx.lane) % 32;
 
-			SRF[wg][off] = in_dram_store_data[i].read();
+			SRF[wg][off] = in_dram_store_data[c * (BUS_WIDTH/4) + i].read();
 		}
 	}
 
 	/** Read consecutive SGPRs, write to the DRAM interface.
+	 * @param c DRAM channel.
 	 * @param wg Target work-group slot.
 	 * @param row Scalar register number (row).
 	 * @param mask Read-mask. */
 	void
-	dram_read_sgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	dram_read_sgpr(unsigned int c, sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH/4> &mask)
 	{
 		unsigned int i;
@@ -1042,10 +1163,10 @@ private:
 			if (!mask[i])
 				continue;
 
-			idx = in_dram_store_idx[i].read();
+			idx = in_dram_store_idx[c * (BUS_WIDTH/4) + i].read();
 			off = (row + idx.lane) % 32;
 
-			out_dram_store_data[i].write(SRF[wg][off]);
+			out_dram_store_data[c * (BUS_WIDTH/4) + i].write(SRF[wg][off]);
 		}
 	}
 
@@ -1054,7 +1175,7 @@ private:
 	 * @param row Vector register number (row).
 	 * @param mask Write-mask. */
 	void
-	sp_write_vgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	sp_write_vgpr(sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1102,7 +1223,7 @@ private:
 	 * @param row Vector register number (row).
 	 * @param mask Read-mask. */
 	void
-	sp_read_vgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	sp_read_vgpr(sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1156,7 +1277,7 @@ private:
 	 * @param row Vector register number (row).
 	 * @param mask Write-mask. */
 	void
-	sp_write_cam(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	sp_write_cam(sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1189,7 +1310,7 @@ private:
 	 * @param row Vector register number (row).
 	 * @param mask Read-mask. */
 	void
-	sp_read_cam(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	sp_read_cam(sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1224,7 +1345,7 @@ private:
 	 * @param row Base scalar register number (row).
 	 * @param mask Write-mask. */
 	void
-	sp_write_sgpr(sc_uint<1> wg, sc_uint<const_log2(64)> row,
+	sp_write_sgpr(sc_uint<COMPUTE_WG_WIDTH> wg, sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1247,7 +1368,7 @@ private:
 	 * @param row Base scalar register number (row).
 	 * @param mask Read-mask. */
 	void
-	sp_read_sgpr(sc_uint<1> wg,sc_uint<const_log2(64)> row,
+	sp_read_sgpr(sc_uint<COMPUTE_WG_WIDTH> wg,sc_uint<const_log2(64)> row,
 			sc_bv<BUS_WIDTH_SP> &mask)
 	{
 		unsigned int i;
@@ -1272,7 +1393,7 @@ private:
 	update_thread_active(Register<THREADS/LANES> &wreq)
 	{
 		unsigned int i;
-		sc_uint<1> wg;
+		sc_uint<COMPUTE_WG_WIDTH> wg;
 		sc_uint<const_log2(THREADS/LANES) > last_warp;
 
 		if (!in_w.read() || wreq.type != REGISTER_VSP || wreq.row >= 4)
@@ -1287,11 +1408,10 @@ private:
 		threads_fini[wg] = Log_1;
 
 		for (i = 0; i <= last_warp; i++) {
-			if (lanes_en[wg][i].or_reduce() == Log_1)
+			if (lanes_en[wg][i].any())
 				thread_active[wg] = Log_1;
 
-			if (CMRF[wg][VSP_CTRL_EXIT][i].or_reduce()
-					== Log_1)
+			if (CMRF[wg][VSP_CTRL_EXIT][i].any())
 				threads_fini[wg] = Log_0;
 		}
 
@@ -1302,86 +1422,84 @@ private:
 		out_wg_finished.write(threads_fini);
 	}
 
-	/** Main thread for writing. Synchronised to clk */
+	/** Main process for writing, evaluated on every clock edge. */
 	void
-	thread_wr(void)
+	method_wr(void)
 	{
-		unsigned int i;
-		sc_bv<LANES> mask_w;
+		unsigned int i, w;
+		bitset<LANES> mask_w;
 		Register<THREADS/LANES> wreq;
 
-		sc_bv<LANES> mask_one = 0;
-		mask_one.b_not();
-
-		reset_outputs(0);
-		reset_outputs(1);
-
-		while (true) {
-			wreq = in_req_w.read();
+		if (wr_rst) {
+			for (w = 0; w < WG_SLOTS; w++)
+				reset_outputs(w);
 
-			/* A write */
-			if (in_ignore_mask_w.read() || wreq.type == REGISTER_SGPR ||
-			    wreq.type == REGISTER_SSP)
-				mask_w = mask_one;
-			else
-				mask_w = in_mask_w.read();
+			wr_rst = false;
+		}
 
-			if (in_w.read() && mask_w.or_reduce() == Log_1) {
-				switch (wreq.type) {
-				case REGISTER_VGPR:
-					write_vgpr(wreq, mask_w);
-					break;
-				case REGISTER_SGPR:
-					write_sgpr(wreq);
-					break;
-				case REGISTER_PR:
-					write_pr(wreq, mask_w);
-					break;
-				case REGISTER_VSP:
-					write_vsp(wreq, mask_w);
-					break;
-				case REGISTER_SSP:
-					write_ssp(wreq);
-					break;
-				default:
-					assert(false);
-				}
+		wreq = in_req_w.read();
+
+		/* A write. Only convert the mask when there is one. */
+		if (!in_w.read())
+			mask_w.reset();
+		else if (in_ignore_mask_w.read() ||
+		    wreq.type == REGISTER_SGPR ||
+		    wreq.type == REGISTER_SSP)
+			mask_w.set();
+		else
+			mask_w = bv_to_mask(in_mask_w.read());
+
+		if (mask_w.any()) {
+			switch (wreq.type) {
+			case REGISTER_VGPR:
+				write_vgpr(wreq, mask_w);
+				break;
+			case REGISTER_SGPR:
+				write_sgpr(wreq);
+				break;
+			case REGISTER_PR:
+				write_pr(wreq, mask_w);
+				break;
+			case REGISTER_VSP:
+				write_vsp(wreq, mask_w);
+				break;
+			case REGISTER_SSP:
+				write_ssp(wreq);
+				break;
+			default:
+				assert(false);
 			}
+		}
 
-			/* If requested, reset the CMASK for a WG.
-			 * @todo Collisions with other operation? */
-			if (in_cmask_rst.read()) {
-				reset_cmasks(in_cmask_rst_wg.read());
-				reset_outputs(in_cmask_rst_wg.read());
-			}
+		/* If requested, reset the CMASK for a WG.
+		 * @todo Collisions with other operation? */
+		if (in_cmask_rst.read()) {
+			reset_cmasks(in_cmask_rst_wg.read());
+			reset_outputs(in_cmask_rst_wg.read());
+		}
 
-			/* Determine post-write whether there is at least one
-			 * thread active. If not, the control stack needs to
-			 * be popped.
-			 *
-			 * By placing this code after the write, we get the
-			 * new values back for this cycle. If latencies cannot
-			 * be met, this still emulates a write-forwarding
-			 * technique.*/
+		/* Determine post-write whether there is at least one
+		 * thread active. If not, the control stack needs to
+		 * be popped.
+		 *
+		 * By placing this code after the write, we get the
+		 * new values back for this cycle. If latencies cannot
+		 * be met, this still emulates a write-forwarding
+		 * technique.*/
+		for (w = 0; w < WG_SLOTS; w++) {
 			for (i = 0; i < THREADS/LANES; i++) {
-				lanes_en[0][i] = CMRF[0][VSP_CTRL_RUN][i] &
-						 CMRF[0][VSP_CTRL_BREAK][i] &
-						 CMRF[0][VSP_CTRL_RET][i] &
-						 CMRF[0][VSP_CTRL_EXIT][i];
-
-				lanes_en[1][i] = CMRF[1][VSP_CTRL_RUN][i] &
-						 CMRF[1][VSP_CTRL_BREAK][i] &
-						 CMRF[1][VSP_CTRL_RET][i] &
-						 CMRF[1][VSP_CTRL_EXIT][i];
+				lanes_en[w][i] =
+					CMRF[w][VSP_CTRL_RUN][i] &
+					CMRF[w][VSP_CTRL_BREAK][i] &
+					CMRF[w][VSP_CTRL_RET][i] &
+					CMRF[w][VSP_CTRL_EXIT][i];
 			}
-
-			update_thread_active(wreq);
-
-			wait();
 		}
+
+		update_thread_active(wreq);
 	}
 
-	/** Main thread for reading. Performs max one request (3 (v)regs) per
+	/** Main process for reading. Performs max one request (3 (v)regs) per
 	 * cycle.
 	 * Timing-wise. This will run as soon as the inputs change. In essence
 	 * this means that when IDecode finishes generating signals, this
@@ -1392,103 +1510,110 @@ private:
 	 * latest first thing of the next cycle. This should be ensured by
 	 * the SystemC simulation model, where */
 	void
-	thread_rd(void)
+	method_rd(void)
 	{
 		unsigned int p;
-		reg_read_req<THREADS/LANES> req;
 		sc_bv<3> conflicts;
 		RequestTarget dst;
 
-		while (true) {
-			req = in_req_r.read();
+		if (!rd_delta) {
+			if (!in_req_r.nb_read(rd_req)) {
+				next_trigger(in_req_r.data_written_event());
+				return;
+			}
+
 			/* Performs writes in the next delta cycle, ensures
 			 * IExecute finished */
-			wait(SC_ZERO_TIME);
-
-			conflicts = hazard_detect->execute_bank_conflict(req);
-			dst = in_dram_dst.read();
-
-			/* And three reads.
-			 *
-			 * Do not perform a write on ports if the req.r[] mask
-			 * is Log_0. Crucial for conflict resolution!
-			 * @todo Do we need three channels for all or just VGPR?
-			 * Seems only crucial for MAD. */
-			for (p = 0; p < 3; p++) {
-				if (!req.r[p] || conflicts[p])
-					continue;
-
-				assert(!in_store_enable[IF_DRAM].read() ||
-					(dst.type != TARGET_CAM && dst.type != TARGET_REG) ||
-					!hazard_detect->ae_hazard(in_store_reg[IF_DRAM].read(), req.reg[p]));
-				assert(!in_store_enable[req.reg[p].wg].read() || !hazard_detect->
-					ae_hazard(in_store_reg[req.reg[p].wg].read(), req.reg[p]));
-
-				switch (req.reg[p].type) {
-				case REGISTER_VGPR:
-					read_vgpr(req.reg[p], p);
-					break;
-				case REGISTER_SGPR:
-					read_sgpr(req.reg[p], p);
-					break;
-				case REGISTER_PR:
-					read_pr(req.reg[p], p);
-					break;
-				case REGISTER_VSP:
-					read_vsp(req.reg[p], p);
-					break;
-				case REGISTER_SSP:
-					read_ssp(req.reg[p], p);
-					break;
-				case REGISTER_IMM:
-					broadcast_value(req.imm[p],p);
-					break;
-				default:
-					assert(false);
-				}
-			}
+			rd_delta = true;
+			next_trigger(SC_ZERO_TIME);
+			return;
+		}
 
-			out_req_conflicts.write(conflicts);
+		conflicts = hazard_detect->execute_bank_conflict(rd_req);
+		dst = in_dram_dst.read();
+
+		/* And three reads.
+		 *
+		 * Do not perform a write on ports if the rd_req.r[] mask
+		 * is Log_0. Crucial for conflict resolution!
+		 * @todo Do we need three channels for all or just VGPR?
+		 * Seems only crucial for MAD. */
+		for (p = 0; p < 3; p++) {
+			if (!rd_req.r[p] || conflicts[p])
+				continue;
 
-			/* Don't process another until next clock cycle */
-			wait();
+			assert(!in_store_enable[IF_DRAM].read() ||
+				(dst.type != TARGET_CAM && dst.type != TARGET_REG) ||
+				!hazard_detect->ae_hazard(in_store_reg[IF_DRAM].read(), rd_req.reg[p]));
+			assert(!in_store_enable[rd_req.reg[p].wg].read() || !hazard_detect->
+				ae_hazard(in_store_reg[rd_req.reg[p].wg].read(), rd_req.reg[p]));
+
+			switch (rd_req.reg[p].type) {
+			case REGISTER_VGPR:
+				read_vgpr(rd_req.reg[p], p);
+				break;
+			case REGISTER_SGPR:
+				read_sgpr(rd_req.reg[p], p);
+				break;
+			case REGISTER_PR:
+				read_pr(rd_req.reg[p], p);
+				break;
+			case REGISTER_VSP:
+				read_vsp(rd_req.reg[p], p);
+				break;
+			case REGISTER_SSP:
+				read_ssp(rd_req.reg[p], p);
+				break;
+			case REGISTER_IMM:
+				broadcast_value(rd_req.imm[p],p);
+				break;
+			default:
+				assert(false);
+			}
 		}
+
+		out_req_conflicts.write(conflicts);
+
+		/* Don't process another until next clock cycle */
+		rd_delta = false;
 	}
 
 	/** Separate read channel for the active thread mask.
 	 * This mask is defined as the AND product of the four masks, which
-	 * is calculated in thread_wr(). */
+	 * is calculated in method_wr(). */
 	void
-	thread_rd_mask_w(void)
+	method_rd_mask_w(void)
 	{
-		sc_uint<const_log2(THREADS/LANES)> col;
-		unsigned int wg;
-
-		while (true) {
-			col = in_col_mask_w.read();
-			wg = in_wg_mask_w.read();
+		if (!mask_w_delta) {
+			mask_w_col = in_col_mask_w.read();
+			mask_w_wg = in_wg_mask_w.read();
 
 			if (debug_output[DEBUG_COMPUTE_TRACE])
-				cout << sc_time_stamp() << " RegFile cmask col " << col << endl;
+				cout << sc_time_stamp() << " RegFile cmask col " <<
+					mask_w_col << endl;
+
 			/* Performs writes in the next delta cycle, ensures
 			 * IExecute finished */
-			wait(SC_ZERO_TIME);
+			mask_w_delta = true;
+			next_trigger(SC_ZERO_TIME);
+			return;
+		}
 
-			out_mask_w.write(lanes_en[wg][col]);
+		out_mask_w.write(mask_to_bv(lanes_en[mask_w_wg][mask_w_col]));
 
-			/* Don't process another until next clock cycle */
-			wait();
-		}
+		/* Don't process another until next clock cycle */
+		mask_w_delta = false;
 	}
 
-	/** Perform a read/write operation instructed by DRAM. */
+	/** Perform a read/write operation instructed by a DRAM channel.
+	 * @param c DRAM channel. */
 	void
-	do_store_dram(void)
+	do_store_dram_chan(unsigned int c)
 	{
 		sc_bv<BUS_WIDTH/4> mask;
 		AbstractRegister reg;
 
-		mask = in_dram_store_mask.read();
+		mask = in_dram_store_mask[c].read();
 		if (mask.or_reduce() == Log_0)
 			return;
 
@@ -1497,21 +1622,21 @@ private:
 		switch (reg.type) {
 		case REGISTER_VGPR:
 			if (in_store_write[IF_DRAM].read())
-				dram_write_vgpr(reg.wg, reg.row, mask);
+				dram_write_vgpr(c, reg.wg, reg.row, mask);
 			else
-				dram_read_vgpr(reg.wg, reg.row, mask);
+				dram_read_vgpr(c, reg.wg, reg.row, mask);
 			break;
 		case REGISTER_SGPR:
 			if (in_store_write[IF_DRAM].read())
-				dram_write_sgpr(reg.wg, reg.row, mask);
+				dram_write_sgpr(c, reg.wg, reg.row, mask);
 			else
-				dram_read_sgpr(reg.wg, reg.row, mask);
+				dram_read_sgpr(c, reg.wg, reg.row, mask);
 			break;
 		case REGISTER_VSP:
 			if (in_store_write[IF_DRAM].read())
-				dram_write_cam(reg.wg, reg.row, mask);
+				dram_write_cam(c, reg.wg, reg.row, mask);
 			else
-				dram_read_cam(reg.wg, reg.row, mask);
+				dram_read_cam(c, reg.wg, reg.row, mask);
 			break;
 		default:
 			cerr << "Unknown store from DRAM interface." << endl;
@@ -1520,6 +1645,18 @@ private:
 		}
 	}
 
+	/** Perform the read/write operations instructed by all DRAM
+	 * channels. Channels serve the same stride descriptor, hence target
+	 * the same register. */
+	void
+	do_store_dram(void)
+	{
+		unsigned int c;
+
+		for (c = 0; c < DRAM_CHANS; c++)
+			do_store_dram_chan(c);
+	}
+
 	/** perform a read/write operation instruction by the scratchpad.
 	 * @param intf Scratchpad interface (work-group) */
 	void
@@ -1560,72 +1697,70 @@ private:
 		}
 	}
 
-	/** Storage back-end read/write port thread. */
+	/** Storage back-end read/write port, evaluated on every DRAM clock
+	 * edge. */
 	void
-	thread_store(void)
+	method_store(void)
 	{
-		sc_bv<BUS_WIDTH/4> mask;
-		AbstractRegister reg;
 		RequestTarget dst;
+		unsigned int w;
 
-		while (true) {
-			wait();
+		dst = in_dram_dst.read();
 
-			dst = in_dram_dst.read();
+		if (in_store_enable[IF_DRAM].read() &&
+		   (dst.type == TARGET_REG || dst.type == TARGET_CAM)) {
+			assert(!in_store_enable[dst.wg.to_int()].read());
 
-			if (in_store_enable[IF_DRAM].read() &&
-			   (dst.type == TARGET_REG || dst.type == TARGET_CAM)) {
-				assert(!in_store_enable[dst.wg.to_int()].read());
-
-				do_store_dram();
-			}
-
-			if (in_store_enable[IF_SP_WG0].read())
-				do_store_sp(IF_SP_WG0);
+			do_store_dram();
+		}
 
-			if (in_store_enable[IF_SP_WG1].read())
-				do_store_sp(IF_SP_WG1);
+		for (w = 0; w < WG_SLOTS; w++) {
+			if (in_store_enable[IF_SP_WG0 + w].read())
+				do_store_sp(req_if_t(IF_SP_WG0 + w));
 		}
 	}
 
-	/** The thread that pushes CAM indexes to the index iterator FIFOs. */
+	/** Push CAM indexes to the index iterator FIFO, evaluated on every
+	 * DRAM clock edge. */
 	void
-	thread_idx_push(void)
+	method_idx_push(void)
 	{
-		unsigned int l;
-		AbstractRegister reg;
-		enum {
-			STATE_IDLE,
-			STATE_PUSH,
-		} state = STATE_IDLE;
+		idx_t<THREADS> idx;
 
-		while(true) {
-			wait();
+		switch (idx_push_state) {
+		case IDX_PUSH_ST_IDLE:
+			if (!in_store_idx_push_trigger.read())
+				break;
 
-			switch (state) {
-			case STATE_IDLE:
-				if (!in_store_idx_push_trigger.read())
-					break;
+			idx_push_reg = in_store_reg[IF_DRAM].read();
 
-				reg = in_store_reg[IF_DRAM].read();
-
-				l = 0;
-				state = STATE_PUSH;
-				/* fall-through */
-			case STATE_PUSH:
-				if (l < THREADS) {
-					if (lanes_en[reg.wg][l >> const_log2(LANES)][l & (LANES-1)])
-						out_store_idx.write(idx_t<THREADS>(l,cam_idx[reg.wg][l]));
-
-					l++;
-				} else {
-					/** Dummy to indicate this was the last. */
-					out_store_idx.write(idx_t<THREADS>());
-					state = STATE_IDLE;
+			idx_push_thread = 0;
+			idx_push_state = IDX_PUSH_ST_PUSH;
+			/* fall-through */
+		case IDX_PUSH_ST_PUSH:
+			if (idx_push_thread < THREADS) {
+				if (lanes_en[idx_push_reg.wg]
+						[idx_push_thread >> const_log2(LANES)]
+						[idx_push_thread & (LANES-1)]) {
+					idx = idx_t<THREADS>(idx_push_thread,
+						cam_idx[idx_push_reg.wg][idx_push_thread]);
+					if (!out_store_idx.nb_write(idx)) {
+						next_trigger(out_store_idx.data_read_event());
+						return;
+					}
 				}
-				break;
-			}
 
+				idx_push_thread++;
+			} else {
+				/** Dummy to indicate this was the last. */
+				if (!out_store_idx.nb_write(idx_t<THREADS>())) {
+					next_trigger(out_store_idx.data_read_event());
+					return;
+				}
+
+				idx_push_state = IDX_PUSH_ST_IDLE;
+			}
+			break;
 		}
 	}
 };
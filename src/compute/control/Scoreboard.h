@@ -22,6 +22,7 @@
 #include "model/reg_read_req.h"
 #include "util/constmath.h"
 #include "util/debug_output.h"
+#include "util/defaults.h"
 
 using namespace sc_core;
 using namespace sc_dt;
@@ -41,8 +42,12 @@ namespace compute_control {
  * These CAMs could live alongside each pipeline stage in a real HW
  * (systemverilog) implementation. We group all the CAMs in this one Scoreboard
  * module instead for code readability purposes.
+ * @param THREADS Number of work-items in a work-group.
+ * @param LANES Number of FPUs in the SimdCluster.
+ * @param WG_SLOTS Number of resident work-group slots.
  */
-template <unsigned int THREADS = 1024, unsigned int LANES = 128>
+template <unsigned int THREADS = 1024, unsigned int LANES = 128,
+	unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class Scoreboard : public sc_core::sc_module
 {
 private:
@@ -67,10 +72,10 @@ private:
 	unsigned int max_entries;
 
 	/** Population (bit-mask) of active entries in the queue. */
-	sc_bv<32> entries_pop[2];
+	sc_bv<32> entries_pop[WG_SLOTS];
 
 	/** Counters for how many CSTACK writes are pending in the pipeline. */
-	unsigned int cstack_writes_pending[2];
+	unsigned int cstack_writes_pending[WG_SLOTS];
 
 public:
 	/** Compute clock. */
@@ -86,17 +91,17 @@ public:
 	sc_in<bool> in_dequeue_cstack_write{"in_dequeue_cstack_write"};
 
 	/** WG to consume CSTACK entry from */
-	sc_in<sc_uint<1> > in_dequeue_cstack_wg{"in_dequeue_cstack_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_dequeue_cstack_wg{"in_dequeue_cstack_wg"};
 
 	/** Produce an entry. */
 	sc_in<bool> in_enqueue_cstack_write{"in_enqueue_cstack_write"};
 
 	/** For this WG. */
-	sc_in<sc_uint<1> > in_enqueue_cstack_wg{"in_enqueue_cstack_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_enqueue_cstack_wg{"in_enqueue_cstack_wg"};
 
 	/** Indicate whether CPOP should not be issued yet, as CPUSHes are still
 	 * in progress. */
-	sc_inout<bool> out_cpop_stall[2];
+	sc_inout<bool> out_cpop_stall[WG_SLOTS];
 
 	/** Write request to add */
 	sc_in<Register<THREADS/LANES> > in_req_w{"in_req_w"};
@@ -135,7 +140,7 @@ public:
 	 * slots. Would be painful to achieve. Obviously in a real
 	 * implementation we wouldn't need to waste bits.
 	 */
-	sc_inout<sc_bv<32> > out_entries_pop[2];
+	sc_inout<sc_bv<32> > out_entries_pop[WG_SLOTS];
 
 	/** Invalidate entries for given work-group. This does not pop them
 	 * off, but avoids delays caused by false matches upon pipeline
@@ -143,19 +148,20 @@ public:
 	sc_in<bool> in_entries_disable{"in_entries_disable"};
 
 	/** Workgroup for which entries should be disabled. */
-	sc_in<sc_uint<1> > in_entries_disable_wg{"in_entries_disable_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_entries_disable_wg{"in_entries_disable_wg"};
 
 	/** Constructor. */
 	SC_CTOR(Scoreboard)
 	: scoreboard_entries(8), head(0), tail(0), max_entries(0)
 	{
-		request_queue = new Register<THREADS/LANES>[scoreboard_entries];
+		unsigned int w;
 
-		entries_pop[0] = 0;
-		entries_pop[1] = 0;
+		request_queue = new Register<THREADS/LANES>[scoreboard_entries];
 
-		cstack_writes_pending[0] = 0;
-		cstack_writes_pending[1] = 0;
+		for (w = 0; w < WG_SLOTS; w++) {
+			entries_pop[w] = 0;
+			cstack_writes_pending[w] = 0;
+		}
 
 		SC_THREAD(thread_push_pop);
 		sensitive << in_clk.pos();
@@ -252,8 +258,9 @@ private:
 	{
 		unsigned int e;
 		unsigned int wg;
-		out_entries_pop[0].write(0);
-		out_entries_pop[1].write(0);
+
+		for (wg = 0; wg < WG_SLOTS; wg++)
+			out_entries_pop[wg].write(0);
 
 		while (true) {
 			wait();
@@ -271,8 +278,8 @@ private:
 						" Popping from an empty SB" << endl;
 					assert("Popping from an empty SB");
 				} else {
-					entries_pop[0][tail] = Log_0;
-					entries_pop[1][tail] = Log_0;
+					for (wg = 0; wg < WG_SLOTS; wg++)
+						entries_pop[wg][tail] = Log_0;
 					tail = (tail + 1) % scoreboard_entries;
 				}
 			}
@@ -298,11 +305,11 @@ private:
 				cstack_writes_pending[in_enqueue_cstack_wg.read()]++;
 
 			max_entries = max(max_entries, entries());
-			out_entries_pop[0].write(entries_pop[0]);
-			out_entries_pop[1].write(entries_pop[1]);
-
-			out_cpop_stall[0].write(cstack_writes_pending[0] > 0);
-			out_cpop_stall[1].write(cstack_writes_pending[1] > 0);
+			for (wg = 0; wg < WG_SLOTS; wg++) {
+				out_entries_pop[wg].write(entries_pop[wg]);
+				out_cpop_stall[wg].write(
+					cstack_writes_pending[wg] > 0);
+			}
 
 			if (debug_output[DEBUG_COMPUTE_TRACE]) {
 				cout << sc_time_stamp() << " Scoreboard: " <<
@@ -316,10 +323,11 @@ private:
 
 				cout << endl;
 
-				cout << sc_time_stamp() << " Scoreboard: (" <<
-					cstack_writes_pending[0] << "," <<
-					cstack_writes_pending[1] <<
-					") Control stack writes pending." << endl;
+				cout << sc_time_stamp() << " Scoreboard: (";
+				for (wg = 0; wg < WG_SLOTS; wg++)
+					cout << (wg ? "," : "") <<
+						cstack_writes_pending[wg];
+				cout << ") Control stack writes pending." << endl;
 			}
 		}
 	}
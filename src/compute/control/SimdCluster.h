@@ -24,6 +24,8 @@
 
 #include "util/defaults.h"
 #include "util/sched_opts.h"
+#include "util/Checkpoint.h"
+#include "util/GatedClock.h"
 #include "model/Buffer.h"
 #include "model/request_target.h"
 
@@ -45,6 +47,7 @@ using namespace compute_model;
 using namespace simd_model;
 using namespace compute_control;
 using namespace sp_control;
+using namespace simd_util;
 using namespace std;
 
 namespace compute_control {
@@ -52,8 +55,10 @@ namespace compute_control {
 /** Single SimdCluster module.
  *
  * Instantiates all relevant submodules and provides a simpler coherent
- * interface. Maintains the state of both work-groups in this SimdCluster,
- * pulling work-groups from the WorkScheduler whenever idle.
+ * interface. Maintains the state of all resident work-groups in this
+ * SimdCluster, pulling work-groups from the WorkScheduler whenever a slot is
+ * idle. Each work-group slot has its own register file partition and
+ * scratchpad.
  *
  * @param THREADS 	Number of threads in a work-group.
  * @param LANES 	Number of FPUs in this SimdCluster.
@@ -64,12 +69,22 @@ namespace compute_control {
  * @param XLAT_ENTRIES 	Number of mapped DRAM buffers supported.
  * @param BUS_WIDTH 	Number of words transferred in a single DRAM burst.
  * @param BUS_WIDTH_SP  Number of words transferred in a scratchpad cycle.
+ * @param DRAM_CHANS 	Number of DRAM channels, each transferring BUS_WIDTH/4
+ * 			words per cycle.
+ * @param WG_SLOTS 	Number of resident work-group slots. Must match
+ * 			COMPUTE_WG_SLOTS, which sizes the memory controller
+ * 			interfaces.
  */
 template <unsigned int THREADS, unsigned int LANES, unsigned int RCPUS,
 	unsigned int PC_WIDTH, unsigned int XLAT_ENTRIES,
-	unsigned int BUS_WIDTH, unsigned int BUS_WIDTH_SP>
+	unsigned int BUS_WIDTH, unsigned int BUS_WIDTH_SP,
+	unsigned int DRAM_CHANS = MC_DRAM_CHANS,
+	unsigned int WG_SLOTS = COMPUTE_WG_SLOTS>
 class SimdCluster : public sc_module
 {
+	static_assert(WG_SLOTS == COMPUTE_WG_SLOTS, "SimdCluster work-group "
+			"slots must match the memory controller interfaces.");
+
 public:
 	/** Compute clock */
 	sc_in<bool> in_clk{"in_clk"};
@@ -153,27 +168,29 @@ public:
 	 * Using a FIFO to easily cross clock domains in SystemC. */
 	sc_fifo_in<RequestTarget> in_dram_done_dst{"in_dram_done_dst"};
 
-	/** DRAM write mask */
-	sc_in<sc_bv<BUS_WIDTH/4> > in_dram_mask{"in_dram_mask"};
+	/** DRAM write mask, per DRAM channel. */
+	sc_in<sc_bv<BUS_WIDTH/4> > in_dram_mask[DRAM_CHANS];
 
-	/** Data to write back to register */
-	sc_in<sc_uint<32> > in_dram_data[BUS_WIDTH/4];
+	/** Data to write back to register, BUS_WIDTH/4 lanes per DRAM
+	 * channel. */
+	sc_in<sc_uint<32> > in_dram_data[DRAM_CHANS*BUS_WIDTH/4];
 
 	/** Data to read from register */
-	sc_inout<sc_uint<32> > out_dram_data[IF_SENTINEL][BUS_WIDTH/4];
+	sc_inout<sc_uint<32> > out_dram_data[IF_SENTINEL][DRAM_CHANS*BUS_WIDTH/4];
 
 	/** Refresh in progress. */
 	sc_in<bool> in_dram_ref{"in_dram_ref"};
 
 	/************ Write path to Register file ****************/
 	/** Index within register to read/write to */
-	sc_in<reg_offset_t<THREADS> > in_dram_idx[4];
+	sc_in<reg_offset_t<THREADS> > in_dram_idx[DRAM_CHANS*BUS_WIDTH/4];
 
 	/** Register addressed by DRAM */
 	sc_in<AbstractRegister> in_dram_reg{"in_dram_reg"};
 
-	/** Write mask taking into account individual lane status */
-	sc_inout<sc_bv<BUS_WIDTH/4> > out_dram_mask;
+	/** Write mask taking into account individual lane status, per DRAM
+	 * channel. */
+	sc_inout<sc_bv<BUS_WIDTH/4> > out_dram_mask[DRAM_CHANS];
 
 	/** Triggers pushing the DRAM indexes from the vc.cam_idx register
 	 * to the DRAM controller's index iterator. */
@@ -183,8 +200,9 @@ public:
 	sc_fifo_out<idx_t<THREADS> > out_dram_idx{"out_dram_idx"};
 
 	/************ Write path to scratchpads *****************/
-	/** Base scratchpad address that DRAM tries to write to. */
-	sc_in<sc_uint<18> > in_dram_sp_addr{"in_dram_sp_addr"};
+	/** Base scratchpad address that DRAM tries to write to, per DRAM
+	 * channel. */
+	sc_in<sc_uint<18> > in_dram_sp_addr[DRAM_CHANS];
 
 private:
 	/** Boolean indicating whether elaborate() has been called. */
@@ -195,59 +213,73 @@ private:
 
 	/****************** Signals I must generate ******************/
 	/** Workgroup global thread ID offsets */
-	sc_signal<sc_uint<32> > simdcluster_wg_off[2][2];
+	sc_signal<sc_uint<32> > simdcluster_wg_off[WG_SLOTS][2];
 
 	/** Last warp for each workgroup */
-	sc_signal<sc_uint<const_log2(THREADS/LANES)> > simdcluster_last_warp[2];
+	sc_signal<sc_uint<const_log2(THREADS/LANES)> > simdcluster_last_warp[WG_SLOTS];
 
 	/** Workgroup is active */
-	sc_signal<workgroup_state> simdcluster_wg_state[2];
+	sc_signal<workgroup_state> simdcluster_wg_state[WG_SLOTS];
 
 	/** Workgroup to reset CMask/PC for. */
-	sc_signal<sc_uint<1> > simdcluster_rst_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > simdcluster_rst_wg;
 
 	/** Reset the cmask and PC */
 	sc_signal<bool> simdcluster_rst;
 
 	/* Local variables */
 	/** State of each work-group. */
-	workgroup_state wg_state[2];
+	workgroup_state wg_state[WG_SLOTS];
 
 	/** Boolean indicated whether work-group slot is ready to be filled. */
-	bool wg_accept_next[2];
+	bool wg_accept_next[WG_SLOTS];
 
 	/** Perf counter: Number of active DRAM cycles. */
 	unsigned long dram_active;
 	/** Perf counter: Number of active compute cycles. */
 	unsigned long compute_active;
 	/** Perf counter: Number of active SP cycles. */
-	unsigned long sp_active[2];
+	unsigned long sp_active[WG_SLOTS];
 
 	/** Counter indicating which stride_descriptor should be popped next.
 	 *
 	 * @todo No longer feasible in a set-up with multiple SimdClusters. */
 	sc_uint<4> ticket_pop;
 
+	/** Gated compute clock, nullptr if the clock never skips edges. */
+	GatedClock *clk;
+
+	/** Number of skipped clock edges accounted for in the perf counters. */
+	unsigned long clk_skipped;
+
+	/** Quiescence client identifier. */
+	unsigned int q_id;
+
+	/** Number of consecutive cycles all work-groups were blocked on DRAM. */
+	unsigned int quiet_cycles;
+
+	/** Number of quiet cycles required before declaring quiescence. */
+	unsigned int quiesce_cycles;
+
 	/** @cond Doxygen_Suppress */
 	/****************** Child modules ******************/
-	IFetch<PC_WIDTH> ifetch;
-	IDecode<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES> *idecode;
-	IExecute<PC_WIDTH,THREADS,LANES,RCPUS> iexecute;
+	IFetch<PC_WIDTH,WG_SLOTS> ifetch;
+	IDecode<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES,WG_SLOTS> *idecode;
+	IExecute<PC_WIDTH,THREADS,LANES,RCPUS,COMPUTE_CSTACK_ENTRIES,WG_SLOTS> iexecute;
 	IMem<PC_WIDTH> imem;
-	RegFile<THREADS,LANES,BUS_WIDTH,BUS_WIDTH_SP> regfile;
-	CtrlStack<THREADS,LANES,PC_WIDTH,COMPUTE_CSTACK_ENTRIES> ctrlstack;
-	Scoreboard<THREADS,LANES> scoreboard;
+	RegFile<THREADS,LANES,BUS_WIDTH,BUS_WIDTH_SP,DRAM_CHANS,WG_SLOTS> regfile;
+	CtrlStack<THREADS,LANES,PC_WIDTH,COMPUTE_CSTACK_ENTRIES,WG_SLOTS> ctrlstack;
+	Scoreboard<THREADS,LANES,WG_SLOTS> scoreboard;
 	BufferToPhysXlat<XLAT_ENTRIES> xlat;
 	BufferToPhysXlat<XLAT_ENTRIES> xlat_sp;
-	Scratchpad<0,BUS_WIDTH/4,BUS_WIDTH_SP,SP_BYTES,THREADS> sp_0;
-	Scratchpad<1,BUS_WIDTH/4,BUS_WIDTH_SP,SP_BYTES,THREADS> sp_1;
+	Scratchpad<BUS_WIDTH/4,BUS_WIDTH_SP,SP_BYTES,THREADS,DRAM_CHANS> *sp[WG_SLOTS];
 
 	/****************** Child module wiring ******************/
 	/* IFetch -> IMem */
 	sc_fifo<imem_request<PC_WIDTH> > ifetch_insn_r;
 
 	/* IFetch -> IDecode */
-	sc_signal<sc_uint<1> > ifetch_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > ifetch_wg;
 
 	/* IMem -> IDecode */
 	sc_signal<Instruction> imem_op;
@@ -263,7 +295,7 @@ private:
 	sc_signal<sc_uint<PC_WIDTH> > idecode_pc;
 	sc_signal<sc_uint<const_log2(THREADS/LANES)> > idecode_col_w;
 	sc_signal<sc_uint<const_log2(LANES/RCPUS)> > idecode_subcol_w;
-	sc_signal<sc_uint<1> > idecode_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > idecode_wg;
 
 	/* IDecode -> IFetch */
 	sc_signal<bool> idecode_stall_f;
@@ -271,7 +303,7 @@ private:
 	/* IDecode -> Scoreboard */
 	sc_signal<bool> idecode_enqueue;
 	sc_signal<bool> idecode_enqueue_cstack_write;
-	sc_signal<sc_uint<1> > idecode_enqueue_cstack_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > idecode_enqueue_cstack_wg;
 	sc_signal<Register<THREADS/LANES> > idecode_req_w;
 	sc_fifo<reg_read_req<THREADS/LANES> > idecode_req_r_sb;
 	sc_signal<sc_bv<32> > idecode_req_sb_pop[3];
@@ -283,10 +315,12 @@ private:
 
 	/* RegFile -> IExecute */
 	sc_signal<sc_uint<32> > regfile_data_r[3][LANES];
-	sc_signal<stride_descriptor> regfile_sd[2];
+	sc_signal<operand_bus<LANES> > regfile_data_bus_r[3];
+	sc_signal<stride_descriptor> regfile_sd[WG_SLOTS];
 
 	/* IDecode -> IExecute */
 	sc_signal<sc_uint<32> > idecode_data_r[2][LANES];
+	sc_signal<operand_bus<LANES> > idecode_data_bus_r[2];
 
 	/* RegFile -> RegFile */
 	sc_signal<sc_bv<LANES> > regfile_mask_w;
@@ -295,15 +329,15 @@ private:
 	sc_fifo<sc_bv<3> > regfile_req_conflicts;
 
 	/* RegFile -> XXX */
-	sc_signal<sc_bv<2> > regfile_thread_active;
-	sc_signal<sc_bv<2> > regfile_wg_finished;
-	sc_signal<sc_uint<32> > regfile_store_data[2][BUS_WIDTH_SP];
-	sc_signal<sc_bv<BUS_WIDTH_SP> > regfile_store_mask[2];
+	sc_signal<sc_bv<WG_SLOTS> > regfile_thread_active;
+	sc_signal<sc_bv<WG_SLOTS> > regfile_wg_finished;
+	sc_signal<sc_uint<32> > regfile_store_data[WG_SLOTS][BUS_WIDTH_SP];
+	sc_signal<sc_bv<BUS_WIDTH_SP> > regfile_store_mask[WG_SLOTS];
 
 	/* IExecute -> RegFile */
 	sc_signal<sc_uint<32> > iexecute_data_w[LANES];
 	sc_signal<Register<THREADS/LANES> > iexecute_req_w;
-	sc_signal<sc_uint<1> > iexecute_wg_w;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > iexecute_wg_w;
 	sc_signal<bool> iexecute_w;
 	sc_fifo<sc_uint<const_log2(THREADS/LANES)> > iexecute_col_mask_w;
 	sc_signal<bool> iexecute_ignore_mask_w;
@@ -317,8 +351,8 @@ private:
 	sc_signal<ctrlstack_entry<THREADS,PC_WIDTH> > iexecute_cstack_entry;
 
 	/* IExecute -> SimdCluster */
-	sc_signal<workgroup_state> iexecute_wg_state_next[2];
-	sc_signal<sc_bv<2> > iexecute_wg_exit_commit;
+	sc_signal<workgroup_state> iexecute_wg_state_next[WG_SLOTS];
+	sc_signal<sc_bv<WG_SLOTS> > iexecute_wg_exit_commit;
 
 	/* CStack -> IExecute */
 	sc_signal<bool> cstack_ex_overflow;
@@ -330,36 +364,31 @@ private:
 	sc_signal<bool> iexecute_pc_do_w;
 	sc_signal<sc_uint<PC_WIDTH> > iexecute_pc_w;
 
-	sc_signal<workgroup_state> iexecute_wg_next_state[2];
-
 	/* IExecute -> Scratchpad */
-	sc_fifo<stride_descriptor> iexecute_sp_desc_fifo_0;
-	sc_fifo<stride_descriptor> iexecute_sp_desc_fifo_1;
-	sc_fifo<bool> iexecute_store_kick_0;
-	sc_fifo<bool> iexecute_store_kick_1;
+	sc_fifo<stride_descriptor> *iexecute_sp_desc_fifo[WG_SLOTS];
+	sc_fifo<bool> *iexecute_store_kick[WG_SLOTS];
 
 	/* Scratchpad -> ??? */
-	sc_fifo<sc_uint<1> > sp_wg_done_0;
-	sc_fifo<sc_uint<1> > sp_wg_done_1;
+	sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > *sp_wg_done[WG_SLOTS];
 
 	/* Scratchpad -> RegFile */
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	sc_signal<sc_uint<32> > sp_out_data[2][BUS_WIDTH_SP-(BUS_WIDTH/4)];
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	sc_signal<sc_uint<32> > sp_out_data[WG_SLOTS][BUS_WIDTH_SP-(DRAM_CHANS*BUS_WIDTH/4)];
 #endif
-	sc_signal<bool> sp_rf_enable[2];
-	sc_signal<bool> sp_rf_write[2];
-	sc_signal<AbstractRegister> sp_rf_reg[2];
-	sc_signal<sc_bv<BUS_WIDTH_SP> > sp_rf_mask[2];
-	sc_signal<reg_offset_t<THREADS> > sp_rf_idx[2][BUS_WIDTH_SP];
+	sc_signal<bool> sp_rf_enable[WG_SLOTS];
+	sc_signal<bool> sp_rf_write[WG_SLOTS];
+	sc_signal<AbstractRegister> sp_rf_reg[WG_SLOTS];
+	sc_signal<sc_bv<BUS_WIDTH_SP> > sp_rf_mask[WG_SLOTS];
+	sc_signal<reg_offset_t<THREADS> > sp_rf_idx[WG_SLOTS][BUS_WIDTH_SP];
 
 	/* Scoreboard -> IDecode */
 	sc_fifo<sc_bv<3> > scoreboard_raw;
 	sc_signal<bool> scoreboard_ex_overflow;
-	sc_signal<bool> scoreboard_cpop_stall[2];
-	sc_signal<sc_bv<32> > scoreboard_entries_pop[2];
+	sc_signal<bool> scoreboard_cpop_stall[WG_SLOTS];
+	sc_signal<sc_bv<32> > scoreboard_entries_pop[WG_SLOTS];
 
 	sc_signal<bool> ifetch_pc_rst;
-	sc_signal<sc_uint<1> > ifetch_pc_rst_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > ifetch_pc_rst_wg;
 
 	/* BufferToPhysXlat -> IExecute */
 	sc_signal<Buffer> xlat_phys;
@@ -370,20 +399,34 @@ public:
 	/** Constructor. */
 	SC_CTOR(SimdCluster) :
 		elaborated(false), idec_impl(IDECODE_1S), dram_active(0ul),
-		compute_active(0ul),
+		compute_active(0ul), clk(nullptr), clk_skipped(0ul),
+		q_id(Quiescence::get().add_client()), quiet_cycles(0u),
+		quiesce_cycles(COMPUTE_QUIESCE_CYCLES),
 		ifetch("ifetch"), idecode(nullptr), iexecute("iexecute"),
 		imem("imem"), regfile("regfile"), ctrlstack("ctrlstack"),
 		scoreboard("scoreboard"), xlat("xlat"), xlat_sp("xlat_sp"),
-		sp_0("sp_0"), sp_1("sp_1"),
 		ifetch_insn_r(1), idecode_req_r(1),
 		idecode_req_r_sb(1), regfile_req_conflicts(1),
-		iexecute_col_mask_w(1), iexecute_sp_desc_fifo_0(1),
-		iexecute_sp_desc_fifo_1(1), iexecute_store_kick_0(2),
-		iexecute_store_kick_1(2), sp_wg_done_0(1), sp_wg_done_1(1),
-		scoreboard_raw(1)
+		iexecute_col_mask_w(1), scoreboard_raw(1)
 	{
-		sp_active[0] = 0ul;
-		sp_active[1] = 0ul;
+		unsigned int w;
+		string n;
+
+		for (w = 0; w < WG_SLOTS; w++) {
+			n = to_string(w);
+
+			sp[w] = new Scratchpad<BUS_WIDTH/4,BUS_WIDTH_SP,SP_BYTES,
+					THREADS,DRAM_CHANS>(("sp_" + n).c_str());
+			sp[w]->set_wg(w);
+			iexecute_sp_desc_fifo[w] = new sc_fifo<stride_descriptor>(
+					("iexecute_sp_desc_fifo_" + n).c_str(), 1);
+			iexecute_store_kick[w] = new sc_fifo<bool>(
+					("iexecute_store_kick_" + n).c_str(), 2);
+			sp_wg_done[w] = new sc_fifo<sc_uint<COMPUTE_WG_WIDTH> >(
+					("sp_wg_done_" + n).c_str(), 1);
+
+			sp_active[w] = 0ul;
+		}
 
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
@@ -432,6 +475,20 @@ public:
 		idecode->set_iexec_pipeline_stages(stages);
 		dec_stages = idecode->get_pipeline_stages();
 		scoreboard.set_slots(stages + dec_stages);
+		quiesce_cycles = COMPUTE_QUIESCE_CYCLES + stages + dec_stages;
+	}
+
+	/** Attach the gated clock driving in_clk.
+	 *
+	 * Clock edges skipped due to quiescence are added to the performance
+	 * counters, keeping them exact.
+	 * @param c Gated compute clock. */
+	void
+	set_gated_clock(GatedClock *c)
+	{
+		clk = c;
+		clk_skipped = c->get_skipped();
+		iexecute.set_gated_clock(c);
 	}
 
 	/** Set VRF bank width.
@@ -449,29 +506,65 @@ public:
 	void
 	get_stats(compute_stats &s)
 	{
+		unsigned int w;
+
 		idecode->get_stats(s);
 		iexecute.get_stats(s);
 		regfile.get_stats(s);
 
 		s.max_scoreboard_entries = scoreboard.get_max_entries();
 		s.dram_active = dram_active;
-		s.sp_active[0] = sp_active[0];
-		s.sp_active[1] = sp_active[1];
+		for (w = 0; w < WG_SLOTS; w++)
+			s.sp_active[w] = sp_active[w];
 		s.compute_active = compute_active;
 	}
 
+	/** Write the scratchpad contents to a checkpoint.
+	 *
+	 * Must only be called at a work-group boundary, with all slots idle.
+	 * @param w Checkpoint writer.
+	 * @param c Index of this cluster. */
+	void
+	checkpoint(CheckpointWriter &w, unsigned int c)
+	{
+		unsigned int s;
+
+		for (s = 0; s < WG_SLOTS; s++)
+			w.add_section(CKPT_SP, c * WG_SLOTS + s,
+					sp[s]->debug_sp_image(), SP_BYTES);
+	}
+
+	/** Restore the scratchpad contents from a checkpoint.
+	 * @param r Checkpoint reader.
+	 * @param c Index of this cluster.
+	 * @return False iff the checkpoint lacks a scratchpad image of the
+	 * 	   right size. */
+	bool
+	restore(const CheckpointReader &r, unsigned int c)
+	{
+		unsigned int s;
+
+		for (s = 0; s < WG_SLOTS; s++) {
+			if (!r.read(CKPT_SP, c * WG_SLOTS + s,
+					sp[s]->debug_sp_image(), SP_BYTES))
+				return false;
+		}
+
+		return true;
+	}
+
 	/** Wire up the SimdCluster. */
 	void
 	elaborate(void)
 	{
-		unsigned int i, l;
+		unsigned int i, l, w;
 
 		/* IFetch */
 		ifetch.in_clk(in_clk);
 		ifetch.out_insn_r(ifetch_insn_r);
 		ifetch.out_wg(ifetch_wg);
-		ifetch.in_wg_state[0](simdcluster_wg_state[0]);
-		ifetch.in_wg_state[1](simdcluster_wg_state[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			ifetch.in_wg_state[w](simdcluster_wg_state[w]);
 		ifetch.in_wg_finished(regfile_wg_finished);
 		ifetch.in_pc_write(iexecute_pc_do_w);
 		ifetch.in_pc_w(iexecute_pc_w);
@@ -510,6 +603,7 @@ public:
 		for (i = 0; i < 3; i++) {
 			for (l = 0; l < LANES; l++)
 				regfile.out_data_r[i][l](regfile_data_r[i][l]);
+			regfile.out_data_bus_r[i](regfile_data_bus_r[i]);
 		}
 
 		regfile.out_req_conflicts(regfile_req_conflicts);
@@ -519,8 +613,8 @@ public:
 
 		regfile.in_mask_w(regfile_mask_w);
 		regfile.in_w(iexecute_w);
-		regfile.in_last_warp[0](simdcluster_last_warp[0]);
-		regfile.in_last_warp[1](simdcluster_last_warp[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			regfile.in_last_warp[w](simdcluster_last_warp[w]);
 		regfile.in_wg_mask_w(iexecute_wg_w);
 		regfile.in_col_mask_w(iexecute_col_mask_w);
 		regfile.out_mask_w(regfile_mask_w);
@@ -531,10 +625,9 @@ public:
 		regfile.in_cmask_rst(simdcluster_rst);
 		regfile.in_cmask_rst_wg(simdcluster_rst_wg);
 		for (i = 0; i < 2; i++) {
-			for (l = 0; l < 2; l++) {
-				regfile.in_wg_off[i][l](simdcluster_wg_off[i][l]);
-				iexecute.in_wg_off[i][l](simdcluster_wg_off[i][l]);
-
+			for (w = 0; w < WG_SLOTS; w++) {
+				regfile.in_wg_off[w][i](simdcluster_wg_off[w][i]);
+				iexecute.in_wg_off[w][i](simdcluster_wg_off[w][i]);
 			}
 			regfile.in_dim[i](in_work_dim[i]);
 			iexecute.in_dim[i](in_work_dim[i]);
@@ -542,54 +635,52 @@ public:
 		regfile.in_wg_width(in_wg_width);
 
 		regfile.in_store_enable[IF_DRAM](in_dram_enable);
-		regfile.in_store_enable[IF_SP_WG0](sp_rf_enable[IF_SP_WG0]);
-		regfile.in_store_enable[IF_SP_WG1](sp_rf_enable[IF_SP_WG1]);
-
 		regfile.in_store_write[IF_DRAM](in_dram_write);
-		regfile.in_store_write[IF_SP_WG0](sp_rf_write[IF_SP_WG0]);
-		regfile.in_store_write[IF_SP_WG1](sp_rf_write[IF_SP_WG1]);
-
 		regfile.in_store_reg[IF_DRAM](in_dram_reg);
-		regfile.in_store_reg[IF_SP_WG0](sp_rf_reg[IF_SP_WG0]);
-		regfile.in_store_reg[IF_SP_WG1](sp_rf_reg[IF_SP_WG1]);
 
-		regfile.in_dram_store_mask(in_dram_mask);
-		regfile.in_sp_store_mask[IF_SP_WG0](sp_rf_mask[IF_SP_WG0]);
-		regfile.in_sp_store_mask[IF_SP_WG1](sp_rf_mask[IF_SP_WG1]);
+		for (w = 0; w < WG_SLOTS; w++) {
+			regfile.in_store_enable[IF_SP_WG0 + w](sp_rf_enable[w]);
+			regfile.in_store_write[IF_SP_WG0 + w](sp_rf_write[w]);
+			regfile.in_store_reg[IF_SP_WG0 + w](sp_rf_reg[w]);
+			regfile.in_sp_store_mask[w](sp_rf_mask[w]);
+		}
+
+		for (unsigned int c = 0; c < DRAM_CHANS; c++) {
+			regfile.in_dram_store_mask[c](in_dram_mask[c]);
+			regfile.out_dram_store_mask[c](out_dram_mask[c]);
+		}
 
-		for (unsigned int i = 0; i < BUS_WIDTH/4; i++) {
+		for (unsigned int i = 0; i < DRAM_CHANS*BUS_WIDTH/4; i++) {
 			regfile.in_dram_store_idx[i](in_dram_idx[i]);
 			regfile.in_dram_store_data[i](in_dram_data[i]);
 			regfile.out_dram_store_data[i](out_dram_data[IF_DRAM][i]);
 
-			regfile.in_sp_store_data[IF_SP_WG0][i](out_dram_data[IF_SP_WG0][i]);
-			regfile.in_sp_store_data[IF_SP_WG1][i](out_dram_data[IF_SP_WG1][i]);
+			for (w = 0; w < WG_SLOTS; w++)
+				regfile.in_sp_store_data[w][i](out_dram_data[IF_SP_WG0 + w][i]);
 		}
 
 		for (unsigned int i = 0; i < BUS_WIDTH_SP; i++) {
-			regfile.in_sp_store_idx[IF_SP_WG0][i](sp_rf_idx[IF_SP_WG0][i]);
-			regfile.in_sp_store_idx[IF_SP_WG1][i](sp_rf_idx[IF_SP_WG1][i]);
-
-			regfile.out_sp_store_data[IF_SP_WG0][i](regfile_store_data[IF_SP_WG0][i]);
-			regfile.out_sp_store_data[IF_SP_WG1][i](regfile_store_data[IF_SP_WG1][i]);
+			for (w = 0; w < WG_SLOTS; w++) {
+				regfile.in_sp_store_idx[w][i](sp_rf_idx[w][i]);
+				regfile.out_sp_store_data[w][i](regfile_store_data[w][i]);
+			}
 		}
 
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-		for (i = 0; i < SP_BUS_WIDTH - (BUS_WIDTH/4); i++) {
-			regfile.in_sp_store_data[IF_SP_WG0][(BUS_WIDTH/4)+i](sp_out_data[IF_SP_WG0][i]);
-			regfile.in_sp_store_data[IF_SP_WG1][(BUS_WIDTH/4)+i](sp_out_data[IF_SP_WG1][i]);
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+		for (i = 0; i < SP_BUS_WIDTH - (DRAM_CHANS*BUS_WIDTH/4); i++) {
+			for (w = 0; w < WG_SLOTS; w++)
+				regfile.in_sp_store_data[w][(DRAM_CHANS*BUS_WIDTH/4)+i](sp_out_data[w][i]);
 		}
 #endif
 
 		regfile.in_dram_dst(in_dram_dst);
-		regfile.out_dram_store_mask(out_dram_mask);
-		regfile.out_sp_store_mask[IF_SP_WG0](regfile_store_mask[IF_SP_WG0]);
-		regfile.out_sp_store_mask[IF_SP_WG1](regfile_store_mask[IF_SP_WG1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			regfile.out_sp_store_mask[w](regfile_store_mask[w]);
 		regfile.in_store_idx_push_trigger(in_dram_idx_push_trigger);
 		regfile.out_store_idx(out_dram_idx);
 
-		regfile.out_sd[0](regfile_sd[0]);
-		regfile.out_sd[1](regfile_sd[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			regfile.out_sd[w](regfile_sd[w]);
 
 		/* IExecute */
 		iexecute.in_clk(in_clk);
@@ -600,8 +691,9 @@ public:
 		iexecute.in_subcol_w(idecode_subcol_w);
 		for (l = 0; l < LANES; l++)
 			iexecute.in_operand[2][l](regfile_data_r[2][l]);
-		iexecute.in_sd[0](regfile_sd[0]);
-		iexecute.in_sd[1](regfile_sd[1]);
+		iexecute.in_operand_bus[2](regfile_data_bus_r[2]);
+		for (w = 0; w < WG_SLOTS; w++)
+			iexecute.in_sd[w](regfile_sd[w]);
 		iexecute.in_thread_active(regfile_thread_active);
 		iexecute.in_xlat_phys(xlat_phys);
 		iexecute.in_sp_xlat_phys(xlat_sp_phys);
@@ -618,8 +710,8 @@ public:
 
 		iexecute.out_pc_do_w(iexecute_pc_do_w);
 		iexecute.out_pc_w(iexecute_pc_w);
-		iexecute.out_wg_state_next[0](iexecute_wg_state_next[0]);
-		iexecute.out_wg_state_next[1](iexecute_wg_state_next[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			iexecute.out_wg_state_next[w](iexecute_wg_state_next[w]);
 		iexecute.out_wg_exit_commit(iexecute_wg_exit_commit);
 
 		iexecute.out_cstack_action(iexecute_cstack_action);
@@ -629,11 +721,11 @@ public:
 		iexecute.in_cstack_ex_overflow(cstack_ex_overflow);
 		iexecute.in_wg_width(in_wg_width);
 		iexecute.out_desc_fifo[IF_DRAM](out_desc_fifo);
-		iexecute.out_desc_fifo[IF_SP_WG0](iexecute_sp_desc_fifo_0);
-		iexecute.out_desc_fifo[IF_SP_WG1](iexecute_sp_desc_fifo_1);
 		iexecute.out_store_kick[IF_DRAM](out_dram_kick);
-		iexecute.out_store_kick[IF_SP_WG0](iexecute_store_kick_0);
-		iexecute.out_store_kick[IF_SP_WG1](iexecute_store_kick_1);
+		for (w = 0; w < WG_SLOTS; w++) {
+			iexecute.out_desc_fifo[IF_SP_WG0 + w](*iexecute_sp_desc_fifo[w]);
+			iexecute.out_store_kick[IF_SP_WG0 + w](*iexecute_store_kick[w]);
+		}
 
 		iexecute.set_scoreboard(&scoreboard);
 
@@ -654,8 +746,8 @@ public:
 		scoreboard.in_dequeue_cstack_wg(iexecute_wg_w);
 		scoreboard.in_enqueue_cstack_write(idecode_enqueue_cstack_write);
 		scoreboard.in_enqueue_cstack_wg(idecode_enqueue_cstack_wg);
-		scoreboard.out_cpop_stall[0](scoreboard_cpop_stall[0]);
-		scoreboard.out_cpop_stall[1](scoreboard_cpop_stall[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			scoreboard.out_cpop_stall[w](scoreboard_cpop_stall[w]);
 		scoreboard.in_req_w(idecode_req_w);
 		scoreboard.in_req_r(idecode_req_r_sb);
 		scoreboard.in_ssp_match(idecode_ssp_match);
@@ -664,8 +756,8 @@ public:
 		scoreboard.in_req_sb_pop[2](idecode_req_sb_pop[2]);
 		scoreboard.out_raw(scoreboard_raw);
 		scoreboard.out_ex_overflow(scoreboard_ex_overflow);
-		scoreboard.out_entries_pop[0](scoreboard_entries_pop[0]);
-		scoreboard.out_entries_pop[1](scoreboard_entries_pop[1]);
+		for (w = 0; w < WG_SLOTS; w++)
+			scoreboard.out_entries_pop[w](scoreboard_entries_pop[w]);
 		scoreboard.in_entries_disable(iexecute_pc_do_w);
 		scoreboard.in_entries_disable_wg(iexecute_wg_w);
 
@@ -685,87 +777,73 @@ public:
 		xlat_sp.in_idx_w(in_sp_xlat_idx_w);
 		xlat_sp.in_phys_w(in_sp_xlat_phys_w);
 
-		sp_0.in_clk(in_clk_dram);
-		sp_0.in_sched_opts(in_sched_opts);
-		sp_0.in_ticket_pop(out_ticket_pop);
-		sp_0.in_desc_fifo(iexecute_sp_desc_fifo_0);
-		sp_0.in_trigger(iexecute_store_kick_0);
-		sp_0.out_wg_done(sp_wg_done_0);
-		sp_0.out_rf_enable(sp_rf_enable[IF_SP_WG0]);
-		sp_0.out_rf_write(sp_rf_write[IF_SP_WG0]);
-		sp_0.out_rf_reg(sp_rf_reg[IF_SP_WG0]);
-		sp_0.out_rf_mask(sp_rf_mask[IF_SP_WG0]);
-		sp_0.in_rf_mask(regfile_store_mask[IF_SP_WG0]);
-		sp_0.in_dram_enable(in_dram_enable);
-		sp_0.in_dram_dst(in_dram_dst);
-		sp_0.in_dram_write(in_dram_write);
-		sp_0.in_dram_addr(in_dram_sp_addr);
-		sp_0.in_dram_mask(in_dram_mask);
-
-		for (i = 0; i < MC_BUS_WIDTH/4; i++) {
-			sp_0.out_data[i](out_dram_data[IF_SP_WG0][i]);
-			sp_0.in_dram_data[i](in_dram_data[i]);
-		}
+		for (w = 0; w < WG_SLOTS; w++)
+			elaborate_sp(w);
 
-		for (i = 0; i < SP_BUS_WIDTH; i++) {
-			sp_0.out_rf_idx[i](sp_rf_idx[IF_SP_WG0][i]);
-			sp_0.in_rf_data[i](regfile_store_data[IF_SP_WG0][i]);
+		elaborated = true;
+	}
+
+private:
+	/** Wire up the scratchpad of a work-group slot.
+	 * @param w Work-group slot. */
+	void
+	elaborate_sp(unsigned int w)
+	{
+		unsigned int i;
+
+		sp[w]->in_clk(in_clk_dram);
+		sp[w]->in_sched_opts(in_sched_opts);
+		sp[w]->in_ticket_pop(out_ticket_pop);
+		sp[w]->in_desc_fifo(*iexecute_sp_desc_fifo[w]);
+		sp[w]->in_trigger(*iexecute_store_kick[w]);
+		sp[w]->out_wg_done(*sp_wg_done[w]);
+		sp[w]->out_rf_enable(sp_rf_enable[w]);
+		sp[w]->out_rf_write(sp_rf_write[w]);
+		sp[w]->out_rf_reg(sp_rf_reg[w]);
+		sp[w]->out_rf_mask(sp_rf_mask[w]);
+		sp[w]->in_rf_mask(regfile_store_mask[w]);
+		sp[w]->in_dram_enable(in_dram_enable);
+		sp[w]->in_dram_dst(in_dram_dst);
+		sp[w]->in_dram_write(in_dram_write);
+
+		for (i = 0; i < DRAM_CHANS; i++) {
+			sp[w]->in_dram_addr[i](in_dram_sp_addr[i]);
+			sp[w]->in_dram_mask[i](in_dram_mask[i]);
 		}
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-		for (i = 0; i < SP_BUS_WIDTH - (BUS_WIDTH/4); i++)
-			sp_0.out_data[(BUS_WIDTH/4)+i](sp_out_data[IF_SP_WG0][i]);
-#endif
 
-		sp_0.elaborate();
-
-		sp_1.in_clk(in_clk_dram);
-		sp_1.in_sched_opts(in_sched_opts);
-		sp_1.in_ticket_pop(out_ticket_pop);
-		sp_1.in_desc_fifo(iexecute_sp_desc_fifo_1);
-		sp_1.in_trigger(iexecute_store_kick_1);
-		sp_1.out_wg_done(sp_wg_done_1);
-		sp_1.out_rf_enable(sp_rf_enable[IF_SP_WG1]);
-		sp_1.out_rf_write(sp_rf_write[IF_SP_WG1]);
-		sp_1.out_rf_reg(sp_rf_reg[IF_SP_WG1]);
-		sp_1.out_rf_mask(sp_rf_mask[IF_SP_WG1]);
-		sp_1.in_rf_mask(regfile_store_mask[IF_SP_WG1]);
-		sp_1.in_dram_enable(in_dram_enable);
-		sp_1.in_dram_dst(in_dram_dst);
-		sp_1.in_dram_write(in_dram_write);
-		sp_1.in_dram_addr(in_dram_sp_addr);
-		sp_1.in_dram_mask(in_dram_mask);
-
-		for (i = 0; i < MC_BUS_WIDTH/4; i++) {
-			sp_1.out_data[i](out_dram_data[IF_SP_WG1][i]);
-			sp_1.in_dram_data[i](in_dram_data[i]);
+		for (i = 0; i < DRAM_CHANS*BUS_WIDTH/4; i++) {
+			sp[w]->out_data[i](out_dram_data[IF_SP_WG0 + w][i]);
+			sp[w]->in_dram_data[i](in_dram_data[i]);
 		}
 
 		for (i = 0; i < SP_BUS_WIDTH; i++) {
-			sp_1.out_rf_idx[i](sp_rf_idx[IF_SP_WG1][i]);
-			sp_1.in_rf_data[i](regfile_store_data[IF_SP_WG1][i]);
+			sp[w]->out_rf_idx[i](sp_rf_idx[w][i]);
+			sp[w]->in_rf_data[i](regfile_store_data[w][i]);
 		}
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-		for (i = 0; i < SP_BUS_WIDTH - (BUS_WIDTH/4); i++)
-			sp_1.out_data[(BUS_WIDTH/4)+i](sp_out_data[IF_SP_WG1][i]);
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+		for (i = 0; i < SP_BUS_WIDTH - (DRAM_CHANS*BUS_WIDTH/4); i++)
+			sp[w]->out_data[(DRAM_CHANS*BUS_WIDTH/4)+i](sp_out_data[w][i]);
 #endif
 
-		sp_1.elaborate();
-
-		elaborated = true;
+		sp[w]->elaborate();
 	}
 
-private:
 	/** Wire up the generic parts of the IDecoder. */
 	void
 	elaborate_idecode(void)
 	{
+		unsigned int w;
+
 		idecode->in_clk(in_clk);
 		idecode->in_insn(imem_op);
 		idecode->in_pc(imem_pc);
 		idecode->in_wg(ifetch_wg);
 		idecode->in_wg_width(in_wg_width);
-		idecode->in_last_warp[0](simdcluster_last_warp[0]);
-		idecode->in_last_warp[1](simdcluster_last_warp[1]);
+		for (w = 0; w < WG_SLOTS; w++) {
+			idecode->in_last_warp[w](simdcluster_last_warp[w]);
+			idecode->in_sb_cpop_stall[w](scoreboard_cpop_stall[w]);
+			idecode->in_entries_pop[w](scoreboard_entries_pop[w]);
+		}
 		idecode->in_thread_active(regfile_thread_active);
 		idecode->in_wg_finished(regfile_wg_finished);
 		idecode->out_pc(idecode_pc);
@@ -776,11 +854,7 @@ private:
 		idecode->out_enqueue_sb(idecode_enqueue);
 		idecode->out_enqueue_sb_cstack_write(idecode_enqueue_cstack_write);
 		idecode->out_enqueue_sb_cstack_wg(idecode_enqueue_cstack_wg);
-		idecode->in_sb_cpop_stall[0](scoreboard_cpop_stall[0]);
-		idecode->in_sb_cpop_stall[1](scoreboard_cpop_stall[1]);
 		idecode->out_req_w_sb(idecode_req_w);
-		idecode->in_entries_pop[0](scoreboard_entries_pop[0]);
-		idecode->in_entries_pop[1](scoreboard_entries_pop[1]);
 		idecode->out_wg(idecode_wg);
 		idecode->out_col_w(idecode_col_w);
 		idecode->out_subcol_w(idecode_subcol_w);
@@ -800,7 +874,8 @@ private:
 	elaborate_idecode_1s(void)
 	{
 		unsigned int l;
-		idecode = new IDecode_1S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES>("idecode");
+		idecode = new IDecode_1S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES,
+				WG_SLOTS>("idecode");
 
 		/* IDecode */
 		elaborate_idecode();
@@ -809,6 +884,8 @@ private:
 			iexecute.in_operand[0][l](regfile_data_r[0][l]);
 			iexecute.in_operand[1][l](regfile_data_r[1][l]);
 		}
+		iexecute.in_operand_bus[0](regfile_data_bus_r[0]);
+		iexecute.in_operand_bus[1](regfile_data_bus_r[1]);
 	}
 
 	/** Construct and elaborate a 3-stage IDecode component */
@@ -817,8 +894,9 @@ private:
 	{
 		unsigned int l;
 
-		IDecode_3S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES> *idecode_3s =
-				new IDecode_3S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES>("idecode");
+		IDecode_3S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES,WG_SLOTS> *idecode_3s =
+				new IDecode_3S<PC_WIDTH,THREADS,LANES,RCPUS,XLAT_ENTRIES,
+						WG_SLOTS>("idecode");
 
 		idecode = idecode_3s;
 
@@ -837,17 +915,27 @@ private:
 			iexecute.in_operand[0][l](idecode_data_r[0][l]);
 			iexecute.in_operand[1][l](idecode_data_r[1][l]);
 		}
+
+		idecode_3s->in_operand_bus[0](regfile_data_bus_r[0]);
+		idecode_3s->in_operand_bus[1](regfile_data_bus_r[1]);
+		idecode_3s->out_operand_bus[0](idecode_data_bus_r[0]);
+		idecode_3s->out_operand_bus[1](idecode_data_bus_r[1]);
+		iexecute.in_operand_bus[0](idecode_data_bus_r[0]);
+		iexecute.in_operand_bus[1](idecode_data_bus_r[1]);
 	}
 
 	/** Update the performance counters.
 	 *
-	 * Called on every cycle. */
+	 * Called on every cycle.
+	 * @param n Number of cycles passed since the previous update. More
+	 * 	    than one if the clock skipped edges, during which the
+	 * 	    work-group states did not change. */
 	void
-	update_pcounters(void)
+	update_pcounters(unsigned long n)
 	{
 		ifetch_wg_select wgs;
 
-		for (unsigned int wg = 0; wg < 2; wg++) {
+		for (unsigned int wg = 0; wg < WG_SLOTS; wg++) {
 			switch (wg_state[wg]) {
 			case WG_STATE_NONE:
 				break;
@@ -855,16 +943,16 @@ private:
 			case WG_STATE_BLOCKED_DRAM_POSTEXIT:
 				if (in_dram_dst.read().type != TARGET_NONE &&
 				    in_dram_dst.read().wg == wg) {
-					dram_active++;
+					dram_active += n;
 				}
 				break;
 			case WG_STATE_BLOCKED_SP:
-				sp_active[wg]++;
+				sp_active[wg] += n;
 				break;
 			case WG_STATE_RUN:
 				wgs = ifetch.select_wg();
 				if (wgs == wg) {
-					compute_active++;
+					compute_active += n;
 				}
 				break;
 			default:
@@ -880,9 +968,10 @@ private:
 	 * workgroup provided.
 	 */
 	const string
-	dbg_print_state(sc_uint<1> wg)
+	dbg_print_state(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		ifetch_wg_select wgs;
+		unsigned int w;
 
 		switch (wg_state[wg]) {
 		case WG_STATE_NONE:
@@ -907,15 +996,12 @@ private:
 			}
 			break;
 		case WG_STATE_BLOCKED_SP:
-			if (sp_0.out_rf_reg.read().type != REGISTER_NONE &&
-			    sp_0.out_rf_reg.read().wg == wg) {
-				return "     SP";
-			} else if (sp_1.out_rf_reg.read().type != REGISTER_NONE &&
-				   sp_1.out_rf_reg.read().wg == wg) {
-				return "     SP";
-			} else {
-				return "blocked";
+			for (w = 0; w < WG_SLOTS; w++) {
+				if (sp_rf_reg[w].read().type != REGISTER_NONE &&
+				    sp_rf_reg[w].read().wg == wg)
+					return "     SP";
 			}
+			return "blocked";
 			break;
 		case WG_STATE_RUN:
 			wgs = ifetch.select_wg();
@@ -938,9 +1024,10 @@ private:
 	 * workgroup provided.
 	 */
 	const string
-	dbg_print_state_code(sc_uint<1> wg)
+	dbg_print_state_code(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		ifetch_wg_select wgs;
+		unsigned int w;
 
 		switch (wg_state[wg]) {
 		case WG_STATE_NONE:
@@ -957,15 +1044,12 @@ private:
 			}
 			break;
 		case WG_STATE_BLOCKED_SP:
-			if (sp_0.out_rf_reg.read().type != REGISTER_NONE &&
-			    sp_0.out_rf_reg.read().wg == wg) {
-				return "3";
-			} else if (sp_1.out_rf_reg.read().type != REGISTER_NONE &&
-				   sp_1.out_rf_reg.read().wg == wg) {
-				return "3";
-			} else {
-				return "4";
+			for (w = 0; w < WG_SLOTS; w++) {
+				if (sp_rf_reg[w].read().type != REGISTER_NONE &&
+				    sp_rf_reg[w].read().wg == wg)
+					return "3";
 			}
+			return "4";
 			break;
 		case WG_STATE_RUN:
 			wgs = ifetch.select_wg();
@@ -986,19 +1070,16 @@ private:
 	stats(void)
 	{
 		uint64 time;
-		string wg0_status;
-		string wg1_status;
+		unsigned int w;
 
 		if (!debug_output[DEBUG_COMPUTE_WG_STATUS])
 			return;
 
-		wg0_status = dbg_print_state(0);
-		wg1_status = dbg_print_state(1);
-
 		time = sc_time_stamp().value() / 1000;
-		cout << time << " ns Cluster X: [0] " <<
-				wg0_status << " [1] " << wg1_status <<
-				endl;
+		cout << time << " ns Cluster X:";
+		for (w = 0; w < WG_SLOTS; w++)
+			cout << " [" << w << "] " << dbg_print_state(w);
+		cout << endl;
 	}
 
 	/** Retreive and print the status for the current workgroups. */
@@ -1006,30 +1087,28 @@ private:
 	stats_code(void)
 	{
 		uint64 time;
-		string wg0_status;
-		string wg1_status;
+		unsigned int w;
 
 		if (!debug_output[DEBUG_COMPUTE_WG_STATUS_CODE])
 			return;
 
-		wg0_status = dbg_print_state_code(0);
-		wg1_status = dbg_print_state_code(1);
-
 		time = sc_time_stamp().value() / 1000;
-		cout << time << ",0," << wg0_status << endl;
-		cout << time << ",1," << wg1_status << endl;
-		cout << time << ",2,0" << endl << endl;
+		for (w = 0; w < WG_SLOTS; w++)
+			cout << time << "," << w << "," << dbg_print_state_code(w)
+					<< endl;
+		cout << time << "," << WG_SLOTS << ",0" << endl << endl;
 	}
 
 	/** Perform a hardware reset */
 	void
 	do_reset(void)
 	{
-		wg_state[0] = WG_STATE_NONE;
-		wg_state[1] = WG_STATE_NONE;
+		unsigned int w;
 
-		wg_accept_next[0] = true;
-		wg_accept_next[1] = true;
+		for (w = 0; w < WG_SLOTS; w++) {
+			wg_state[w] = WG_STATE_NONE;
+			wg_accept_next[w] = true;
+		}
 
 		ticket_pop = 0;
 
@@ -1059,8 +1138,8 @@ private:
 		simdcluster_rst_wg.write(slot);
 		simdcluster_rst.write(true);
 
-		/* Under "Pairwise WG" scheduling, don't accept another WG until
-		 * the other one hits an exit. */
+		/* Under "Pairwise WG" scheduling, don't accept another WG in
+		 * this slot until the WG in the preceding slot hits an exit. */
 		if (sched_opts[WSS_PAIRWISE_WG])
 			wg_accept_next[slot] = false;
 
@@ -1074,7 +1153,8 @@ private:
 	wg_try_unblock(void)
 	{
 		RequestTarget dst_done;
-		sc_uint<1> wg_done;
+		sc_uint<COMPUTE_WG_WIDTH> wg_done;
+		unsigned int w;
 
 		if (in_dram_done_dst.num_available()) {
 			dst_done = in_dram_done_dst.read();
@@ -1089,17 +1169,11 @@ private:
 			ticket_pop++;
 		}
 
-		if (sp_wg_done_0.num_available()) {
-			wg_done = sp_wg_done_0.read();
-			assert(wg_state[wg_done] == WG_STATE_BLOCKED_SP);
-
-			wg_state[wg_done] = WG_STATE_RUN;
-
-			ticket_pop++;
-		}
+		for (w = 0; w < WG_SLOTS; w++) {
+			if (!sp_wg_done[w]->num_available())
+				continue;
 
-		if (sp_wg_done_1.num_available()) {
-			wg_done = sp_wg_done_1.read();
+			wg_done = sp_wg_done[w]->read();
 			assert(wg_state[wg_done] == WG_STATE_BLOCKED_SP);
 
 			wg_state[wg_done] = WG_STATE_RUN;
@@ -1114,7 +1188,7 @@ private:
 	 * @param wg Workgroup to update blocked status for.
 	 */
 	void
-	wg_update_block(sc_uint<1> wg)
+	wg_update_block(sc_uint<COMPUTE_WG_WIDTH> wg)
 	{
 		workgroup_state wg_state_next;
 
@@ -1122,7 +1196,7 @@ private:
 
 		switch (wg_state_next) {
 			case WG_STATE_BLOCKED_DRAM_POSTEXIT:
-				wg_accept_next[1 - wg.to_uint()] = true;
+				wg_accept_next[(wg.to_uint() + 1) % WG_SLOTS] = true;
 				/* fall-through */
 			case WG_STATE_BLOCKED_DRAM:
 			case WG_STATE_BLOCKED_SP:
@@ -1138,31 +1212,76 @@ private:
 	 * @param mask_exit Mask indicating which WG had its exit bit set in
 	 * 		    the previous cycle. */
 	void
-	wg_update_status(sc_bv<2> mask_exit)
+	wg_update_status(sc_bv<WG_SLOTS> mask_exit)
 	{
-		sc_bv<2> mask;
+		sc_bv<WG_SLOTS> mask;
+		unsigned int w;
 
-		wg_update_block(0);
-		wg_update_block(1);
+		for (w = 0; w < WG_SLOTS; w++)
+			wg_update_block(w);
 
 		mask = regfile_wg_finished.read() & mask_exit;
 
-		if (mask[0]) {
-			wg_state[0] = WG_STATE_NONE;
-			wg_accept_next[1] = true;
+		for (w = 0; w < WG_SLOTS; w++) {
+			if (mask[w]) {
+				wg_state[w] = WG_STATE_NONE;
+				wg_accept_next[(w + 1) % WG_SLOTS] = true;
+			}
 		}
+	}
 
-		if (mask[1]) {
-			wg_state[1] = WG_STATE_NONE;
-			wg_accept_next[0] = true;
+	/** Declare the quiescence state of this SimdCluster.
+	 *
+	 * Quiescent once each work-group is either blocked on DRAM or
+	 * finished with no more work to come, for long enough to drain the
+	 * pipeline. Only a DRAM transfer completing ends this state. */
+	void
+	quiesce(void)
+	{
+		Quiescence &q = Quiescence::get();
+		unsigned int wg;
+		bool blocked = false;
+
+		for (wg = 0; wg < WG_SLOTS; wg++) {
+			switch (wg_state[wg]) {
+			case WG_STATE_BLOCKED_DRAM:
+			case WG_STATE_BLOCKED_DRAM_POSTEXIT:
+				blocked = true;
+				break;
+			case WG_STATE_NONE:
+				if (in_end_prg.read())
+					break;
+				/* fall-through */
+			default:
+				goto busy;
+			}
+		}
+
+		if (!blocked || in_dram_done_dst.num_available())
+			goto busy;
+
+		if (quiet_cycles < quiesce_cycles) {
+			quiet_cycles++;
+			q.busy(q_id);
+			return;
 		}
+
+		q.idle(q_id);
+		return;
+
+	busy:
+		quiet_cycles = 0;
+		q.busy(q_id);
 	}
 
 	/** Main thread */
 	void
 	thread_lt(void)
 	{
-		sc_bv<2> mask_exit = 0;
+		sc_bv<WG_SLOTS> mask_exit = 0;
+		unsigned long skip;
+		unsigned int w;
+		bool fini;
 
 		assert(elaborated);
 
@@ -1192,28 +1311,38 @@ private:
 			wg_update_status(mask_exit);
 
 			/* Only one per cycle */
-			if (wg_state[0] == WG_STATE_NONE &&
-					wg_accept_next[0])
-				wg_try_obtain(0);
-			else if (wg_state[1] == WG_STATE_NONE &&
-					wg_accept_next[1])
-				wg_try_obtain(1);
+			for (w = 0; w < WG_SLOTS; w++) {
+				if (wg_state[w] == WG_STATE_NONE &&
+						wg_accept_next[w])
+					break;
+			}
+
+			if (w < WG_SLOTS)
+				wg_try_obtain(w);
 			else
 				simdcluster_rst.write(false);
 
-			simdcluster_wg_state[0].write(wg_state[0]);
-			simdcluster_wg_state[1].write(wg_state[1]);
+			fini = in_end_prg.read();
+			for (w = 0; w < WG_SLOTS; w++) {
+				simdcluster_wg_state[w].write(wg_state[w]);
+				fini &= (wg_state[w] == WG_STATE_NONE);
+			}
 
-			if (in_end_prg.read() && wg_state[0] == WG_STATE_NONE &&
-					wg_state[1] == WG_STATE_NONE)
-				out_exec_fini.write(true);
-			else
-				out_exec_fini.write(false);
+			out_exec_fini.write(fini);
 
 			wait(SC_ZERO_TIME);
 			mask_exit = iexecute_wg_exit_commit.read();
 						/* Save for next cycle */
-			update_pcounters();
+			skip = 0ul;
+			if (clk) {
+				skip = clk->get_skipped() - clk_skipped;
+				clk_skipped = clk->get_skipped();
+			}
+
+			update_pcounters(1ul + skip);
+
+			if (Quiescence::get().is_enabled())
+				quiesce();
 			stats();
 			stats_code();
 		}
@@ -21,16 +21,20 @@
 
 #include "compute/model/work.h"
 #include "compute/model/compute_stats.h"
+#include "compute/model/wg_sampling.h"
 #include "model/Buffer.h"
+#include "mc/model/dram_channel.h"
 
 #include "util/ddr4_lid.h"
 #include "util/sched_opts.h"
+#include "util/GatedClock.h"
 
 using namespace std;
 using namespace sc_dt;
 using namespace sc_core;
 using namespace compute_model;
 using namespace dram;
+using namespace simd_util;
 
 namespace compute_control {
 
@@ -44,13 +48,27 @@ typedef enum {
 } ws_state;
 
 /** Enumerate work into workgroups. (For now) serves as a front-end.
+ *
+ * Work-groups are distributed over CLUSTERS SimdClusters in strict round-robin
+ * order, such that each cluster executes every CLUSTERS-th work-group. This
+ * keeps the assignment of work-groups to clusters independent of timing,
+ * bounding the number of work-groups each cluster executes for WCET analysis.
+ *
+ * With a work-group sampling policy attached, work-groups that are not sampled
+ * are skipped rather than dispatched. They must be executed functionally after
+ * simulation, see wg_sampling.
+ *
+ * For checkpointing, enumeration can be stopped at a work-group boundary: the
+ * WorkScheduler stops dispatching, waits for all clusters to finish and ends
+ * the kernel as if all work-groups were enumerated. A kernel can be resumed
+ * from such a boundary in a new simulation.
  * @todo Kernel should obviously come from a DRAM buffer, but given we don't
  * have an opcode format this doesn't make sense to simulate right now. We
  * could add support for deriving a latency by directly querying Ramulator
  * (which we'd be linking anyway) or indirectly by querying MC for an estimate.
  */
 template <unsigned int THREADS, unsigned int LANES, unsigned int PC_WIDTH,
-	unsigned int XLAT_ENTRIES>
+	unsigned int XLAT_ENTRIES, unsigned int CLUSTERS = 1>
 class WorkScheduler : public sc_core::sc_module
 {
 private:
@@ -60,15 +78,47 @@ private:
 	/** Stats for kernel execution */
 	compute_stats stats;
 
+	/** Number of work-groups dispatched to each cluster. */
+	unsigned long cluster_wgs[CLUSTERS];
+
+	/** Number of threads dispatched to each cluster. */
+	unsigned long cluster_threads[CLUSTERS];
+
+	/** Cluster the next work-group is dispatched to. */
+	unsigned int cluster_next;
+
 	/** Cycle counter */
 	unsigned long cycle;
 
+	/** True iff the cycle counter waits for the delta cycle following a
+	 * clock edge. */
+	bool cycle_delta;
+
 	/** Cycle for kick-off of kernel */
 	unsigned long start_cycle;
 
 	/** Number of bytes per opcode. */
 	unsigned int opcode_bytes;
 
+	/** Gated compute clock, nullptr if the clock never skips edges. */
+	GatedClock *clk;
+
+	/** Number of skipped clock edges accounted for in the cycle counter. */
+	unsigned long clk_skipped;
+
+	/** Work-group sampling policy, nullptr if all work-groups are
+	 * dispatched. */
+	wg_sampling *sampling;
+
+	/** Enumeration index of the first work-group to dispatch. */
+	unsigned long wg_first;
+
+	/** Enumeration index to stop dispatching at, 0 to run to completion. */
+	unsigned long wg_stop;
+
+	/** True iff enumeration stopped at wg_stop. */
+	bool stopped;
+
 public:
 	/** Compute clock. */
 	sc_in<bool> in_clk{"in_clk"};
@@ -79,9 +129,8 @@ public:
 	/** Kick off work. */
 	sc_in<bool> in_kick{"in_kick"};
 
-	/** Workgroup generated
-	 * @todo FIFO? */
-	sc_fifo_out<workgroup<THREADS,LANES> > out_wg{"out_wg"};
+	/** Workgroup generated, one FIFO per cluster. */
+	sc_fifo_out<workgroup<THREADS,LANES> > out_wg[CLUSTERS];
 
 	/** Workgroup width. */
 	sc_inout<workgroup_width> out_wg_width{"out_wg_width"};
@@ -104,8 +153,8 @@ public:
 	/** True iff all workgroups have been enumerated into the FIFO. */
 	sc_inout<bool> out_end_prg{"out_end_prg"};
 
-	/** True iff execution is finished. */
-	sc_in<bool> in_exec_fini{"in_exec_fini"};
+	/** True iff execution is finished, one per cluster. */
+	sc_in<bool> in_exec_fini[CLUSTERS];
 
 	/** Write a translation table entry */
 	sc_inout<bool> out_xlat_w{"out_xlat_w"};
@@ -129,15 +178,82 @@ public:
 
 	/** Constructor */
 	SC_CTOR(WorkScheduler) : state(WS_STATE_IDLE), cycle(0ull),
-			start_cycle(0ull), opcode_bytes(8)
+			cycle_delta(false), start_cycle(0ull), opcode_bytes(8),
+			clk(nullptr), clk_skipped(0ul), sampling(nullptr),
+			wg_first(0ul), wg_stop(0ul), stopped(false)
 	{
+		unsigned int c;
+
 		stats = {0,0,0,0};
+		cluster_next = 0;
+		for (c = 0; c < CLUSTERS; c++) {
+			cluster_wgs[c] = 0ul;
+			cluster_threads[c] = 0ul;
+		}
 
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
 
-		SC_THREAD(thread_cycle_counter);
+		SC_METHOD(method_cycle_counter);
 		sensitive << in_clk.pos();
+		dont_initialize();
+	}
+
+	/** Attach the gated clock driving in_clk.
+	 *
+	 * Clock edges skipped due to quiescence are added to the cycle
+	 * counter, keeping it exact.
+	 * @param c Gated compute clock. */
+	void
+	set_gated_clock(GatedClock *c)
+	{
+		clk = c;
+		clk_skipped = c->get_skipped();
+	}
+
+	/** Attach a work-group sampling policy.
+	 *
+	 * Must be called prior to kernel kick-off. The policy records which
+	 * work-groups were dispatched and which were skipped.
+	 * @param s Work-group sampling policy. */
+	void
+	set_sampling(wg_sampling *s)
+	{
+		sampling = s;
+	}
+
+	/** Resume enumeration at a given work-group.
+	 *
+	 * Must be called prior to kernel kick-off. Work-groups preceding idx
+	 * are assumed to have executed, in a simulation that stopped at
+	 * idx.
+	 * @param idx Enumeration index of the first work-group to dispatch. */
+	void
+	set_resume(unsigned long idx)
+	{
+		wg_first = idx;
+	}
+
+	/** Stop enumeration at a given work-group.
+	 *
+	 * Must be called prior to kernel kick-off. Work-groups up to but not
+	 * including idx are dispatched. If the kernel has more work-groups,
+	 * the kernel ends once the clusters finished these.
+	 * @param idx Enumeration index of the first work-group not to
+	 * 	      dispatch. */
+	void
+	set_stop(unsigned long idx)
+	{
+		wg_stop = idx;
+	}
+
+	/** Return whether enumeration stopped before the last work-group.
+	 * @return True iff the kernel ended at the work-group set through
+	 * 	   set_stop(). */
+	bool
+	has_stopped(void) const
+	{
+		return stopped;
 	}
 
 	/** Copy the current set of stats to the provided compute stats object.
@@ -153,6 +269,22 @@ public:
 		s.wgs = stats.wgs;
 	}
 
+	/** Copy the stats for a single cluster to the provided compute stats
+	 * object.
+	 *
+	 * Execution and program load time are shared by all clusters. Thread
+	 * and work-group counts reflect the work dispatched to this cluster.
+	 * @param s Reference to a compute_stats object to store performance
+	 * 	    counter data into.
+	 * @param c Cluster index. */
+	void
+	get_stats(compute_stats &s, unsigned int c)
+	{
+		get_stats(s);
+		s.wgs = cluster_wgs[c];
+		s.threads = cluster_threads[c];
+	}
+
 	/** Compute the execution time in number of cycles. */
 	void
 	stats_set_cycle_time(void)
@@ -187,8 +319,10 @@ private:
 
 		t = getTiming(MC_DRAM_SPEED, MC_DRAM_ORG, MC_DRAM_BANKS / 4);
 
-		b = bursts(t, bytes, 1);
+		b = chan_bursts(t, bytes, 1);
 		dram_cycles = least_issue_delay_rd_ddr4(t, b, 1);
+		if (MC_DRAM_CHANS > 1)
+			dram_cycles += DRAM_CHAN_JOIN_CYCLES;
 
 		/* And convert to SimdCluster cycles
 		 * @todo Less static */
@@ -197,20 +331,63 @@ private:
 	}
 
 	/**
-	 * A separate thread for maintaining the cycle counter.
+	 * A separate process for maintaining the cycle counter.
 	 *
 	 * This way we can block in thread_lt() on fifo writes without worries.
+	 * The counter increments one delta cycle after the clock edge.
 	 */
 	void
-	thread_cycle_counter(void)
+	method_cycle_counter(void)
 	{
-		while (true) {
-			wait();
-			wait(SC_ZERO_TIME);
-			cycle++;
+		if (!cycle_delta) {
+			cycle_delta = true;
+			next_trigger(SC_ZERO_TIME);
+			return;
+		}
+
+		cycle_delta = false;
+		cycle++;
+
+		/* Count the edges a gated clock skipped since. */
+		if (clk) {
+			cycle += clk->get_skipped() - clk_skipped;
+			clk_skipped = clk->get_skipped();
 		}
 	}
 
+	/** Return the number of work-groups a kernel is enumerated into.
+	 * @param w Work specification.
+	 * @return Number of work-groups. */
+	unsigned long
+	count_wgs(work<XLAT_ENTRIES> &w)
+	{
+		unsigned long wgs_x, wgs_y;
+
+		wgs_x = (w.dims[0] + (32 << w.wg_width) - 1) >>
+				(w.wg_width + 5);
+		wgs_y = (w.dims[1] + (THREADS >> (w.wg_width + 5)) - 1) /
+				(THREADS >> (w.wg_width + 5));
+
+		return wgs_x * wgs_y;
+	}
+
+	/** Advance to the next work-group in enumeration order.
+	 * @param w Work specification.
+	 * @param x X offset in multiples of 32 threads, updated.
+	 * @param y Y offset, updated.
+	 * @return False iff all work-groups have been enumerated. */
+	bool
+	next_wg(work<XLAT_ENTRIES> &w, unsigned int &x, unsigned int &y)
+	{
+		x += (1 << w.wg_width);
+		if ((x << 5) >= w.dims[0]) {
+			x = 0;
+			y += (THREADS >> (w.wg_width + 5));
+		}
+
+		return y < w.dims[1];
+	}
+
 	/** Perform a reset */
 	void
 	do_rst(void)
@@ -220,6 +397,21 @@ private:
 		out_xlat_w.write(false);
 	}
 
+	/** Return whether all clusters finished execution.
+	 * @return True iff every cluster raised its in_exec_fini. */
+	bool
+	exec_fini(void)
+	{
+		unsigned int c;
+
+		for (c = 0; c < CLUSTERS; c++) {
+			if (!in_exec_fini[c].read())
+				return false;
+		}
+
+		return true;
+	}
+
 	/** Main thread. */
 	void
 	thread_lt(void)
@@ -231,6 +423,7 @@ private:
 		vector<Instruction>::iterator it;
 		unsigned int i, j;
 		unsigned long cycle_fini_upload;
+		unsigned long idx;
 
 		do_rst();
 
@@ -262,6 +455,17 @@ private:
 				y = 0;
 				pc = 0;
 				i = 0;
+				idx = 0;
+				cluster_next = 0;
+				stopped = false;
+
+				if (sampling)
+					sampling->reset(count_wgs(work));
+
+				/* Resume: clusters are assigned round-robin in
+				 * enumeration order. */
+				for (; idx < wg_first && next_wg(work, x, y); idx++);
+				cluster_next = idx % CLUSTERS;
 
 				assert((32 << work.wg_width) <= THREADS);
 
@@ -318,27 +522,41 @@ private:
 
 				/* fall-through */
 			case WS_STATE_ENUM_WGS:
+				/* The last work-group is always sampled. */
+				while (sampling && !sampling->is_sampled(idx)) {
+					sampling->skip(x, y);
+					idx++;
+					next_wg(work, x, y);
+				}
+
 				wg.off_x = x;
 				wg.off_y = y;
-				out_wg.write(wg);
+				wg.idx = idx;
+				out_wg[cluster_next].write(wg);
+
+				if (sampling)
+					sampling->dispatch(idx, cycle);
+				idx++;
 
 				stats.threads += LANES * (wg.last_warp + 1);
 				stats.wgs++;
+				cluster_wgs[cluster_next]++;
+				cluster_threads[cluster_next] +=
+						LANES * (wg.last_warp + 1);
+				cluster_next = (cluster_next + 1) % CLUSTERS;
 
-				x += (1 << work.wg_width);
-				if ((x << 5) >= work.dims[0]) {
-					x = 0;
-					y += (THREADS >> (work.wg_width + 5));
-				}
-
-				if (y >= work.dims[1]) {
+				if (!next_wg(work, x, y)) {
+					out_end_prg.write(true);
+					state = WS_STATE_WAIT_FINI;
+				} else if (wg_stop && idx >= wg_stop) {
+					stopped = true;
 					out_end_prg.write(true);
 					state = WS_STATE_WAIT_FINI;
 				}
 
 				break;
 			case WS_STATE_WAIT_FINI:
-				if (in_exec_fini.read()) {
+				if (exec_fini()) {
 					state = WS_STATE_IDLE;
 					stats_set_cycle_time();
 				}
@@ -19,10 +19,12 @@
 #ifndef COMPUTE_MODEL_COMPUTE_STATS_H
 #define COMPUTE_MODEL_COMPUTE_STATS_H
 
+#include <algorithm>
 #include <ostream>
 #include <iomanip>
 
 #include "isa/model/Instruction.h"
+#include "util/defaults.h"
 
 using namespace std;
 
@@ -52,7 +54,8 @@ public:
 	unsigned long dram_active; /**< Number of active cycles of DRAM */
 	unsigned long compute_active; /**< Number of cycles compute was
 				       * active. */
-	unsigned long sp_active[2]; /**< Cycles each SP is active. */
+	unsigned long sp_active[COMPUTE_WG_SLOTS]; /**< Cycles each SP is
+						    * active. */
 	unsigned long raw_stalls; /**< Number of RAW stall cycles. */
 	unsigned long rf_bank_conflict_stalls; /**< Number of stall cycles
 						* caused by regfile bank
@@ -76,6 +79,87 @@ public:
 	unsigned long commit_sc[isa_model::CAT_SENTINEL];  /**< \#Scalar insns.*/
 	unsigned long commit_nop;		/**< \#NOPs, pipeline bubbles. */
 
+	/** Aggregate the stats of another SimdCluster into this object.
+	 *
+	 * Execution and program load time are shared by all clusters and
+	 * hence retained. Activity counters are summed, expressing utilisation
+	 * in cluster-cycles: with N clusters the maximum is N*100%.
+	 * @param s Stats of another cluster executing the same kernel. */
+	void
+	aggregate(compute_stats const &s)
+	{
+		unsigned int i;
+
+		threads += s.threads;
+		wgs += s.wgs;
+		max_scoreboard_entries = max(max_scoreboard_entries,
+				s.max_scoreboard_entries);
+		dram_active += s.dram_active;
+		compute_active += s.compute_active;
+		for (i = 0; i < COMPUTE_WG_SLOTS; i++)
+			sp_active[i] += s.sp_active[i];
+		raw_stalls += s.raw_stalls;
+		rf_bank_conflict_stalls += s.rf_bank_conflict_stalls;
+		resource_busy_stalls += s.resource_busy_stalls;
+		dram_vrf_words_r += s.dram_vrf_words_r;
+		dram_vrf_words_w += s.dram_vrf_words_w;
+		dram_vrf_net_words_r += s.dram_vrf_net_words_r;
+		dram_vrf_net_words_w += s.dram_vrf_net_words_w;
+
+		for (i = 0; i < isa_model::CAT_SENTINEL; i++) {
+			commit_vec[i] += s.commit_vec[i];
+			commit_sc[i] += s.commit_sc[i];
+		}
+		commit_nop += s.commit_nop;
+	}
+
+	/** Accumulate the stats of the simulation preceding a checkpoint this
+	 * simulation resumed from.
+	 *
+	 * The resumed simulation loads the program anew, which the
+	 * preceding simulation already accounted for.
+	 * @param s Stats of the same cluster up to the checkpoint. */
+	void
+	resume(compute_stats const &s)
+	{
+		exec_time = s.exec_time + exec_time - prg_load_time;
+		prg_load_time = s.prg_load_time;
+		aggregate(s);
+	}
+
+	/** Scale all counters by f, extrapolating from a sample of the
+	 * work-groups to all work-groups.
+	 *
+	 * Execution and program load time, the thread and work-group counts
+	 * and the scoreboard high-water mark are retained. The caller must
+	 * provide these separately.
+	 * @param f Scaling factor. */
+	void
+	scale(double f)
+	{
+		unsigned int i;
+
+		dram_active = (unsigned long) (dram_active * f);
+		compute_active = (unsigned long) (compute_active * f);
+		for (i = 0; i < COMPUTE_WG_SLOTS; i++)
+			sp_active[i] = (unsigned long) (sp_active[i] * f);
+		raw_stalls = (unsigned long) (raw_stalls * f);
+		rf_bank_conflict_stalls =
+			(unsigned long) (rf_bank_conflict_stalls * f);
+		resource_busy_stalls =
+			(unsigned long) (resource_busy_stalls * f);
+		dram_vrf_words_r = (unsigned long) (dram_vrf_words_r * f);
+		dram_vrf_words_w = (unsigned long) (dram_vrf_words_w * f);
+		dram_vrf_net_words_r = (unsigned long) (dram_vrf_net_words_r * f);
+		dram_vrf_net_words_w = (unsigned long) (dram_vrf_net_words_w * f);
+
+		for (i = 0; i < isa_model::CAT_SENTINEL; i++) {
+			commit_vec[i] = (unsigned long) (commit_vec[i] * f);
+			commit_sc[i] = (unsigned long) (commit_sc[i] * f);
+		}
+		commit_nop = (unsigned long) (commit_nop * f);
+	}
+
 	/** SystemC mandatory print stream operation.
 	 * @param os Output stream
 	 * @param stats Reference to statistics object to print.
@@ -86,8 +170,7 @@ public:
 		unsigned int i;
 		double compute_util = std::numeric_limits<double>::quiet_NaN();
 		double dram_util = std::numeric_limits<double>::quiet_NaN();
-		double sp0_util = std::numeric_limits<double>::quiet_NaN();
-		double sp1_util = std::numeric_limits<double>::quiet_NaN();
+		double sp_util[COMPUTE_WG_SLOTS];
 
 		unsigned long commit_vec = 0ul;
 		unsigned long commit_vec_ops = 0ul;
@@ -99,8 +182,12 @@ public:
 		if (stats.exec_time) {
 			compute_util = ((double) stats.compute_active * 100) / ((double) stats.exec_time);
 			dram_util = ((double) stats.dram_active * 100) / ((double) stats.exec_time);
-			sp0_util = ((double) stats.sp_active[0] * 100) / ((double) stats.exec_time);
-			sp1_util = ((double) stats.sp_active[1] * 100) / ((double) stats.exec_time);
+		}
+
+		for (i = 0; i < COMPUTE_WG_SLOTS; i++) {
+			sp_util[i] = std::numeric_limits<double>::quiet_NaN();
+			if (stats.exec_time)
+				sp_util[i] = ((double) stats.sp_active[i] * 100) / ((double) stats.exec_time);
 		}
 
 		for (i = 0; i < isa_model::CAT_SENTINEL; i++) {
@@ -122,8 +209,8 @@ public:
 		os << "# Work-groups              :" << setw(10) << stats.wgs << endl;
 		os << "# scoreboard entries (max) :" << setw(10) << stats.max_scoreboard_entries << endl;
 		os << "DRAM active (compute cycs) :" << setw(10) << stats.dram_active << " (" << dram_util << "%)" << endl;
-		os << "SP0 active (compute cycs)  :" << setw(10) << stats.sp_active[0] << " (" << sp0_util << "%)" << endl;
-		os << "SP1 active (compute cycs)  :" << setw(10) << stats.sp_active[1] << " (" << sp1_util << "%)" << endl;
+		for (i = 0; i < COMPUTE_WG_SLOTS; i++)
+			os << "SP" << i << " active (compute cycs)  :" << setw(10) << stats.sp_active[i] << " (" << sp_util[i] << "%)" << endl;
 		os << "Compute active cycles      :" << setw(10) << stats.compute_active << " (" << compute_util << "%)" << endl;
 		os << endl;
 		os << "= Performance counters - commit stage" << endl;
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPUTE_MODEL_CTRLSTACK_H
+#define COMPUTE_MODEL_CTRLSTACK_H
+
+#include <cassert>
+#include <systemc>
+
+#include "compute/model/ctrlstack_entry.h"
+#include "util/constmath.h"
+
+using namespace sc_dt;
+
+namespace compute_model {
+
+/**
+ * Control stack of a single work-group.
+ *
+ * Holds the push and pop semantics of the control stack. The CtrlStack module
+ * keeps one per work-group slot, the functional simulator one per work-group
+ * in flight.
+ * @param THREADS Number of threads in a work-group.
+ * @param PC_WIDTH Width of the program counter in bits.
+ * @param ENTRIES Max. number of stack entries.
+ */
+template <unsigned int THREADS, unsigned int PC_WIDTH, unsigned int ENTRIES>
+class ctrlstack {
+private:
+	/** Storage for stack entries. */
+	ctrlstack_entry<THREADS,PC_WIDTH> stack[ENTRIES];
+
+	/** Stack pointer. */
+	sc_uint<const_log2(ENTRIES) + 1> sp;
+
+public:
+	/** Constructor. Creates an empty stack. */
+	ctrlstack() : sp(0) {}
+
+	/** Remove all entries. */
+	void
+	reset(void)
+	{
+		sp = 0;
+	}
+
+	/** Push an entry.
+	 * @param e Entry to push.
+	 * @return False iff the stack is full, in which case nothing is
+	 * 	   pushed. */
+	bool
+	push(const ctrlstack_entry<THREADS,PC_WIDTH> &e)
+	{
+		if (sp == ENTRIES)
+			return false;
+
+		stack[sp] = e;
+		sp++;
+
+		return true;
+	}
+
+	/** Pop the top entry.
+	 * @return False iff the stack is empty. */
+	bool
+	pop(void)
+	{
+		if (sp == 0)
+			return false;
+
+		sp--;
+
+		return true;
+	}
+
+	/** Return the top entry.
+	 * @return The top entry. Only valid if the stack is not empty. */
+	const ctrlstack_entry<THREADS,PC_WIDTH> &
+	top(void) const
+	{
+		assert(sp > 0);
+
+		return stack[sp - 1];
+	}
+
+	/** Return the number of entries on the stack.
+	 * @return The stack pointer. */
+	sc_uint<const_log2(ENTRIES) + 1>
+	size(void) const
+	{
+		return sp;
+	}
+
+	/** Return whether the stack is empty.
+	 * @return True iff the stack holds no entries. */
+	bool
+	empty(void) const
+	{
+		return sp == 0;
+	}
+
+	/** Return whether the stack is full.
+	 * @return True iff a push would overflow. */
+	bool
+	full(void) const
+	{
+		return sp == ENTRIES;
+	}
+};
+
+}
+
+#endif /* COMPUTE_MODEL_CTRLSTACK_H */
@@ -19,8 +19,11 @@
 #ifndef COMPUTE_MODEL_CTRLSTACK_ENTRY_H
 #define COMPUTE_MODEL_CTRLSTACK_ENTRY_H
 
+#include <cassert>
+#include <cstdint>
 #include <systemc>
 
+#include "isa/model/Instruction.h"
 #include "isa/model/Operand.h"
 
 using namespace sc_core;
@@ -61,6 +64,80 @@ public:
 	ctrlstack_entry(sc_bv<THREADS> pm, sc_uint<PC_WIDTH> p, sc_uint<2> mt)
 	: pred_mask(pm), pc(p), mask_type(mt) {}
 
+	/** Return the mask type pushed by a CPUSH sub-operation.
+	 * @param subop CPUSH sub-operation.
+	 * @return Control mask (VSP_CTRL_*) the entry restores upon pop. */
+	static sc_uint<2>
+	cpush_mask_type(ISASubOpCPUSH subop)
+	{
+		switch (subop) {
+		case CPUSH_BRK:
+			return VSP_CTRL_BREAK;
+		case CPUSH_RET:
+			return VSP_CTRL_RET;
+		case CPUSH_IF:
+			return VSP_CTRL_RUN;
+		default:
+			assert(false);
+			return VSP_CTRL_RUN;
+		}
+	}
+
+	/** Store a range of lanes in the predicate mask.
+	 *
+	 * Ranges aligned to 32 lanes are stored a word at a time.
+	 * @param offset First lane.
+	 * @param pred Predicate per lane, non-zero iff set.
+	 * @param n Number of lanes. */
+	template <typename T>
+	void
+	set_pred(unsigned int offset, const T *pred, unsigned int n)
+	{
+		unsigned int l;
+		unsigned int b;
+		uint32_t w;
+
+		if ((offset | n) & 31) {
+			for (l = 0; l < n; l++)
+				pred_mask[offset + l] = (pred[l] ? 1 : 0);
+			return;
+		}
+
+		for (l = 0; l < n; l += 32) {
+			w = 0u;
+			for (b = 0; b < 32; b++)
+				w |= (pred[l + b] ? 1u : 0u) << b;
+			pred_mask.set_word((offset + l) / 32, w);
+		}
+	}
+
+	/** Load a range of lanes from the predicate mask.
+	 *
+	 * Ranges aligned to 32 lanes are loaded a word at a time.
+	 * @param offset First lane.
+	 * @param pred Output, 1 or 0 per lane.
+	 * @param n Number of lanes. */
+	template <typename T>
+	void
+	get_pred(unsigned int offset, T *pred, unsigned int n) const
+	{
+		unsigned int l;
+		unsigned int b;
+		uint32_t w;
+
+		if ((offset | n) & 31) {
+			for (l = 0; l < n; l++)
+				pred[l] = pred_mask[offset + l] ? 1 : 0;
+			return;
+		}
+
+		for (l = 0; l < n; l += 32) {
+			w = pred_mask.get_word((offset + l) / 32);
+			for (b = 0; b < 32; b++)
+				pred[l + b] = (w >> b) & 1u;
+		}
+	}
+
 	/** SystemC mandatory print stream operation
 	 * @param os Output stream.
 	 * @param v Object to print.
@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPUTE_MODEL_OPERAND_BUS_H
+#define COMPUTE_MODEL_OPERAND_BUS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <systemc>
+
+using namespace sc_core;
+
+namespace compute_model {
+
+/**
+ * One operand for all lanes, as read from the register file in a single cycle.
+ *
+ * Carried over a single port rather than one port per lane, such that a
+ * register read costs one signal write and one update request rather than
+ * LANES of each.
+ */
+template <unsigned int LANES = 32>
+class operand_bus {
+public:
+	/** Register contents, one word per lane. */
+	alignas(64) uint32_t data[LANES];
+
+	/** Default constructor. */
+	operand_bus()
+	{
+		memset(data, 0, sizeof(data));
+	}
+
+	/** Lane accessor.
+	 * @param l Lane.
+	 * @return Reference to the word for lane l. */
+	inline uint32_t &
+	operator[](unsigned int l)
+	{
+		return data[l];
+	}
+
+	/** Lane accessor.
+	 * @param l Lane.
+	 * @return Word for lane l. */
+	inline uint32_t
+	operator[](unsigned int l) const
+	{
+		return data[l];
+	}
+
+	/** Write the same value to all lanes.
+	 * @param v Value to broadcast. */
+	inline void
+	broadcast(uint32_t v)
+	{
+		unsigned int l;
+
+		for (l = 0; l < LANES; l++)
+			data[l] = v;
+	}
+
+	/** SystemC mandatory print stream operation
+	 * @param os Output stream.
+	 * @param v Object to print.
+	 * @return The updated output stream.*/
+	inline friend std::ostream&
+	operator<<(std::ostream& os, operand_bus<LANES> const &v)
+	{
+		unsigned int l;
+
+		os << "operand_bus(";
+		for (l = 0; l < LANES; l++)
+			os << (l ? "," : "") << v.data[l];
+		os << ")";
+
+		return os;
+	}
+
+	/** SystemC mandatory trace output.
+	 * @param tf Reference to trace file.
+	 * @param v Operand bus to print.
+	 * @param NAME Name of the SystemC object.
+	 */
+	inline friend void
+	sc_trace(sc_trace_file *tf, const operand_bus<LANES> &v,
+			const std::string &NAME)
+	{
+		unsigned int l;
+
+		for (l = 0; l < LANES; l++)
+			sc_trace(tf, v.data[l], NAME + ".data_" + std::to_string(l));
+	}
+
+	/** Comparator.
+	 * @param v Object to compare to this.
+	 * @return true iff objects are equal.
+	 */
+	inline bool
+	operator==(const operand_bus<LANES> &v) const
+	{
+		return !memcmp(data, v.data, sizeof(data));
+	}
+};
+
+}
+
+#endif /* COMPUTE_MODEL_OPERAND_BUS_H */
@@ -0,0 +1,360 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPUTE_MODEL_WG_SAMPLING_H
+#define COMPUTE_MODEL_WG_SAMPLING_H
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <iomanip>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace compute_model {
+
+/** Two-sided 95% quantile of the standard normal distribution. */
+#define WG_SAMPLING_Z95 1.96
+
+/** Callback reading the DRAM counters at a work-group dispatch.
+ * @param bytes Number of bytes transferred by DRAM so far.
+ * @param acts Number of activate commands issued so far. */
+typedef void (*wg_sampling_dram_probe)(unsigned long &bytes,
+		unsigned long &acts);
+
+/** Work-group sampling policy, and the measurements taken under it.
+ *
+ * Work-groups are identified by their index in WorkScheduler enumeration
+ * order. The first FIRST work-groups, every PERIOD-th work-group and the last
+ * work-group are sampled: simulated cycle-accurately. The WorkScheduler skips
+ * all other work-groups, they must be fast-forwarded functionally afterwards.
+ *
+ * Work-groups of a kernel are assumed to be homogeneous. The cost of a
+ * skipped work-group is estimated from the intervals between dispatching two
+ * consecutive sampled work-groups. Intervals ending in one of the first FIRST
+ * work-groups cover pipeline fill and are excluded, unless fewer than two
+ * intervals remain. The estimate comes with a confidence interval under a
+ * normal approximation. Performance counters are extrapolated linearly in the
+ * number of work-groups.
+ *
+ * With a DRAM probe attached, the DRAM bytes and activate counters are read at
+ * every sampled dispatch as well. Their increments over the same intervals
+ * give a confidence interval for the extrapolated DRAM traffic. DRAM energy is
+ * only known at the end of a simulation, it has no confidence interval.
+ */
+class wg_sampling {
+private:
+	/** Number of leading work-groups sampled. */
+	unsigned long first;
+
+	/** Sample every period-th work-group, 0 to disable sampling. */
+	unsigned long period;
+
+	/** Number of work-groups in the kernel. */
+	unsigned long total;
+
+	/** Enumeration index of each sampled work-group, in dispatch order. */
+	vector<unsigned long> sampled;
+
+	/** Compute cycle in which each sampled work-group was dispatched. */
+	vector<unsigned long> dispatched;
+
+	/** Offsets (x in multiples of 32 threads, y) of skipped work-groups. */
+	vector<pair<unsigned int, unsigned int> > skipped;
+
+	/** DRAM probe, nullptr if DRAM counters are not tracked. */
+	wg_sampling_dram_probe dram_probe;
+
+	/** DRAM bytes transferred when each sampled work-group was
+	 * dispatched. */
+	vector<unsigned long> dram_bytes;
+
+	/** DRAM activates issued when each sampled work-group was
+	 * dispatched. */
+	vector<unsigned long> dram_acts;
+
+	/** Compute the mean and sample variance of the increments of a counter
+	 * between consecutive sampled dispatches.
+	 * @param v Counter value at each sampled dispatch.
+	 * @param mean Mean increment.
+	 * @param var Sample variance of the increments.
+	 * @return Number of increments taken into account. */
+	unsigned long
+	intervals(const vector<unsigned long> &v, double &mean,
+			double &var) const
+	{
+		unsigned long i;
+		unsigned long n;
+		unsigned long skip;
+		double d;
+
+		mean = numeric_limits<double>::quiet_NaN();
+		var = numeric_limits<double>::quiet_NaN();
+
+		/* Exclude the pipeline fill if enough samples remain. */
+		skip = 0ul;
+		for (i = 1; i < sampled.size(); i++) {
+			if (sampled[i] < first)
+				skip++;
+		}
+
+		if (v.size() < skip + 3)
+			skip = 0ul;
+
+		n = 0ul;
+		mean = 0.;
+		for (i = skip + 1; i < v.size(); i++) {
+			mean += v[i] - v[i - 1];
+			n++;
+		}
+
+		if (n == 0)
+			return 0ul;
+		mean /= n;
+
+		if (n < 2)
+			return n;
+
+		var = 0.;
+		for (i = skip + 1; i < v.size(); i++) {
+			d = (v[i] - v[i - 1]) - mean;
+			var += d * d;
+		}
+		var /= (n - 1);
+
+		return n;
+	}
+
+	/** Compute the half-width of the 95% confidence interval of a counter
+	 * summed over all skipped work-groups.
+	 * @param v Counter value at each sampled dispatch.
+	 * @return Half-width of the confidence interval, NaN if fewer than two
+	 * 	   increments were measured. */
+	double
+	skipped_ci(const vector<unsigned long> &v) const
+	{
+		double mean;
+		double var;
+		unsigned long n;
+
+		if (skipped.size() == 0)
+			return 0.;
+
+		n = intervals(v, mean, var);
+		if (n < 2)
+			return numeric_limits<double>::quiet_NaN();
+
+		return WG_SAMPLING_Z95 * sqrt(var / n) * skipped.size();
+	}
+
+public:
+	/** Constructor.
+	 * @param k Number of leading work-groups sampled.
+	 * @param m Sample every m-th work-group, 0 to disable sampling. */
+	wg_sampling(unsigned long k = 0ul, unsigned long m = 0ul)
+	: first(k), period(m), total(0ul), dram_probe(nullptr) {}
+
+	/** Return whether sampling is enabled.
+	 * @return True iff work-groups may be skipped. */
+	bool
+	enabled(void) const
+	{
+		return period != 0ul;
+	}
+
+	/** Prepare for the enumeration of a new kernel.
+	 * @param wgs Number of work-groups in the kernel. */
+	void
+	reset(unsigned long wgs)
+	{
+		total = wgs;
+		sampled.clear();
+		dispatched.clear();
+		skipped.clear();
+		dram_bytes.clear();
+		dram_acts.clear();
+	}
+
+	/** Attach a probe reading the DRAM counters at each sampled dispatch.
+	 * @param p DRAM probe, nullptr to stop tracking DRAM counters. */
+	void
+	set_dram_probe(wg_sampling_dram_probe p)
+	{
+		dram_probe = p;
+	}
+
+	/** Return whether a work-group must be simulated cycle-accurately.
+	 * @param idx Enumeration index of the work-group.
+	 * @return True iff work-group idx is sampled. */
+	bool
+	is_sampled(unsigned long idx) const
+	{
+		if (!enabled())
+			return true;
+
+		return idx < first || idx + 1 >= total || (idx % period) == 0;
+	}
+
+	/** Record the dispatch of a sampled work-group.
+	 * @param idx Enumeration index of the work-group.
+	 * @param cycle Compute cycle of dispatch. */
+	void
+	dispatch(unsigned long idx, unsigned long cycle)
+	{
+		unsigned long bytes;
+		unsigned long acts;
+
+		sampled.push_back(idx);
+		dispatched.push_back(cycle);
+
+		if (dram_probe) {
+			dram_probe(bytes, acts);
+			dram_bytes.push_back(bytes);
+			dram_acts.push_back(acts);
+		}
+	}
+
+	/** Record a skipped work-group.
+	 * @param off_x Work-group offset in X-dimension, in multiples of 32
+	 * 	        threads.
+	 * @param off_y Work-group offset in Y-dimension. */
+	void
+	skip(unsigned int off_x, unsigned int off_y)
+	{
+		skipped.emplace_back(off_x, off_y);
+	}
+
+	/** Return the work-groups skipped.
+	 * @return Offsets of the skipped work-groups, in enumeration order. */
+	const vector<pair<unsigned int, unsigned int> > &
+	get_skipped(void) const
+	{
+		return skipped;
+	}
+
+	/** Return the factor by which to scale performance counters.
+	 * @return Total over sampled number of work-groups. */
+	double
+	factor(void) const
+	{
+		if (sampled.size() == 0)
+			return 1.;
+
+		return ((double) (sampled.size() + skipped.size())) /
+				((double) sampled.size());
+	}
+
+	/** Estimate the execution time of all work-groups.
+	 * @param exec_time Execution time of the sampled work-groups in
+	 * 		    compute cycles.
+	 * @param ci Half-width of the 95% confidence interval, NaN if fewer
+	 * 	     than two intervals were measured.
+	 * @return Estimated execution time in compute cycles. */
+	unsigned long
+	estimate_exec_time(unsigned long exec_time, double &ci) const
+	{
+		double mean;
+		double var;
+		unsigned long n;
+
+		n = intervals(dispatched, mean, var);
+		ci = numeric_limits<double>::quiet_NaN();
+
+		if (skipped.size() == 0) {
+			ci = 0.;
+			return exec_time;
+		}
+
+		if (n == 0)
+			return exec_time;
+
+		if (n >= 2)
+			ci = WG_SAMPLING_Z95 * sqrt(var / n) * skipped.size();
+
+		return exec_time + (unsigned long) (mean * skipped.size());
+	}
+
+	/** Return the confidence interval of the DRAM bytes transferred by the
+	 * skipped work-groups.
+	 * @return Half-width of the 95% confidence interval in bytes, NaN if
+	 * 	   no DRAM probe is attached or fewer than two intervals were
+	 * 	   measured. */
+	double
+	dram_bytes_ci(void) const
+	{
+		return skipped_ci(dram_bytes);
+	}
+
+	/** Return the confidence interval of the DRAM activates issued by the
+	 * skipped work-groups.
+	 * @return Half-width of the 95% confidence interval, NaN if no DRAM
+	 * 	   probe is attached or fewer than two intervals were
+	 * 	   measured. */
+	double
+	dram_acts_ci(void) const
+	{
+		return skipped_ci(dram_acts);
+	}
+
+	/** Print the sampling report.
+	 * @param os Output stream.
+	 * @param s Sampling object to print.
+	 * @return Output stream. */
+	inline friend ostream &
+	operator<<(ostream &os, wg_sampling const &s)
+	{
+		double mean;
+		double var;
+		unsigned long n;
+		unsigned long i, j;
+
+		n = s.intervals(s.dispatched, mean, var);
+
+		os << "=== Work-group sampling ===" << endl;
+		os << "Sampled work-groups        :" << setw(10) <<
+				s.sampled.size() << " of " <<
+				(s.sampled.size() + s.skipped.size()) << endl;
+		os << "Policy                     : first " << s.first <<
+				", every " << s.period << "-th, last" << endl;
+		os << "WG dispatch interval (cycs):" << setw(10) << mean <<
+				" (stddev " << sqrt(var) << ", n=" << n << ")" <<
+				endl;
+
+		/* Enumeration indexes, consecutive runs collapsed. */
+		os << "Sampled WG indexes         : ";
+		for (i = 0; i < s.sampled.size(); i = j) {
+			for (j = i + 1; j < s.sampled.size() &&
+					s.sampled[j] == s.sampled[j - 1] + 1; j++);
+
+			if (i)
+				os << ",";
+			os << s.sampled[i];
+			if (j - 1 > i)
+				os << "-" << s.sampled[j - 1];
+		}
+		os << endl;
+
+		return os;
+	}
+};
+
+}
+
+#endif /* COMPUTE_MODEL_WG_SAMPLING_H */
@@ -254,6 +254,9 @@ public:
 	 * Y = THREADS / width. */
 	sc_uint<const_log2(THREADS/LANES)> last_warp;
 
+	/** Index of this workgroup in WorkScheduler enumeration order. */
+	unsigned long idx;
+
 	/** @todo Convey the number of threads active. Do they start counting
 	 * from lane 0, or do we need to send a mask instead? */
 
@@ -261,8 +264,9 @@ public:
 	inline friend std::ostream&
 	operator<<(std::ostream& os, workgroup<THREADS,LANES> const &v)
 	{
-		os << "workgroup(THREADS: " << (LANES * (v.last_warp + 1)) <<
-				"; "<< (32 * v.off_x) << "," << v.off_y << ")";
+		os << "workgroup(#" << v.idx << " THREADS: " <<
+				(LANES * (v.last_warp + 1)) << "; " <<
+				(32 * v.off_x) << "," << v.off_y << ")";
 		return os;
 	}
 
@@ -302,6 +306,7 @@ public:
 		off_x = v.off_x;
 		off_y = v.off_y;
 		last_warp = v.last_warp;
+		idx = v.idx;
 		return *this;
 	}
 };
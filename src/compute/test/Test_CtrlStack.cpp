@@ -51,7 +51,7 @@ public:
 	/** (Synchronous) reset. */
 	sc_inout<bool> out_rst{"out_rst"};
 
-	sc_inout<sc_uint<1> > out_wg{"out_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg{"out_wg"};
 
 	/** Action to perform this cycle (push, pop). */
 	sc_inout<ctrlstack_action> out_action;
@@ -186,7 +186,7 @@ int
 sc_main(int argc, char* argv[])
 {
 	sc_signal<bool> rst;
-	sc_signal<sc_uint<1> > wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > wg;
 	sc_signal<ctrlstack_action> action;
 	sc_signal<ctrlstack_entry<COMPUTE_THREADS,11> > entry;
 	sc_signal<ctrlstack_entry<COMPUTE_THREADS,11> > top;
@@ -68,7 +68,7 @@ public:
 	sc_inout<sc_uint<PC_WIDTH> > out_pc{"out_pc"};
 
 	/** Currently active workgroup. */
-	sc_inout<sc_uint<1> > out_wg{"out_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg{"out_wg"};
 
 	/** Width of workgroups for running kernel. */
 	sc_inout<workgroup_width> out_wg_width{"out_wg_width"};
@@ -105,7 +105,7 @@ public:
 				{"in_enqueue_sb_cstack_write"};
 
 	/** Enqueue a control stack write to the scoreboard. */
-	sc_in<sc_uint<1> > in_enqueue_sb_cstack_wg
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_enqueue_sb_cstack_wg
 				{"in_enqueue_sb_cstack_wg"};
 
 	/** True iff CPOPs must stall (until all scoreboard entries have been
@@ -119,7 +119,7 @@ public:
 	sc_inout<sc_bv<32> > out_entries_pop[2];
 
 	/** Currently active workgroup. */
-	sc_in<sc_uint<1> > in_wg{"in_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg{"in_wg"};
 
 	/** Column to write result of instruction to. Used for IExecute and
 	 * write mask retrieval. */
@@ -395,7 +395,7 @@ sc_main(int argc, char* argv[])
 {
 	sc_signal<Instruction> insn;
 	sc_signal<sc_uint<11> > pc;
-	sc_signal<sc_uint<1> > iwarp;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > iwarp;
 	sc_signal<workgroup_width> wg_width;
 	sc_signal<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> > last_warp[2];
 	sc_signal<sc_bv<2> > thread_active;
@@ -408,11 +408,11 @@ sc_main(int argc, char* argv[])
 	sc_signal<bool> ssp_match;
 	sc_signal<bool> enqueue_sb;
 	sc_signal<bool> enqueue_sb_cstack_write;
-	sc_signal<sc_uint<1> > enqueue_sb_cstack_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > enqueue_sb_cstack_wg;
 	sc_signal<bool> sb_cpop_stall[2];
 	sc_signal<Register<COMPUTE_THREADS/COMPUTE_FPUS> > req_w_sb;
 	sc_signal<sc_bv<32> > entries_pop[2];
-	sc_signal<sc_uint<1> > o_warp;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > o_warp;
 	sc_signal<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> > col_w;
 	sc_signal<sc_uint<const_log2(COMPUTE_FPUS/COMPUTE_RCPUS)> > subcol_w;
 	sc_signal<bool> stall_f, pipe_flush;
@@ -56,7 +56,7 @@ public:
 	sc_inout<Instruction> out_insn{"out_insn"};
 
 	/** Workgroup associated with this instruction */
-	sc_inout<sc_uint<1> > out_wg{"out_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg{"out_wg"};
 
 	/** Identifier of currently active warp - important for write-back. */
 	sc_inout<sc_uint<const_log2(THREADS/FPUS)> > out_col_w{"out_col_w"};
@@ -93,7 +93,7 @@ public:
 	sc_in<Register<THREADS/FPUS> > in_req_w{"in_req_w"};
 
 	/** Workgroup for which the write mask should be ready next cycle */
-	sc_in<sc_uint<1> > in_wg_w{"in_wg_w"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg_w{"in_wg_w"};
 
 	/** Output of instruction. For scalar, result in lane 0. */
 	sc_in<sc_uint<32> > in_data_w[FPUS];
@@ -828,7 +828,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<sc_uint<11> > pc;
 	sc_signal<Instruction> insn;
 	sc_signal<bool> insn_valid;
-	sc_signal<sc_uint<1> > wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > wg;
 	sc_signal<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> > col_w;
 	sc_signal<sc_uint<const_log2(COMPUTE_FPUS/COMPUTE_RCPUS)> > subcol_w;
 	sc_signal<sc_uint<32> > operand[3][COMPUTE_FPUS];
@@ -840,7 +840,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<bool> w;
 	sc_signal<bool> dequeue_sb;
 	sc_signal<bool> ignore_mask_w;
-	sc_signal<sc_uint<1> > wg_w;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > wg_w;
 	sc_fifo<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> >
 				col_mask_w(1);
 	sc_signal<ctrlstack_action> cstack_action;
@@ -53,16 +53,16 @@ public:
 	sc_inout<sc_uint<PC_WIDTH> > out_pc_w{"out_pc_w"};
 
 	/** WG to overwrite PC for. */
-	sc_inout<sc_uint<1> > out_pc_wg_w{"out_pc_wg_w"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_pc_wg_w{"out_pc_wg_w"};
 
 	/** Out PC, connecting to IMem input. */
 	sc_fifo_in<imem_request<PC_WIDTH> > in_insn_r{"in_insn_r"};
 
 	/** Currently active workgroup */
-	sc_in<sc_uint<1> > in_wg{"in_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg{"in_wg"};
 
 	/** Workgroup to reset PC for. */
-	sc_inout<sc_uint<1> > out_pc_rst_wg{"pc_rst_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_pc_rst_wg{"pc_rst_wg"};
 
 	/** Boolean: true iff PC for wg in in_pc_rst_wg must be reset. */
 	sc_inout<bool> out_pc_rst{"pc_rst"};
@@ -141,12 +141,12 @@ sc_main(int argc, char* argv[])
 	sc_signal<bool> stall_d;
 	sc_signal<sc_uint<11> > pc_w;
 	sc_fifo<imem_request<11> > insn_r(1);
-	sc_signal<sc_uint<1> > wg;
-	sc_signal<sc_uint<1> > pc_wg_w;
-	sc_signal<sc_uint<1> > i_pc_wg_w;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > pc_wg_w;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > i_pc_wg_w;
 	sc_signal<workgroup_state> wg_state[2];
 	sc_signal<sc_bv<2> > wg_finished;
-	sc_signal<sc_uint<1> > pc_rst_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > pc_rst_wg;
 	sc_signal<bool> pc_rst;
 	sc_signal<sc_bv<WSS_SENTINEL> > sched_opts;
 
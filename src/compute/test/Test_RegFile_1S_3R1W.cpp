@@ -68,7 +68,7 @@ public:
 	sc_inout<sc_uint<const_log2(THREADS/LANES)> > out_last_warp[2];
 
 	/** Workgroup associated with write mask. */
-	sc_inout<sc_uint<1> > out_wg_mask_w{"out_wg_mask_w"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_wg_mask_w{"out_wg_mask_w"};
 
 	/** Column for reading the special mask registers */
 	sc_fifo_out<sc_uint<const_log2(THREADS/LANES)> >
@@ -92,7 +92,7 @@ public:
 	sc_inout<bool> out_cmask_rst{"in_cmask_rst"};
 
 	/** Workgroup to reset CMASK for */
-	sc_inout<sc_uint<1> > out_cmask_rst_wg{"in_cmask_rst_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_cmask_rst_wg{"in_cmask_rst_wg"};
 
 	/** Workgroup offsets (X, Y) */
 	sc_inout<sc_uint<32> > out_wg_off[2][2];
@@ -557,7 +557,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<sc_uint<const_log2(64)> > row_w;
 	sc_signal<sc_uint<32> > data_w[COMPUTE_FPUS];
 	sc_signal<sc_bv<COMPUTE_FPUS> > mask_w;
-	sc_signal<sc_uint<1> > wg_mask_w;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > wg_mask_w;
 	sc_fifo<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> > col_mask_w(1);
 	sc_signal<sc_bv<COMPUTE_FPUS> > o_mask_w;
 	sc_signal<bool> w;
@@ -566,7 +566,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<bool> ignore_mask_w;
 	sc_signal<sc_uint<const_log2(COMPUTE_THREADS/COMPUTE_FPUS)> > last_warp[2];
 	sc_signal<bool> cmask_rst;
-	sc_signal<sc_uint<1> > cmask_rst_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > cmask_rst_wg;
 	sc_signal<sc_uint<32> > wg_off[2][2];
 	sc_signal<sc_uint<32> > dim[2];
 	sc_signal<workgroup_width> wg_width;
@@ -592,7 +592,7 @@ sc_main(int argc, char* argv[])
 	sc_clock clk("clk", sc_time(10./12., SC_NS));
 	sc_clock clk_dram("clk_dram", sc_time(10./16., SC_NS));
 
-	RegFile<COMPUTE_THREADS,COMPUTE_FPUS,MC_BUS_WIDTH,SP_BUS_WIDTH> my_regfile("my_regfile");
+	RegFile<COMPUTE_THREADS,COMPUTE_FPUS,MC_BUS_WIDTH,SP_BUS_WIDTH,1> my_regfile("my_regfile");
 	my_regfile.in_clk(clk);
 	my_regfile.in_clk_dram(clk_dram);
 	my_regfile.in_req_r(req);
@@ -617,8 +617,8 @@ sc_main(int argc, char* argv[])
 	my_regfile.in_dim[0](dim[0]);
 	my_regfile.in_dim[1](dim[1]);
 	my_regfile.in_wg_width(wg_width);
-	my_regfile.in_dram_store_mask(dram_store_mask);
-	my_regfile.out_dram_store_mask(dram_store_mask_o);
+	my_regfile.in_dram_store_mask[0](dram_store_mask);
+	my_regfile.out_dram_store_mask[0](dram_store_mask_o);
 
 	for (unsigned int i = 0; i < 2; i++) {
 		my_regfile.in_sp_store_mask[i](store_mask[i]);
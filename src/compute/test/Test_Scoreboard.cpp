@@ -50,13 +50,13 @@ public:
 	sc_inout<bool> out_dequeue_cstack_write{"out_dequeue_cstack_write"};
 
 	/** WG to consume CSTACK entry from. */
-	sc_inout<sc_uint<1> > out_dequeue_cstack_wg{"out_dequeue_cstack_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_dequeue_cstack_wg{"out_dequeue_cstack_wg"};
 
 	/** Add a CSTACK write entry. */
 	sc_in<bool> out_enqueue_cstack_write{"out_enqueue_cstack_write"};
 
 	/** WG to add CSTACK write entry for. */
-	sc_in<sc_uint<1> > out_enqueue_cstack_wg{"out_enqueue_cstack_wg"};
+	sc_in<sc_uint<COMPUTE_WG_WIDTH> > out_enqueue_cstack_wg{"out_enqueue_cstack_wg"};
 
 	/** Wait with issuing a CPOP, there's CSTACK writes in progress. */
 	sc_in<bool> in_cpop_stall[2];
@@ -89,7 +89,7 @@ public:
 	sc_inout<bool> out_entries_disable{"out_entries_disable"};
 
 	/** Workgroup for which entries should be disabled. */
-	sc_inout<sc_uint<1> > out_entries_disable_wg{"out_entries_disable_wg"};
+	sc_inout<sc_uint<COMPUTE_WG_WIDTH> > out_entries_disable_wg{"out_entries_disable_wg"};
 
 	/** Constructor */
 	SC_CTOR(Test_Scoreboard) : scoreboard_entries(8)
@@ -220,9 +220,9 @@ main(int argc, char **argv)
 	sc_signal<bool> dequeue;
 	sc_signal<bool> enqueue;
 	sc_signal<bool> dequeue_cstack_write;
-	sc_signal<sc_uint<1> > dequeue_cstack_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > dequeue_cstack_wg;
 	sc_signal<bool> enqueue_cstack_write;
-	sc_signal<sc_uint<1> > enqueue_cstack_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > enqueue_cstack_wg;
 	sc_signal<bool> cpop_stall[2];
 	sc_signal<Register<COMPUTE_THREADS/COMPUTE_FPUS> > req_w;
 	sc_fifo<reg_read_req<COMPUTE_THREADS/COMPUTE_FPUS> > req_r(1);
@@ -232,7 +232,7 @@ main(int argc, char **argv)
 	sc_signal<sc_bv<32> > req_sb_pop[3];
 	sc_signal<sc_bv<32> > entries_pop[2];
 	sc_signal<bool> entries_disable;
-	sc_signal<sc_uint<1> > entries_disable_wg;
+	sc_signal<sc_uint<COMPUTE_WG_WIDTH> > entries_disable_wg;
 
 	my_sb.in_clk(clk);
 	my_sb.in_dequeue(dequeue);
@@ -280,13 +280,13 @@ main(int argc, char **argv)
 	my_sc.out_desc_fifo(desc_fifo);
 	my_sc.out_dram_kick(dram_kick);
 	my_sc.in_dram_done_dst(dram_done_dst);
-	my_sc.in_dram_mask(dram_mask);
+	my_sc.in_dram_mask[0](dram_mask);
 	my_sc.in_dram_ref(dram_ref);
 	my_sc.in_dram_reg(dram_reg);
-	my_sc.out_dram_mask(o_dram_mask);
+	my_sc.out_dram_mask[0](o_dram_mask);
 	my_sc.in_dram_idx_push_trigger(dram_idx_push_trigger);
 	my_sc.out_dram_idx(o_dram_idx);
-	my_sc.in_dram_sp_addr(dram_sp_addr);
+	my_sc.in_dram_sp_addr[0](dram_sp_addr);
 
 	my_sc_test.in_clk(clk);
 	my_sc_test.out_wg(wg);
@@ -31,6 +31,15 @@ using namespace simd_test;
 
 namespace compute_test{
 
+/** Work-group sampling policy attached to the WorkScheduler. */
+static wg_sampling sampling;
+
+/** Enumeration index of the first work-group dispatched. */
+static unsigned long resume_wg = 0;
+
+/** Enumeration index to stop dispatching at, 0 to run to completion. */
+static unsigned long stop_wg = 0;
+
 template <unsigned int THREADS = 1024, unsigned int FPUS = 128,
 		unsigned int PC_WIDTH = 11, unsigned int XLAT_ENTRIES = 32>
 class Test_WorkScheduler : public SimdTest
@@ -93,7 +102,10 @@ public:
 	/** Physical address indexed by buffer index. */
 	sc_in<Buffer> in_sp_xlat_phys_w{"in_sp_xlat_phys_w"};
 
-	SC_CTOR(Test_WorkScheduler)
+	/** WorkScheduler under test, for setting up checkpoint boundaries. */
+	WorkScheduler<THREADS,FPUS,PC_WIDTH,XLAT_ENTRIES> *ws;
+
+	SC_CTOR(Test_WorkScheduler) : ws(nullptr)
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
@@ -104,8 +116,12 @@ private:
 	{
 		unsigned int x, y;
 		unsigned int i;
+		unsigned long idx;
 		workgroup<THREADS,FPUS> wg;
 
+		ws->set_resume(resume_wg);
+		ws->set_stop(stop_wg);
+
 		w.add_op(Instruction());
 		w.add_op(Instruction(OP_EXIT));
 		out_work.write(w);
@@ -142,11 +158,20 @@ private:
 
 		assert(in_imem_w.read() == false);
 
+		idx = 0;
 		for (y = 0; y < w.dims[1]; y += (THREADS >> (w.wg_width + 5))) {
 			for (x = 0; x < w.dims[0]; x += (32 << w.wg_width)) {
+				if (!sampling.is_sampled(idx++) ||
+				    idx <= resume_wg)
+					continue;
+
+				if (stop_wg && idx > stop_wg)
+					break;
+
 				wg = in_wg.read();
 				assert((wg.off_x << 5) == x);
 				assert(wg.off_y == y);
+				assert(wg.idx == idx - 1);
 				wait();
 			}
 		}
@@ -174,6 +199,23 @@ private:
 		if (THREADS >= 512)
 			test_work(work<XLAT_ENTRIES>(1048576,1,WG_WIDTH_512));
 
+		/* 12 work-groups, of which 0, 1, 5, 10 and 11 are sampled. */
+		sampling = wg_sampling(2, 5);
+		test_work(w);
+		assert(sampling.get_skipped().size() == 7);
+		assert(sampling.get_skipped()[0] == make_pair(2u, 0u));
+		assert(sampling.factor() == 12. / 5.);
+		sampling = wg_sampling();
+
+		/* Checkpoint at work-group 7, resume from there. */
+		stop_wg = 7;
+		test_work(w);
+		assert(ws->has_stopped());
+		resume_wg = 7;
+		stop_wg = 0;
+		test_work(w);
+		assert(!ws->has_stopped());
+
 		test_finish();
 	}
 };
@@ -213,10 +255,12 @@ main(int argc, char **argv)
 
 	sc_clock clk("clk", sc_time(10./12., SC_NS));
 
+	my_ws.set_sampling(&sampling);
+	my_ws_test.ws = &my_ws;
 	my_ws.in_clk(clk);
 	my_ws.in_work(work);
 	my_ws.in_kick(kick);
-	my_ws.out_wg(wg);
+	my_ws.out_wg[0](wg);
 	my_ws.out_wg_width(wg_width);
 	my_ws.out_sched_opts(sched_opts);
 	my_ws.out_dim[0](dim[0]);
@@ -224,7 +268,7 @@ main(int argc, char **argv)
 	my_ws.out_imem_pc(imem_pc);
 	my_ws.out_imem_w(imem_w);
 	my_ws.out_end_prg(end_prg);
-	my_ws.in_exec_fini(exec_fini);
+	my_ws.in_exec_fini[0](exec_fini);
 	my_ws.out_xlat_w(xlat_w);
 	my_ws.out_xlat_idx_w(xlat_idx_w);
 	my_ws.out_xlat_phys_w(xlat_phys_w);
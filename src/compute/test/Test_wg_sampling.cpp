@@ -0,0 +1,193 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "compute/model/compute_stats.h"
+#include "compute/model/wg_sampling.h"
+#include "mc/model/cmdarb_stats.h"
+
+using namespace std;
+using namespace compute_model;
+using namespace mc_model;
+
+namespace compute_test {
+
+/** Number of work-groups in the kernel. */
+#define WGS 40
+
+/** Cycles between dispatching two work-groups. */
+#define WG_INTERVAL 100
+
+/** Cycles from dispatching the last work-group to the end of the kernel. */
+#define WG_TAIL 250
+
+/** Width of the DRAM data bus in bytes, for the utilisation. */
+#define BUS_BYTES 64
+
+/** DRAM bytes and activates of the running kernel, read by dram_probe(). */
+static unsigned long probe_bytes;
+static unsigned long probe_acts;
+
+/** DRAM probe for the sampling policy.
+ * @param bytes Number of bytes transferred so far.
+ * @param acts Number of activates issued so far. */
+static void
+dram_probe(unsigned long &bytes, unsigned long &acts)
+{
+	bytes = probe_bytes;
+	acts = probe_acts;
+}
+
+/** Run a kernel of uniform work-groups.
+ *
+ * Each dispatched work-group takes WG_INTERVAL cycles and adds the same
+ * amount to every counter. Skipped work-groups take no time, as they do in
+ * the WorkScheduler. DRAM and compute cycles are taken to be equal.
+ * @param smp Sampling policy.
+ * @param cs Compute stats of the run.
+ * @param ms DRAM stats of the run. */
+static void
+run_uniform(wg_sampling &smp, compute_stats &cs, cmdarb_stats &ms)
+{
+	unsigned long idx;
+	unsigned long cycle;
+
+	memset(&cs, 0, sizeof(cs));
+	memset(&ms, 0, sizeof(ms));
+	probe_bytes = 0;
+	probe_acts = 0;
+
+	smp.reset(WGS);
+	cycle = 0;
+
+	for (idx = 0; idx < WGS; idx++) {
+		if (!smp.is_sampled(idx)) {
+			smp.skip(idx, 0);
+			continue;
+		}
+
+		smp.dispatch(idx, cycle);
+		cycle += WG_INTERVAL;
+
+		cs.wgs++;
+		cs.compute_active += 80;
+		cs.raw_stalls += 5;
+		cs.commit_nop += 3;
+
+		ms.act_c += 2;
+		ms.cas_c += 8;
+		ms.pre_c += 1;
+		ms.bytes += 512;
+		ms.energy += 1000.;
+
+		probe_bytes = ms.bytes;
+		probe_acts = ms.act_c;
+	}
+
+	cs.exec_time = cycle - WG_INTERVAL + WG_TAIL;
+	ms.lda = cs.exec_time - 10;
+	ms.lid = cs.exec_time - 20;
+	ms.power = ms.energy / cs.exec_time;
+	ms.dq_util = (ms.bytes * 100.) / (cs.exec_time * BUS_BYTES);
+}
+
+/** Extrapolate the stats of a sampled run, as main does.
+ * @param smp Sampling policy the run was sampled under.
+ * @param cs Compute stats of the run.
+ * @param ms DRAM stats of the run. */
+static void
+extrapolate(wg_sampling &smp, compute_stats &cs, cmdarb_stats &ms)
+{
+	unsigned long exec_time;
+	double f;
+	double ci;
+
+	exec_time = cs.exec_time;
+	f = smp.factor();
+
+	cs.exec_time = smp.estimate_exec_time(exec_time, ci);
+	cs.wgs = (unsigned long) (cs.wgs * f + 0.5);
+	cs.scale(f);
+	ms.scale(f, exec_time, cs.exec_time);
+
+	/* Uniform intervals, no uncertainty. */
+	assert(ci == 0.);
+}
+
+/** Return whether two doubles are equal up to rounding.
+ * @param a First value.
+ * @param b Second value.
+ * @return True iff a and b are within a relative 1e-9 of each other. */
+static bool
+near(double a, double b)
+{
+	return fabs(a - b) <= 1e-9 * max(fabs(a), fabs(b));
+}
+
+}
+
+using namespace compute_test;
+
+int
+main(int argc, char **argv)
+{
+	wg_sampling full;
+	wg_sampling sampled(2, 5);
+	compute_stats full_cs, cs;
+	cmdarb_stats full_ms, ms;
+
+	run_uniform(full, full_cs, full_ms);
+
+	/* Without a DRAM probe, DRAM counters have no confidence interval. */
+	run_uniform(sampled, cs, ms);
+	assert(std::isnan(sampled.dram_bytes_ci()));
+	assert(std::isnan(sampled.dram_acts_ci()));
+
+	sampled.set_dram_probe(dram_probe);
+	run_uniform(sampled, cs, ms);
+
+	/* Uniform work-groups, no uncertainty. */
+	assert(sampled.dram_bytes_ci() == 0.);
+	assert(sampled.dram_acts_ci() == 0.);
+
+	assert(sampled.get_skipped().size() > 0);
+	assert(cs.exec_time < full_cs.exec_time);
+
+	extrapolate(sampled, cs, ms);
+
+	assert(cs.exec_time == full_cs.exec_time);
+	assert(cs.wgs == full_cs.wgs);
+	assert(cs.compute_active == full_cs.compute_active);
+	assert(cs.raw_stalls == full_cs.raw_stalls);
+	assert(cs.commit_nop == full_cs.commit_nop);
+
+	assert(ms.act_c == full_ms.act_c);
+	assert(ms.cas_c == full_ms.cas_c);
+	assert(ms.pre_c == full_ms.pre_c);
+	assert(ms.bytes == full_ms.bytes);
+	assert(ms.lda == full_ms.lda);
+	assert(ms.lid == full_ms.lid);
+	assert(near(ms.energy, full_ms.energy));
+	assert(near(ms.power, full_ms.power));
+	assert(near(ms.dq_util, full_ms.dq_util));
+
+	return 0;
+}
@@ -0,0 +1,465 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <systemc>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <getopt.h>
+#include <thread>
+#include <unistd.h>
+
+#include "util/constmath.h"
+#include "util/defaults.h"
+#include "util/debug_output.h"
+#include "util/parse.h"
+#include "util/compare.h"
+#include "isa/model/Program.h"
+#include "isa/analysis/ControlFlow.h"
+#include "isa/analysis/FlatMemory.h"
+#include "isa/analysis/FuncSim.h"
+#include "model/Buffer.h"
+#include "model/workgroup_width.h"
+
+using namespace std;
+using namespace sc_core;
+using namespace simd_model;
+using namespace isa_model;
+using namespace isa_analysis;
+
+static string program = "";
+static unsigned long dims[2];
+static float delta = 0.001f;
+static bool dfrac = false;
+/** Path of the JSON comparison report, empty if none requested. */
+static string cmp_json = "";
+static workgroup_width wgw = WG_WIDTH_SENTINEL;
+/** Number of worker threads, 0 to use all hardware threads. */
+static unsigned int threads = 0;
+/** True iff stores should be checked for races between work-groups. */
+static bool race_detect = false;
+
+static Program prg;
+
+typedef struct {
+	enum {
+		ACTION_DOWNLOAD,
+		ACTION_COMPARE,
+	} action;
+	string path;
+	unsigned int buffer;
+	buffer_input_type type;
+} download;
+
+typedef struct {
+	string path;
+	unsigned int buffer;
+	buffer_input_type type;
+} upload;
+
+static vector<download> d;
+static vector<upload> u;
+
+/** Determine the work-group width, like main's SimD_Control does.
+ * @return The work-group width to execute the kernel with. */
+static workgroup_width
+prg_wg_width(void)
+{
+	if (wgw < WG_WIDTH_SENTINEL)
+		return wgw;
+	else if (dims[0] >= 1024)
+		return WG_WIDTH_1024;
+	else if (dims[0] >= 512)
+		return WG_WIDTH_512;
+	else if (dims[0] >= 256)
+		return WG_WIDTH_256;
+	else if (dims[0] >= 128)
+		return WG_WIDTH_128;
+	else if (dims[0] >= 64)
+		return WG_WIDTH_64;
+
+	return WG_WIDTH_32;
+}
+
+/** Document the parameters accepted by this binary.
+ * @param Program name binary name used to invoke this program. */
+void
+help(char *program_name)
+{
+	unsigned int i;
+	string::size_type j;
+
+	cout << program_name << " [options] program.sas" << endl;
+	cout << "Functionally execute a Sim-D kernel, without timing." << endl;
+	cout << endl;
+	cout << "Options:" << endl;
+	cout << "  -d [x,y]\t\t     : (x,y)-dimensions of program execution." << endl;
+	cout << "  -w [t]\t\t     : Workgroup width, t a power-of-two > 32." << endl;
+	cout << "  -i [buf,in.csv]\t     : Prior to execution, upload given file (CSV," << endl;
+	cout << "  \t\t\t       .npy or binary) into buffer indexed by [buf]." << endl;
+	cout << "  -o [buf,out.txt]\t     : After execution, dump contents of given buffer" << endl;
+	cout << "  \t\t\t       into file." << endl;
+	cout << "  -c [buf,in.bin]\t     : After execution, compare the contents of given" << endl;
+	cout << "  \t\t\t       buffer against the contents of the (binary) file" << endl;
+	cout << "  \t\t\t       provided." << endl;
+	cout << "  -e [error]\t\t     : Tolerable comparison error (delta or" << endl;
+	cout << "  \t\t\t       percentage, default: 0.001)." << endl;
+	cout << "  -J [report.json]\t     : Write error statistics of all comparisons" << endl;
+	cout << "  \t\t\t       (-c) to a JSON file." << endl;
+	cout << "  -j [threads]\t\t     : Number of worker threads executing" << endl;
+	cout << "  \t\t\t       work-groups (default: all hardware threads)." << endl;
+	cout << "  -r\t\t\t     : Report stores to the same word by concurrently" << endl;
+	cout << "  \t\t\t       executing work-groups." << endl;
+	cout << "  -D dbgopt[,dbgopt[,..]]    : Enable debugging output options." << endl;
+
+	cout << endl;
+	cout << "Debugging options (dbgopt):" << endl;
+
+	for (i = 0; i < DEBUG_SENTINEL; i++) {
+		cout << "  " << debug_output_opts[i].first;
+
+		for (j = debug_output_opts[i].first.size(); j < 24; j++)
+			cout << " ";
+
+		cout << ": " <<	debug_output_opts[i].second << endl;
+	}
+}
+
+buffer_input_type
+getBufferTypeFromFilename(string &file)
+{
+	size_t s;
+	string extension;
+
+	s = file.find_last_of('.');
+
+	if (s == string::npos || s == file.length() - 1)
+		return BINARY;
+
+	extension = file.substr(s + 1);
+
+	/** Find the extension */
+	if (extension == "csv" || extension == "txt")
+		return DECIMAL_CSV;
+
+	if (extension == "npy")
+		return NUMPY;
+
+	return BINARY;
+}
+
+/** Parse command line parameters
+ * @param argc Number of parameters given
+ * @param argv List of strings, each containing one parameter */
+void
+parse_parameters(int argc, char* argv[])
+{
+	int c;
+	int i;
+	int wg_width;
+	int nthreads;
+	unsigned int pos;
+	string::size_type sz;
+	string oa;
+	string dbgopt;
+	unsigned int bufno;
+	bool dims_provided = false;
+	buffer_input_type t;
+	string path;
+
+	if (argc <= 1) {
+		cout << "Missing program" << endl << endl;
+		help(argv[0]);
+		exit(1);
+	}
+
+	program = string(argv[argc-1]);
+
+	while ( (c = getopt(argc - 1, argv, "hd:w:i:o:c:e:J:j:rD:")) != -1) {
+		switch (c) {
+		case 'h':
+			help(argv[0]);
+			exit(1);
+			break;
+		case 'd':
+			oa = string(optarg);
+			dims[0] = stoul(oa, &sz);
+			oa = oa.substr(sz);
+			if (oa.size() == 0) {
+				dims[1] = 1;
+				break;
+			} else if (oa[0] != ',') {
+				cout << "Error: Invalid dimension specification"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			oa = oa.substr(1);
+			dims[1] = stoul(oa, &sz);
+			dims_provided = true;
+			break;
+		case 'w':
+			i = sscanf(optarg, "%i", &wg_width);
+			if (i < 0 || wg_width < 32) {
+				cout << "Error: Invalid workgroup width"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			wg_width = const_log2(wg_width >> 5);
+			wgw = workgroup_width(min(int(wg_width),
+					int(WG_WIDTH_SENTINEL)));
+			break;
+		case 'i':
+			i = sscanf(optarg, "%i,%n", &bufno, &pos);
+			if (i == 0 || bufno >= 32) {
+				cout << "Error: Invalid buffer index" <<
+						endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			path = string(&optarg[pos]);
+			t = getBufferTypeFromFilename(path);
+
+			u.push_back({path, bufno, t});
+			break;
+		case 'o':
+			i = sscanf(optarg, "%i,%n", &bufno, &pos);
+			if (i == 0 || bufno >= 32) {
+				cout << "Error: Invalid buffer index" <<
+						endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			path = string(&optarg[pos]);
+			t = getBufferTypeFromFilename(path);
+
+			d.push_back({download::ACTION_DOWNLOAD, path,
+				bufno, t});
+			break;
+		case 'c':
+			i = sscanf(optarg, "%i,%n", &bufno, &pos);
+			if (i == 0 || bufno >= 32) {
+				cout << "Error: Invalid buffer index" <<
+						endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			path = string(&optarg[pos]);
+			t = getBufferTypeFromFilename(path);
+
+			d.push_back({download::ACTION_COMPARE, path, bufno, t});
+			break;
+		case 'e':
+			dfrac = (optarg[strlen(optarg)-1] == '%');
+
+			i = sscanf(optarg, "%f", &delta);
+			if (i == 0) {
+				cout << "Error: No delta provided" <<
+						endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			if (dfrac)
+				delta *= 0.01f;
+			break;
+		case 'J':
+			cmp_json = string(optarg);
+			break;
+		case 'j':
+			i = sscanf(optarg, "%i", &nthreads);
+			if (i <= 0 || nthreads <= 0) {
+				cout << "Error: Invalid number of threads"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+
+			threads = nthreads;
+			break;
+		case 'r':
+			race_detect = true;
+			break;
+		case 'D':
+			oa = string(optarg);
+
+			while (read_id(oa, dbgopt)) {
+				for (i = 0; i < DEBUG_SENTINEL; i++) {
+					if (dbgopt == debug_output_opts[i].first) {
+						debug_output[i] = 1;
+						break;
+					}
+				}
+
+				if (i == DEBUG_SENTINEL) {
+					cout << "Error: unknown debug option \"" <<
+						dbgopt << "\"" << endl << endl;
+					help(argv[0]);
+					exit(1);
+				}
+
+				if (oa[0] == ',')
+					oa = oa.substr(1);
+			}
+
+			break;
+		default:
+			help(argv[0]);
+			exit(1);
+		}
+	}
+
+	if (!dims_provided) {
+		cout << "Error: No kernel dimensions provided" << endl << endl;
+		help(argv[0]);
+		exit(1);
+	}
+}
+
+int
+sc_main(int argc, char* argv[])
+{
+	const ProgramBuffer *b;
+	fstream fs;
+	ofstream js;
+	cmp_stats cs;
+	bool first_cmp = true;
+	FlatMemory mem;
+	FuncSim *sim;
+	vector<pair<unsigned int, unsigned int> > wgl;
+
+	debug_output_reset();
+	parse_parameters(argc, argv);
+
+	if (!debug_output_validate())
+		exit(1);
+
+	fs = fstream(program);
+	if (!fs) {
+		cout << "Could not open program file " << program << endl;
+		exit(1);
+	}
+	prg.parse(fs);
+	prg.resolve_branch_targets();
+	/* Analysis folds the last exit into the store operation. */
+	ControlFlow(prg);
+	prg.validate_buffers();
+
+	for (upload &ul : u) {
+		ProgramBuffer &buf = prg.getBuffer(ul.buffer);
+		if (buf.hasDataInputFile())
+			cout << "Warning: overwriting buffer data input file "
+				"for buffer " << ul.buffer <<" with command-"
+				"line parameter." << endl;
+
+		buf.setDataInputFile(ul.path, ul.type);
+	}
+
+	mem.map_program(prg);
+
+	for (b = prg.buffer_begin(); b < prg.buffer_end(); b++) {
+		if (b->hasDataInputFile())
+			mem.upload_buffer(*b);
+	}
+
+	if (debug_output[DEBUG_PROGRAM]) {
+		prg.print_buffers();
+		cout << endl;
+		prg.print();
+		cout << endl;
+	}
+
+	if (threads == 0)
+		threads = max(1u, thread::hardware_concurrency());
+
+	sim = new FuncSim(prg, mem, dims[0], dims[1], prg_wg_width());
+	sim->set_race_detect(race_detect);
+	sim->run(threads);
+
+	cout << "Work-groups: " << sim->get_wgs() << endl;
+	cout << "Instructions: " << sim->get_insns() << endl;
+
+	if (race_detect) {
+		wgl = sim->enumerate_wgs();
+
+		for (const funcsim_race &r : sim->get_races())
+			cerr << "Race: WG (" << wgl[r.wg_first].first << "," <<
+				wgl[r.wg_first].second << ") and WG (" <<
+				wgl[r.wg_second].first << "," <<
+				wgl[r.wg_second].second << ") store to 0x" <<
+				hex << r.addr << dec << endl;
+
+		cout << "Races: " << sim->get_race_count() << endl;
+	}
+
+	delete sim;
+
+	for (download &dl : d) {
+		ProgramBuffer &buf = prg.getBuffer(dl.buffer);
+
+		switch (dl.action) {
+		case download::ACTION_DOWNLOAD:
+			if (dl.type == BINARY)
+				mem.download_buffer_bin(buf, dl.path);
+			else if (dl.type == NUMPY)
+				mem.download_buffer_npy(buf, dl.path);
+			else
+				mem.download_buffer_csv(buf, dl.path);
+			break;
+		case download::ACTION_COMPARE:
+			memset(&cs, 0, sizeof(cs));
+			if (dl.type == BINARY)
+				mem.compare_buffer_bin(buf, dl.path, delta, dfrac, &cs);
+			else if (dl.type == NUMPY)
+				mem.compare_buffer_npy(buf, dl.path, delta, dfrac, &cs);
+			else
+				mem.compare_buffer_csv(buf, dl.path, delta, dfrac, &cs);
+
+			if (cmp_json != "") {
+				if (first_cmp) {
+					js.open(cmp_json, ios_base::out | ios_base::trunc);
+					js << "[";
+				}
+
+				js << (first_cmp ? "\n  " : ",\n  ");
+				cmp_print_json(js, cs, dl.path);
+				first_cmp = false;
+			}
+			break;
+		default:
+			cout << "Error: Unknown action." << endl;
+			help(argv[0]);
+			exit(1);
+		}
+
+	}
+
+	if (!first_cmp) {
+		js << "\n]" << endl;
+		js.close();
+	}
+
+	return 0;
+}
@@ -17,12 +17,14 @@
  */
 
 #include "isa/analysis/DRAMSim.h"
+#include "mc/model/dram_channel.h"
 #include "util/constmath.h"
 #include "util/debug_output.h"
 
 using namespace isa_model;
 using namespace simd_model;
 using namespace dram;
+using namespace mc_model;
 
 namespace isa_analysis {
 
@@ -164,12 +166,15 @@ boundLDSTGBIDX(Program &p, Instruction *op,
 	Buffer &b = p.getBuffer(bidx);
 
 	/** XXX: Actually we know our alignment. Can derive a tighter bound. */
-	bs = bursts(dram, b.dims[0] * b.dims[1] * 4, false);
+	bs = chan_bursts(dram, b.dims[0] * b.dims[1] * 4, false);
 	if (op->getOp() == OP_LDGBIDX)
 		bound = least_issue_delay_rd_ddr4(dram, bs, false);
 	else
 		bound = least_issue_delay_wr_ddr4(dram, bs, false);
 
+	if (MC_DRAM_CHANS > 1)
+		bound += DRAM_CHAN_JOIN_CYCLES;
+
 	return bound;
 }
 
@@ -230,6 +235,9 @@ boundLDSTGIDXIT(Program &p, const dram_timing *dram, Instruction *op)
 	/* Add 3 for DRAM pipeline delay */
 	bound += 3;
 
+	if (MC_DRAM_CHANS > 1)
+		bound += DRAM_CHAN_JOIN_CYCLES;
+
 	return bound;
 }
 
@@ -307,6 +315,38 @@ boundLDSTSPLIN(Program &p, workgroup_width w, Instruction *op)
 	return spStrides(words, period, period_cnt) + 1;
 }
 
+/** Obtain the least-issue delay for a stride descriptor, either from the cache
+ * or through simulation.
+ * @param sd Stride descriptor to simulate.
+ * @param sweep True iff all DRAM alignments must be simulated.
+ * @param sim Function pointer to method launching simulation.
+ * @param cache Stride simulation result cache, may be nullptr.
+ * @return The worst-case least-issue delay in DRAM cycles. */
+static unsigned long
+simStride(stride_descriptor &sd, bool sweep,
+		void (*sim)(stride_descriptor &, bool, cmdarb_stats *),
+		StrideCache *cache)
+{
+	cmdarb_stats stats[STATS_AGG + 1];
+	stride_descriptor sim_sd;
+
+	if (cache && cache->lookup(sd, sweep, stats)) {
+		if (debug_output[DEBUG_WCET_PROGRESS])
+			cout << "    - Cached" << endl;
+
+		return stats[STATS_MAX].lid;
+	}
+
+	/* The simulator may modify the descriptor address during a sweep. */
+	sim_sd = sd;
+	sim(sim_sd, sweep, stats);
+
+	if (cache)
+		cache->store(sd, sweep, stats);
+
+	return stats[STATS_MAX].lid;
+}
+
 unsigned long
 ProgramUploadTime(Program &p, const dram_timing *dram)
 {
@@ -316,8 +356,10 @@ ProgramUploadTime(Program &p, const dram_timing *dram)
 
 	bytes = p.countInstructions() * 8;
 
-	b = bursts(dram, bytes, 1);
+	b = chan_bursts(dram, bytes, 1);
 	dram_cycles = least_issue_delay_rd_ddr4(dram, b, 1);
+	if (MC_DRAM_CHANS > 1)
+		dram_cycles += DRAM_CHAN_JOIN_CYCLES;
 
 	/* And convert to SimdCluster cycles
 	 * @todo Less static */
@@ -326,7 +368,8 @@ ProgramUploadTime(Program &p, const dram_timing *dram)
 
 void
 DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
-		unsigned long (*sim)(stride_descriptor &, bool))
+		void (*sim)(stride_descriptor &, bool, cmdarb_stats *),
+		StrideCache *cache)
 {
 	vector<BB *>::const_iterator bbit;
 	BB *bb;
@@ -355,7 +398,7 @@ DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
 				cout << "    - Stride: " << sd << endl;
 			}
 
-			bound = sim(sd, true);
+			bound = simStride(sd, true, sim, cache);
 			break;
 		case OP_SLDG:
 			sd = strideSLDG(p, op);
@@ -364,7 +407,7 @@ DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
 				cout << "    - Stride: " << sd << endl;
 			}
 
-			bound = sim(sd, false);
+			bound = simStride(sd, false, sim, cache);
 			break;
 		case OP_LDGBIDX:
 		case OP_STGBIDX:
@@ -381,7 +424,7 @@ DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
 				cout << "    - Stride: " << sd << endl;
 			}
 
-			bound = sim(sd, true);
+			bound = simStride(sd, true, sim, cache);
 			break;
 		case OP_LDG2SPTILE:
 		case OP_STG2SPTILE:
@@ -391,7 +434,7 @@ DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
 				cout << "    - Stride: " << sd << endl;
 			}
 
-			bound = sim(sd, true);
+			bound = simStride(sd, true, sim, cache);
 			break;
 		case OP_LDSPBIDX:
 		case OP_STSPBIDX:
@@ -430,7 +473,7 @@ DRAMSim(Program &p, workgroup_width w, const dram_timing *dram,
 		md = op->getMetadata();
 
 		if (md) {
-			md = new Metadata();
+			md = p.alloc_metadata();
 			op->addMetadata(md);
 		}
 
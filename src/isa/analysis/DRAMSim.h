@@ -22,7 +22,9 @@
 #include "isa/model/Program.h"
 #include "model/workgroup_width.h"
 #include "model/stride_descriptor.h"
+#include "mc/model/cmdarb_stats.h"
 #include "util/ddr4_lid.h"
+#include "isa/analysis/StrideCache.h"
 
 namespace isa_analysis {
 
@@ -41,10 +43,15 @@ ProgramUploadTime(isa_model::Program &p, const dram::dram_timing *dram);
  * @param p Program for which DRAM and scratchpad requests are bound,
  * @param w Width of a work-group, determines stride parameters,
  * @param dram DRAM timings for the current configuration,
- * @param sim Function pointer to method launching simulation. */
+ * @param sim Function pointer to method launching simulation. Stores the
+ * 	      min/max/aggregate statistics in the provided array of three
+ * 	      cmdarb_stats objects.
+ * @param cache Stride simulation result cache, nullptr to always simulate. */
 void DRAMSim(isa_model::Program &p, simd_model::workgroup_width w,
 		const dram::dram_timing *dram,
-		unsigned long (*sim)(simd_model::stride_descriptor &, bool));
+		void (*sim)(simd_model::stride_descriptor &, bool,
+				mc_model::cmdarb_stats *),
+		StrideCache *cache = nullptr);
 
 }
 
@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "isa/analysis/FlatMemory.h"
+#include "util/constmath.h"
+
+using namespace std;
+using namespace simd_model;
+using namespace isa_model;
+
+namespace isa_analysis {
+
+FlatMemory::FlatMemory()
+{
+}
+
+void
+FlatMemory::map_program(const Program &p)
+{
+	const ProgramBuffer *b;
+	size_t words;
+	size_t end = mem.size();
+
+	for (b = p.buffer_begin(); b < p.buffer_end(); b++) {
+		if (!b->valid)
+			continue;
+
+		words = (b->getAddress() >> 2) + (b->dims[0] * b->dims[1]);
+		end = max(end, words);
+	}
+
+	mem.resize(end, 0u);
+}
+
+size_t
+FlatMemory::size(void) const
+{
+	return mem.size() * sizeof(uint32_t);
+}
+
+uint32_t *
+FlatMemory::data(void)
+{
+	return mem.data();
+}
+
+void
+FlatMemory::bulk_copy(uint32_t addr, uint32_t *buf, size_t words, bool upload)
+{
+	size_t n;
+
+	addr >>= 2;
+	n = (addr < mem.size()) ? min(words, mem.size() - addr) : 0;
+
+	if (upload) {
+		if (n)
+			memcpy(&mem[addr], buf, n * sizeof(uint32_t));
+	} else {
+		if (n)
+			memcpy(buf, &mem[addr], n * sizeof(uint32_t));
+		memset(&buf[n], 0, (words - n) * sizeof(uint32_t));
+	}
+}
+
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISA_ANALYSIS_FLATMEMORY_H
+#define ISA_ANALYSIS_FLATMEMORY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "isa/model/Program.h"
+#include "model/BufferStore.h"
+
+namespace isa_analysis {
+
+/** Flat image of DRAM contents for functional simulation.
+ *
+ * Stores one 32-bit word per word-aligned address, covering all buffers of a
+ * program. The cycle-accurate Backend scatters the same addresses over banks,
+ * rows and columns, which does not affect buffer contents. Reads outside the
+ * image return 0, writes outside the image are dropped.
+ *
+ * Buffer upload, download and comparison are inherited from BufferStore and
+ * shared with the Backend. */
+class FlatMemory : public simd_model::BufferStore {
+private:
+	/** Memory contents, indexed by word address. */
+	std::vector<uint32_t> mem;
+
+public:
+	/** Constructor. Creates an empty image. */
+	FlatMemory();
+
+	/** Size the image such that it covers all DRAM buffers of a program.
+	 *
+	 * Existing contents are retained.
+	 * @param p Program. */
+	void map_program(const isa_model::Program &p);
+
+	/** Return the size of this image.
+	 * @return Size of this image in bytes. */
+	size_t size(void) const;
+
+	/** Return a pointer to the first word of the image.
+	 * @return Pointer to the image data. */
+	uint32_t *data(void);
+
+	/** Read a word.
+	 * @param addr Byte address, word aligned.
+	 * @return The word stored at addr, 0 if addr lies outside the image. */
+	inline uint32_t
+	read(uint32_t addr) const
+	{
+		addr >>= 2;
+
+		if (addr >= mem.size())
+			return 0u;
+
+		return mem[addr];
+	}
+
+	/** Write a word.
+	 * @param addr Byte address, word aligned.
+	 * @param v Value to store. */
+	inline void
+	write(uint32_t addr, uint32_t v)
+	{
+		addr >>= 2;
+
+		if (addr < mem.size())
+			mem[addr] = v;
+	}
+
+	/** Copy a consecutive range of words from or to the image.
+	 * @param addr Start address, word-aligned.
+	 * @param buf Host buffer.
+	 * @param words Number of words to copy.
+	 * @param upload True iff words are copied from buf to the image, false
+	 * 		 iff copied from the image to buf. */
+	void bulk_copy(uint32_t addr, uint32_t *buf, size_t words, bool upload);
+};
+}
+
+#endif /* ISA_ANALYSIS_FLATMEMORY_H */
@@ -0,0 +1,1384 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+#include "isa/analysis/FuncSim.h"
+#include "isa/model/lane_ops.h"
+#include "isa/model/ldst_ops.h"
+#include "util/constmath.h"
+
+using namespace std;
+using namespace sc_dt;
+using namespace simd_model;
+using namespace isa_model;
+
+namespace isa_analysis {
+
+/** Number of lanes IExecute processes per cycle. Some scalar operands are
+ * sampled from the first lane of a column. */
+#define FUNCSIM_LANES COMPUTE_FPUS
+
+/** Register column type used to construct stride descriptors. */
+typedef Register<COMPUTE_THREADS/COMPUTE_FPUS> funcsim_reg;
+
+FuncSimWG::FuncSimWG()
+: idx(0u), off_x(0u), off_y(0u), pc(0u), vrf(64 * COMPUTE_THREADS, 0u),
+  prf(4 * COMPUTE_THREADS, 0u), cam_idx(COMPUTE_THREADS, 0u),
+  cam_val(COMPUTE_THREADS, 0u), sd_words(0u), sd_period(0u),
+  sd_period_count(0u), sp(SP_BYTES / 4, 0u), lanes_en(COMPUTE_THREADS, 0u),
+  res(COMPUTE_THREADS, 0u), insns(0ul)
+{
+	unsigned int i;
+
+	for (i = 0; i < 32; i++)
+		srf[i] = 0u;
+
+	for (i = 0; i < 4; i++)
+		cmask[i].resize(COMPUTE_THREADS, 1u);
+
+	for (i = 0; i < 3; i++)
+		opnd[i].resize(COMPUTE_THREADS, 0u);
+}
+
+void
+FuncSimWG::reset(unsigned int x, unsigned int y)
+{
+	unsigned int i;
+
+	off_x = x;
+	off_y = y;
+	pc = 0u;
+
+	for (i = 0; i < 4; i++)
+		fill(cmask[i].begin(), cmask[i].end(), 1u);
+
+	cstack.reset();
+
+	sd_words = 0u;
+	sd_period = 0u;
+	sd_period_count = 0u;
+}
+
+FuncSim::FuncSim(Program &p, FlatMemory &m, unsigned long dim_x,
+		unsigned long dim_y, workgroup_width w)
+: mem(m), wg_width(w), wgs(0ul), insns(0ul), workers(0u),
+  race_detect(false), shadow_words(0u), ticket(0ul), race_count(0ul)
+{
+	vector<Instruction *> lin;
+	funcsim_insn in;
+	unsigned int i;
+
+	dims[0] = dim_x;
+	dims[1] = dim_y;
+
+	for (i = 0; i < MC_BIND_BUFS; i++) {
+		buf[i] = p.buffer_begin()[i];
+		sp_buf[i] = p.sp_buffer_begin()[i];
+	}
+
+	lin = p.linearise_code();
+	code.reserve(lin.size());
+
+	for (Instruction *op : lin) {
+		in.insn = *op;
+		add_implicit_operands(in.insn);
+
+		in.op = in.insn.getOp();
+		in.subop = op->getSubOp();
+		in.vec = in.insn.isVectorInstruction();
+		in.post_exit = in.insn.postExit();
+		in.srcs = in.insn.getSrcs();
+
+		for (i = 0; i < 3; i++) {
+			in.src[i] = Operand();
+			in.imm[i] = 0u;
+		}
+
+		for (i = 0; i < in.srcs && i < 3; i++) {
+			in.src[i] = in.insn.getSrc(i);
+			if (in.src[i].getType() == OPERAND_IMM ||
+			    in.src[i].getType() == OPERAND_BRANCH_TARGET)
+				in.imm[i] = in.src[i].getValue();
+		}
+
+		in.dst = Operand();
+		in.dst_imm = 0u;
+		if (in.insn.hasDst()) {
+			in.dst = in.insn.getDst();
+			if (in.dst.getType() == OPERAND_IMM)
+				in.dst_imm = in.dst.getValue();
+		}
+
+		code.push_back(in);
+	}
+}
+
+void
+FuncSim::add_implicit_operands(Instruction &op)
+{
+	/* Implicit sources, as added by IDecode::op_add_implicit_src(). */
+	switch (op.getOp()) {
+	case OP_LDGLIN:
+	case OP_STGLIN:
+	case OP_LDSPLIN:
+	case OP_STSPLIN:
+	case OP_SLDSP:
+	case OP_LDG2SPTILE:
+	case OP_STG2SPTILE:
+		if (op.getSrcs() < 2)
+			op.addSrc(Operand(0));
+		if (op.getSrcs() < 3)
+			op.addSrc(Operand(0));
+		break;
+	case OP_SLDG:
+		if (op.getSrcs() < 2)
+			op.addSrc(Operand(1));
+		break;
+	case OP_EXIT:
+		if (op.getSrcs() == 0)
+			op.addSrc(Operand(REGISTER_VSP, VSP_ONE));
+		break;
+	case OP_CALL:
+		if (op.getSrcs() == 1)
+			op.addSrc(Operand(REGISTER_VSP, VSP_ONE));
+		break;
+	case OP_CPUSH:
+		if (op.getSrcs() >= 2)
+			break;
+
+		switch (op.getSubOp().cpush) {
+		case CPUSH_IF:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_RUN));
+			break;
+		case CPUSH_BRK:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_BREAK));
+			break;
+		case CPUSH_RET:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_RET));
+			break;
+		default:
+			assert(false);
+			break;
+		}
+		break;
+	case OP_DBG_PRINTCMASK:
+		if (op.getSrcs())
+			break;
+
+		switch (op.getSubOp().printcmask) {
+		case PRINTCMASK_IF:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_RUN));
+			break;
+		case PRINTCMASK_BRK:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_BREAK));
+			break;
+		case PRINTCMASK_RET:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_RET));
+			break;
+		case PRINTCMASK_EXIT:
+			op.addSrc(Operand(REGISTER_VSP, VSP_CTRL_EXIT));
+			break;
+		default:
+			assert(false);
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+
+	/* Implicit destinations, as set by IDecode::op_process_implicit_dst()*/
+	switch (op.getOp()) {
+	case OP_BRA:
+	case OP_CMASK:
+		op.setDst(Operand(REGISTER_VSP,VSP_CTRL_RUN));
+		break;
+	case OP_BRK:
+		op.setDst(Operand(REGISTER_VSP,VSP_CTRL_BREAK));
+		break;
+	case OP_EXIT:
+		op.setDst(Operand(REGISTER_VSP,VSP_CTRL_EXIT));
+		break;
+	case OP_CALL:
+	case OP_RET:
+		op.setDst(Operand(REGISTER_VSP,VSP_CTRL_RET));
+		break;
+	case OP_LDGBIDX:
+	case OP_STGBIDX:
+	case OP_LDGCIDX:
+	case OP_STGCIDX:
+	case OP_LDSPBIDX:
+	case OP_STSPBIDX:
+		op.setDst(Operand(REGISTER_VSP,VSP_MEM_DATA));
+		break;
+	default:
+		break;
+	}
+}
+
+vector<pair<unsigned int, unsigned int> >
+FuncSim::enumerate_wgs(void) const
+{
+	vector<pair<unsigned int, unsigned int> > list;
+	unsigned int x = 0u;
+	unsigned int y = 0u;
+
+	/* Same enumeration as WorkScheduler's WS_STATE_ENUM_WGS, which
+	 * always dispatches at least one work-group. */
+	do {
+		list.push_back(make_pair(x, y));
+
+		x += (1u << wg_width);
+		if ((x << 5) >= dims[0]) {
+			x = 0u;
+			y += COMPUTE_THREADS >> (wg_width + 5);
+		}
+	} while (y < dims[1]);
+
+	return list;
+}
+
+uint32_t
+FuncSim::read_ssp(FuncSimWG &s, unsigned int row)
+{
+	switch (row) {
+	case SSP_DIM_X:
+		return dims[0];
+	case SSP_DIM_Y:
+		return dims[1];
+	case SSP_WG_OFF_X:
+		return s.off_x << 5;
+	case SSP_WG_OFF_Y:
+		return s.off_y;
+	case SSP_WG_WIDTH:
+		return 32u << wg_width;
+	case SSP_SD_WORDS:
+		return s.sd_words;
+	case SSP_SD_PERIOD:
+		return s.sd_period;
+	case SSP_SD_PERIOD_CNT:
+		return s.sd_period_count;
+	default:
+		assert(false);
+		break;
+	}
+
+	return 0u;
+}
+
+const uint32_t *
+FuncSim::read_operand(FuncSimWG &s, const funcsim_insn &in, unsigned int i)
+{
+	uint32_t *o = s.opnd[i].data();
+	const Operand &src = in.src[i];
+	unsigned int row;
+	unsigned int t;
+	uint32_t v;
+
+	switch (src.getType()) {
+	case OPERAND_IMM:
+	case OPERAND_BRANCH_TARGET:
+		fill(s.opnd[i].begin(), s.opnd[i].end(), in.imm[i]);
+		return o;
+	case OPERAND_REG:
+		break;
+	default:
+		fill(s.opnd[i].begin(), s.opnd[i].end(), 0u);
+		return o;
+	}
+
+	row = src.getIndex();
+
+	switch (src.getRegisterType()) {
+	case REGISTER_VGPR:
+		return &s.vrf[row * COMPUTE_THREADS];
+	case REGISTER_SGPR:
+		fill(s.opnd[i].begin(), s.opnd[i].end(), s.srf[row]);
+		break;
+	case REGISTER_PR:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			o[t] = s.prf[row * COMPUTE_THREADS + t] ? 1u : 0u;
+		break;
+	case REGISTER_SSP:
+		fill(s.opnd[i].begin(), s.opnd[i].end(), read_ssp(s, row));
+		break;
+	case REGISTER_VSP:
+		switch (row) {
+		case VSP_CTRL_RUN:
+		case VSP_CTRL_BREAK:
+		case VSP_CTRL_RET:
+		case VSP_CTRL_EXIT:
+			for (t = 0; t < COMPUTE_THREADS; t++)
+				o[t] = s.cmask[row][t] ? 1u : 0u;
+			break;
+		case VSP_TID_X:
+			v = s.off_x << 5;
+			for (t = 0; t < COMPUTE_THREADS; t++)
+				o[t] = v + (t & ((32u << wg_width) - 1));
+			break;
+		case VSP_TID_Y:
+			for (t = 0; t < COMPUTE_THREADS; t++)
+				o[t] = s.off_y + (t >> (5 + wg_width));
+			break;
+		case VSP_LID_X:
+			for (t = 0; t < COMPUTE_THREADS; t++)
+				o[t] = t & ((32u << wg_width) - 1);
+			break;
+		case VSP_LID_Y:
+			for (t = 0; t < COMPUTE_THREADS; t++)
+				o[t] = t >> (5 + wg_width);
+			break;
+		case VSP_ZERO:
+			fill(s.opnd[i].begin(), s.opnd[i].end(), 0u);
+			break;
+		case VSP_ONE:
+			fill(s.opnd[i].begin(), s.opnd[i].end(), 1u);
+			break;
+		case VSP_MEM_IDX:
+			return s.cam_idx.data();
+		case VSP_MEM_DATA:
+			return s.cam_val.data();
+		default:
+			assert(false);
+			break;
+		}
+		break;
+	default:
+		fill(s.opnd[i].begin(), s.opnd[i].end(), 0u);
+		break;
+	}
+
+	return o;
+}
+
+uint32_t
+FuncSim::read_scalar(FuncSimWG &s, const funcsim_insn &in, unsigned int i)
+{
+	const Operand &src = in.src[i];
+
+	switch (src.getType()) {
+	case OPERAND_IMM:
+	case OPERAND_BRANCH_TARGET:
+		return in.imm[i];
+	case OPERAND_REG:
+		break;
+	default:
+		return 0u;
+	}
+
+	switch (src.getRegisterType()) {
+	case REGISTER_SGPR:
+		return s.srf[src.getIndex()];
+	case REGISTER_SSP:
+		return read_ssp(s, src.getIndex());
+	default:
+		return read_operand(s, in, i)[0];
+	}
+}
+
+void
+FuncSim::write_result(FuncSimWG &s, const Operand &dst, bool vec,
+		bool ignore_mask)
+{
+	unsigned int row;
+	unsigned int t;
+	uint32_t d;
+
+	if (dst.getType() != OPERAND_REG)
+		return;
+
+	row = dst.getIndex();
+
+	switch (dst.getRegisterType()) {
+	case REGISTER_SGPR:
+		s.srf[row] = s.res[0];
+		return;
+	case REGISTER_SSP:
+		switch (row) {
+		case SSP_SD_WORDS:
+			s.sd_words = s.res[0] & 0xfffffu;
+			break;
+		case SSP_SD_PERIOD:
+			s.sd_period = s.res[0] & 0xfffffu;
+			break;
+		case SSP_SD_PERIOD_CNT:
+			s.sd_period_count = s.res[0] & 0xfffffu;
+			break;
+		default:
+			break;
+		}
+		return;
+	default:
+		break;
+	}
+
+	for (t = 0; t < COMPUTE_THREADS; t++) {
+		if (!ignore_mask && !s.lanes_en[t])
+			continue;
+
+		d = s.res[vec ? t : 0];
+
+		switch (dst.getRegisterType()) {
+		case REGISTER_VGPR:
+			s.vrf[row * COMPUTE_THREADS + t] = d;
+			break;
+		case REGISTER_PR:
+			s.prf[row * COMPUTE_THREADS + t] = d & 1u;
+			break;
+		case REGISTER_VSP:
+			switch (row) {
+			case VSP_CTRL_RUN:
+			case VSP_CTRL_BREAK:
+			case VSP_CTRL_RET:
+			case VSP_CTRL_EXIT:
+				s.cmask[row][t] = (d != 0u);
+				break;
+			case VSP_MEM_IDX:
+				s.cam_idx[t] = d & 0x3fffffffu;
+				break;
+			case VSP_MEM_DATA:
+				s.cam_val[t] = d;
+				break;
+			default:
+				/* Remaining VSP registers are read-only. */
+				return;
+			}
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+bool
+FuncSim::update_lanes_en(FuncSimWG &s)
+{
+	unsigned int t;
+	bool any = false;
+
+	for (t = 0; t < COMPUTE_THREADS; t++) {
+		s.lanes_en[t] = s.cmask[VSP_CTRL_RUN][t] &
+				s.cmask[VSP_CTRL_BREAK][t] &
+				s.cmask[VSP_CTRL_RET][t] &
+				s.cmask[VSP_CTRL_EXIT][t];
+		any |= !!s.lanes_en[t];
+	}
+
+	return any;
+}
+
+bool
+FuncSim::finished(FuncSimWG &s)
+{
+	unsigned int t;
+
+	for (t = 0; t < COMPUTE_THREADS; t++) {
+		if (s.cmask[VSP_CTRL_EXIT][t])
+			return false;
+	}
+
+	return true;
+}
+
+void
+FuncSim::cpop(FuncSimWG &s)
+{
+	if (s.cstack.empty()) {
+		cerr << "Error: Control stack underflow at PC " << s.pc
+				<< ", WG (" << s.off_x << "," << s.off_y
+				<< ")" << endl;
+		exit(1);
+	}
+
+	const funcsim_cstack_entry &e = s.cstack.top();
+	e.get_pred(0, s.cmask[e.mask_type].data(), COMPUTE_THREADS);
+	s.pc = e.pc;
+	s.cstack.pop();
+}
+
+void
+FuncSim::cpush(FuncSimWG &s, unsigned int mask_type, unsigned int pc,
+		const uint32_t *pred)
+{
+	funcsim_cstack_entry e;
+
+	e.set_pred(0, pred, COMPUTE_THREADS);
+	e.pc = pc & (COMPUTE_IMEM_INSNS - 1);
+	e.mask_type = mask_type;
+
+	if (!s.cstack.push(e)) {
+		cerr << "Error: Control stack overflow at PC " << s.pc
+				<< ", WG (" << s.off_x << "," << s.off_y
+				<< ")" << endl;
+		exit(1);
+	}
+}
+
+void
+FuncSim::exec_lanes(FuncSimWG &s, const funcsim_insn &in)
+{
+	const uint32_t *a, *b, *c;
+	uint32_t *r = s.res.data();
+	uint32_t neg;
+	unsigned int t;
+
+	a = b = c = nullptr;
+	if (in.srcs > 0)
+		a = read_operand(s, in, 0);
+	if (in.srcs > 1)
+		b = read_operand(s, in, 1);
+	if (in.srcs > 2)
+		c = read_operand(s, in, 2);
+
+	neg = lane_ops::fpu_neg(in.subop.fpumod);
+
+	switch (in.op) {
+	case OP_MAD:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::mad(a[t], b[t] ^ neg, c[t]);
+		break;
+	case OP_ADD:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::add(a[t], b[t] ^ neg);
+		break;
+	case OP_MUL:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::mul(a[t], b[t] ^ neg);
+		break;
+	case OP_MIN:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::fmin(a[t], b[t]);
+		break;
+	case OP_MAX:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::fmax(a[t], b[t]);
+		break;
+	case OP_ABS:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::abs(a[t]);
+		break;
+	case OP_MOV:
+	case OP_MOVVSP:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = a[t];
+		break;
+	case OP_CVT:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::cvt(in.subop.cvt, a[t]);
+		break;
+	case OP_TEST:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::test(in.subop.test, a[t]);
+		break;
+	case OP_ITEST:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::itest(in.subop.test, a[t]);
+		break;
+	case OP_PBOOL:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::pbool(in.subop.pbool, a[t], b[t]);
+		break;
+	case OP_IADD:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::iadd(a[t], b[t]);
+		break;
+	case OP_ISUB:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::isub(a[t], b[t]);
+		break;
+	case OP_IMUL:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::imul(a[t], b[t]);
+		break;
+	case OP_IMAD:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::imad(a[t], b[t], c[t]);
+		break;
+	case OP_IMIN:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::imin(a[t], b[t]);
+		break;
+	case OP_IMAX:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::imax(a[t], b[t]);
+		break;
+	case OP_SHL:
+		/* The shift amount is sampled from the first lane of each
+		 * column, like IExecute does. */
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::shl(a[t], b[t & ~(FUNCSIM_LANES - 1)]);
+		break;
+	case OP_SHR:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::shr(a[t], b[t & ~(FUNCSIM_LANES - 1)]);
+		break;
+	case OP_AND:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::band(a[t], b[t]);
+		break;
+	case OP_OR:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::bor(a[t], b[t]);
+		break;
+	case OP_XOR:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::bxor(a[t], b[t]);
+		break;
+	case OP_NOT:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::bnot(a[t]);
+		break;
+	case OP_RCP:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::rcp(a[t]);
+		break;
+	case OP_RSQRT:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::rsqrt(a[t]);
+		break;
+	case OP_SIN:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::sin(a[t]);
+		break;
+	case OP_COS:
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			r[t] = lane_ops::cos(a[t]);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	write_result(s, in.dst, true, false);
+}
+
+void
+FuncSim::exec_scalar(FuncSimWG &s, const funcsim_insn &in)
+{
+	uint32_t a = 0, b = 0, c = 0;
+	Buffer bq;
+
+	if (in.srcs > 0)
+		a = read_scalar(s, in, 0);
+	if (in.srcs > 1)
+		b = read_scalar(s, in, 1);
+	if (in.srcs > 2)
+		c = read_scalar(s, in, 2);
+
+	switch (in.op) {
+	case OP_SMOV:
+	case OP_SMOVSSP:
+		s.res[0] = a;
+		break;
+	case OP_SCVT:
+		s.res[0] = lane_ops::cvt(in.subop.cvt, a);
+		break;
+	case OP_BUFQUERY:
+		bq = buf[in.imm[0] & (MC_BIND_BUFS - 1)];
+		if (!bq.valid) {
+			cout << "Error: querying unmapped buffer" << endl;
+			exit(-1);
+		}
+
+		if (in.subop.bufquery == BUFQUERY_DIM_X)
+			s.res[0] = bq.dims[0];
+		else
+			s.res[0] = bq.dims[1];
+		break;
+	case OP_SIADD:
+		s.res[0] = lane_ops::iadd(a, b);
+		break;
+	case OP_SISUB:
+		s.res[0] = lane_ops::isub(a, b);
+		break;
+	case OP_SIMUL:
+		s.res[0] = lane_ops::imul(a, b);
+		break;
+	case OP_SIMAD:
+		s.res[0] = lane_ops::imad(a, b, c);
+		break;
+	case OP_SIMIN:
+		s.res[0] = lane_ops::imin(a, b);
+		break;
+	case OP_SIMAX:
+		s.res[0] = lane_ops::imax(a, b);
+		break;
+	case OP_SINEG:
+		s.res[0] = lane_ops::ineg(a);
+		break;
+	case OP_SIBFIND:
+		s.res[0] = lane_ops::ibfind(a);
+		break;
+	case OP_SSHL:
+		s.res[0] = lane_ops::shl(a, b);
+		break;
+	case OP_SSHR:
+		s.res[0] = lane_ops::shr(a, b);
+		break;
+	case OP_SIDIV:
+		s.res[0] = lane_ops::idiv(a, b);
+		break;
+	case OP_SIMOD:
+		s.res[0] = lane_ops::imod(a, b);
+		break;
+	case OP_SAND:
+		s.res[0] = lane_ops::band(a, b);
+		break;
+	case OP_SOR:
+		s.res[0] = lane_ops::bor(a, b);
+		break;
+	case OP_SNOT:
+		s.res[0] = lane_ops::bnot(a);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	write_result(s, in.dst, false, false);
+}
+
+void
+FuncSim::ldst_descriptor(FuncSimWG &s, const funcsim_insn &in,
+		stride_descriptor &sd, bool &sp)
+{
+	funcsim_reg dst;
+	sc_uint<32> wg_w;
+	Buffer b, spb;
+
+	wg_w = 32 << wg_width;
+	b = buf[in.imm[0] & (MC_BIND_BUFS - 1)];
+	spb = sp_buf[in.imm[0] & (MC_BIND_BUFS - 1)];
+
+	if (in.dst.getType() == OPERAND_REG)
+		dst = in.dst.getRegister<COMPUTE_THREADS/COMPUTE_FPUS>(0, 0);
+
+	sd = stride_descriptor(dst);
+	sp = false;
+
+	switch (in.op) {
+	case OP_LDGLIN:
+	case OP_STGLIN:
+		ldst_ops::lin(sd, in.op == OP_STGLIN, in.subop.ldstlin, b,
+				COMPUTE_THREADS, wg_w, s.off_x, s.off_y,
+				dims[1], read_scalar(s, in, 1),
+				read_scalar(s, in, 2), dst.type);
+		break;
+	case OP_LDSPLIN:
+	case OP_STSPLIN:
+		ldst_ops::splin(sd, in.op == OP_STSPLIN, spb, COMPUTE_THREADS,
+				wg_w, read_scalar(s, in, 1),
+				read_scalar(s, in, 2), dst.type);
+		sp = true;
+		break;
+	case OP_LDGBIDX:
+	case OP_STGBIDX:
+		ldst_ops::bidx(sd, in.op == OP_STGBIDX, b, wg_w);
+		break;
+	case OP_LDGCIDX:
+	case OP_STGCIDX:
+		ldst_ops::cidx(sd, in.op == OP_STGCIDX, b, s.sd_period,
+				s.sd_period_count, s.sd_words,
+				read_scalar(s, in, 1), read_scalar(s, in, 2));
+		break;
+	case OP_LDGIDXIT:
+	case OP_STGIDXIT:
+		ldst_ops::gidxit(sd, in.op == OP_STGIDXIT, b);
+		break;
+	case OP_LDG2SPTILE:
+	case OP_STG2SPTILE:
+		sd = stride_descriptor();
+		sd.dst = RequestTarget(0, TARGET_SP);
+		ldst_ops::g2sptile(sd, in.op == OP_STG2SPTILE, b,
+				sp_buf[in.dst_imm & (MC_BIND_BUFS - 1)],
+				read_scalar(s, in, 1), read_scalar(s, in, 2));
+		break;
+	case OP_LDSPBIDX:
+	case OP_STSPBIDX:
+		ldst_ops::bidx(sd, in.op == OP_STSPBIDX, spb, spb.dims[0]);
+		sp = true;
+		break;
+	case OP_SLDG:
+		ldst_ops::sld(sd, b, read_scalar(s, in, 1));
+		break;
+	case OP_SLDSP:
+		ldst_ops::sldsp(sd, spb, read_scalar(s, in, 1),
+				read_scalar(s, in, 2), s.sd_words);
+		sp = true;
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+uint32_t
+FuncSim::ldst_read(FuncSimWG &s, bool sp, uint32_t addr)
+{
+	if (sp)
+		return s.sp[(addr & (SP_BYTES - 1)) >> 2];
+
+	return mem.read(addr);
+}
+
+void
+FuncSim::mem_write(FuncSimWG &s, uint32_t addr, uint32_t v)
+{
+	uint32_t prev;
+	size_t w;
+
+	w = addr >> 2;
+	if (race_detect && w < shadow_words) {
+		prev = shadow[w].exchange(s.idx + 1);
+
+		/* The previous writer must have finished before we started. */
+		if (prev != 0u && prev - 1 != s.idx &&
+		    wg_end[prev - 1].load() > wg_start[s.idx].load()) {
+			if (race_count++ < FUNCSIM_RACES_REPORTED) {
+				lock_guard<mutex> l(race_lock);
+				races.push_back({addr, prev - 1, s.idx});
+			}
+		}
+	}
+
+	mem.write(addr, v);
+}
+
+void
+FuncSim::ldst_write(FuncSimWG &s, bool sp, uint32_t addr, uint32_t v)
+{
+	if (sp)
+		s.sp[(addr & (SP_BYTES - 1)) >> 2] = v;
+	else
+		mem_write(s, addr, v);
+}
+
+void
+FuncSim::exec_ldst(FuncSimWG &s, const funcsim_insn &in)
+{
+	stride_descriptor sd;
+	bool sp;
+	unsigned int words, period, period_count, dst_period;
+	unsigned int off_x, off_y, xform;
+	unsigned int p, w, ph, lane, row, rel;
+	uint32_t addr, sp_addr, base, dst_offset;
+	size_t idx;
+	int t;
+
+	ldst_descriptor(s, in, sd, sp);
+
+	words = sd.words;
+	period = sd.period;
+	period_count = sd.period_count;
+	dst_period = sd.dst_period;
+	off_x = sd.dst_off_x;
+	off_y = sd.dst_off_y;
+	xform = sd.idx_transform;
+	base = sd.addr;
+	dst_offset = sd.dst_offset;
+	row = sd.getTargetReg().row;
+
+	if (sd.type == stride_descriptor::IDXIT) {
+		/* One word per enabled lane, index taken from vc.mem_idx. */
+		for (t = 0; t < COMPUTE_THREADS; t++) {
+			if (!s.lanes_en[t])
+				continue;
+
+			addr = base + (s.cam_idx[t] << 2);
+			idx = row * COMPUTE_THREADS + t;
+			if (sd.write)
+				mem_write(s, addr, s.vrf[idx]);
+			else
+				s.vrf[idx] = mem.read(addr);
+		}
+		return;
+	}
+
+	switch (sd.getTargetType()) {
+	case TARGET_SP:
+		/* DRAM <-> scratchpad tile, as laid out by StrideSequencer. */
+		for (p = 0; p < period_count; p++) {
+			for (w = 0; w < words; w++) {
+				addr = base + ((p * period + w) << 2);
+				if (dst_period >= words)
+					sp_addr = dst_offset +
+						((p * dst_period + w) << 2);
+				else
+					sp_addr = dst_offset +
+						((p * words + w) << 2);
+
+				if (sd.write)
+					mem_write(s, addr,
+						ldst_read(s, true, sp_addr));
+				else
+					ldst_write(s, true, sp_addr,
+						mem.read(addr));
+			}
+		}
+		break;
+	case TARGET_CAM:
+		/* Each lane plucks the word whose index matches vc.mem_idx
+		 * from the stream. For stores the lowest matching lane wins,
+		 * hence iterate in descending order. */
+		for (t = COMPUTE_THREADS - 1; t >= 0; t--) {
+			if (!s.lanes_en[t] || s.cam_idx[t] < dst_offset ||
+			    period_count == 0)
+				continue;
+
+			rel = s.cam_idx[t] - dst_offset;
+			p = period ? min(rel / period, period_count - 1) : 0;
+			w = rel - p * period;
+			if (w >= words)
+				continue;
+
+			addr = base + (rel << 2);
+			if (sd.write)
+				ldst_write(s, sp, addr, s.cam_val[t]);
+			else
+				s.cam_val[t] = ldst_read(s, sp, addr);
+		}
+		break;
+	case TARGET_REG:
+		for (p = 0; p < period_count; p++) {
+			for (w = 0; w < words; w++) {
+				addr = base + ((p * period + w) << 2);
+				ph = w + off_x;
+				lane = ((p + off_y) * dst_period) | (ph >> xform);
+
+				if (sd.getTargetReg().type == REGISTER_SGPR) {
+					idx = (row + lane) % 32;
+					if (sd.write)
+						ldst_write(s, sp, addr,
+								s.srf[idx]);
+					else
+						s.srf[idx] =
+							ldst_read(s, sp, addr);
+					continue;
+				}
+
+				if (lane >= COMPUTE_THREADS || !s.lanes_en[lane])
+					continue;
+
+				idx = (row + (ph & ((1u << xform) - 1))) *
+						COMPUTE_THREADS + lane;
+				if (idx >= s.vrf.size())
+					continue;
+
+				if (sd.write)
+					ldst_write(s, sp, addr, s.vrf[idx]);
+				else
+					s.vrf[idx] = ldst_read(s, sp, addr);
+			}
+		}
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+void
+FuncSim::exec_debug(FuncSimWG &s, const funcsim_insn &in)
+{
+	const uint32_t *v;
+	unsigned int t;
+	bfloat item;
+
+	switch (in.op) {
+	case OP_DBG_PRINTSGPR:
+		item.b = read_scalar(s, in, 0);
+		cout << "Print SGPR(" << s.off_x << "," << s.off_y << "): "
+				<< item.b << "/" << item.f << endl;
+		break;
+	case OP_DBG_PRINTVGPR:
+		v = read_operand(s, in, 0);
+		item.b = v[read_scalar(s, in, 1) & (COMPUTE_THREADS - 1)];
+		cout << "Print VGPR(" << s.off_x << "," << s.off_y << "): "
+				<< item.b << "/" << item.f << endl;
+		break;
+	case OP_DBG_PRINTPR:
+	case OP_DBG_PRINTCMASK:
+		v = read_operand(s, in, 0);
+		for (t = 0; t < COMPUTE_THREADS; t++) {
+			if ((t % FUNCSIM_LANES) == 0)
+				cout << (in.op == OP_DBG_PRINTPR ?
+					"Print PR(" : "Print CMASK(") <<
+					s.off_x << "," << s.off_y << "): ";
+
+			cout << v[t];
+
+			if ((t % FUNCSIM_LANES) == FUNCSIM_LANES - 1)
+				cout << endl;
+		}
+		break;
+	case OP_DBG_PRINTTRACE:
+		/* Tracing applies to the cycle-accurate model only. */
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+bool
+FuncSim::exec(FuncSimWG &s, const funcsim_insn &in)
+{
+	const uint32_t *pred;
+	unsigned int next_pc;
+	unsigned int mask_type;
+	unsigned int t;
+	bool res = false;
+	int v;
+
+	next_pc = s.pc + 1;
+
+	switch (in.op) {
+	case NOP:
+		break;
+	case OP_J:
+		next_pc = read_scalar(s, in, 0);
+		break;
+	case OP_SICJ:
+		v = read_scalar(s, in, 1);
+
+		switch (in.subop.test) {
+		case TEST_EZ:
+			res = (v == 0);
+			break;
+		case TEST_NZ:
+			res = (v != 0);
+			break;
+		case TEST_L:
+			res = (v < 0);
+			break;
+		case TEST_LE:
+			res = (v <= 0);
+			break;
+		case TEST_G:
+			res = (v > 0);
+			break;
+		case TEST_GE:
+			res = (v >= 0);
+			break;
+		default:
+			break;
+		}
+
+		if (res)
+			next_pc = read_scalar(s, in, 0);
+		break;
+	case OP_BRA:
+		pred = read_operand(s, in, 1);
+		cpush(s, VSP_CTRL_RUN, read_scalar(s, in, 0), pred);
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			s.res[t] = pred[t] ? 0u : 1u;
+		write_result(s, in.dst, true, false);
+		break;
+	case OP_CALL:
+		pred = read_operand(s, in, 1);
+		cpush(s, VSP_CTRL_RET, s.pc + 1, pred);
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			s.res[t] = pred[t] ? 1u : 0u;
+		write_result(s, in.dst, true, false);
+		next_pc = read_scalar(s, in, 0);
+		break;
+	case OP_CPUSH:
+		mask_type = funcsim_cstack_entry::cpush_mask_type(
+				in.subop.cpush);
+		cpush(s, mask_type, read_scalar(s, in, 0),
+				read_operand(s, in, 1));
+		break;
+	case OP_CPOP:
+		cpop(s);
+		return false;
+	case OP_EXIT:
+	case OP_BRK:
+	case OP_CMASK:
+		pred = read_operand(s, in, 0);
+		for (t = 0; t < COMPUTE_THREADS; t++)
+			s.res[t] = pred[t] ? 0u : 1u;
+		write_result(s, in.dst, true, false);
+		break;
+	case OP_TEST:
+	case OP_ITEST:
+	case OP_PBOOL:
+	case OP_MUL:
+	case OP_ADD:
+	case OP_MAD:
+	case OP_MIN:
+	case OP_MAX:
+	case OP_ABS:
+	case OP_MOV:
+	case OP_MOVVSP:
+	case OP_CVT:
+	case OP_IADD:
+	case OP_ISUB:
+	case OP_IMUL:
+	case OP_IMAD:
+	case OP_IMIN:
+	case OP_IMAX:
+	case OP_SHL:
+	case OP_SHR:
+	case OP_AND:
+	case OP_OR:
+	case OP_XOR:
+	case OP_NOT:
+	case OP_RCP:
+	case OP_RSQRT:
+	case OP_SIN:
+	case OP_COS:
+		exec_lanes(s, in);
+		break;
+	case OP_SMOV:
+	case OP_SMOVSSP:
+	case OP_SCVT:
+	case OP_BUFQUERY:
+	case OP_SIADD:
+	case OP_SISUB:
+	case OP_SIMUL:
+	case OP_SIMAD:
+	case OP_SIMIN:
+	case OP_SIMAX:
+	case OP_SINEG:
+	case OP_SIBFIND:
+	case OP_SSHL:
+	case OP_SSHR:
+	case OP_SIDIV:
+	case OP_SIMOD:
+	case OP_SAND:
+	case OP_SOR:
+	case OP_SNOT:
+		exec_scalar(s, in);
+		break;
+	case OP_LDGLIN:
+	case OP_STGLIN:
+	case OP_LDGBIDX:
+	case OP_STGBIDX:
+	case OP_LDGCIDX:
+	case OP_STGCIDX:
+	case OP_LDGIDXIT:
+	case OP_STGIDXIT:
+	case OP_LDG2SPTILE:
+	case OP_STG2SPTILE:
+	case OP_LDSPLIN:
+	case OP_STSPLIN:
+	case OP_LDSPBIDX:
+	case OP_STSPBIDX:
+	case OP_SLDG:
+	case OP_SLDSP:
+		exec_ldst(s, in);
+		if (in.post_exit)
+			return true;
+		break;
+	case OP_DBG_PRINTSGPR:
+	case OP_DBG_PRINTVGPR:
+	case OP_DBG_PRINTPR:
+	case OP_DBG_PRINTCMASK:
+	case OP_DBG_PRINTTRACE:
+		exec_debug(s, in);
+		break;
+	default:
+		cout << "FuncSim ERROR: Unhandled op " << in.insn.opToString()
+				<< endl;
+		break;
+	}
+
+	s.pc = next_pc & (COMPUTE_IMEM_INSNS - 1);
+
+	return false;
+}
+
+void
+FuncSim::run_wg(FuncSimWG &s, unsigned int off_x, unsigned int off_y)
+{
+	s.reset(off_x, off_y);
+
+	while (!finished(s)) {
+		/* No lane enabled: IDecode injects a CPOP. */
+		if (!update_lanes_en(s)) {
+			cpop(s);
+			continue;
+		}
+
+		if (s.pc >= code.size()) {
+			cerr << "Error: PC " << s.pc << " out of bounds, WG ("
+					<< off_x << "," << off_y << ")" << endl;
+			exit(1);
+		}
+
+		s.insns++;
+		if (exec(s, code[s.pc]))
+			break;
+	}
+}
+
+bool
+FuncSim::pop_wg(unsigned int w, size_t &i)
+{
+	lock_guard<mutex> l(queues[w].lock);
+
+	if (queues[w].head >= queues[w].tail)
+		return false;
+
+	i = queues[w].head++;
+
+	return true;
+}
+
+bool
+FuncSim::steal_wg(unsigned int w, size_t &i)
+{
+	unsigned int v;
+	unsigned int n;
+	size_t head = 0;
+	size_t tail = 0;
+
+	for (n = 1; n < workers; n++) {
+		v = (w + n) % workers;
+
+		{
+			lock_guard<mutex> l(queues[v].lock);
+
+			if (queues[v].head >= queues[v].tail)
+				continue;
+
+			/* Steal the back half, rounded up. */
+			tail = queues[v].tail;
+			head = tail - ((tail - queues[v].head + 1) / 2);
+			queues[v].tail = head;
+		}
+
+		lock_guard<mutex> l(queues[w].lock);
+		i = head;
+		queues[w].head = head + 1;
+		queues[w].tail = tail;
+
+		return true;
+	}
+
+	return false;
+}
+
+void
+FuncSim::worker(unsigned int w, FuncSimWG &s)
+{
+	size_t i;
+
+	while (pop_wg(w, i) || steal_wg(w, i)) {
+		s.idx = i;
+		if (race_detect)
+			wg_start[i] = ticket++;
+
+		run_wg(s, wg_list[i].first, wg_list[i].second);
+
+		if (race_detect)
+			wg_end[i] = ticket++;
+	}
+}
+
+void
+FuncSim::set_race_detect(bool enable)
+{
+	race_detect = enable;
+}
+
+void
+FuncSim::run(unsigned int threads)
+{
+	vector<FuncSimWG> s;
+	vector<thread> t;
+	unsigned int w;
+	size_t i;
+
+	wg_list = enumerate_wgs();
+	workers = max(1u, (unsigned int) min(size_t(threads), wg_list.size()));
+
+	queues.reset(new funcsim_worker_queue[workers]);
+	for (w = 0; w < workers; w++) {
+		queues[w].head = (wg_list.size() * w) / workers;
+		queues[w].tail = (wg_list.size() * (w + 1)) / workers;
+	}
+
+	race_count = 0ul;
+	races.clear();
+	if (race_detect) {
+		shadow_words = mem.size() / sizeof(uint32_t);
+		shadow.reset(new atomic<uint32_t>[shadow_words]);
+		for (i = 0; i < shadow_words; i++)
+			shadow[i] = 0u;
+
+		wg_start.reset(new atomic<unsigned long>[wg_list.size()]);
+		wg_end.reset(new atomic<unsigned long>[wg_list.size()]);
+		for (i = 0; i < wg_list.size(); i++) {
+			wg_start[i] = 0ul;
+			wg_end[i] = numeric_limits<unsigned long>::max();
+		}
+	}
+
+	s.resize(workers);
+
+	/* The calling thread acts as worker 0. */
+	for (w = 1; w < workers; w++)
+		t.push_back(thread(&FuncSim::worker, this, w, ref(s[w])));
+
+	worker(0, s[0]);
+
+	for (thread &th : t)
+		th.join();
+
+	wgs += wg_list.size();
+	for (FuncSimWG &ws : s)
+		insns += ws.insns;
+
+	shadow.reset();
+	wg_start.reset();
+	wg_end.reset();
+}
+
+unsigned long
+FuncSim::get_wgs(void) const
+{
+	return wgs;
+}
+
+unsigned long
+FuncSim::get_insns(void) const
+{
+	return insns;
+}
+
+unsigned long
+FuncSim::get_race_count(void) const
+{
+	return race_count;
+}
+
+const vector<funcsim_race> &
+FuncSim::get_races(void) const
+{
+	return races;
+}
+
+}
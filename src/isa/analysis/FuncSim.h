@@ -0,0 +1,411 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISA_ANALYSIS_FUNCSIM_H
+#define ISA_ANALYSIS_FUNCSIM_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "compute/model/ctrlstack.h"
+#include "isa/analysis/FlatMemory.h"
+#include "isa/model/Program.h"
+#include "model/Buffer.h"
+#include "model/stride_descriptor.h"
+#include "model/workgroup_width.h"
+#include "util/defaults.h"
+
+namespace isa_analysis {
+
+/** Maximum number of races recorded for reporting. */
+#define FUNCSIM_RACES_REPORTED 16
+
+/** Control stack entry of a functionally simulated work-group. */
+typedef compute_model::ctrlstack_entry<COMPUTE_THREADS,COMPUTE_PC_WIDTH>
+		funcsim_cstack_entry;
+
+/** Architectural state of a single work-group in functional simulation.
+ *
+ * Corresponds to one work-group slot of the RegFile, CtrlStack and
+ * scratchpad. A FuncSimWG object can be reused for any number of consecutive
+ * work-groups. Work-groups executing concurrently each require their own. */
+class FuncSimWG {
+public:
+	/** Index of the work-group in enumeration order. */
+	unsigned int idx;
+	/** Work-group offset in X-dimension, in multiples of 32 threads. */
+	unsigned int off_x;
+	/** Work-group offset in Y-dimension. */
+	unsigned int off_y;
+
+	/** Program counter. */
+	unsigned int pc;
+
+	/** Vector register file, 64 rows of COMPUTE_THREADS words. */
+	std::vector<uint32_t> vrf;
+	/** Scalar register file. */
+	uint32_t srf[32];
+	/** Predicate register file, 4 rows of COMPUTE_THREADS bits. */
+	std::vector<uint8_t> prf;
+	/** Control masks, indexed by VSP_CTRL_*. */
+	std::vector<uint8_t> cmask[4];
+	/** vc.mem_idx CAM indexes. */
+	std::vector<uint32_t> cam_idx;
+	/** vc.mem_data CAM values. */
+	std::vector<uint32_t> cam_val;
+
+	/** sc.sd_words. */
+	uint32_t sd_words;
+	/** sc.sd_period. */
+	uint32_t sd_period;
+	/** sc.sd_period_cnt. */
+	uint32_t sd_period_count;
+
+	/** Control stack. */
+	compute_model::ctrlstack<COMPUTE_THREADS,COMPUTE_PC_WIDTH,
+			COMPUTE_CSTACK_ENTRIES> cstack;
+
+	/** Scratchpad contents, indexed by word address. */
+	std::vector<uint32_t> sp;
+
+	/** Lanes enabled by the control masks, updated per instruction. */
+	std::vector<uint8_t> lanes_en;
+	/** Operand staging area for broadcast and special registers. */
+	std::vector<uint32_t> opnd[3];
+	/** Result staging area. */
+	std::vector<uint32_t> res;
+
+	/** Number of instructions executed. */
+	unsigned long insns;
+
+	/** Constructor. */
+	FuncSimWG();
+
+	/** Prepare for execution of a new work-group.
+	 *
+	 * Resets the control masks, control stack, stride descriptor and
+	 * program counter. Register and scratchpad contents are retained, like
+	 * they are in hardware.
+	 * @param x Work-group offset in X-dimension, in multiples of 32
+	 * 	    threads.
+	 * @param y Work-group offset in Y-dimension. */
+	void reset(unsigned int x, unsigned int y);
+};
+
+/** A pair of concurrently executing work-groups storing to the same word. */
+typedef struct {
+	/** Byte address of the word. */
+	uint32_t addr;
+	/** Enumeration index of the work-group that stored first. */
+	unsigned int wg_first;
+	/** Enumeration index of the work-group that stored second. */
+	unsigned int wg_second;
+} funcsim_race;
+
+/** Functional (untimed) simulator for Sim-D programs.
+ *
+ * Executes a program one work-group at a time against a FlatMemory image.
+ * Work-groups are enumerated the way WorkScheduler does. Each instruction is
+ * executed for all threads of a work-group at once, rather than one column of
+ * COMPUTE_FPUS lanes per cycle. Arithmetic, operand semantics, control stack
+ * behaviour and the construction of stride descriptors for loads and stores
+ * follow IDecode, IExecute and RegFile. Stride descriptors are then carried
+ * out in one go, mapping words to registers the way the memory controller's
+ * StrideIterator and the scratchpad's StrideSequencer do.
+ *
+ * Work-groups only communicate through DRAM buffers, hence they can be executed
+ * in any order. run() optionally distributes them over a pool of worker
+ * threads. Each worker starts with a contiguous range of work-groups, and steals
+ * half of the remaining range of another worker once it runs dry. With race
+ * detection enabled, every DRAM word remembers the last work-group that
+ * stored to it. A store to a word last written by a work-group that was
+ * still executing when the storing work-group started is reported as a race.
+ *
+ * No timing is modelled at all: only buffer contents are meaningful. */
+class FuncSim {
+private:
+	/** Range of work-group indexes owned by a worker thread. */
+	struct funcsim_worker_queue {
+		/** Protects head and tail. */
+		std::mutex lock;
+		/** Index of the next work-group to execute. */
+		size_t head;
+		/** One past the index of the last work-group owned. */
+		size_t tail;
+	};
+
+	/** Instruction decoded for functional execution. */
+	struct funcsim_insn {
+		/** Instruction, with implicit operands added by IDecode. */
+		isa_model::Instruction insn;
+		/** Operation. */
+		isa_model::ISAOp op;
+		/** Sub-operation. */
+		isa_model::ISASubOp subop;
+		/** True iff this is a vector instruction. */
+		bool vec;
+		/** True iff the work-group ends after this instruction. */
+		bool post_exit;
+		/** Number of source operands. */
+		unsigned int srcs;
+		/** Source operands. */
+		isa_model::Operand src[3];
+		/** Immediate value of each source operand. */
+		uint32_t imm[3];
+		/** Destination operand. */
+		isa_model::Operand dst;
+		/** Immediate value of the destination operand. */
+		uint32_t dst_imm;
+	};
+
+	/** Decoded program. */
+	std::vector<funcsim_insn> code;
+
+	/** DRAM buffer mappings. */
+	simd_model::Buffer buf[MC_BIND_BUFS];
+	/** Scratchpad buffer mappings. */
+	simd_model::Buffer sp_buf[MC_BIND_BUFS];
+
+	/** Global memory image. */
+	FlatMemory &mem;
+
+	/** Kernel dimensions. */
+	unsigned long dims[2];
+	/** Work-group width. */
+	simd_model::workgroup_width wg_width;
+
+	/** Number of work-groups executed. */
+	unsigned long wgs;
+	/** Number of instructions executed. */
+	unsigned long insns;
+
+	/** Work-group list of the kernel being run. */
+	std::vector<std::pair<unsigned int, unsigned int> > wg_list;
+	/** Per-worker work-group ranges. */
+	std::unique_ptr<funcsim_worker_queue[]> queues;
+	/** Number of worker threads. */
+	unsigned int workers;
+
+	/** True iff stores are checked for races between work-groups. */
+	bool race_detect;
+	/** Per DRAM word, 1 + index of the work-group that last stored to it.
+	 * 0 if the word was not stored to. */
+	std::unique_ptr<std::atomic<uint32_t>[]> shadow;
+	/** Number of words covered by shadow. */
+	size_t shadow_words;
+	/** Ticket taken by each work-group when it starts execution. */
+	std::unique_ptr<std::atomic<unsigned long>[]> wg_start;
+	/** Ticket taken by each work-group when it finishes execution. */
+	std::unique_ptr<std::atomic<unsigned long>[]> wg_end;
+	/** Ticket dispenser for wg_start and wg_end. */
+	std::atomic<unsigned long> ticket;
+	/** Number of races detected. */
+	std::atomic<unsigned long> race_count;
+	/** Protects races. */
+	std::mutex race_lock;
+	/** First races detected, up to FUNCSIM_RACES_REPORTED. */
+	std::vector<funcsim_race> races;
+
+	/** Add the implicit source and destination operands IDecode adds.
+	 * @param op Instruction to update. */
+	static void add_implicit_operands(isa_model::Instruction &op);
+
+	/** Read a scalar special purpose register.
+	 * @param s Work-group state.
+	 * @param row SSP register index.
+	 * @return Value of the register. */
+	uint32_t read_ssp(FuncSimWG &s, unsigned int row);
+
+	/** Return a pointer to COMPUTE_THREADS values of a source operand.
+	 * @param s Work-group state.
+	 * @param in Instruction.
+	 * @param i Source operand index.
+	 * @return Pointer to the operand values, valid until the next
+	 * 	   instruction. */
+	const uint32_t *read_operand(FuncSimWG &s, const funcsim_insn &in,
+			unsigned int i);
+
+	/** Return the value of a scalar source operand.
+	 * @param s Work-group state.
+	 * @param in Instruction.
+	 * @param i Source operand index.
+	 * @return The operand value as seen by lane 0. */
+	uint32_t read_scalar(FuncSimWG &s, const funcsim_insn &in,
+			unsigned int i);
+
+	/** Write the result of an instruction to its destination.
+	 * @param s Work-group state.
+	 * @param dst Destination operand.
+	 * @param vec True iff the result holds COMPUTE_THREADS values, false
+	 * 	      iff only the first value is valid.
+	 * @param ignore_mask True iff disabled lanes are written too. */
+	void write_result(FuncSimWG &s, const isa_model::Operand &dst,
+			bool vec, bool ignore_mask);
+
+	/** Recompute the enabled lanes from the control masks.
+	 * @param s Work-group state.
+	 * @return True iff any lane is enabled. */
+	bool update_lanes_en(FuncSimWG &s);
+
+	/** Return whether all threads of a work-group exited.
+	 * @param s Work-group state.
+	 * @return True iff the work-group finished execution. */
+	bool finished(FuncSimWG &s);
+
+	/** Pop an entry off the control stack.
+	 * @param s Work-group state. */
+	void cpop(FuncSimWG &s);
+
+	/** Push an entry on the control stack.
+	 * @param s Work-group state.
+	 * @param mask_type Control mask to restore upon pop.
+	 * @param pc Program counter to continue from upon pop.
+	 * @param pred Predicate mask values, COMPUTE_THREADS of them. */
+	void cpush(FuncSimWG &s, unsigned int mask_type, unsigned int pc,
+			const uint32_t *pred);
+
+	/** Execute a lane-parallel arithmetic, predicate or data copy
+	 * instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction. */
+	void exec_lanes(FuncSimWG &s, const funcsim_insn &in);
+
+	/** Execute a scalar arithmetic or data copy instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction. */
+	void exec_scalar(FuncSimWG &s, const funcsim_insn &in);
+
+	/** Construct the stride descriptor for a load/store instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction.
+	 * @param sd Stride descriptor to construct.
+	 * @param sp True iff the transfer is between scratchpad and register
+	 * 	     file, false iff it involves DRAM. */
+	void ldst_descriptor(FuncSimWG &s, const funcsim_insn &in,
+			simd_model::stride_descriptor &sd, bool &sp);
+
+	/** Read a word from DRAM or scratchpad.
+	 * @param s Work-group state.
+	 * @param sp True iff addr is a scratchpad address.
+	 * @param addr Byte address.
+	 * @return The word stored at addr. */
+	uint32_t ldst_read(FuncSimWG &s, bool sp, uint32_t addr);
+
+	/** Store a word to DRAM, checking for races if enabled.
+	 * @param s Work-group state.
+	 * @param addr Byte address.
+	 * @param v Value to write. */
+	void mem_write(FuncSimWG &s, uint32_t addr, uint32_t v);
+
+	/** Write a word to DRAM or scratchpad.
+	 * @param s Work-group state.
+	 * @param sp True iff addr is a scratchpad address.
+	 * @param addr Byte address.
+	 * @param v Value to write. */
+	void ldst_write(FuncSimWG &s, bool sp, uint32_t addr, uint32_t v);
+
+	/** Carry out a load/store instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction. */
+	void exec_ldst(FuncSimWG &s, const funcsim_insn &in);
+
+	/** Execute a debug print instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction. */
+	void exec_debug(FuncSimWG &s, const funcsim_insn &in);
+
+	/** Execute a single instruction.
+	 * @param s Work-group state.
+	 * @param in Instruction.
+	 * @return True iff the work-group must stop after this instruction. */
+	bool exec(FuncSimWG &s, const funcsim_insn &in);
+
+	/** Take the next work-group off a worker's own range.
+	 * @param w Worker index.
+	 * @param i Index of the work-group to execute.
+	 * @return False iff the range of this worker is empty. */
+	bool pop_wg(unsigned int w, size_t &i);
+
+	/** Steal half of the remaining range of another worker.
+	 * @param w Index of the worker stealing.
+	 * @param i Index of the work-group to execute.
+	 * @return False iff all other ranges are empty. */
+	bool steal_wg(unsigned int w, size_t &i);
+
+	/** Main loop of a worker thread.
+	 * @param w Worker index.
+	 * @param s Work-group state owned by this worker. */
+	void worker(unsigned int w, FuncSimWG &s);
+
+public:
+	/** Constructor.
+	 *
+	 * The program must have its branch targets resolved.
+	 * @param p Program to execute.
+	 * @param m Global memory image, sized to cover all buffers.
+	 * @param dim_x Kernel size in X-dimension.
+	 * @param dim_y Kernel size in Y-dimension.
+	 * @param w Work-group width. */
+	FuncSim(isa_model::Program &p, FlatMemory &m, unsigned long dim_x,
+			unsigned long dim_y, simd_model::workgroup_width w);
+
+	/** Enumerate all work-groups of the kernel in WorkScheduler order.
+	 * @return Vector of (off_x, off_y) pairs, off_x in multiples of 32
+	 * 	   threads. */
+	std::vector<std::pair<unsigned int, unsigned int> >
+	enumerate_wgs(void) const;
+
+	/** Execute a single work-group.
+	 * @param s Work-group state to execute in. Reset by this method.
+	 * @param off_x Work-group offset in X-dimension, in multiples of 32
+	 * 	        threads.
+	 * @param off_y Work-group offset in Y-dimension. */
+	void run_wg(FuncSimWG &s, unsigned int off_x, unsigned int off_y);
+
+	/** Enable or disable race detection for subsequent runs.
+	 * @param enable True iff stores should be checked for races. */
+	void set_race_detect(bool enable);
+
+	/** Execute all work-groups of the kernel.
+	 * @param threads Number of worker threads. With a single thread,
+	 * 		  work-groups are executed in enumeration order. */
+	void run(unsigned int threads = 1);
+
+	/** Return the number of work-groups executed by run().
+	 * @return The number of work-groups executed. */
+	unsigned long get_wgs(void) const;
+
+	/** Return the number of instructions executed by run().
+	 * @return The number of instructions executed. */
+	unsigned long get_insns(void) const;
+
+	/** Return the number of races detected by run().
+	 * @return The number of racing stores. */
+	unsigned long get_race_count(void) const;
+
+	/** Return the first races detected by run().
+	 * @return Up to FUNCSIM_RACES_REPORTED races. */
+	const std::vector<funcsim_race> &get_races(void) const;
+};
+
+}
+
+#endif /* ISA_ANALYSIS_FUNCSIM_H */
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "isa/analysis/StrideCache.h"
+#include "util/constmath.h"
+#include "util/defaults.h"
+
+using namespace std;
+using namespace simd_model;
+using namespace mc_model;
+
+/** Version of the cache entry format and memory controller model. */
+#define STRIDE_CACHE_VERSION 3
+
+namespace isa_analysis {
+
+/** Number of bytes after which the DRAM address mapping repeats itself, up to
+ * the row index. Within a channel, all address bits below the row bits select
+ * the bank and column. Channel bits are below the row bits too. */
+#define STRIDE_CACHE_ADDR_PERIOD (MC_DRAM_CHANS * (1ul << \
+	(const_log2(MC_BUS_WIDTH) + const_log2(MC_DRAM_COLS) - 1 + \
+	const_log2(MC_DRAM_BANKS))))
+
+/** 64-bit FNV-1a hash.
+ * @param s String to hash.
+ * @return Hash of s. */
+static uint64_t
+fnv1a(const string &s)
+{
+	uint64_t h = 0xcbf29ce484222325ull;
+
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 0x100000001b3ull;
+	}
+
+	return h;
+}
+
+/** Create a directory and all its parents.
+ * @param d Directory to create.
+ * @return True iff the directory exists after this call. */
+static bool
+mkdir_p(const string &d)
+{
+	string::size_type pos = 0;
+	struct stat st;
+
+	while ((pos = d.find('/', pos + 1)) != string::npos)
+		mkdir(d.substr(0, pos).c_str(), 0755);
+
+	mkdir(d.c_str(), 0755);
+
+	return (stat(d.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+}
+
+/** Reinterpret a double as its bit pattern, for lossless serialisation.
+ * @param d Double.
+ * @return Bit pattern of d. */
+static uint64_t
+double_bits(double d)
+{
+	uint64_t b;
+
+	memcpy(&b, &d, sizeof(b));
+	return b;
+}
+
+/** Reinterpret a bit pattern as a double.
+ * @param b Bit pattern.
+ * @return Double with bit pattern b. */
+static double
+bits_double(uint64_t b)
+{
+	double d;
+
+	memcpy(&d, &b, sizeof(d));
+	return d;
+}
+
+StrideCache::StrideCache(string d)
+: dir(d), hits(0ul), misses(0ul)
+{
+	const char *env;
+
+	if (dir != "")
+		return;
+
+	if ((env = getenv("SIMD_CACHE_DIR")) && env[0])
+		dir = string(env);
+	else if ((env = getenv("XDG_CACHE_HOME")) && env[0])
+		dir = string(env) + "/simd";
+	else if ((env = getenv("HOME")) && env[0])
+		dir = string(env) + "/.cache/simd";
+	else
+		dir = ".simd_cache";
+}
+
+string
+StrideCache::key(stride_descriptor &sd, bool sweep)
+{
+	stringstream ss;
+
+	ss << "v" << STRIDE_CACHE_VERSION << ";" << MC_DRAM_SPEED << ";" <<
+		MC_DRAM_ORG << ";" << MC_DRAM_BANKS << "," << MC_DRAM_ROWS <<
+		"," << MC_DRAM_COLS << "," << MC_BUS_WIDTH << "," <<
+		COMPUTE_THREADS << ";" << MC_DRAM_CHANS << "," <<
+		MC_DRAM_CHAN_INTERLEAVE << ";";
+
+	/* Descriptors that only differ in the row index of their address
+	 * generate the same DRAM command sequence (see alignment_signature()
+	 * in wcet), hence share an entry. */
+	ss << hex << ((unsigned long) sd.addr % STRIDE_CACHE_ADDR_PERIOD) <<
+		dec << "," << sd.words << "," << sd.period <<
+		"," << sd.period_count << "," << sd.dst_period << "," <<
+		sd.write << "," << sd.idx_transform << ";" << sweep;
+
+	return ss.str();
+}
+
+string
+StrideCache::path(const string &k)
+{
+	stringstream ss;
+
+	ss << dir << "/stride_" << hex << setfill('0') << setw(16) << fnv1a(k);
+
+	return ss.str();
+}
+
+bool
+StrideCache::lookup(stride_descriptor &sd, bool sweep, cmdarb_stats *stats)
+{
+	string k;
+	string fk;
+	ifstream fs;
+	unsigned int i;
+	uint64_t dq_util, energy, power;
+
+	k = key(sd, sweep);
+	fs.open(path(k));
+	if (!fs.is_open())
+		goto miss;
+
+	getline(fs, fk);
+	if (fk != k)
+		goto miss;
+
+	for (i = STATS_MIN; i <= STATS_AGG; i++) {
+		fs >> stats[i].base_addr >> stats[i].lid >> stats[i].lda >>
+			stats[i].act_c >> stats[i].pre_c >> stats[i].cas_c >>
+			stats[i].ref_c >> stats[i].bytes >> hex >> dq_util >>
+			energy >> power >> dec;
+
+		if (!fs)
+			goto miss;
+
+		stats[i].dq_util = bits_double(dq_util);
+		stats[i].energy = bits_double(energy);
+		stats[i].power = bits_double(power);
+	}
+
+	hits++;
+	return true;
+
+miss:
+	misses++;
+	return false;
+}
+
+void
+StrideCache::store(stride_descriptor &sd, bool sweep, const cmdarb_stats *stats)
+{
+	string k;
+	string p;
+	string tmp;
+	ofstream fs;
+	unsigned int i;
+
+	if (!mkdir_p(dir))
+		return;
+
+	k = key(sd, sweep);
+	p = path(k);
+	tmp = p + "." + to_string(getpid());
+
+	/* Write to a temporary file first, rename is atomic. This permits
+	 * concurrent wcet processes to share a cache directory. */
+	fs.open(tmp, ios_base::out | ios_base::trunc);
+	if (!fs.is_open())
+		return;
+
+	fs << k << endl;
+	for (i = STATS_MIN; i <= STATS_AGG; i++) {
+		fs << stats[i].base_addr << " " << stats[i].lid << " " <<
+			stats[i].lda << " " << stats[i].act_c << " " <<
+			stats[i].pre_c << " " << stats[i].cas_c << " " <<
+			stats[i].ref_c << " " << stats[i].bytes << " " << hex <<
+			double_bits(stats[i].dq_util) << " " <<
+			double_bits(stats[i].energy) << " " <<
+			double_bits(stats[i].power) << dec << endl;
+	}
+	fs.close();
+
+	if (!fs || rename(tmp.c_str(), p.c_str()) != 0)
+		unlink(tmp.c_str());
+}
+
+unsigned long
+StrideCache::getHits(void) const
+{
+	return hits;
+}
+
+unsigned long
+StrideCache::getMisses(void) const
+{
+	return misses;
+}
+
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISA_ANALYSIS_STRIDECACHE_H
+#define ISA_ANALYSIS_STRIDECACHE_H
+
+#include <string>
+
+#include "model/stride_descriptor.h"
+#include "mc/model/cmdarb_stats.h"
+
+namespace isa_analysis {
+
+/** Persistent on-disk cache of stride descriptor simulation results.
+ *
+ * DRAM simulation of a stride descriptor is deterministic for a given
+ * descriptor shape and memory controller configuration. This cache stores the
+ * min/max/aggregate cmdarb_stats of each simulated (sweep of a) descriptor in
+ * a file named after a hash of the key. The full key is stored inside the file
+ * too, such that hash collisions are detected rather than silently returning
+ * the wrong results.
+ *
+ * The key consists of the DRAM configuration (MC_DRAM_SPEED, MC_DRAM_ORG,
+ * MC_DRAM_BANKS, ...), all stride descriptor parameters that affect DRAM
+ * timing, and the sweep flag. The descriptor address is reduced to its offset
+ * within the period of the DRAM address mapping: under the closed-page
+ * policy, only the equality of rows affects timing, not the row index. Bump STRIDE_CACHE_VERSION whenever a change to
+ * the memory controller model alters its timing behaviour. */
+class StrideCache {
+private:
+	/** Directory containing cache entries. */
+	std::string dir;
+
+	/** Number of cache hits. */
+	unsigned long hits;
+	/** Number of cache misses. */
+	unsigned long misses;
+
+	/** Generate the key for a given stride descriptor.
+	 * @param sd Stride descriptor.
+	 * @param sweep True iff all DRAM alignments are simulated.
+	 * @return A string uniquely describing this simulation. */
+	std::string key(simd_model::stride_descriptor &sd, bool sweep);
+
+	/** Return the path of the cache file for a given key.
+	 * @param k Key string.
+	 * @return Path to the cache file. */
+	std::string path(const std::string &k);
+
+public:
+	/** Constructor.
+	 * @param d Cache directory. If empty, $SIMD_CACHE_DIR is used, or
+	 * 	    $XDG_CACHE_HOME/simd, or ~/.cache/simd, in that order. */
+	StrideCache(std::string d = "");
+
+	/** Look up the simulation results for a given stride descriptor.
+	 * @param sd Stride descriptor.
+	 * @param sweep True iff all DRAM alignments are simulated.
+	 * @param stats Array of three cmdarb_stats objects (min, max, agg) to
+	 * 		store results in.
+	 * @return True iff the results were found in the cache. */
+	bool lookup(simd_model::stride_descriptor &sd, bool sweep,
+			mc_model::cmdarb_stats *stats);
+
+	/** Store simulation results for a given stride descriptor.
+	 * @param sd Stride descriptor.
+	 * @param sweep True iff all DRAM alignments are simulated.
+	 * @param stats Array of three cmdarb_stats objects (min, max, agg). */
+	void store(simd_model::stride_descriptor &sd, bool sweep,
+			const mc_model::cmdarb_stats *stats);
+
+	/** Return the number of cache hits.
+	 * @return The number of cache hits. */
+	unsigned long getHits(void) const;
+
+	/** Return the number of cache misses.
+	 * @return The number of cache misses. */
+	unsigned long getMisses(void) const;
+};
+
+}
+
+#endif /* ISA_ANALYSIS_STRIDECACHE_H */
@@ -884,12 +884,6 @@ Instruction::Instruction(ISAOp operation, ISASubOp suboperation,
 	assert(validate());
 }
 
-Instruction::~Instruction(void)
-{
-	if (md)
-		delete md;
-}
-
 bool
 Instruction::checkOperandType(Operand &oper, unsigned int typemask)
 {
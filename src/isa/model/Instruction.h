@@ -271,7 +271,9 @@ private:
 	/** True iff this instruction ends with an unconditional exit. */
 	bool post_exit;
 
-	/** Optional metadata. */
+	/** Optional metadata, owned by the Program this instruction was
+	 * parsed into. Copies, like those travelling down the pipeline, refer
+	 * to the same object, so copying is a plain pointer copy. */
 	Metadata *md;
 
 	/** Parse the sub-operation from an input string.
@@ -317,9 +319,6 @@ public:
 	 * 	     purposes. */
 	Instruction(string &op, string &l, int ln);
 
-	/** Destructor */
-	~Instruction(void);
-
 	/** Validate whether instruction is valid or not.
 	 * @return true iff this object is valid. */
 	bool validate(void);
@@ -496,7 +495,8 @@ public:
 	unsigned int getConsecutiveDstRegs(unsigned int sd_words);
 
 	/** Attach branchcycle or load/store cost metadata to this instruction.
-	 * @param m Metadata to attach. */
+	 * @param m Metadata to attach, allocated with
+	 * 	    Program::alloc_metadata(). Not owned by the instruction. */
 	void addMetadata(Metadata *m);
 
 	/** Return the branchcycle or load/store cost metadata associated with
@@ -713,10 +713,7 @@ public:
 		on_cstack_sb = v.on_cstack_sb;
 		line = v.line;
 		post_exit = v.post_exit;
-		if (v.md)
-			md = v.md->clone();
-		else
-			md = nullptr;
+		md = v.md;
 
 		srcs = v.srcs;
 		for (unsigned int i = 0; i < v.srcs; i++)
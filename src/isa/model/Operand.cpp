@@ -18,6 +18,8 @@
 
 #include <stdexcept>
 #include <limits>
+#include <unordered_map>
+#include <vector>
 
 #include "isa/model/Operand.h"
 #include "isa/model/BB.h"
@@ -67,8 +69,38 @@ static const RegisterType stateToRegType[S_SENTINEL] = {
 		[S_LABEL] = REGISTER_NONE,
 };
 
+/** Interned branch target labels. Index 0 is reserved for "no label". */
+static vector<string> &
+label_table(void)
+{
+	static vector<string> t(1, "");
+
+	return t;
+}
+
+/** Return the index of a branch target label in the label table, adding it
+ * when it wasn't seen before.
+ * @param id Label string.
+ * @return Index of this label in label_table(). */
+static unsigned int
+intern_label(const string &id)
+{
+	static unordered_map<string, unsigned int> idx;
+	vector<string> &t = label_table();
+	unordered_map<string, unsigned int>::iterator it;
+
+	it = idx.find(id);
+	if (it != idx.end())
+		return it->second;
+
+	t.push_back(id);
+	idx[id] = t.size() - 1;
+
+	return t.size() - 1;
+}
+
 Operand::Operand(RegisterType rt, unsigned int idx)
-: type(OPERAND_REG), rtype(rt), payload(idx), branch_target(""),
+: type(OPERAND_REG), rtype(rt), payload(idx), label(0),
   target_bb(nullptr)
 {
 	if (idx > maxPayload[rt])
@@ -76,18 +108,18 @@ Operand::Operand(RegisterType rt, unsigned int idx)
 }
 
 Operand::Operand(unsigned int p)
-: type(OPERAND_IMM), rtype(REGISTER_IMM), payload(p), branch_target(""),
+: type(OPERAND_IMM), rtype(REGISTER_IMM), payload(p), label(0),
   target_bb(nullptr)
 {
 }
 
 Operand::Operand()
-: type(OPERAND_NONE), rtype(REGISTER_NONE), payload(0), branch_target(""),
+: type(OPERAND_NONE), rtype(REGISTER_NONE), payload(0), label(0),
   target_bb(nullptr)
 {
 }
 
-Operand::Operand(string &s) : target_bb(nullptr)
+Operand::Operand(string &s) : label(0), target_bb(nullptr)
 {
 	bfloat bf;
 	unsigned int ridx;
@@ -201,7 +233,7 @@ Operand::Operand(string &s) : target_bb(nullptr)
 
 				type = OPERAND_BRANCH_TARGET;
 				rtype = REGISTER_IMM;
-				branch_target = id;
+				label = intern_label(id);
 			}
 
 			goto exit_op;
@@ -344,7 +376,7 @@ Operand::getValue()
 string
 Operand::getBranchTarget() const
 {
-	return branch_target;
+	return label_table()[label];
 }
 
 BB *
@@ -52,8 +52,10 @@ private:
 	/** Payload. Imm: value, otherwise reg index */
 	unsigned int payload;
 
-	/** Branch target label. */
-	string branch_target;
+	/** Branch target label, as index into the interned label table. Keeps
+	 * Operand trivially copyable, such that Instructions can be passed
+	 * down the pipeline without touching the heap. */
+	unsigned int label;
 
 	/** Resolved branch target BB. */
 	BB *target_bb;
@@ -114,7 +116,7 @@ public:
 	 * @param col Column (warp) for this register.
 	 */
 	template<unsigned int COLS>
-	Register<COLS> getRegister(sc_uint<1> wg,
+	Register<COLS> getRegister(sc_uint<COMPUTE_WG_WIDTH> wg,
 			sc_uint<const_log2(COLS)> col) const
 	{
 		assert(type != OPERAND_BRANCH_TARGET || branch_target_resolved());
@@ -204,7 +206,7 @@ public:
 			if (branch_target_resolved())
 				return payload == v.payload;
 			else
-				return branch_target == v.branch_target;
+				return label == v.label;
 
 			break;
 		case OPERAND_NONE:
@@ -288,7 +290,7 @@ public:
 			if (v.branch_target_resolved())
 				os << v.payload;
 			else
-				os << v.branch_target;
+				os << v.getBranchTarget();
 			break;
 		default:
 			os << "ERROR";
@@ -309,7 +311,7 @@ public:
 		rtype = v.rtype;
 		payload = v.payload;
 		target_bb = v.target_bb;
-		branch_target = v.branch_target;
+		label = v.label;
 
 		return *this;
 	}
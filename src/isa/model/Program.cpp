@@ -49,6 +49,19 @@ Program::~Program()
 	delete[] vrf_wr;
 	delete[] srf_wr;
 	delete[] prf_wr;
+
+	while (md_store.size()) {
+		delete md_store.back();
+		md_store.pop_back();
+	}
+}
+
+Metadata *
+Program::alloc_metadata(void)
+{
+	md_store.push_back(new Metadata());
+
+	return md_store.back();
 }
 
 bool
@@ -125,6 +138,9 @@ Program::parse_data(unsigned int l, string &s)
 			case 'f':
 				btype = BINARY;
 				break;
+			case 'y':
+				btype = NUMPY;
+				break;
 			case 'n':
 				btype = INPUT_NONE;
 				break;
@@ -174,7 +190,7 @@ Program::parse_bound(unsigned int l, string &s)
 		value_annotation_line = l;
 	} else {
 		if (!md)
-			md = new Metadata();
+			md = alloc_metadata();
 
 		try {
 			md->updateFromString(label, s);
@@ -231,7 +247,7 @@ Program::metadata_ldst(Instruction *op)
 	md = op->getMetadata();
 
 	if (!md) {
-		md = new Metadata();
+		md = alloc_metadata();
 		op->addMetadata(md);
 	}
 
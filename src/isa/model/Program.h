@@ -106,6 +106,10 @@ private:
 	/** Pointer to metadata structure used for static WCET analysis. */
 	Metadata *md;
 
+	/** Storage for all metadata of this program's instructions.
+	 * Instructions only hold pointers into it. */
+	vector<Metadata *> md_store;
+
 	/** Emit a warning.
 	 * @param l Line of occurance of warning.
 	 * @param s String to print as a warning. */
@@ -249,6 +253,13 @@ public:
 	 * @return Dummy end constant iterator. */
 	vector<BB *>::const_reverse_iterator crend() const;
 
+	/** Allocate a metadata object owned by this Program.
+	 *
+	 * The object lives as long as this Program, such that instructions
+	 * and all their copies can refer to it without ownership.
+	 * @return Pointer to a new metadata object. */
+	Metadata *alloc_metadata(void);
+
 	/** Return the BB corresponding with a given identifier
 	 * @param i BB ID
 	 * @return pointer to the corresponding BB. */
@@ -54,29 +54,60 @@ ProgramPhaseList::ProgramPhaseList(DAG *dag, unsigned long pipe_depth)
 }
 
 unsigned long
-ProgramPhaseList::WCET(unsigned long workgroups)
+ProgramPhaseList::interleavedRound(unsigned int slots) const
+{
+	unsigned long execute;
+	unsigned long access;
+	unsigned long round;
+	unsigned int i, j, n;
+
+	n = phases.size();
+	round = 0ul;
+
+	for (i = 0; i < n; i++) {
+		execute = 0ul;
+		access = 0ul;
+
+		/* Scratchpad and DRAM accesses are treated as one resource,
+		 * they share the register file store port. */
+		for (j = 0; j < slots; j++) {
+			if (phases[(i + j) % n].first == PHASE_EXECUTE)
+				execute += phases[(i + j) % n].second;
+			else
+				access += phases[(i + j) % n].second;
+		}
+
+		round += max(execute, access);
+	}
+
+	return round;
+}
+
+unsigned long
+ProgramPhaseList::WCET(unsigned long workgroups, unsigned int slots)
 {
-	unsigned long wcet_1t;
-	unsigned long wcet_interleaved;
 	unsigned long w;
-	unsigned int i;
+	unsigned long rem;
+	unsigned int i, n;
 
-	wcet_1t = 0ul;
-	wcet_interleaved = 0ul;
+	if (slots < 1)
+		throw invalid_argument("Need at least one work-group slot.");
 
-	for (i = 0; i < phases.size(); i++) {
-		wcet_1t += phases[i].second;
-		wcet_interleaved += max(phases[i].second,
-				phases[(i+1) % phases.size()].second);
+	n = phases.size();
+	rem = workgroups % slots;
+
+	w = interleavedRound(slots) * (workgroups / slots);
+	if (rem) {
+		/* Partially filled last round. */
+		w += interleavedRound(rem);
 	}
 
-	w = wcet_interleaved * (workgroups >> 1);
-	if (workgroups % 2) {
-		/* Odd # workgroups.*/
-		w += wcet_1t;
-	} else {
-		/* Even # WGs */
-		w += min(phases[0].second,phases[phases.size() - 1].second);
+	/* Ramp of the staggered work-groups in the last round. With one
+	 * work-group left there is no stagger. */
+	if (rem != 1) {
+		for (i = 1; i < (rem ? rem : slots); i++)
+			w += min(phases[(i - 1) % n].second,
+					phases[(n - (i % n)) % n].second);
 	}
 
 	return w;
@@ -84,7 +115,7 @@ ProgramPhaseList::WCET(unsigned long workgroups)
 
 unsigned long
 ProgramPhaseList::PerfectParallelismWCETLB(const dram_timing *dram,
-		unsigned long workgroups)
+		unsigned long workgroups, unsigned int clusters)
 {
 	unsigned long wcet[PHASE_SENTINEL];
 	unsigned long w;
@@ -99,9 +130,12 @@ ProgramPhaseList::PerfectParallelismWCETLB(const dram_timing *dram,
 	w = 0ul;
 
 	for (i = 0; i < PHASE_SENTINEL; i++) {
-		wcet[i] *= workgroups;
-		if (i == unsigned(PHASE_ACCESS_DRAM))
+		if (i == unsigned(PHASE_ACCESS_DRAM)) {
+			wcet[i] *= workgroups;
 			wcet[i] = inflate_refresh(dram, wcet[i]);
+		} else {
+			wcet[i] *= div_round_up(workgroups, clusters);
+		}
 		w = max(w, wcet[i]);
 	}
 
@@ -136,6 +170,28 @@ ProgramPhaseList::SingleBufferedWCET(unsigned long workgroups)
 	return wcet_1t * workgroups;
 }
 
+void
+ProgramPhaseList::arbitrate(unsigned int clusters, unsigned long grant_cycles)
+{
+	unsigned long slot;
+	unsigned int i;
+
+	if (clusters <= 1)
+		return;
+
+	slot = 0ul;
+	for (i = 0; i < phases.size(); i++) {
+		if (phases[i].first == PHASE_ACCESS_DRAM)
+			slot = max(slot, phases[i].second);
+	}
+	slot += grant_cycles;
+
+	for (i = 0; i < phases.size(); i++) {
+		if (phases[i].first == PHASE_ACCESS_DRAM)
+			phases[i].second += grant_cycles + (clusters - 1) * slot;
+	}
+}
+
 unsigned int
 ProgramPhaseList::countPhases(void) const
 {
@@ -41,22 +41,37 @@ class ProgramPhaseList {
 private:
 	/** List of program phases. Pairs of \<type, cost\>. */
 	std::vector<std::pair<program_phase_t, unsigned long> > phases;
+
+	/** Return the cost of one round of interleaved work-groups.
+	 *
+	 * Each work-group in the round lags its predecessor by one phase.
+	 * In every step, phases of the same type serialise, while execute
+	 * and access phases overlap.
+	 * @param slots Number of work-groups interleaved in this round.
+	 * @return The cost of the round in compute cycles. */
+	unsigned long interleavedRound(unsigned int slots) const;
+
 public:
 	/** Construct a ProgramPhaseList from a DAG */
 	ProgramPhaseList(DAG *dag, unsigned long pipe_depth);
 
 	/** Return the WCET for this ProgramPhaseList
 	 * @param workgroups Number of work-groups that execute this phase list.
+	 * @param slots Number of resident work-group slots per SimdCluster.
 	 * @return The WCET in compute cycles. */
-	unsigned long WCET(unsigned long workgroups);
+	unsigned long WCET(unsigned long workgroups, unsigned int slots = 2);
 
 	/** Return a lower bound on the WCET based on all resources running
 	 * in parallel at maximum rate, without dependencies between phases.
+	 *
+	 * The DRAM is shared by all clusters, each cluster has its own
+	 * compute pipeline and scratchpads.
 	 * @param dram DRAM timing parameters
 	 * @param workgroups Number of work-groups executing this phase list.
+	 * @param clusters Number of SimdClusters executing work-groups.
 	 * @return A non-tight lower bound WCET, inflated for DRAM refresh. */
 	unsigned long PerfectParallelismWCETLB(const dram::dram_timing *dram,
-			unsigned long workgroups);
+			unsigned long workgroups, unsigned int clusters = 1);
 
 	/** Return a lower bound on the WCET based on always having two work-
 	 * groups running in parallel, independent of whether they might use
@@ -71,6 +86,18 @@ public:
 	 * @return An upper bound WCET, not inflated for DRAM refresh. */
 	unsigned long SingleBufferedWCET(unsigned long workgroups);
 
+	/** Account for sharing the DRAM between multiple SimdClusters.
+	 *
+	 * The cluster arbiter grants DRAM in round-robin order at stride
+	 * descriptor granularity. Each DRAM access phase is thus delayed by at
+	 * most one access of every other cluster, bounded by the longest DRAM
+	 * access phase of this list. Every access additionally pays the grant
+	 * handshake. Must only be called once, after the lower bounds are
+	 * computed from the unarbitrated list.
+	 * @param clusters Number of SimdClusters sharing the DRAM.
+	 * @param grant_cycles Cost of the grant handshake in compute cycles. */
+	void arbitrate(unsigned int clusters, unsigned long grant_cycles);
+
 	/** Get the number of phases in this phase list.
 	 * @return The number of phases in this phase list. */
 	unsigned int countPhases(void) const;
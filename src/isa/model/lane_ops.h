@@ -0,0 +1,463 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISA_MODEL_LANE_OPS_H
+#define ISA_MODEL_LANE_OPS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "isa/model/Instruction.h"
+#include "util/constmath.h"
+
+namespace isa_model {
+
+/** Semantics of the arithmetic, logic and compare operations on a single lane.
+ *
+ * These are the reference semantics of the ISA. Both the cycle-accurate
+ * IExecute and the functional simulator apply them per lane, so that the two
+ * cannot diverge. Operands and results are the 32-bit register contents; float
+ * operations reinterpret them as IEEE-754 binary32. Scalar operations use the
+ * same helpers on lane 0. */
+namespace lane_ops {
+
+/** Return the sign mask applied to the second operand of MAD, ADD and MUL.
+ * @param mod Instruction modifier.
+ * @return 0x80000000 iff the operand must be negated, 0 otherwise. */
+inline uint32_t
+fpu_neg(ISASubOpFPUMod mod)
+{
+	return (mod == FPU_NEG) ? 0x80000000u : 0u;
+}
+
+/** Floating point multiply-add.
+ * @param a First multiplicand.
+ * @param b Second multiplicand, sign already flipped by fpu_neg() if required.
+ * @param c Addend.
+ * @return a * b + c. */
+inline uint32_t
+mad(uint32_t a, uint32_t b, uint32_t c)
+{
+	simd_util::bfloat m1, m2, m3, res;
+
+	m1.b = a;
+	m2.b = b;
+	m3.b = c;
+	res.f = m1.f * m2.f + m3.f;
+
+	return res.b;
+}
+
+/** Floating point addition.
+ * @param a First operand.
+ * @param b Second operand, sign already flipped by fpu_neg() if required.
+ * @return a + b. */
+inline uint32_t
+add(uint32_t a, uint32_t b)
+{
+	simd_util::bfloat m1, m2, res;
+
+	m1.b = a;
+	m2.b = b;
+	res.f = m1.f + m2.f;
+
+	return res.b;
+}
+
+/** Floating point multiplication.
+ * @param a First operand.
+ * @param b Second operand, sign already flipped by fpu_neg() if required.
+ * @return a * b. */
+inline uint32_t
+mul(uint32_t a, uint32_t b)
+{
+	simd_util::bfloat m1, m2, res;
+
+	m1.b = a;
+	m2.b = b;
+	res.f = m1.f * m2.f;
+
+	return res.b;
+}
+
+/** Floating point minimum.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return min(a, b). */
+inline uint32_t
+fmin(uint32_t a, uint32_t b)
+{
+	simd_util::bfloat m1, m2, res;
+
+	m1.b = a;
+	m2.b = b;
+	res.f = std::min(m1.f, m2.f);
+
+	return res.b;
+}
+
+/** Floating point maximum.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return max(a, b). */
+inline uint32_t
+fmax(uint32_t a, uint32_t b)
+{
+	simd_util::bfloat m1, m2, res;
+
+	m1.b = a;
+	m2.b = b;
+	res.f = std::max(m1.f, m2.f);
+
+	return res.b;
+}
+
+/** Floating point absolute value.
+ * @param a Operand.
+ * @return a with its sign bit cleared. */
+inline uint32_t
+abs(uint32_t a)
+{
+	return a & ~0x80000000u;
+}
+
+/** Convert between integer and float. Integers are taken to be unsigned,
+ * floats are truncated through a 64-bit integer, matching sc_uint<32>.
+ * @param subop Direction of the conversion.
+ * @param a Operand.
+ * @return Converted value. */
+inline uint32_t
+cvt(ISASubOpCVT subop, uint32_t a)
+{
+	simd_util::bfloat intm;
+
+	if (subop == CVT_I2F) {
+		intm.f = a;
+		return intm.b;
+	}
+
+	intm.b = a;
+	return (int64_t) intm.f;
+}
+
+/** Compare a float against zero.
+ * @param test Comparison to perform.
+ * @param a Operand.
+ * @return 1 iff the comparison holds, 0 otherwise. */
+inline uint32_t
+test(ISASubOpTEST test, uint32_t a)
+{
+	simd_util::bfloat in;
+
+	in.b = a;
+
+	switch (test) {
+	case TEST_EZ:
+		return (in.f == 0.f || in.f == -0.f);
+	case TEST_NZ:
+		return (in.f != 0.f && in.f != -0.f);
+	case TEST_L:
+		return (in.f < 0.f);
+	case TEST_LE:
+		return (in.f <= 0.f || in.f == -0.f);
+	case TEST_G:
+		return (in.f > 0.f);
+	case TEST_GE:
+		return (in.f >= 0.f || in.f == -0.f);
+	default:
+		return 0u;
+	}
+}
+
+/** Compare a signed integer against zero.
+ * @param test Comparison to perform.
+ * @param a Operand.
+ * @return 1 iff the comparison holds, 0 otherwise. */
+inline uint32_t
+itest(ISASubOpTEST test, uint32_t a)
+{
+	int32_t in = a;
+
+	switch (test) {
+	case TEST_EZ:
+		return (in == 0);
+	case TEST_NZ:
+		return (in != 0);
+	case TEST_L:
+		return (in < 0);
+	case TEST_LE:
+		return (in <= 0);
+	case TEST_G:
+		return (in > 0);
+	case TEST_GE:
+		return (in >= 0);
+	default:
+		return 0u;
+	}
+}
+
+/** Boolean operation on two predicates. Only bit 0 of each operand counts.
+ * @param subop Operation to perform.
+ * @param a First predicate.
+ * @param b Second predicate.
+ * @return Resulting predicate, 0 or 1. */
+inline uint32_t
+pbool(ISASubOpPBOOL subop, uint32_t a, uint32_t b)
+{
+	a &= 1u;
+	b &= 1u;
+
+	switch (subop) {
+	case PBOOL_AND:
+		return a & b;
+	case PBOOL_OR:
+		return a | b;
+	case PBOOL_NAND:
+		return !(a & b);
+	case PBOOL_NOR:
+		return !(a | b);
+	default:
+		return 0u;
+	}
+}
+
+/** Integer addition, wrapping.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a + b. */
+inline uint32_t
+iadd(uint32_t a, uint32_t b)
+{
+	return a + b;
+}
+
+/** Integer subtraction, wrapping.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a - b. */
+inline uint32_t
+isub(uint32_t a, uint32_t b)
+{
+	return a - b;
+}
+
+/** Integer multiplication, wrapping.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a * b. */
+inline uint32_t
+imul(uint32_t a, uint32_t b)
+{
+	return a * b;
+}
+
+/** Integer multiply-add, wrapping.
+ * @param a First multiplicand.
+ * @param b Second multiplicand.
+ * @param c Addend.
+ * @return a * b + c. */
+inline uint32_t
+imad(uint32_t a, uint32_t b, uint32_t c)
+{
+	return a * b + c;
+}
+
+/** Signed integer minimum.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return min(a, b). */
+inline uint32_t
+imin(uint32_t a, uint32_t b)
+{
+	return std::min((int32_t) a, (int32_t) b);
+}
+
+/** Signed integer maximum.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return max(a, b). */
+inline uint32_t
+imax(uint32_t a, uint32_t b)
+{
+	return std::max((int32_t) a, (int32_t) b);
+}
+
+/** Integer negation.
+ * @param a Operand.
+ * @return -a. */
+inline uint32_t
+ineg(uint32_t a)
+{
+	return -a;
+}
+
+/** Signed integer division, rounding towards zero.
+ * @param a Dividend.
+ * @param b Divisor.
+ * @return a / b. */
+inline uint32_t
+idiv(uint32_t a, uint32_t b)
+{
+	return (int32_t) a / (int32_t) b;
+}
+
+/** Signed integer remainder, with the sign of the dividend.
+ * @param a Dividend.
+ * @param b Divisor.
+ * @return a % b. */
+inline uint32_t
+imod(uint32_t a, uint32_t b)
+{
+	return (int32_t) a % (int32_t) b;
+}
+
+/** Find the most significant bit that differs from the sign bit.
+ * @param a Operand.
+ * @return Index of that bit, -1 if there is none. */
+inline uint32_t
+ibfind(uint32_t a)
+{
+	if (a & 0x80000000u)
+		a = ~a;
+
+	a = (a << 1) | 1;
+
+	return 30 - __builtin_clz(a);
+}
+
+/** Shift left.
+ * @param a Operand.
+ * @param b Number of bits to shift by.
+ * @return a << b. */
+inline uint32_t
+shl(uint32_t a, uint32_t b)
+{
+	return a << b;
+}
+
+/** Arithmetic shift right.
+ * @param a Operand, signed.
+ * @param b Number of bits to shift by.
+ * @return a >> b. */
+inline uint32_t
+shr(uint32_t a, uint32_t b)
+{
+	return (int32_t) a >> b;
+}
+
+/** Bitwise AND.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a & b. */
+inline uint32_t
+band(uint32_t a, uint32_t b)
+{
+	return a & b;
+}
+
+/** Bitwise OR.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a | b. */
+inline uint32_t
+bor(uint32_t a, uint32_t b)
+{
+	return a | b;
+}
+
+/** Bitwise XOR.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return a ^ b. */
+inline uint32_t
+bxor(uint32_t a, uint32_t b)
+{
+	return a ^ b;
+}
+
+/** Bitwise NOT.
+ * @param a Operand.
+ * @return ~a. */
+inline uint32_t
+bnot(uint32_t a)
+{
+	return ~a;
+}
+
+/** Floating point reciprocal.
+ * @param a Operand.
+ * @return 1 / a. */
+inline uint32_t
+rcp(uint32_t a)
+{
+	simd_util::bfloat in, res;
+
+	in.b = a;
+	res.f = 1.f / in.f;
+
+	return res.b;
+}
+
+/** Floating point reciprocal square root.
+ * @param a Operand.
+ * @return 1 / sqrt(a). */
+inline uint32_t
+rsqrt(uint32_t a)
+{
+	simd_util::bfloat in, res;
+
+	in.b = a;
+	res.f = 1.f / std::sqrt(in.f);
+
+	return res.b;
+}
+
+/** Floating point sine.
+ * @param a Operand, in radians.
+ * @return sin(a). */
+inline uint32_t
+sin(uint32_t a)
+{
+	simd_util::bfloat in, res;
+
+	in.b = a;
+	res.f = std::sin(in.f);
+
+	return res.b;
+}
+
+/** Floating point cosine.
+ * @param a Operand, in radians.
+ * @return cos(a). */
+inline uint32_t
+cos(uint32_t a)
+{
+	simd_util::bfloat in, res;
+
+	in.b = a;
+	res.f = std::cos(in.f);
+
+	return res.b;
+}
+
+}
+
+}
+
+#endif /* ISA_MODEL_LANE_OPS_H */
@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISA_MODEL_LDST_OPS_H
+#define ISA_MODEL_LDST_OPS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <systemc>
+
+#include "isa/model/Instruction.h"
+#include "model/Buffer.h"
+#include "model/Register.h"
+#include "model/stride_descriptor.h"
+
+namespace isa_model {
+
+/** Construction of the stride descriptors issued by load and store operations.
+ *
+ * These are the reference semantics of the ISA. Both the cycle-accurate
+ * IExecute and the functional simulator build their stride descriptors with
+ * them, so that the two cannot diverge. Each helper takes a stride descriptor
+ * whose destination is already set, and fills in the remaining fields from the
+ * translated buffers and the operands of the operation. */
+namespace ldst_ops {
+
+/** LDGLIN, STGLIN: global load/store following the work-group dimensions.
+ * @param sd Stride descriptor to fill in.
+ * @param write True iff this is a store.
+ * @param subop Number of words per thread.
+ * @param b Translated global buffer.
+ * @param threads Number of threads in a work-group.
+ * @param wg_width Width of a work-group in threads.
+ * @param wg_off_x Work-group offset in X-dimension, in multiples of 32.
+ * @param wg_off_y Work-group offset in Y-dimension.
+ * @param dim_y Work dimension in Y-dimension.
+ * @param x X offset operand.
+ * @param y Y offset operand.
+ * @param dst_type Type of the destination register. */
+inline void
+lin(simd_model::stride_descriptor &sd, bool write, ISASubOpLDSTLIN subop,
+		const simd_model::Buffer &b, unsigned int threads,
+		sc_dt::sc_uint<32> wg_width, sc_dt::sc_uint<32> wg_off_x,
+		sc_dt::sc_uint<32> wg_off_y, sc_dt::sc_uint<32> dim_y,
+		sc_dt::sc_int<32> x, sc_dt::sc_int<32> y,
+		simd_model::RegisterType dst_type)
+{
+	sc_dt::sc_int<32> offset_x;
+	sc_dt::sc_int<32> offset_y;
+	sc_dt::sc_uint<32> wl;
+
+	offset_x = (wg_off_x << 5) + x;
+	offset_y = wg_off_y + y;
+
+	switch (subop) {
+	case LIN_VEC2:
+		wl = 2;
+		sd.idx_transform = simd_model::IDX_TRANSFORM_VEC2;
+		break;
+	case LIN_VEC4:
+		wl = 4;
+		sd.idx_transform = simd_model::IDX_TRANSFORM_VEC4;
+		break;
+	case LIN_UNIT:
+	default:
+		wl = 1;
+		sd.idx_transform = simd_model::IDX_TRANSFORM_UNIT;
+		break;
+	}
+
+	sd.write = write;
+	sd.period = b.get_dim_x();
+	sd.period_count = std::min(sc_dt::sc_uint<32>(threads/wg_width),
+			(sc_dt::sc_uint<32>) (dim_y - wg_off_y));
+	sd.words = std::min(sc_dt::sc_uint<32>(wl * wg_width),
+			(sc_dt::sc_uint<32>) (b.get_dim_x() - (offset_x * wl)));
+	sd.dst_period = wg_width;
+
+	sd.dst_offset = 0;
+	if (offset_y < 0) {
+		sd.dst_off_y = -offset_y;
+		sd.period_count += offset_y;
+		offset_y = 0;
+	}
+
+	if (offset_x < 0) {
+		sd.dst_off_x = -offset_x;
+		sd.words += offset_x;
+		offset_x = 0;
+	}
+	sd.addr = b.getAddress() +
+		((offset_y * b.get_dim_x() + offset_x * wl) << 2);
+
+	if (dst_type == simd_model::REGISTER_VSP)
+		sd.dst_offset = (offset_y * b.get_dim_x() + offset_x * wl);
+}
+
+/** LDSPLIN, STSPLIN: scratchpad load/store following the work-group
+ * dimensions.
+ * @param sd Stride descriptor to fill in.
+ * @param write True iff this is a store.
+ * @param b Translated scratchpad buffer.
+ * @param threads Number of threads in a work-group.
+ * @param wg_width Width of a work-group in threads.
+ * @param x X offset operand.
+ * @param y Y offset operand.
+ * @param dst_type Type of the destination register. */
+inline void
+splin(simd_model::stride_descriptor &sd, bool write,
+		const simd_model::Buffer &b, unsigned int threads,
+		sc_dt::sc_uint<32> wg_width, sc_dt::sc_int<32> x,
+		sc_dt::sc_int<32> y, simd_model::RegisterType dst_type)
+{
+	sc_dt::sc_int<32> offset_x = x;
+	sc_dt::sc_int<32> offset_y = y;
+
+	sd.write = write;
+	sd.period = b.get_dim_x();
+	sd.period_count = std::min(sc_dt::sc_uint<32>(threads/wg_width),
+			(sc_dt::sc_uint<32>) (b.get_dim_y() - offset_y));
+	sd.words = std::min(sc_dt::sc_uint<32>(wg_width),
+			(sc_dt::sc_uint<32>) (b.get_dim_x() - offset_x));
+	sd.dst_period = wg_width;
+
+	sd.dst_offset = 0;
+	if (offset_y < 0) {
+		sd.dst_off_y = -offset_y;
+		sd.period_count += offset_y;
+		offset_y = 0;
+	}
+
+	if (offset_x < 0) {
+		sd.dst_off_x = -offset_x;
+		sd.words += offset_x;
+		offset_x = 0;
+	}
+	sd.addr = b.getAddress() +
+		((offset_y * b.get_dim_x() + offset_x) << 2);
+
+	if (dst_type == simd_model::REGISTER_VSP)
+		sd.dst_offset = (offset_y * b.get_dim_x() + offset_x);
+}
+
+/** LDGBIDX, STGBIDX, LDSPBIDX, STSPBIDX: stream an entire buffer past the
+ * CAMs' shared data bus.
+ * @param sd Stride descriptor to fill in.
+ * @param write True iff this is a store.
+ * @param b Translated global or scratchpad buffer.
+ * @param dst_period Destination period. */
+inline void
+bidx(simd_model::stride_descriptor &sd, bool write,
+		const simd_model::Buffer &b, sc_dt::sc_uint<32> dst_period)
+{
+	sd.write = write;
+	sd.period = b.dims[0];
+	sd.period_count = b.dims[1];
+	sd.words = b.dims[0];
+	sd.dst_period = dst_period;
+
+	sd.dst_offset = 0;
+	sd.addr = b.getAddress();
+}
+
+/** LDGCIDX, STGCIDX: custom stride, data plucked from the bus by the CAMs.
+ * @param sd Stride descriptor to fill in.
+ * @param write True iff this is a store.
+ * @param b Translated global buffer.
+ * @param period Stride period, from sc.sd_period.
+ * @param period_count Stride period count, from sc.sd_period_cnt.
+ * @param words Words per period, from sc.sd_words.
+ * @param x X offset operand.
+ * @param y Y offset operand. */
+inline void
+cidx(simd_model::stride_descriptor &sd, bool write,
+		const simd_model::Buffer &b, sc_dt::sc_uint<20> period,
+		sc_dt::sc_uint<20> period_count, sc_dt::sc_uint<20> words,
+		sc_dt::sc_int<32> x, sc_dt::sc_int<32> y)
+{
+	sc_dt::sc_int<32> offset_x = x;
+	sc_dt::sc_int<32> offset_y = y;
+
+	sd.write = write;
+	sd.period = period;
+	sd.period_count = period_count;
+	sd.words = words;
+	sd.dst_period = 0;
+
+	if (offset_y < 0) {
+		sd.period_count += offset_y;
+		offset_y = 0;
+	}
+
+	if (offset_x < 0) {
+		sd.words += offset_x;
+		offset_x = 0;
+	}
+	sd.addr = b.getAddress() +
+		((offset_y * b.get_dim_x() + offset_x) << 2);
+
+	sd.dst_offset = (offset_y * b.get_dim_x() + offset_x);
+}
+
+/** LDGIDXIT, STGIDXIT: iterate over the indexes one by one.
+ * @param sd Stride descriptor to fill in.
+ * @param write True iff this is a store.
+ * @param b Translated global buffer. */
+inline void
+gidxit(simd_model::stride_descriptor &sd, bool write,
+		const simd_model::Buffer &b)
+{
+	sd.type = simd_model::stride_descriptor::IDXIT;
+	sd.write = write;
+
+	sd.dst_offset = 0;
+	sd.addr = b.getAddress();
+}
+
+/** LDG2SPTILE, STG2SPTILE: transfer a tile between DRAM and the scratchpad.
+ * @param sd Stride descriptor to fill in, destination set to the
+ * 	     scratchpad.
+ * @param write True iff this is a store.
+ * @param b Translated global buffer.
+ * @param spb Translated scratchpad buffer.
+ * @param x X offset operand.
+ * @param y Y offset operand. */
+inline void
+g2sptile(simd_model::stride_descriptor &sd, bool write,
+		const simd_model::Buffer &b, const simd_model::Buffer &spb,
+		sc_dt::sc_int<32> x, sc_dt::sc_int<32> y)
+{
+	sc_dt::sc_int<32> offset_x = x;
+	sc_dt::sc_int<32> offset_y = y;
+
+	sd.write = write;
+	sd.period = b.get_dim_x();
+	sd.period_count = std::min(sc_dt::sc_uint<32>(spb.get_dim_y()),
+			(sc_dt::sc_uint<32>) (b.get_dim_y() - (offset_y)));
+	sd.words = std::min(sc_dt::sc_uint<32>(spb.get_dim_x()),
+			(sc_dt::sc_uint<32>) (b.get_dim_x() - (offset_x)));
+	sd.dst_period = spb.get_dim_x();
+
+	sd.dst_offset = spb.addr;
+
+	/** Negative edge cases. */
+	if (offset_y < 0) {
+		sd.dst_offset += (sd.dst_period * (-offset_y) * 4);
+		sd.period_count += offset_y;
+		offset_y = 0;
+	}
+	if (offset_x < 0) {
+		sd.dst_offset -= offset_x * 4;
+		sd.words += offset_x;
+		offset_x = 0;
+	}
+	sd.addr = b.getAddress() +
+		((offset_y * b.get_dim_x() + offset_x) << 2);
+}
+
+/** SLDG: small DRAM load to the scalar register file.
+ * @param sd Stride descriptor to fill in.
+ * @param b Translated global buffer.
+ * @param words Number of words operand. */
+inline void
+sld(simd_model::stride_descriptor &sd, const simd_model::Buffer &b,
+		uint32_t words)
+{
+	sd.write = false;
+	sd.addr = b.getAddress();
+	sd.period = words;
+	sd.period_count = 1;
+	sd.words = words;
+}
+
+/** SLDSP: small scratchpad load to the scalar register file.
+ * @param sd Stride descriptor to fill in.
+ * @param b Translated scratchpad buffer.
+ * @param x X offset operand.
+ * @param y Y offset operand.
+ * @param words Number of words, from sc.sd_words. */
+inline void
+sldsp(simd_model::stride_descriptor &sd, const simd_model::Buffer &b,
+		uint32_t x, uint32_t y, sc_dt::sc_uint<20> words)
+{
+	sc_dt::sc_uint<32> offset_x;
+	sc_dt::sc_uint<32> offset_y;
+
+	offset_x = x << 2;
+	offset_y = (y * b.dims[0]) << 2;
+
+	sd.write = false;
+	sd.addr = b.getAddress() + offset_x + offset_y;
+	sd.period = words;
+	sd.period_count = 1;
+	sd.words = words;
+}
+
+}
+
+}
+
+#endif /* ISA_MODEL_LDST_OPS_H */
@@ -0,0 +1,240 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "isa/model/lane_ops.h"
+
+using namespace std;
+using namespace isa_model;
+using namespace simd_util;
+
+namespace isa_test {
+
+/** Return the binary representation of a float.
+ * @param f Float value.
+ * @return Register contents holding f. */
+static uint32_t
+fb(float f)
+{
+	bfloat v;
+
+	v.f = f;
+	return v.b;
+}
+
+/** Return the float held in a register.
+ * @param b Register contents.
+ * @return Float value of b. */
+static float
+bf(uint32_t b)
+{
+	bfloat v;
+
+	v.b = b;
+	return v.f;
+}
+
+/** MAD, ADD, MUL and their FPU_NEG variants. */
+static void
+test_fpu_arith(void)
+{
+	uint32_t neg;
+
+	neg = lane_ops::fpu_neg(FPU_NORMAL);
+	assert(neg == 0u);
+	assert(bf(lane_ops::mad(fb(2.f), fb(3.f) ^ neg, fb(1.f))) == 7.f);
+	assert(bf(lane_ops::add(fb(2.f), fb(3.f) ^ neg)) == 5.f);
+	assert(bf(lane_ops::mul(fb(2.f), fb(3.f) ^ neg)) == 6.f);
+
+	neg = lane_ops::fpu_neg(FPU_NEG);
+	assert(neg == 0x80000000u);
+	assert(bf(lane_ops::mad(fb(2.f), fb(3.f) ^ neg, fb(1.f))) == -5.f);
+	assert(bf(lane_ops::add(fb(2.f), fb(3.f) ^ neg)) == -1.f);
+	assert(bf(lane_ops::mul(fb(2.f), fb(3.f) ^ neg)) == -6.f);
+}
+
+/** MIN, MAX, ABS. */
+static void
+test_fpu_minmax(void)
+{
+	assert(bf(lane_ops::fmin(fb(-1.5f), fb(2.f))) == -1.5f);
+	assert(bf(lane_ops::fmax(fb(-1.5f), fb(2.f))) == 2.f);
+	assert(bf(lane_ops::abs(fb(-1.5f))) == 1.5f);
+	assert(bf(lane_ops::abs(fb(1.5f))) == 1.5f);
+	assert(lane_ops::abs(fb(-0.f)) == fb(0.f));
+}
+
+/** CVT and SCVT, both directions. */
+static void
+test_cvt(void)
+{
+	assert(bf(lane_ops::cvt(CVT_I2F, 7u)) == 7.f);
+	assert(bf(lane_ops::cvt(CVT_I2F, 0x80000000u)) == 2147483648.f);
+	assert(lane_ops::cvt(CVT_F2I, fb(7.9f)) == 7u);
+	assert(lane_ops::cvt(CVT_F2I, fb(-7.9f)) == (uint32_t) -7);
+}
+
+/** TEST against zero, including negative zero. */
+static void
+test_test(void)
+{
+	assert(lane_ops::test(TEST_EZ, fb(0.f)) == 1u);
+	assert(lane_ops::test(TEST_EZ, fb(-0.f)) == 1u);
+	assert(lane_ops::test(TEST_EZ, fb(1.f)) == 0u);
+	assert(lane_ops::test(TEST_NZ, fb(-0.f)) == 0u);
+	assert(lane_ops::test(TEST_NZ, fb(1.f)) == 1u);
+	assert(lane_ops::test(TEST_L, fb(-1.f)) == 1u);
+	assert(lane_ops::test(TEST_L, fb(-0.f)) == 0u);
+	assert(lane_ops::test(TEST_LE, fb(-0.f)) == 1u);
+	assert(lane_ops::test(TEST_LE, fb(1.f)) == 0u);
+	assert(lane_ops::test(TEST_G, fb(1.f)) == 1u);
+	assert(lane_ops::test(TEST_G, fb(0.f)) == 0u);
+	assert(lane_ops::test(TEST_GE, fb(0.f)) == 1u);
+	assert(lane_ops::test(TEST_GE, fb(-1.f)) == 0u);
+}
+
+/** ITEST and SICJ conditions against zero. */
+static void
+test_itest(void)
+{
+	assert(lane_ops::itest(TEST_EZ, 0u) == 1u);
+	assert(lane_ops::itest(TEST_EZ, 1u) == 0u);
+	assert(lane_ops::itest(TEST_NZ, (uint32_t) -1) == 1u);
+	assert(lane_ops::itest(TEST_L, (uint32_t) -1) == 1u);
+	assert(lane_ops::itest(TEST_L, 0u) == 0u);
+	assert(lane_ops::itest(TEST_LE, 0u) == 1u);
+	assert(lane_ops::itest(TEST_G, 0x7fffffffu) == 1u);
+	assert(lane_ops::itest(TEST_G, 0x80000000u) == 0u);
+	assert(lane_ops::itest(TEST_GE, 0u) == 1u);
+	assert(lane_ops::itest(TEST_GE, (uint32_t) -5) == 0u);
+}
+
+/** PBOOL, only bit 0 of each predicate counts. */
+static void
+test_pbool(void)
+{
+	assert(lane_ops::pbool(PBOOL_AND, 1u, 3u) == 1u);
+	assert(lane_ops::pbool(PBOOL_AND, 1u, 2u) == 0u);
+	assert(lane_ops::pbool(PBOOL_OR, 2u, 0u) == 0u);
+	assert(lane_ops::pbool(PBOOL_OR, 0u, 1u) == 1u);
+	assert(lane_ops::pbool(PBOOL_NAND, 1u, 1u) == 0u);
+	assert(lane_ops::pbool(PBOOL_NAND, 1u, 0u) == 1u);
+	assert(lane_ops::pbool(PBOOL_NOR, 0u, 0u) == 1u);
+	assert(lane_ops::pbool(PBOOL_NOR, 0u, 1u) == 0u);
+}
+
+/** IADD, ISUB, IMUL, IMAD and their scalar counterparts. */
+static void
+test_int_arith(void)
+{
+	assert(lane_ops::iadd(0xffffffffu, 2u) == 1u);
+	assert(lane_ops::isub(1u, 2u) == 0xffffffffu);
+	assert(lane_ops::imul((uint32_t) -3, 4u) == (uint32_t) -12);
+	assert(lane_ops::imad(3u, 4u, (uint32_t) -2) == 10u);
+	assert(lane_ops::ineg(5u) == (uint32_t) -5);
+}
+
+/** IMIN, IMAX are signed. */
+static void
+test_int_minmax(void)
+{
+	assert(lane_ops::imin((uint32_t) -1, 1u) == (uint32_t) -1);
+	assert(lane_ops::imax((uint32_t) -1, 1u) == 1u);
+}
+
+/** SIDIV and SIMOD round towards zero. */
+static void
+test_int_div(void)
+{
+	assert(lane_ops::idiv(7u, 2u) == 3u);
+	assert(lane_ops::idiv((uint32_t) -7, 2u) == (uint32_t) -3);
+	assert(lane_ops::imod(7u, 3u) == 1u);
+	assert(lane_ops::imod((uint32_t) -7, 3u) == (uint32_t) -1);
+}
+
+/** SIBFIND. */
+static void
+test_ibfind(void)
+{
+	assert(lane_ops::ibfind(0u) == (uint32_t) -1);
+	assert(lane_ops::ibfind((uint32_t) -1) == (uint32_t) -1);
+	assert(lane_ops::ibfind(1u) == 0u);
+	assert(lane_ops::ibfind(0x100u) == 8u);
+	assert(lane_ops::ibfind(0x7fffffffu) == 30u);
+	assert(lane_ops::ibfind((uint32_t) -2) == 0u);
+}
+
+/** SHL, SHR (arithmetic). */
+static void
+test_shift(void)
+{
+	assert(lane_ops::shl(3u, 4u) == 48u);
+	assert(lane_ops::shl(0x80000001u, 1u) == 2u);
+	assert(lane_ops::shr(48u, 4u) == 3u);
+	assert(lane_ops::shr(0x80000000u, 4u) == 0xf8000000u);
+}
+
+/** AND, OR, XOR, NOT. */
+static void
+test_bitwise(void)
+{
+	assert(lane_ops::band(0xf0f0u, 0xff00u) == 0xf000u);
+	assert(lane_ops::bor(0xf0f0u, 0xff00u) == 0xfff0u);
+	assert(lane_ops::bxor(0xf0f0u, 0xff00u) == 0x0ff0u);
+	assert(lane_ops::bnot(0u) == 0xffffffffu);
+}
+
+/** RCP, RSQRT, SIN, COS. */
+static void
+test_transcendental(void)
+{
+	assert(bf(lane_ops::rcp(fb(4.f))) == 0.25f);
+	assert(isinf(bf(lane_ops::rcp(fb(0.f)))));
+	assert(bf(lane_ops::rsqrt(fb(4.f))) == 0.5f);
+	assert(bf(lane_ops::sin(fb(0.f))) == 0.f);
+	assert(fabs(bf(lane_ops::sin(fb(M_PI / 2.f))) - 1.f) < 1e-6f);
+	assert(bf(lane_ops::cos(fb(0.f))) == 1.f);
+	assert(fabs(bf(lane_ops::cos(fb(M_PI))) + 1.f) < 1e-6f);
+}
+
+}
+
+using namespace isa_test;
+
+int
+main(int argc, char **argv)
+{
+	test_fpu_arith();
+	test_fpu_minmax();
+	test_cvt();
+	test_test();
+	test_itest();
+	test_pbool();
+	test_int_arith();
+	test_int_minmax();
+	test_int_div();
+	test_ibfind();
+	test_shift();
+	test_bitwise();
+	test_transcendental();
+
+	return 0;
+}
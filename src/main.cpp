@@ -20,16 +20,27 @@
 #include <iostream>
 #include <string>
 #include <array>
+#include <cstring>
+#include <fstream>
 
 #include "mc/control/Backend.h"
+#include "mc/control/ClusterArbiter.h"
 #include "mc/control/StrideSequencer.h"
 #include "compute/control/WorkScheduler.h"
 #include "compute/control/SimdCluster.h"
+#include "compute/model/wg_sampling.h"
 #include "util/constmath.h"
 #include "util/defaults.h"
 #include "util/sched_opts.h"
+#include "util/compare.h"
+#include "util/Checkpoint.h"
+#include "util/GatedClock.h"
+#include "util/Quiescence.h"
+#include "util/RingChannel.h"
 #include "isa/model/Program.h"
 #include "isa/analysis/ControlFlow.h"
+#include "isa/analysis/FlatMemory.h"
+#include "isa/analysis/FuncSim.h"
 #include "model/Buffer.h"
 #include "model/request_target.h"
 
@@ -42,18 +53,58 @@ using namespace mc_model;
 using namespace mc_control;
 using namespace compute_model;
 using namespace compute_control;
+using namespace simd_util;
 
 static int ns = 0;
 static string program = "";
 static unsigned long dims[2];
 static float delta = 0.001f;
 static bool dfrac = false;
+/** Path of the JSON comparison report, empty if none requested. */
+static string cmp_json = "";
 
 static IDecode_impl idec_impl = IDECODE_1S;
 static unsigned int iexec_pipe_length = 3;
 
 static sc_bv<WSS_SENTINEL> ws_sched = 0;
 static unsigned long refc = 0;
+/** True iff clock edges in which the design is quiescent are skipped. */
+static bool quiesce = false;
+/** Width of a VRF SRAM bank in 32-bit words, 0 for the default. */
+static unsigned int vrf_bank_words = 0;
+/** Work-group sampling policy, disabled unless requested. */
+static wg_sampling sampling;
+/** Path of the checkpoint to write, empty if none requested. */
+static string ckpt_out = "";
+/** Enumeration index of the work-group to checkpoint at. */
+static unsigned long ckpt_wg = 0;
+/** Path of the checkpoint to restore from, empty if none requested. */
+static string ckpt_in = "";
+/** Checkpoint restored from. Its DRAM image is used in-place, hence it must
+ * stay mapped throughout simulation. */
+static CheckpointReader ckpt;
+/** Enumeration index of the first work-group after the restored checkpoint. */
+static unsigned long ckpt_resume_wg = 0;
+/** Compute stats per cluster, up to the restored checkpoint. */
+static compute_stats ckpt_cs[COMPUTE_CLUSTERS];
+/** DRAM stats up to the restored checkpoint. */
+static cmdarb_stats ckpt_mcs;
+
+/** Build configuration and kernel stored with a checkpoint. A checkpoint can
+ * only be restored by a binary with an identical configuration. */
+typedef struct {
+	uint32_t bus_width;
+	uint32_t dram_banks;
+	uint32_t dram_cols;
+	uint32_t dram_rows;
+	uint32_t dram_chans;
+	uint32_t dram_chan_interleave;
+	uint32_t threads;
+	uint32_t clusters;
+	uint32_t wg_slots;
+	uint32_t pad;
+	uint64_t dims[2];
+} ckpt_config;
 
 static Program prg;
 
@@ -172,25 +223,27 @@ public:
 using namespace simd_test;
 using namespace isa_analysis;
 
-static sc_clock clk_compute("clk_compute", sc_time(1.L, SC_NS));
-static sc_clock *clk_dram;
+static GatedClock clk_compute("clk_compute", sc_time(1.L, SC_NS));
+static GatedClock *clk_dram;
 
 static sc_signal<bool> rst;
 
 static SimD_Control<MC_BIND_BUFS> test("test");
 static mc_control::StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS> sseq("sseq");
 static Backend<MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS> mc("mc");
-static WorkScheduler<COMPUTE_THREADS,COMPUTE_FPUS,COMPUTE_PC_WIDTH,MC_BIND_BUFS>
-				workscheduler("workscheduler");
+static WorkScheduler<COMPUTE_THREADS,COMPUTE_FPUS,COMPUTE_PC_WIDTH,MC_BIND_BUFS,
+	COMPUTE_CLUSTERS> workscheduler("workscheduler");
 static SimdCluster<COMPUTE_THREADS,COMPUTE_FPUS,COMPUTE_RCPUS,COMPUTE_PC_WIDTH,
-	MC_BIND_BUFS,MC_BUS_WIDTH,SP_BUS_WIDTH> simdcluster("simdcluster");
+	MC_BIND_BUFS,MC_BUS_WIDTH,SP_BUS_WIDTH> *simdcluster[COMPUTE_CLUSTERS];
+
+/** Arbiter sharing the memory controller, only with multiple clusters. */
+static ClusterArbiter<MC_BUS_WIDTH,COMPUTE_THREADS,COMPUTE_CLUSTERS> *arb = nullptr;
 
 /** Test -> WorkScheduler */
 static sc_signal<work<MC_BIND_BUFS> > test_work;
 static sc_signal<bool> test_kick;
 
 /* WorkScheduler -> SimdCluster */
-static sc_fifo<workgroup<COMPUTE_THREADS,COMPUTE_FPUS> > workscheduler_wg(1);
 static sc_signal<sc_uint<32> > workscheduler_dim[2];
 static sc_signal<workgroup_width> workscheduler_wg_width;
 static sc_signal<Instruction> workscheduler_op_w[4];
@@ -205,26 +258,52 @@ static sc_signal<Buffer> workscheduler_sp_xlat_phys_w;
 static sc_signal<bool> workscheduler_end_prg;
 static sc_signal<sc_bv<WSS_SENTINEL> > workscheduler_sched_opts;
 
-/* SimdCluster -> WorkScheduler */
-static sc_signal<bool> simdcluster_exec_fini;
-
-/* SimdCluster -> StrideSequencer */
+/** Channels private to a single SimdCluster. With a single cluster, the cluster
+ * connects to the StrideSequencer and Backend channels below instead of the
+ * arbiter facing channels. */
+typedef struct {
+	/* WorkScheduler -> SimdCluster */
+	sc_fifo<workgroup<COMPUTE_THREADS,COMPUTE_FPUS> > wg{1};
+
+	/* SimdCluster -> WorkScheduler */
+	sc_signal<bool> exec_fini;
+
+	/* SimdCluster -> ClusterArbiter */
+	sc_fifo<stride_descriptor> desc_fifo;
+	sc_fifo<bool> dram_kick{2};
+	RingChannel<idx_t<COMPUTE_THREADS> > idx{16};
+	sc_signal<sc_uint<4> > ticket_pop;
+	sc_signal<sc_bv<MC_BUS_WIDTH/4> > dram_mask[MC_DRAM_CHANS];
+	sc_signal<sc_uint<32> > dram_data[IF_SENTINEL][MC_DRAM_CHANS*MC_BUS_WIDTH/4];
+
+	/* ClusterArbiter -> SimdCluster */
+	sc_signal<bool> enable;
+	sc_signal<RequestTarget> dst;
+	sc_signal<AbstractRegister> dst_reg;
+	sc_signal<bool> idx_push_trigger;
+	sc_fifo<RequestTarget> done_dst;
+} cluster_channels;
+
+static cluster_channels simdcluster_chan[COMPUTE_CLUSTERS];
+
+/* SimdCluster/ClusterArbiter -> StrideSequencer */
 static sc_fifo<stride_descriptor> simdcluster_desc_fifo;
 static sc_fifo<bool> simdcluster_dram_kick(2);
-static sc_fifo<idx_t<COMPUTE_THREADS> > simdcluster_idx(16);
+static RingChannel<idx_t<COMPUTE_THREADS> > simdcluster_idx(16);
 static sc_signal<sc_uint<4> > simdcluster_ticket_pop;
 
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > simdcluster_dram_mask;
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > simdcluster_dram_mask[MC_DRAM_CHANS];
 
 /* StrideSequencer -> MC Backend */
-static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > sseq_req_fifo(MC_BURSTREQ_FIFO_DEPTH);
+static RingChannel<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > *sseq_req_fifo[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_DRAM_CHANS> > sseq_chans;
 
-/* StrideSequencer -> SimdCluster */
+/* StrideSequencer -> SimdCluster/ClusterArbiter */
 static sc_signal<RequestTarget> sseq_dst;
 static sc_signal<AbstractRegister> sseq_dst_reg;
 static sc_signal<bool> sseq_idx_push_trigger;
 
-/* StrideSequencer -> Test */
+/* StrideSequencer -> Test/ClusterArbiter */
 static sc_signal<bool> strseq_done;
 
 /* MC Backend -> StrideSequencer */
@@ -233,43 +312,171 @@ static sc_signal<bool> mc_allpre;
 static sc_signal<bool> mc_ref;
 static sc_signal<long> mc_cycle;
 
-/* MC Backend -> SimdCluster */
+/* MC Backend -> SimdCluster/ClusterArbiter */
 static sc_fifo<RequestTarget> mc_done_dst;
 
-/* MC Backend -> SimdCluster */
+/* MC Backend -> SimdCluster/ClusterArbiter */
 static sc_signal<bool> mc_enable;
-static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_BUS_WIDTH/4];
+static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
 /* MC Backend -> Scratchpad */
-static sc_signal<sc_uint<18> > mc_sp_addr;
+static sc_signal<sc_uint<18> > mc_sp_addr[MC_DRAM_CHANS];
 static sc_signal<sc_uint<const_log2(SP_BUS_WIDTH)> > mc_sp_words;
 
 /* MC Backend -> Scratchpad/SimdCluster */
 static sc_signal<bool> mc_write;
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w;
-static sc_signal<sc_uint<32> > mc_out_data[MC_BUS_WIDTH/4];
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w[MC_DRAM_CHANS];
+static sc_signal<sc_uint<32> > mc_out_data[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
-/* XXX: SimdCluster -> MC Backend */
-static sc_signal<sc_uint<32> > simdcluster_dram_data[IF_SENTINEL][MC_BUS_WIDTH/4];
+/* XXX: SimdCluster/ClusterArbiter -> MC Backend */
+static sc_signal<sc_uint<32> > simdcluster_dram_data[IF_SENTINEL][MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
+/** Wire up a SimdCluster.
+ *
+ * With a single cluster, its memory controller interface is connected
+ * directly to the StrideSequencer and Backend, otherwise to the arbiter.
+ * @param c Index of the cluster. */
 void
-elaborate(void)
+elaborate_simdcluster(unsigned int c)
 {
-	unsigned int i;
+	unsigned int i, j;
+	string name;
+	cluster_channels &ch = simdcluster_chan[c];
+
+	name = "simdcluster";
+	if (COMPUTE_CLUSTERS > 1)
+		name += to_string(c);
+
+	simdcluster[c] = new SimdCluster<COMPUTE_THREADS,COMPUTE_FPUS,
+			COMPUTE_RCPUS,COMPUTE_PC_WIDTH,MC_BIND_BUFS,
+			MC_BUS_WIDTH,SP_BUS_WIDTH>(name.c_str());
+	SimdCluster<COMPUTE_THREADS,COMPUTE_FPUS,COMPUTE_RCPUS,COMPUTE_PC_WIDTH,
+		MC_BIND_BUFS,MC_BUS_WIDTH,SP_BUS_WIDTH> &sc = *simdcluster[c];
+
+	sc.setIDecode(idec_impl);
+	if (vrf_bank_words)
+		sc.regfile_set_vrf_bank_words(vrf_bank_words);
+
+	workscheduler.out_wg[c](ch.wg);
+	workscheduler.in_exec_fini[c](ch.exec_fini);
+
+	sc.in_clk(clk_compute.out);
+	sc.in_clk_dram(clk_dram->out);
+	sc.in_rst(rst);
+	sc.in_wg(ch.wg);
+	sc.in_work_dim[0](workscheduler_dim[0]);
+	sc.in_work_dim[1](workscheduler_dim[1]);
+	sc.in_wg_width(workscheduler_wg_width);
+	sc.in_sched_opts(workscheduler_sched_opts);
+	sc.in_prog_pc_w(workscheduler_pc_w);
+	sc.in_prog_w(workscheduler_w);
+	sc.in_end_prg(workscheduler_end_prg);
+	sc.out_exec_fini(ch.exec_fini);
+	sc.in_xlat_w(workscheduler_xlat_w);
+	sc.in_xlat_idx_w(workscheduler_xlat_idx_w);
+	sc.in_xlat_phys_w(workscheduler_xlat_phys_w);
+	sc.in_sp_xlat_w(workscheduler_sp_xlat_w);
+	sc.in_sp_xlat_idx_w(workscheduler_sp_xlat_idx_w);
+	sc.in_sp_xlat_phys_w(workscheduler_sp_xlat_phys_w);
+
+	sc.in_dram_write(mc_write);
+	sc.in_dram_ref(mc_ref);
+
+	for (i = 0; i < 4; i++)
+		sc.in_prog_op_w[i](workscheduler_op_w[i]);
 
-	clk_dram = new sc_clock("clk_dram", sc_time(mc.get_clk_period(), SC_NS));
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		sc.in_dram_mask[i](mc_mask_w[i]);
+		sc.in_dram_sp_addr[i](mc_sp_addr[i]);
+	}
+
+	for (i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
+		sc.in_dram_data[i](mc_out_data[i]);
+		sc.in_dram_idx[i](mc_vreg_idx_w[i]);
+	}
 
-	simdcluster.setIDecode(idec_impl);
+	if (COMPUTE_CLUSTERS == 1) {
+		sc.out_ticket_pop(simdcluster_ticket_pop);
+		sc.in_dram_enable(mc_enable);
+		sc.in_dram_dst(sseq_dst);
+		sc.out_desc_fifo(simdcluster_desc_fifo);
+		sc.out_dram_kick(simdcluster_dram_kick);
+		sc.in_dram_done_dst(mc_done_dst);
+		sc.in_dram_reg(sseq_dst_reg);
+		sc.in_dram_idx_push_trigger(sseq_idx_push_trigger);
+		sc.out_dram_idx(simdcluster_idx);
+
+		for (i = 0; i < MC_DRAM_CHANS; i++)
+			sc.out_dram_mask[i](simdcluster_dram_mask[i]);
+
+		for (i = 0; i < IF_SENTINEL; i++) {
+			for (j = 0; j < MC_DRAM_CHANS*MC_BUS_WIDTH/4; j++)
+				sc.out_dram_data[i][j](simdcluster_dram_data[i][j]);
+		}
+	} else {
+		sc.out_ticket_pop(ch.ticket_pop);
+		sc.in_dram_enable(ch.enable);
+		sc.in_dram_dst(ch.dst);
+		sc.out_desc_fifo(ch.desc_fifo);
+		sc.out_dram_kick(ch.dram_kick);
+		sc.in_dram_done_dst(ch.done_dst);
+		sc.in_dram_reg(ch.dst_reg);
+		sc.in_dram_idx_push_trigger(ch.idx_push_trigger);
+		sc.out_dram_idx(ch.idx);
+
+		arb->in_desc_fifo[c](ch.desc_fifo);
+		arb->in_trigger[c](ch.dram_kick);
+		arb->in_ticket_pop[c](ch.ticket_pop);
+		arb->in_idx[c](ch.idx);
+		arb->out_done_dst[c](ch.done_dst);
+		arb->out_enable[c](ch.enable);
+		arb->out_dst[c](ch.dst);
+		arb->out_dst_reg[c](ch.dst_reg);
+		arb->out_idx_push_trigger[c](ch.idx_push_trigger);
+
+		for (i = 0; i < MC_DRAM_CHANS; i++) {
+			sc.out_dram_mask[i](ch.dram_mask[i]);
+			arb->in_mask[c][i](ch.dram_mask[i]);
+		}
+
+		for (i = 0; i < IF_SENTINEL; i++) {
+			for (j = 0; j < MC_DRAM_CHANS*MC_BUS_WIDTH/4; j++) {
+				sc.out_dram_data[i][j](ch.dram_data[i][j]);
+				arb->in_data[c][i][j](ch.dram_data[i][j]);
+			}
+		}
+	}
 
-	test.in_clk(clk_compute);
+	sc.elaborate();
+	sc.iexecute_pipeline_stages(iexec_pipe_length);
+	sc.set_gated_clock(&clk_compute);
+}
+
+/** DRAM probe for work-group sampling.
+ * @param bytes Number of bytes transferred by DRAM so far.
+ * @param acts Number of activate commands issued so far. */
+static void
+sampling_dram_probe(unsigned long &bytes, unsigned long &acts)
+{
+	mc.get_cmdarb_counters(bytes, acts);
+}
+
+void
+elaborate(void)
+{
+	unsigned int c, i, j;
+
+	clk_dram = new GatedClock("clk_dram", sc_time(mc.get_clk_period(), SC_NS));
+	Quiescence::get().enable(quiesce);
+
+	test.in_clk(clk_compute.out);
 	test.out_kick(test_kick);
 	test.out_work(test_work);
 	test.out_rst(rst);
 
-	workscheduler.in_clk(clk_compute);
+	workscheduler.in_clk(clk_compute.out);
 	workscheduler.in_work(test_work);
 	workscheduler.in_kick(test_kick);
-	workscheduler.out_wg(workscheduler_wg);
 	for (i = 0; i < 4; i++)
 		workscheduler.out_imem_op[i](workscheduler_op_w[i]);
 	workscheduler.out_imem_pc(workscheduler_pc_w);
@@ -279,7 +486,6 @@ elaborate(void)
 	workscheduler.out_dim[0](workscheduler_dim[0]);
 	workscheduler.out_dim[1](workscheduler_dim[1]);
 	workscheduler.out_end_prg(workscheduler_end_prg);
-	workscheduler.in_exec_fini(simdcluster_exec_fini);
 	workscheduler.out_xlat_w(workscheduler_xlat_w);
 	workscheduler.out_xlat_idx_w(workscheduler_xlat_idx_w);
 	workscheduler.out_xlat_phys_w(workscheduler_xlat_phys_w);
@@ -287,58 +493,42 @@ elaborate(void)
 	workscheduler.out_sp_xlat_idx_w(workscheduler_sp_xlat_idx_w);
 	workscheduler.out_sp_xlat_phys_w(workscheduler_sp_xlat_phys_w);
 
-	/* SimdCluster */
-	simdcluster.in_clk(clk_compute);
-	simdcluster.in_clk_dram(*clk_dram);
-	simdcluster.in_rst(rst);
-	simdcluster.in_wg(workscheduler_wg);
-	simdcluster.in_work_dim[0](workscheduler_dim[0]);
-	simdcluster.in_work_dim[1](workscheduler_dim[1]);
-	simdcluster.in_wg_width(workscheduler_wg_width);
-	simdcluster.in_sched_opts(workscheduler_sched_opts);
-	simdcluster.out_ticket_pop(simdcluster_ticket_pop);
-	simdcluster.in_prog_pc_w(workscheduler_pc_w);
-	simdcluster.in_prog_w(workscheduler_w);
-	simdcluster.in_end_prg(workscheduler_end_prg);
-	simdcluster.out_exec_fini(simdcluster_exec_fini);
-	simdcluster.in_xlat_w(workscheduler_xlat_w);
-	simdcluster.in_xlat_idx_w(workscheduler_xlat_idx_w);
-	simdcluster.in_xlat_phys_w(workscheduler_xlat_phys_w);
-	simdcluster.in_sp_xlat_w(workscheduler_sp_xlat_w);
-	simdcluster.in_sp_xlat_idx_w(workscheduler_sp_xlat_idx_w);
-	simdcluster.in_sp_xlat_phys_w(workscheduler_sp_xlat_phys_w);
-
-	simdcluster.in_dram_enable(mc_enable);
-	simdcluster.in_dram_write(mc_write);
-	simdcluster.in_dram_dst(sseq_dst);
-	simdcluster.out_desc_fifo(simdcluster_desc_fifo);
-	simdcluster.out_dram_kick(simdcluster_dram_kick);
-	simdcluster.in_dram_done_dst(mc_done_dst);
-	simdcluster.in_dram_mask(mc_mask_w);
-	simdcluster.in_dram_reg(sseq_dst_reg);
-	simdcluster.out_dram_mask(simdcluster_dram_mask);
-	simdcluster.in_dram_idx_push_trigger(sseq_idx_push_trigger);
-	simdcluster.out_dram_idx(simdcluster_idx);
-	simdcluster.in_dram_sp_addr(mc_sp_addr);
-	simdcluster.in_dram_ref(mc_ref);
-
-	for (i = 0; i < 4; i++) {
-		simdcluster.in_prog_op_w[i](workscheduler_op_w[i]);
-		simdcluster.in_dram_data[i](mc_out_data[i]);
-		simdcluster.out_dram_data[IF_DRAM][i](simdcluster_dram_data[IF_DRAM][i]);
-		simdcluster.out_dram_data[IF_SP_WG0][i](simdcluster_dram_data[IF_SP_WG0][i]);
-		simdcluster.out_dram_data[IF_SP_WG1][i](simdcluster_dram_data[IF_SP_WG1][i]);
-		simdcluster.in_dram_idx[i](mc_vreg_idx_w[i]);
-	}
-
-	simdcluster.elaborate();
+	/* ClusterArbiter */
+	if (COMPUTE_CLUSTERS > 1) {
+		arb = new ClusterArbiter<MC_BUS_WIDTH,COMPUTE_THREADS,
+				COMPUTE_CLUSTERS>("arb");
+
+		arb->in_clk(clk_dram->out);
+		arb->out_desc_fifo(simdcluster_desc_fifo);
+		arb->out_trigger(simdcluster_dram_kick);
+		arb->out_ticket_pop(simdcluster_ticket_pop);
+		arb->out_idx(simdcluster_idx);
+		arb->in_done(strseq_done);
+		arb->in_done_dst(mc_done_dst);
+		arb->in_enable(mc_enable);
+		arb->in_dst(sseq_dst);
+		arb->in_dst_reg(sseq_dst_reg);
+		arb->in_idx_push_trigger(sseq_idx_push_trigger);
+
+		for (i = 0; i < MC_DRAM_CHANS; i++)
+			arb->out_mask[i](simdcluster_dram_mask[i]);
+
+		for (i = 0; i < IF_SENTINEL; i++) {
+			for (j = 0; j < MC_DRAM_CHANS*MC_BUS_WIDTH/4; j++)
+				arb->out_data[i][j](simdcluster_dram_data[i][j]);
+		}
+	}
+
+	/* SimdClusters */
+	for (c = 0; c < COMPUTE_CLUSTERS; c++)
+		elaborate_simdcluster(c);
 
 	/* StrideSequencer */
-	sseq.in_clk(*clk_dram);
+	sseq.in_clk(clk_dram->out);
 	sseq.in_desc_fifo(simdcluster_desc_fifo);
 	sseq.in_trigger(simdcluster_dram_kick);
 	sseq.in_ref_pending(mc_ref_pending);
-	sseq.out_req_fifo(sseq_req_fifo);
+	sseq.out_chans(sseq_chans);
 	sseq.out_done(strseq_done);
 	sseq.in_DQ_allpre(mc_allpre);
 	sseq.out_dst(sseq_dst);
@@ -350,36 +540,233 @@ elaborate(void)
 	sseq.in_ticket_pop(simdcluster_ticket_pop);
 
 	/* MC Backend */
-	mc.in_clk(*clk_dram);
-	mc.in_req_fifo(sseq_req_fifo);
+	mc.in_clk(clk_dram->out);
+	mc.in_chans(sseq_chans);
 	mc.out_ref_pending(mc_ref_pending);
 	mc.out_allpre(mc_allpre);
 	mc.out_ref(mc_ref);
-	mc.in_mask_w(simdcluster_dram_mask);
-	mc.out_sp_addr(mc_sp_addr);
 	mc.out_done_dst(mc_done_dst);
 	mc.out_enable(mc_enable);
 	mc.out_write(mc_write);
-	mc.out_mask_w(mc_mask_w);
 	mc.out_cycle(mc_cycle);
 
-	for (i = 0; i < 4; i++) {
-		mc.in_data[IF_RF][i](simdcluster_dram_data[IF_RF][i]);
-		mc.in_data[IF_SP_WG0][i](simdcluster_dram_data[IF_SP_WG0][i]);
-		mc.in_data[IF_SP_WG1][i](simdcluster_dram_data[IF_SP_WG1][i]);
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		sseq_req_fifo[i] = new RingChannel<burst_request<MC_BUS_WIDTH,
+				COMPUTE_THREADS> >(MC_BURSTREQ_FIFO_DEPTH);
+		sseq.out_req_fifo[i](*sseq_req_fifo[i]);
+		mc.in_req_fifo[i](*sseq_req_fifo[i]);
+
+		mc.in_mask_w[i](simdcluster_dram_mask[i]);
+		mc.out_sp_addr[i](mc_sp_addr[i]);
+		mc.out_mask_w[i](mc_mask_w[i]);
+	}
+
+	for (i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
+		for (j = 0; j < IF_SENTINEL; j++)
+			mc.in_data[j][i](simdcluster_dram_data[j][i]);
 		mc.out_vreg_idx_w[i](mc_vreg_idx_w[i]);
 		mc.out_data[i](mc_out_data[i]);
 	}
 
-	simdcluster.iexecute_pipeline_stages(iexec_pipe_length);
 	mc.set_refresh_counter(refc);
+
+	workscheduler.set_gated_clock(&clk_compute);
+	mc.set_gated_clock(clk_dram);
+
+	if (sampling.enabled()) {
+		sampling.set_dram_probe(sampling_dram_probe);
+		workscheduler.set_sampling(&sampling);
+	}
+
+	if (ckpt_out != "")
+		workscheduler.set_stop(ckpt_wg);
+}
+
+/** Fill in the configuration of this simulation for a checkpoint.
+ * @param cfg Configuration object to fill in. */
+void
+checkpoint_config(ckpt_config &cfg)
+{
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.bus_width = MC_BUS_WIDTH;
+	cfg.dram_banks = MC_DRAM_BANKS;
+	cfg.dram_cols = MC_DRAM_COLS;
+	cfg.dram_rows = MC_DRAM_ROWS;
+	cfg.dram_chans = MC_DRAM_CHANS;
+	cfg.dram_chan_interleave = MC_DRAM_CHAN_INTERLEAVE;
+	cfg.threads = COMPUTE_THREADS;
+	cfg.clusters = COMPUTE_CLUSTERS;
+	cfg.wg_slots = COMPUTE_WG_SLOTS;
+	cfg.dims[0] = dims[0];
+	cfg.dims[1] = dims[1];
+}
+
+/** Write the simulation state at the work-group boundary the WorkScheduler
+ * stopped at.
+ * @param cs Compute stats per cluster, up to the boundary.
+ * @param mcs DRAM stats up to the boundary. */
+void
+checkpoint_write(compute_stats cs[COMPUTE_CLUSTERS], cmdarb_stats &mcs)
+{
+	CheckpointWriter w;
+	ckpt_config cfg;
+	uint64_t wg;
+	unsigned int c;
+
+	if (!w.open(ckpt_out)) {
+		cerr << "Error: Could not create checkpoint " << ckpt_out <<
+				endl;
+		exit(1);
+	}
+
+	checkpoint_config(cfg);
+	w.add_section(CKPT_CONFIG, 0, &cfg, sizeof(cfg));
+
+	wg = ckpt_wg;
+	w.add_section(CKPT_WS, 0, &wg, sizeof(wg));
+
+	for (c = 0; c < COMPUTE_CLUSTERS; c++) {
+		w.add_section(CKPT_COMPUTE_STATS, c, &cs[c], sizeof(cs[c]));
+		simdcluster[c]->checkpoint(w, c);
+	}
+
+	w.add_section(CKPT_CMDARB_STATS, 0, &mcs, sizeof(mcs));
+	mc.checkpoint(w);
+
+	if (!w.close()) {
+		cerr << "Error: Could not write checkpoint " << ckpt_out <<
+				endl;
+		exit(1);
+	}
+
+	cout << "Checkpoint at work-group " << ckpt_wg << " written to " <<
+			ckpt_out << endl;
+}
+
+/** Restore the simulation state from a checkpoint. Must be called after
+ * elaboration, prior to simulation. */
+void
+checkpoint_restore(void)
+{
+	ckpt_config cfg;
+	ckpt_config cfg_ckpt;
+	uint64_t wg;
+	unsigned int c;
+
+	if (!ckpt.open(ckpt_in)) {
+		cerr << "Error: " << ckpt_in << " is not a valid checkpoint" <<
+				endl;
+		exit(1);
+	}
+
+	checkpoint_config(cfg);
+	if (!ckpt.read(CKPT_CONFIG, 0, &cfg_ckpt, sizeof(cfg_ckpt)) ||
+	    memcmp(&cfg, &cfg_ckpt, sizeof(cfg))) {
+		cerr << "Error: Checkpoint " << ckpt_in << " was taken with a "
+				"different configuration or kernel dimensions"
+				<< endl;
+		exit(1);
+	}
+
+	if (!ckpt.read(CKPT_WS, 0, &wg, sizeof(wg)) ||
+	    !ckpt.read(CKPT_CMDARB_STATS, 0, &ckpt_mcs, sizeof(ckpt_mcs)) ||
+	    !mc.restore(ckpt)) {
+		cerr << "Error: Checkpoint " << ckpt_in << " is corrupt" << endl;
+		exit(1);
+	}
+
+	for (c = 0; c < COMPUTE_CLUSTERS; c++) {
+		if (!ckpt.read(CKPT_COMPUTE_STATS, c, &ckpt_cs[c],
+				sizeof(ckpt_cs[c])) ||
+		    !simdcluster[c]->restore(ckpt, c)) {
+			cerr << "Error: Checkpoint " << ckpt_in <<
+					" is corrupt" << endl;
+			exit(1);
+		}
+	}
+
+	ckpt_resume_wg = wg;
+	workscheduler.set_resume(wg);
+
+	if (ckpt_out != "" && ckpt_wg <= wg) {
+		cerr << "Error: Checkpoint must follow work-group " << wg <<
+				endl;
+		exit(1);
+	}
+
+	cout << "Resuming from checkpoint " << ckpt_in << " at work-group "
+			<< wg << endl;
+}
+
+/** Copy all DRAM buffers of the program between the Backend and a functional
+ * memory image.
+ * @param fm Functional memory image, mapped for the program.
+ * @param upload True iff buffers are copied from fm to the Backend, false iff
+ * 		 copied from the Backend to fm. */
+void
+copy_buffers(FlatMemory &fm, bool upload)
+{
+	const ProgramBuffer *b;
+	vector<uint32_t> buf;
+	size_t words;
+
+	for (b = prg.buffer_begin(); b < prg.buffer_end(); b++) {
+		if (!b->valid)
+			continue;
+
+		words = b->dims[0] * b->dims[1];
+		buf.resize(words);
+
+		if (upload) {
+			fm.bulk_copy(b->getAddress(), buf.data(), words, false);
+			mc.debug_copy_range(b->getAddress(), buf.data(), words,
+					true);
+		} else {
+			mc.debug_copy_range(b->getAddress(), buf.data(), words,
+					false);
+			fm.bulk_copy(b->getAddress(), buf.data(), words, true);
+		}
+	}
+}
+
+/** Execute the work-groups skipped under work-group sampling functionally.
+ *
+ * Work-groups only communicate through DRAM buffers, hence executing them after
+ * all sampled work-groups yields the buffer contents of a full simulation. */
+void
+fast_forward(void)
+{
+	FlatMemory fm;
+	FuncSim *sim;
+	FuncSimWG s;
+
+	if (sampling.get_skipped().size() == 0)
+		return;
+
+	fm.map_program(prg);
+	copy_buffers(fm, false);
+
+	sim = new FuncSim(prg, fm, dims[0], dims[1],
+			workscheduler_wg_width.read());
+	for (const pair<unsigned int, unsigned int> &wg :
+			sampling.get_skipped())
+		sim->run_wg(s, wg.first, wg.second);
+	delete sim;
+
+	copy_buffers(fm, true);
 }
 
 void
 do_sim(void)
 {
 	compute_stats s;
+	compute_stats cs[COMPUTE_CLUSTERS];
 	cmdarb_stats mcs;
+	unsigned int c;
+	unsigned long exec_time;
+	unsigned long cycles;
+	double f;
+	double ci;
 
 	/* Run */
 	sc_set_stop_mode(SC_STOP_FINISH_DELTA);
@@ -389,13 +776,79 @@ do_sim(void)
 	else
 		sc_start();
 
-	workscheduler.get_stats(s);
-	simdcluster.get_stats(s);
+	for (c = 0; c < COMPUTE_CLUSTERS; c++) {
+		workscheduler.get_stats(cs[c], c);
+		simdcluster[c]->get_stats(cs[c]);
+	}
+
+	cycles = (cs[0].exec_time * mc.get_freq_MHz()) / 1000;
+	mc.get_cmdarb_stats(mcs, cycles);
+
+	/* The DRAM timeline of this simulation continues from the checkpoint
+	 * once the program is loaded. */
+	if (ckpt_in != "") {
+		mcs.resume(ckpt_mcs, ((ckpt_cs[0].exec_time -
+				cs[0].prg_load_time) * mc.get_freq_MHz()) / 1000,
+				cycles);
+		for (c = 0; c < COMPUTE_CLUSTERS; c++)
+			cs[c].resume(ckpt_cs[c]);
+	}
+
+	if (ckpt_out != "" && workscheduler.has_stopped())
+		checkpoint_write(cs, mcs);
+
+	s = cs[0];
+	for (c = 1; c < COMPUTE_CLUSTERS; c++)
+		s.aggregate(cs[c]);
+
+	exec_time = s.exec_time;
+
+	if (sampling.enabled()) {
+		fast_forward();
+
+		f = sampling.factor();
+		s.exec_time = sampling.estimate_exec_time(exec_time, ci);
+		s.threads = (unsigned long) (s.threads * f);
+		s.wgs = (unsigned long) (s.wgs * f + 0.5);
+		s.scale(f);
+		mcs.scale(f, (exec_time * mc.get_freq_MHz()) / 1000,
+				(s.exec_time * mc.get_freq_MHz()) / 1000);
+
+		cout << endl;
+		cout << sampling;
+		cout << "Sampled latency            :" << setw(10) <<
+				exec_time << endl;
+		cout << "Est. program latency       :" << setw(10) <<
+				s.exec_time << " (95% CI +/- " << ci << ")" <<
+				endl;
+		cout << "Est. DRAM bytes            :" << setw(10) <<
+				mcs.bytes << " (95% CI +/- " <<
+				sampling.dram_bytes_ci() << ")" << endl;
+		cout << "Est. DRAM activates        :" << setw(10) <<
+				mcs.act_c << " (95% CI +/- " <<
+				sampling.dram_acts_ci() << ")" << endl;
+		cout << "Est. DRAM energy (pJ)      :" << setw(10) <<
+				mcs.energy << " (no CI, DRAMPower only "
+				"reports energy at the end of a run)" << endl;
+		cout << "Compute and DRAM stats are extrapolated from the "
+				"sampled work-groups. Per-cluster stats are "
+				"omitted." << endl;
+	}
 
 	cout << endl;
 	cout << s;
 
-	mc.get_cmdarb_stats(mcs, (s.exec_time * mc.get_freq_MHz()) / 1000);
+	for (c = 0; COMPUTE_CLUSTERS > 1 && !sampling.enabled() &&
+			c < COMPUTE_CLUSTERS; c++) {
+		cout << endl;
+		cout << "=== Cluster " << c << " ===" << endl;
+		cout << "DRAM descriptors granted   :" << setw(10) <<
+				arb->get_grants(c) << endl;
+		cout << "DRAM grant wait (DRAM cycs):" << setw(10) <<
+				arb->get_wait_cycles(c) << endl;
+		cout << cs[c];
+	}
+
 	if (debug_output[DEBUG_CMD_STATS]) {
 		cout << endl;
 		mcs.base_addr = 0;
@@ -420,8 +873,10 @@ help(char *program_name)
 	cout << "  -n [ns]\t\t     : Simulation time in ns (default: 400)." << endl;
 	cout << "  -P [stages]\t\t     : Number of execute pipeline stages (default: 1)." << endl;
 	cout << "  -3\t\t\t     : Enable three-stage IDecode phase." << endl;
-	cout << "  -i [buf,in.csv]\t     : Prior to execution, upload given file (CSV or" << endl;
-	cout << "  \t\t\t       binary) into buffer indexed by [buf]." << endl;
+	cout << "  -Q\t\t\t     : Skip clock cycles in which the design is" << endl;
+	cout << "  \t\t\t       quiescent, e.g. blocked on DRAM." << endl;
+	cout << "  -i [buf,in.csv]\t     : Prior to execution, upload given file (CSV," << endl;
+	cout << "  \t\t\t       .npy or binary) into buffer indexed by [buf]." << endl;
 	cout << "  -o [buf,out.txt]\t     : After execution, dump contents of given buffer" << endl;
 	cout << "  \t\t\t       into file." << endl;
 	cout << "  -c [buf,in.bin]\t     : After execution, compare the contents of given" << endl;
@@ -429,8 +884,19 @@ help(char *program_name)
 	cout << "  \t\t\t       provided." << endl;
 	cout << "  -e [error]\t\t     : Tolerable comparison error (delta or" << endl;
 	cout << "  \t\t\t       percentage, default: 0.001)." << endl;
+	cout << "  -J [report.json]\t     : Write error statistics of all comparisons" << endl;
+	cout << "  \t\t\t       (-c) to a JSON file." << endl;
 	cout << "  -b [width]\t\t     : Width (# 32-bit words) of a VRF SRAM bank." << endl;
 	cout << "  -r [value]\t\t     : Initialise the memory controller's refresh counter." << endl;
+	cout << "  -C [wg,ckpt]\t\t     : Stop at work-group [wg] and write a checkpoint" << endl;
+	cout << "  \t\t\t       of the simulation state to file [ckpt]." << endl;
+	cout << "  -R [ckpt]\t\t     : Resume from checkpoint file [ckpt]. DRAM rows" << endl;
+	cout << "  \t\t\t       open at the checkpoint are not saved, all banks" << endl;
+	cout << "  \t\t\t       start precharged. Cycle counts and DRAM stats" << endl;
+	cout << "  \t\t\t       may differ slightly from an uninterrupted run." << endl;
+	cout << "  -S [k,m]\t\t     : Sample work-groups: simulate the first k, every" << endl;
+	cout << "  \t\t\t       m-th and the last work-group cycle-accurately," << endl;
+	cout << "  \t\t\t       execute others functionally and extrapolate." << endl;
 	cout << "  -s schedopt[,schedopt[,..]]: Enable real-time scheduling options." << endl;
 	cout << "  -D dbgopt[,dbgopt[,..]]    : Enable debugging output options." << endl;
 
@@ -491,6 +957,9 @@ getBufferTypeFromFilename(string &file)
 	if (extension == "csv" || extension == "txt")
 		return DECIMAL_CSV;
 
+	if (extension == "npy")
+		return NUMPY;
+
 	return BINARY;
 }
 
@@ -511,6 +980,7 @@ parse_parameters(int argc, char* argv[])
 	string oa;
 	string dbgopt;
 	unsigned int bufno;
+	unsigned long sample_k, sample_m;
 	bool dims_provided = false;
 	buffer_input_type t;
 	string path;
@@ -526,7 +996,7 @@ parse_parameters(int argc, char* argv[])
 	ws_sched[WSS_STOP_SIM_FINI] = Log_1;
 
 	/* Take stride patterns from the command line */
-	while ( (c = getopt(argc - 1, argv, "hd:w:n:P:3i:o:c:e:b:s:D:r:")) != -1) {
+	while ( (c = getopt(argc - 1, argv, "hd:w:n:P:3Qi:o:c:e:J:b:s:D:r:S:C:R:")) != -1) {
 		switch (c) {
 		case 'h':
 			help(argv[0]);
@@ -585,6 +1055,9 @@ parse_parameters(int argc, char* argv[])
 		case '3':
 			idec_impl = IDECODE_3S;
 			break;
+		case 'Q':
+			quiesce = true;
+			break;
 		case 'i':
 			i = sscanf(optarg, "%i,%n", &bufno, &pos);
 			if (i == 0 || bufno >= 32) {
@@ -642,6 +1115,9 @@ parse_parameters(int argc, char* argv[])
 			if (dfrac)
 				delta *= 0.01f;
 			break;
+		case 'J':
+			cmp_json = string(optarg);
+			break;
 		case 'r':
 			i = sscanf(optarg, "%lu", &refc);
 			if (i < 0 || refc > 15000) {
@@ -652,6 +1128,29 @@ parse_parameters(int argc, char* argv[])
 				exit(1);
 			}
 			break;
+		case 'S':
+			i = sscanf(optarg, "%lu,%lu", &sample_k, &sample_m);
+			if (i != 2 || sample_m == 0) {
+				cout << "Error: Invalid work-group sampling "
+						"policy" << endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+			sampling = wg_sampling(sample_k, sample_m);
+			break;
+		case 'C':
+			i = sscanf(optarg, "%lu,%n", &ckpt_wg, &pos);
+			if (i != 1 || ckpt_wg == 0 || optarg[pos] == '\0') {
+				cout << "Error: Invalid checkpoint specification"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+			ckpt_out = string(&optarg[pos]);
+			break;
+		case 'R':
+			ckpt_in = string(optarg);
+			break;
 		case 'b':
 			i = sscanf(optarg, "%i", &bufno);
 			if (i == 0 || bufno == 32) {
@@ -660,7 +1159,7 @@ parse_parameters(int argc, char* argv[])
 				help(argv[0]);
 				exit(1);
 			}
-			simdcluster.regfile_set_vrf_bank_words(bufno);
+			vrf_bank_words = bufno;
 			break;
 		case 's':
 			oa = string(optarg);
@@ -719,6 +1218,13 @@ parse_parameters(int argc, char* argv[])
 		help(argv[0]);
 		exit(1);
 	}
+
+	if (sampling.enabled() && (ckpt_out != "" || ckpt_in != "")) {
+		cout << "Error: Work-group sampling cannot be combined with "
+				"checkpoints" << endl << endl;
+		help(argv[0]);
+		exit(1);
+	}
 }
 
 /** \mainpage Sim-D
@@ -734,6 +1240,9 @@ sc_main(int argc, char* argv[])
 {
 	const ProgramBuffer *b;
 	fstream fs;
+	ofstream js;
+	cmp_stats cs;
+	bool first_cmp = true;
 
 	debug_output_reset();
 	parse_parameters(argc, argv);
@@ -763,9 +1272,14 @@ sc_main(int argc, char* argv[])
 		buf.setDataInputFile(ul.path, ul.type);
 	}
 
-	for (b = prg.buffer_begin(); b < prg.buffer_end(); b++) {
-		if (b->hasDataInputFile())
-			mc.debug_upload_buffer(*b);
+	/* A checkpoint holds the DRAM contents, including the inputs. */
+	if (ckpt_in != "")
+		checkpoint_restore();
+	else {
+		for (b = prg.buffer_begin(); b < prg.buffer_end(); b++) {
+			if (b->hasDataInputFile())
+				mc.debug_upload_buffer(*b);
+		}
 	}
 
 	if (debug_output[DEBUG_PROGRAM])
@@ -773,6 +1287,10 @@ sc_main(int argc, char* argv[])
 
 	do_sim();
 
+	/* Output buffers are incomplete at a checkpoint. */
+	if (workscheduler.has_stopped())
+		return 0;
+
 	for (download &dl : d) {
 		ProgramBuffer &buf = prg.getBuffer(dl.buffer);
 
@@ -780,14 +1298,30 @@ sc_main(int argc, char* argv[])
 		case download::ACTION_DOWNLOAD:
 			if (dl.type == BINARY)
 				mc.debug_download_buffer_bin(buf, dl.path);
+			else if (dl.type == NUMPY)
+				mc.debug_download_buffer_npy(buf, dl.path);
 			else
 				mc.debug_download_buffer_csv(buf, dl.path);
 			break;
 		case download::ACTION_COMPARE:
+			memset(&cs, 0, sizeof(cs));
 			if (dl.type == BINARY)
-				mc.debug_compare_buffer_bin(buf, dl.path, delta, dfrac);
+				mc.debug_compare_buffer_bin(buf, dl.path, delta, dfrac, &cs);
+			else if (dl.type == NUMPY)
+				mc.debug_compare_buffer_npy(buf, dl.path, delta, dfrac, &cs);
 			else
-				mc.debug_compare_buffer_csv(buf, dl.path, delta, dfrac);
+				mc.debug_compare_buffer_csv(buf, dl.path, delta, dfrac, &cs);
+
+			if (cmp_json != "") {
+				if (first_cmp) {
+					js.open(cmp_json, ios_base::out | ios_base::trunc);
+					js << "[";
+				}
+
+				js << (first_cmp ? "\n  " : ",\n  ");
+				cmp_print_json(js, cs, dl.path);
+				first_cmp = false;
+			}
 			break;
 		default:
 			cout << "Error: Unknown action." << endl;
@@ -797,6 +1331,11 @@ sc_main(int argc, char* argv[])
 
 	}
 
+	if (!first_cmp) {
+		js << "\n]" << endl;
+		js.close();
+	}
+
 	return 0;
 }
 
@@ -24,6 +24,7 @@
 #include <sys/wait.h>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <systemc>
 #include <tlm>
 #include <vector>
@@ -32,88 +33,104 @@
 #include "util/defaults.h"
 #include "util/constmath.h"
 #include "util/csv.h"
+#include "util/compare.h"
+#include "util/Checkpoint.h"
+#include "util/GatedClock.h"
+#include "util/RingChannel.h"
+#include "util/Quiescence.h"
 #include "mc/control/CmdGen_DDR4.h"
 #include "mc/control/CmdArb_DDR4.h"
 #include "mc/control/DQ.h"
+#include "mc/model/dram_channel.h"
 #include "model/Register.h"
 #include "model/Buffer.h"
+#include "model/BufferStore.h"
 
 using namespace std;
 using namespace sc_core;
 using namespace sc_dt;
 using namespace tlm;
 using namespace simd_model;
+using namespace simd_util;
 
 namespace mc_control {
 
-enum {
-	STATS_MIN = 0,
-	STATS_MAX,
-	STATS_AGG
-};
-
 /** The memory controller back-end.
  *
  * From burst requests to actual DRAM commands and data movement. Generally
  * burst requests are generated by the mc_control::StrideSequencer, but it is
  * perfectly feasible to generate them from other sources (e.g.
  * mc_control::IdxIterator).
+ *
+ * Each DRAM channel has its own command generator, command arbiter and DQ
+ * scheduler, receiving channel-local burst requests. Every channel drives its
+ * own group of BUS_WIDTH/4 data lanes, mask and scratchpad address. The
+ * completion of a stride descriptor is signalled once all channels that
+ * received burst requests for it finished.
  * @param BANKS Number of DRAM banks in a chip.
  * @param COLS Number of columns per row in a DRAM chip.
  * @param ROWS Number of rows in a DRAM bank.
  * @param BUS_WIDTH Number of (32-bit) words transferred in a single DRAM burst.
  * @param THREADS Number of threads in a work-group.
+ * @param CHANS Number of DRAM channels.
  */
 template <unsigned int BANKS = MC_DRAM_BANKS, unsigned int COLS = MC_DRAM_COLS,
 		unsigned int ROWS = MC_DRAM_ROWS,
 		unsigned int BUS_WIDTH = MC_BUS_WIDTH,
-		unsigned int THREADS = COMPUTE_THREADS>
-class Backend : public sc_module
+		unsigned int THREADS = COMPUTE_THREADS,
+		unsigned int CHANS = MC_DRAM_CHANS>
+class Backend : public sc_module, public BufferStore
 {
 public:
 	/** DRAM clock, SDR */
 	sc_in<bool> in_clk{"in_clk"};
 
-	/** Input burst-request fifo */
-	sc_fifo_in<burst_request<BUS_WIDTH,THREADS> > in_req_fifo{"in_req_fifo"};
+	/** Input burst-request fifo, per channel. */
+	sc_fifo_in<burst_request<BUS_WIDTH,THREADS> > in_req_fifo[CHANS];
+
+	/** Channels that received burst requests for the active stride
+	 * descriptor. Ignored if CHANS == 1. */
+	sc_in<sc_bv<CHANS> > in_chans{"in_chans"};
 
-	/** Refresh is pending */
+	/** Refresh is pending in any channel. */
 	sc_inout<bool> out_ref_pending{"out_ref_pending"};
 
 	/** All banks precharged */
 	sc_inout<bool> out_allpre{"out_allpre"};
 
-	/** True if currently refreshing. */
+	/** True if any channel is currently refreshing. */
 	sc_inout<bool> out_ref{"out_ref"};
 
 	/************ Write path to(/from) Register file ****************/
-	/** Index within register to read/write to. */
-	sc_inout<reg_offset_t<THREADS> > out_vreg_idx_w[BUS_WIDTH/4];
+	/** Index within register to read/write to, BUS_WIDTH/4 lanes per
+	 * channel. */
+	sc_inout<reg_offset_t<THREADS> > out_vreg_idx_w[CHANS*BUS_WIDTH/4];
 
 	/** Mask returned by the register file that reflects active threads.
 	 * Used when writing back vector registers from RF -> DRAM, to not
 	 * overwrite data from disabled threads. */
-	sc_inout<sc_bv<BUS_WIDTH/4> > in_mask_w{"in_mask_w"};
+	sc_inout<sc_bv<BUS_WIDTH/4> > in_mask_w[CHANS];
 
 	/************* Read/write path to Scratchpad ***************/
-	/** Scratchpad address */
-	sc_inout<sc_uint<18> > out_sp_addr{"out_sp_addr"};
+	/** Scratchpad address, per channel. */
+	sc_inout<sc_uint<18> > out_sp_addr[CHANS];
 
 	/******* Lines shared between data path to Reg and SP *******/
-	/** Data path is active. */
+	/** Data path of any channel is active. */
 	sc_inout<bool> out_enable{"out_enable"};
 
 	/** Scratchpad read data path */
-	sc_in<sc_uint<32> > in_data[IF_SENTINEL][BUS_WIDTH/4];
+	sc_in<sc_uint<32> > in_data[IF_SENTINEL][CHANS*BUS_WIDTH/4];
 
 	/** Data to read from register */
-	sc_inout<sc_uint<32> > out_data[4];
+	sc_inout<sc_uint<32> > out_data[CHANS*BUS_WIDTH/4];
 
 	/** Write bit. 0: read. */
 	sc_inout<bool> out_write{"out_write"};
 
-	/** Register read/write mask. */
-	sc_inout<sc_bv<BUS_WIDTH/4> > out_mask_w{"out_mask_w"};
+	/** Register read/write mask, per channel. Empty for channels that do
+	 * not transfer data. */
+	sc_inout<sc_bv<BUS_WIDTH/4> > out_mask_w[CHANS];
 
 	/** Which WG is finished.
 	 * This is a FIFO to deal most efficiently with the clock-crossing domain.
@@ -124,154 +141,405 @@ public:
 	sc_inout<long> out_cycle{"out_cycle"};
 
 private:
-	/** Command generator submodule. */
-	CmdGen_DDR4<BUS_WIDTH,BANKS,COLS,ROWS,THREADS> cmdgen;
-	/** Command arbiter submodule. */
-	CmdArb_DDR4<BUS_WIDTH,BANKS,THREADS> cmdarb;
-	/** DQ scheduler submodule. */
-	DQ<BUS_WIDTH,BANKS,COLS,ROWS,THREADS> dq;
+	/** Command generator submodule, per channel. */
+	CmdGen_DDR4<BUS_WIDTH,BANKS,COLS,ROWS,THREADS> *cmdgen[CHANS];
+	/** Command arbiter submodule, per channel. */
+	CmdArb_DDR4<BUS_WIDTH,BANKS,THREADS> *cmdarb[CHANS];
+	/** DQ scheduler submodule, per channel. */
+	DQ<BUS_WIDTH,BANKS,COLS,ROWS,THREADS> *dq[CHANS];
 
 	/* IdxIterator -> CmdGen */
 	sc_signal<long> cycle;
 
 	/* CmdGen -> CmdArb */
-	vector<tlm_fifo<cmd_DDR<BUS_WIDTH,THREADS> > *> fifo_cmd;
-	sc_signal<bool> cmdgen_busy;
+	vector<RingChannel<cmd_DDR<BUS_WIDTH,THREADS> > *> fifo_cmd;
+	sc_signal<bool> cmdgen_busy[CHANS];
 
 	/* CmdArb -> DQ */
-	sc_fifo<DQ_reservation<BUS_WIDTH,BANKS,THREADS> > fifo_dq;
+	RingChannel<DQ_reservation<BUS_WIDTH,BANKS,THREADS> > fifo_dq[CHANS];
+
+	/* Per-channel status and data path control, joined if CHANS > 1. */
+	sc_signal<bool> chan_ref_pending[CHANS];
+	sc_signal<bool> chan_allpre[CHANS];
+	sc_signal<bool> chan_ref[CHANS];
+	sc_signal<bool> chan_enable[CHANS];
+	sc_signal<bool> chan_write[CHANS];
+	sc_signal<sc_bv<BUS_WIDTH/4> > chan_mask_w[CHANS];
+	sc_fifo<RequestTarget> chan_done_dst[CHANS];
+
+	/** Channels that finished the active stride descriptor. */
+	sc_bv<CHANS> chans_done;
+
+	/** Target of the active stride descriptor, as reported by the
+	 * channels. */
+	RequestTarget join_dst;
+
+	/** True iff a reset is pending for the join thread. */
+	bool join_rst;
+
+	/** Quiescence client identifier of the join thread. */
+	unsigned int q_id;
+
+	/** Number of cycles left for which the cycle counter is held at 0
+	 * after a reset. */
+	unsigned int rst_cycles;
+
+	/** Gated DRAM clock, nullptr if the clock never skips edges. */
+	GatedClock *clk;
+
+	/** Number of skipped clock edges accounted for in the cycle counter. */
+	unsigned long clk_skipped;
 
 	/** Wire up the subcomponents. */
-	void
-	elaborate(void)
+	/** Generate the name of a per-channel submodule.
+	 * @param name Name of the submodule.
+	 * @param c Channel.
+	 * @return name for a single channel, name suffixed with the channel
+	 * 	   number otherwise. */
+	static string
+	chan_name(string name, unsigned int c)
 	{
-		unsigned int i, j;
+		if (CHANS == 1)
+			return name;
 
-		cmdgen.in_clk(in_clk);
-		cmdgen.in_req_fifo(in_req_fifo);
-		cmdgen.out_busy(cmdgen_busy);
+		return name + to_string(c);
+	}
 
-		cmdarb.in_clk(in_clk);
-		cmdarb.out_dq_fifo(fifo_dq);
-		cmdarb.out_ref_pending(out_ref_pending);
-		cmdarb.in_cmdgen_busy(cmdgen_busy);
-		cmdarb.in_cycle(out_cycle);
-		cmdarb.out_allpre(out_allpre);
-		cmdarb.out_ref(out_ref);
-		cmdarb.out_done_dst(out_done_dst);
+	/** Wire up the subcomponents of a single channel.
+	 * @param c Channel. */
+	void
+	elaborate_chan(unsigned int c)
+	{
+		unsigned int i, j, l;
+		RingChannel<cmd_DDR<BUS_WIDTH,THREADS> > *f;
+
+		cmdgen[c] = new CmdGen_DDR4<BUS_WIDTH,BANKS,COLS,ROWS,THREADS>(
+				chan_name("cmdgen", c).c_str());
+		cmdarb[c] = new CmdArb_DDR4<BUS_WIDTH,BANKS,THREADS>(
+				chan_name("cmdarb", c).c_str());
+		dq[c] = new DQ<BUS_WIDTH,BANKS,COLS,ROWS,THREADS>(
+				chan_name("dq", c).c_str());
+
+		cmdgen[c]->in_clk(in_clk);
+		cmdgen[c]->in_req_fifo(in_req_fifo[c]);
+		cmdgen[c]->out_busy(cmdgen_busy[c]);
+
+		cmdarb[c]->in_clk(in_clk);
+		cmdarb[c]->out_dq_fifo(fifo_dq[c]);
+		cmdarb[c]->in_cmdgen_busy(cmdgen_busy[c]);
+		cmdarb[c]->in_cycle(out_cycle);
 		for (i = 0; i < BANKS; i++) {
-			fifo_cmd[i] = new tlm_fifo<cmd_DDR<BUS_WIDTH,THREADS> >(sc_gen_unique_name("fifo_cmd"),8);
+			f = new RingChannel<cmd_DDR<BUS_WIDTH,THREADS> >(sc_gen_unique_name("fifo_cmd"),8);
+			fifo_cmd[c * BANKS + i] = f;
 
-			cmdgen.out_fifo[i](*fifo_cmd[i]);
-			cmdarb.in_cmd_fifo[i](*fifo_cmd[i]);
+			cmdgen[c]->out_fifo[i](*f);
+			cmdarb[c]->in_cmd_fifo[i](*f);
 		}
 
-		dq.in_clk(in_clk);
-		dq.in_cycle(out_cycle);
-		dq.in_fifo_DQ_res(fifo_dq);
-		dq.out_mask_w(out_mask_w);
-		dq.in_reg_mask_w(in_mask_w);
-		dq.out_sp_addr(out_sp_addr);
-		dq.out_enable(out_enable);
-		dq.out_write(out_write);
+		dq[c]->in_clk(in_clk);
+		dq[c]->in_cycle(out_cycle);
+		dq[c]->in_fifo_DQ_res(fifo_dq[c]);
+		dq[c]->in_reg_mask_w(in_mask_w[c]);
+		dq[c]->out_sp_addr(out_sp_addr[c]);
 		for (i = 0; i < BUS_WIDTH/4; i++) {
-			dq.out_data[i](out_data[i]);
-			dq.out_vreg_idx_w[i](out_vreg_idx_w[i]);
+			l = c * (BUS_WIDTH/4) + i;
+			dq[c]->out_data[i](out_data[l]);
+			dq[c]->out_vreg_idx_w[i](out_vreg_idx_w[l]);
 			for (j = 0; j < int(IF_SENTINEL); j++)
-				dq.in_data[j][i](in_data[j][i]);
+				dq[c]->in_data[j][i](in_data[j][l]);
+		}
+
+		if (CHANS == 1) {
+			cmdarb[c]->out_ref_pending(out_ref_pending);
+			cmdarb[c]->out_allpre(out_allpre);
+			cmdarb[c]->out_ref(out_ref);
+			cmdarb[c]->out_done_dst(out_done_dst);
+
+			dq[c]->out_mask_w(out_mask_w[c]);
+			dq[c]->out_enable(out_enable);
+			dq[c]->out_write(out_write);
+		} else {
+			cmdarb[c]->out_ref_pending(chan_ref_pending[c]);
+			cmdarb[c]->out_allpre(chan_allpre[c]);
+			cmdarb[c]->out_ref(chan_ref[c]);
+			cmdarb[c]->out_done_dst(chan_done_dst[c]);
+
+			dq[c]->out_mask_w(chan_mask_w[c]);
+			dq[c]->out_enable(chan_enable[c]);
+			dq[c]->out_write(chan_write[c]);
 		}
 	}
 
-	/** Main thread */
+	/** Wire up the subcomponents. */
 	void
-	thread_lt(void)
+	elaborate(void)
 	{
-		while (true) {
-			wait();
-			out_cycle.write(out_cycle.read() + 1);
-		}
+		unsigned int c;
 
+		for (c = 0; c < CHANS; c++)
+			elaborate_chan(c);
 	}
 
-	/** Upload CSV data from ProgramBuffer into DRAM.
-	 * @param pb Program buffer. */
+	/** Join the refresh status of all channels. */
 	void
-	debug_upload_buffer_csv(const ProgramBuffer &pb)
+	method_join_ref(void)
 	{
-		sc_uint<const_log2(BANKS)> bank;
-		sc_uint<const_log2(ROWS)> row;
-		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i;
-		bfloat elem;
+		unsigned int c;
+		bool ref_pending = false;
+		bool ref = false;
+
+		for (c = 0; c < CHANS; c++) {
+			ref_pending |= chan_ref_pending[c].read();
+			ref |= chan_ref[c].read();
+		}
 
-		unsigned int addr;
-		float *buf;
+		out_ref_pending.write(ref_pending);
+		out_ref.write(ref);
+	}
 
-		words = csv_file_read_float(pb.getDataInputFile().c_str(), &buf);
-		if (words < 0ul) {
-			throw invalid_argument("Could not read CSV file " + pb.getDataInputFile());
+	/** Join the data path control signals of all channels. All channels
+	 * transferring data serve the same stride descriptor, hence share the
+	 * direction of transfer. */
+	void
+	method_join_dq(void)
+	{
+		unsigned int c;
+		bool enable = false;
+		bool write = false;
+
+		for (c = 0; c < CHANS; c++) {
+			if (chan_enable[c].read()) {
+				enable = true;
+				write |= chan_write[c].read();
+				out_mask_w[c].write(chan_mask_w[c].read());
+			} else {
+				out_mask_w[c].write(0);
+			}
 		}
 
-		words = max(words, (int64_t) (pb.dims[0] * pb.dims[1]));
+		out_enable.write(enable);
+		out_write.write(write);
+	}
 
-		for (i = 0, addr = pb.getAddress(); i < words; i++, addr += 4) {
-			cmdgen.address_translate(addr, bank, row, col);
+	/** Signal completion of a stride descriptor once all channels that
+	 * received burst requests for it precharged all their banks. Costs
+	 * DRAM_CHAN_JOIN_CYCLES over the completion of the slowest channel. */
+	void
+	thread_join(void)
+	{
+		unsigned int c;
+		sc_bv<CHANS> chans;
+		bool active;
 
-			elem.f = buf[i];
+		while (true) {
+			if (join_rst) {
+				join_rst = false;
+				chans_done = 0;
+				join_dst = RequestTarget();
+			}
 
-			dq.debug_store_init(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1, elem.b);
+			active = out_allpre.read();
+			out_allpre.write(false);
+
+			for (c = 0; c < CHANS; c++) {
+				if (chan_allpre[c].read()) {
+					chans_done[c] = Log_1;
+					active = true;
+				}
+
+				while (chan_done_dst[c].num_available())
+					join_dst = chan_done_dst[c].read();
+			}
+
+			chans = in_chans.read();
+			if (chans.or_reduce() && (chans_done & chans) == chans) {
+				out_allpre.write(true);
+				out_done_dst.write(join_dst);
+				chans_done = 0;
+			}
+
+			/* Channels are awake around their allpre pulse, which
+			 * is the only event advancing the join. */
+			if (active)
+				Quiescence::get().busy(q_id);
+			else
+				Quiescence::get().idle(q_id);
+
+			wait();
 		}
+	}
 
-		if (buf)
-			delete[] buf;
+	/** Cycle counter, evaluated on every DRAM clock edge. */
+	void
+	method_cycle(void)
+	{
+		unsigned long skip = 0ul;
+
+		if (clk) {
+			skip = clk->get_skipped() - clk_skipped;
+			clk_skipped = clk->get_skipped();
+		}
+
+		/* After reset, hold the counter at 0 for both the cycle in which
+		 * submodules pick up the reset and the cycle replaying their
+		 * initialisation. */
+		if (rst_cycles) {
+			rst_cycles--;
+			out_cycle.write(0);
+			return;
+		}
+
+		out_cycle.write(out_cycle.read() + 1 + skip);
 	}
 
-	/** Upload data from ProgramBuffer into DRAM. We're handling 32-bit
-	 * "binary" data, no conversion.
-	 * @param pb Program buffer. */
+	/** Copy a contiguous range of words between a host buffer and DRAM.
+	 *
+	 * Rather than translating and looking up every word individually,
+	 * this copies one burst-sized run of words at a time. All words within
+	 * a burst map onto consecutive words of a single DRAM row.
+	 * @param addr DRAM start address, word-aligned.
+	 * @param buf Host buffer.
+	 * @param words Number of words to copy.
+	 * @param upload True iff words are copied from buf to DRAM, false iff
+	 * 		 copied from DRAM to buf. */
 	void
-	debug_upload_buffer_bin_float(const ProgramBuffer &pb)
+	bulk_copy(uint32_t addr, uint32_t *buf, size_t words, bool upload)
 	{
 		sc_uint<const_log2(BANKS)> bank;
 		sc_uint<const_log2(ROWS)> row;
 		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i;
-		bfloat elem;
-		ifstream *fs;
-		unsigned int addr;
-
-		fs = new ifstream(pb.getDataInputFile());
+		size_t n;
+		uint32_t *data;
+		unsigned int c;
 
-		if (!fs->is_open()) {
-			throw invalid_argument("Could not read binary file " + pb.getDataInputFile());
+		if (dq[0]->is_timing_only()) {
+			if (!upload)
+				memset(buf, 0, words * sizeof(uint32_t));
+			return;
 		}
 
-		words = (int64_t) (pb.dims[0] * pb.dims[1]);
+		while (words) {
+			/* A burst never spans multiple channels. */
+			c = dram_chan<CHANS>(addr);
+			cmdgen[c]->address_translate(dram_chan_addr<CHANS>(addr),
+					bank, row, col);
 
-		for (i = 0, addr = pb.getAddress(); i < words; i++, addr += 4) {
-			cmdgen.address_translate(addr, bank, row, col);
+			/* Word offset within the burst. */
+			n = (addr >> 2) & (BUS_WIDTH - 1);
+			data = dq[c]->debug_store_row(bank, row) +
+					(col * (BUS_WIDTH / 8)) + n;
+			n = min(words, size_t(BUS_WIDTH - n));
 
-			fs->read((char *)&elem.b, sizeof(float));
+			if (upload)
+				memcpy(data, buf, n * sizeof(uint32_t));
+			else
+				memcpy(buf, data, n * sizeof(uint32_t));
 
-			dq.debug_store_init(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1, elem.b);
+			buf += n;
+			words -= n;
+			addr += n * 4;
 		}
 	}
+
 public:
 	/** Constructor */
 	SC_CTOR(Backend)
-	: cmdgen("cmdgen"), cmdarb("cmdarb"), dq("dq"), fifo_cmd(BANKS)
-
+	: fifo_cmd(CHANS * BANKS), chans_done(0), join_rst(false),
+	  q_id(Quiescence::get().add_client()), rst_cycles(0u),
+	  clk(nullptr), clk_skipped(0ul)
 	{
+		unsigned int c;
+
 		elaborate();
 
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_cycle);
 		sensitive << in_clk.pos();
+		dont_initialize();
+
+		if (CHANS > 1) {
+			SC_THREAD(thread_join);
+			sensitive << in_clk.pos();
+
+			SC_METHOD(method_join_ref);
+			for (c = 0; c < CHANS; c++)
+				sensitive << chan_ref_pending[c] << chan_ref[c];
+
+			SC_METHOD(method_join_dq);
+			for (c = 0; c < CHANS; c++)
+				sensitive << chan_enable[c] << chan_write[c]
+						<< chan_mask_w[c];
+		} else {
+			/* Nothing to join, never hold the clock. */
+			Quiescence::get().idle(q_id);
+		}
+	}
+
+	/** Reset the back-end to its power-on state, retaining DRAM contents.
+	 *
+	 * Only valid while the simulation is paused (sc_pause()) after all
+	 * outstanding requests finished and all banks are precharged. Upon
+	 * resuming, the back-end spends one cycle picking up the reset, after
+	 * which it behaves identical to a freshly elaborated back-end,
+	 * including the cycle counter starting from 0. */
+	void
+	reset(void)
+	{
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++) {
+			cmdgen[c]->reset();
+			cmdarb[c]->reset();
+			dq[c]->reset();
+		}
+
+		join_rst = true;
+		rst_cycles = 2u;
+	}
+
+	/** Attach the gated clock driving in_clk.
+	 *
+	 * Clock edges skipped due to quiescence are added to the cycle
+	 * counter, keeping it exact.
+	 * @param c Gated DRAM clock. */
+	void
+	set_gated_clock(GatedClock *c)
+	{
+		unsigned int i;
+
+		clk = c;
+		clk_skipped = c->get_skipped();
+		for (i = 0; i < CHANS; i++) {
+			cmdarb[i]->set_clk_period(c->get_period());
+			dq[i]->set_clk_period(c->get_period());
+		}
+	}
+
+	/** Enable or disable timing-only mode.
+	 *
+	 * In timing-only mode, no data is stored in DRAM. Reads return 0 and
+	 * uploads are skipped. Command timing and statistics are unaffected.
+	 * @param t True iff DRAM data should be discarded. */
+	void
+	set_timing_only(bool t)
+	{
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++)
+			dq[c]->set_timing_only(t);
+	}
+
+	/** Copy a contiguous range of words between a host buffer and DRAM
+	 * storage, bypassing the timing model.
+	 * @param addr DRAM start address, word-aligned.
+	 * @param buf Host buffer.
+	 * @param words Number of words to copy.
+	 * @param upload True iff words are copied from buf to DRAM, false iff
+	 * 		 copied from DRAM to buf. */
+	void
+	debug_copy_range(unsigned int addr, uint32_t *buf, size_t words,
+			bool upload)
+	{
+		bulk_copy(addr, buf, words, upload);
 	}
 
 	/** Upload a test pattern to DRAM.
@@ -286,11 +554,17 @@ public:
 		sc_uint<const_log2(COLS)> col;
 
 		unsigned int i;
+		unsigned int c;
+
+		if (dq[0]->is_timing_only())
+			return;
 
 		for (i = addr; i < addr + (words * 4); i += 4) {
-			cmdgen.address_translate(i, bank, row, col);
+			c = dram_chan<CHANS>(i);
+			cmdgen[c]->address_translate(dram_chan_addr<CHANS>(i),
+					bank, row, col);
 
-			dq.debug_store_init(bank, row,
+			dq[c]->debug_store_init(bank, row,
 					col | ((addr >> 3) & 0x7),
 					(addr >> 2) & 0x1, i - addr);
 		}
@@ -301,16 +575,7 @@ public:
 	void
 	debug_upload_buffer(const ProgramBuffer &pb)
 	{
-		if (!pb.hasDataInputFile())
-			return;
-
-		if (pb.getDataInputType() == DECIMAL_CSV) {
-			debug_upload_buffer_csv(pb);
-		} else if (pb.getDataInputType() == BINARY) {
-			debug_upload_buffer_bin_float(pb);
-		} else {
-			throw invalid_argument("Unimplemented buffer type");
-		}
+		upload_buffer(pb);
 	}
 
 	/** Download binary data from DRAM into an output file.
@@ -319,32 +584,19 @@ public:
 	void
 	debug_download_buffer_bin(const ProgramBuffer &pb, string filename)
 	{
-		sc_uint<const_log2(BANKS)> bank;
-		sc_uint<const_log2(ROWS)> row;
-		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i;
-		bfloat elem;
-		ofstream fs(filename, ios_base::out | ios_base::trunc);
-
-		unsigned int addr;
-
-		if (!pb.valid)
-			return;
-
-		words = (int64_t) (pb.dims[0] * pb.dims[1]);
-
-		for (i = 0, addr = pb.getAddress(); i < words; i++, addr += 4) {
-
-			cmdgen.address_translate(addr, bank, row, col);
-
-			elem.b = dq.debug_store_read(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1);
+		download_buffer_bin(pb, filename);
+	}
 
-			fs.write((char *)&elem.b, sizeof(float));
-		}
-		fs.close();
+	/** Download data from DRAM into a NumPy .npy file.
+	 *
+	 * The output file is created at its final size, mapped, and filled
+	 * straight from DRAM storage.
+	 * @param pb Program Buffer to download data from.
+	 * @param filename File to download results into. */
+	void
+	debug_download_buffer_npy(const ProgramBuffer &pb, string filename)
+	{
+		download_buffer_npy(pb, filename);
 	}
 
 	/** Download CSV data from DRAM into an output file.
@@ -353,32 +605,7 @@ public:
 	void
 	debug_download_buffer_csv(const ProgramBuffer &pb, string filename)
 	{
-		sc_uint<const_log2(BANKS)> bank;
-		sc_uint<const_log2(ROWS)> row;
-		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i;
-		bfloat elem;
-		ofstream fs(filename, ios_base::out | ios_base::trunc);
-
-		unsigned int addr;
-
-		if (!pb.valid)
-			return;
-
-		words = (int64_t) (pb.dims[0] * pb.dims[1]);
-
-		for (i = 0, addr = pb.getAddress(); i < words; i++, addr += 4) {
-
-			cmdgen.address_translate(addr, bank, row, col);
-
-			elem.b = dq.debug_store_read(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1);
-
-			fs << elem.f << ", ";
-		}
-		fs.close();
+		download_buffer_csv(pb, filename);
 	}
 
 	/** Compare a DRAM buffer against a provided golden output.
@@ -387,89 +614,31 @@ public:
 	 * @param delta Tolerable delta.
 	 * @param pct True iff delta should be interpreted as a fractional
 	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
 	 * @return True iff the buffer matches the golden values. */
 	bool
 	debug_compare_buffer_bin(const ProgramBuffer &pb, string filename,
-			float delta = 0.001f, bool pct = false)
+			float delta = 0.001f, bool pct = false,
+			cmp_stats *stats = nullptr)
 	{
-		sc_uint<const_log2(BANKS)> bank;
-		sc_uint<const_log2(ROWS)> row;
-		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i = 0ull;
-		bfloat elem, gold;
-		ifstream fs(filename, ios_base::in);
-		unsigned int errors = 0;
-		float diff;
-
-		unsigned int addr;
-
-		if (!fs) {
-			cerr << "Error: could not open file " << filename <<
-				" for buffer comparison." << endl;
-			return false;
-		}
-
-		if (!pb.valid) {
-			cerr << "Error: attempting to compare against invalid "
-				"buffer" << endl;
-			goto cmpbuf_out;
-		}
-
-		words = (int64_t) (pb.dims[0] * pb.dims[1]);
-
-		/* i is already initialised. */
-		for (addr = pb.getAddress(); i < words; i++, addr += 4) {
-			fs.read((char *)&gold.b, sizeof(float));
-
-			if (!fs) {
-				if (fs.eofbit) {
-					break;
-				} else {
-					cerr << "Error: unknown problem comparing "
-						"buffer contents." << endl;
-					errors++;
-					break;
-
-				}
-			}
-
-			cmdgen.address_translate(addr, bank, row, col);
-
-			elem.b = dq.debug_store_read(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1);
-
-			/** Calculate percentage off */
-			if (pct)
-				diff = fabs((elem.f / gold.f) - 1.f);
-			else
-				diff = fabs(gold.f - elem.f);
-
-			if (diff > delta) {
-				cerr << hex << addr << dec << ": MISMATCH " <<
-					elem.f << " != " << gold.f << endl;
-				errors++;
-			}
-
-			if (errors >= 10) {
-				cerr << "Too many errors, quitting." << endl;
-				break;
-			}
-		}
-
-
-		if (errors == 0)
-			cout << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
-			<< i << " words, " << errors << " errors." << endl;
-		else
-			cerr << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
-			<< i << " words, " << errors << " errors." << endl;
-
-	cmpbuf_out:
-		fs.close();
+		return compare_buffer_bin(pb, filename, delta, pct, stats);
+	}
 
-		return (errors == 0);
+	/** Compare a DRAM buffer against a provided golden output in NumPy
+	 * .npy form. The shape of the file must match the buffer dimensions.
+	 * @param pb ProgramBuffer to compare against.
+	 * @param filename Name of file that contains golden values.
+	 * @param delta Tolerable delta.
+	 * @param dfrac True iff delta should be interpreted as a fractional
+	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
+	 * @return True iff the buffer matches the golden values. */
+	bool
+	debug_compare_buffer_npy(const ProgramBuffer &pb, string filename,
+			float delta = 0.001f, bool dfrac = false,
+			cmp_stats *stats = nullptr)
+	{
+		return compare_buffer_npy(pb, filename, delta, dfrac, stats);
 	}
 
 	/** Compare a DRAM buffer against a provided golden output in CSV form.
@@ -478,92 +647,15 @@ public:
 	 * @param delta Tolerable delta.
 	 * @param dfrac True iff delta should be interpreted as a fractional
 	 *  		difference.
+	 * @param stats If not nullptr, error statistics are stored here.
 	 * @return True iff the buffer matches the golden value.
 	 */
 	bool
 	debug_compare_buffer_csv(const ProgramBuffer &pb, string filename,
-			float delta = 0.001f, bool dfrac = false)
+			float delta = 0.001f, bool dfrac = false,
+			cmp_stats *stats = nullptr)
 	{
-		sc_uint<const_log2(BANKS)> bank;
-		sc_uint<const_log2(ROWS)> row;
-		sc_uint<const_log2(COLS)> col;
-		int64_t words;
-		int64_t i = 0ull;
-		bfloat elem, gold;
-		ifstream fs(filename, ios_base::in);
-		unsigned int errors = 0;
-		float diff;
-
-		unsigned int addr;
-
-		if (!fs) {
-			cerr << "Error: could not open file " << filename <<
-				" for buffer comparison." << endl;
-			return false;
-		}
-
-		if (!pb.valid) {
-			cerr << "Error: attempting to compare against invalid "
-				"buffer" << endl;
-			goto cmpbuf_out;
-		}
-
-		words = (int64_t) (pb.dims[0] * pb.dims[1]);
-
-		/* i is already initialised. */
-		for (addr = pb.getAddress(); i < words; i++, addr += 4) {
-
-			fs >> gold.f;
-
-			if (!fs) {
-				if (fs.eofbit) {
-					break;
-				} else {
-					cerr << "Error: unknown problem comparing "
-						"buffer contents." << endl;
-					errors++;
-					break;
-
-				}
-			}
-
-			cmdgen.address_translate(addr, bank, row, col);
-
-			elem.b = dq.debug_store_read(bank, row,
-					col | ((addr >> 3) & 0x7),
-					(addr >> 2) & 0x1);
-
-			/** Calculate percentage off */
-			if (dfrac)
-				diff = fabs((elem.f / gold.f) - 1.f);
-			else
-				diff = fabs(gold.f - elem.f);
-
-			if (diff > delta) {
-				cerr << hex << addr << dec << ": MISMATCH " <<
-					elem.f << " != " << gold.f << endl;
-				errors++;
-			}
-
-			if (errors >= 10) {
-				cerr << "Too many errors, quitting." << endl;
-				break;
-			}
-
-			fs.ignore(numeric_limits<streamsize>::max(), ',');
-		}
-
-		if (errors == 0)
-			cout << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
-			<< i << " words, " << errors << " errors." << endl;
-		else
-			cerr << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
-			<< i << " words, " << errors << " errors." << endl;
-
-	cmpbuf_out:
-		fs.close();
-
-		return (errors == 0);
+		return compare_buffer_csv(pb, filename, delta, dfrac, stats);
 	}
 
 	/** Debug: Print a range of DRAM to stdout
@@ -573,16 +665,19 @@ public:
 	debug_print_range(unsigned int addr, unsigned int words)
 	{
 		unsigned int i;
+		unsigned int c;
 		sc_uint<const_log2(BANKS)> bank;
 		sc_uint<const_log2(ROWS)> row;
 		sc_uint<const_log2(COLS)> col;
 
 		for (i = addr; i < addr + (words * 4); i += 4) {
-			cmdgen.address_translate(i, bank, row, col);
+			c = dram_chan<CHANS>(i);
+			cmdgen[c]->address_translate(dram_chan_addr<CHANS>(i),
+					bank, row, col);
 
 			if (!(i & 0xf))
 				std::cout << std::hex << i << ": ";
-			std::cout << dq.debug_store_read(bank, row,
+			std::cout << dq[c]->debug_store_read(bank, row,
 					col | ((i >> 3) & 0x7), (i >> 2) & 0x1)
 					<< " ";
 			if ((i & 0xf) >= 0xc)
@@ -590,13 +685,48 @@ public:
 		}
 	}
 
-	/** Obtain stats from cmdarb.
+	/** Obtain stats from cmdarb, merged over all channels.
 	 * @param s Reference to cmdarb_stats to store results in.
 	 * @param cycles Number of cycles spent on this request. */
 	void
 	get_cmdarb_stats(cmdarb_stats &s, unsigned int cycles = 0)
 	{
-		cmdarb.get_stats(s, cycles);
+		cmdarb_stats cs;
+		unsigned int c;
+
+		/* Utilisation of all channels over the same time span, by
+		 * default up to the last command issued on any channel. */
+		if (!cycles && CHANS > 1) {
+			for (c = 0; c < CHANS; c++) {
+				cmdarb[c]->get_stats(cs);
+				cycles = max(cycles, (unsigned int) cs.lid);
+			}
+		}
+
+		cmdarb[0]->get_stats(s, cycles);
+		for (c = 1; c < CHANS; c++) {
+			cmdarb[c]->get_stats(cs, cycles);
+			s.merge_channel(cs, c + 1);
+		}
+	}
+
+	/** Obtain the running command counters, summed over all channels.
+	 * @param bytes Number of bytes transferred so far.
+	 * @param acts Number of activate commands issued so far. */
+	void
+	get_cmdarb_counters(unsigned long &bytes, unsigned long &acts)
+	{
+		unsigned long b;
+		unsigned long a;
+		unsigned int c;
+
+		bytes = 0ul;
+		acts = 0ul;
+		for (c = 0; c < CHANS; c++) {
+			cmdarb[c]->get_counters(b, a);
+			bytes += b;
+			acts += a;
+		}
 	}
 
 	/** Return the clock period for the compiled RAM organisation.
@@ -604,7 +734,7 @@ public:
 	double
 	get_clk_period(void)
 	{
-		return cmdarb.get_clk_period();
+		return cmdarb[0]->get_clk_period();
 	}
 
 	/** Return the clock frequency for the compiled RAM organisation.
@@ -612,7 +742,7 @@ public:
 	unsigned long
 	get_freq_MHz(void)
 	{
-		return cmdarb.get_freq_MHz();
+		return cmdarb[0]->get_freq_MHz();
 	}
 
 	/**
@@ -626,7 +756,58 @@ public:
 	void
 	set_refresh_counter(unsigned long refc)
 	{
-		cmdarb.set_refresh_counter(refc);
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++)
+			cmdarb[c]->set_refresh_counter(refc);
+	}
+
+	/** Write the DRAM contents and refresh state to a checkpoint.
+	 *
+	 * Must only be called while the simulation is paused with the memory
+	 * controller idle. The bank state is not saved: rows left open are
+	 * lost, and a restored Backend starts with all banks precharged.
+	 * @param w Checkpoint writer. */
+	void
+	checkpoint(CheckpointWriter &w)
+	{
+		ckpt_refresh ref;
+		unsigned long refc;
+		unsigned int pending;
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++) {
+			cmdarb[c]->get_refresh_state(refc, pending);
+			ref.counter = refc;
+			ref.pending = pending;
+			ref.pad = 0;
+			w.add_section(CKPT_REFRESH, c, &ref, sizeof(ref));
+			dq[c]->checkpoint(w, c);
+		}
+	}
+
+	/** Restore the DRAM contents and refresh state from a checkpoint.
+	 *
+	 * Must be called prior to simulation.
+	 * @param r Checkpoint reader, must outlive this Backend.
+	 * @return False iff the checkpoint does not match this Backend. */
+	bool
+	restore(const CheckpointReader &r)
+	{
+		ckpt_refresh ref;
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++) {
+			if (!r.read(CKPT_REFRESH, c, &ref, sizeof(ref)))
+				return false;
+
+			cmdarb[c]->set_refresh_state(ref.counter, ref.pending);
+
+			if (!dq[c]->restore(r, c))
+				return false;
+		}
+
+		return true;
 	}
 
 	/** Allocate a statistics (performance counters) buffer.
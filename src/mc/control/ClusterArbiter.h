@@ -0,0 +1,348 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MC_CONTROL_CLUSTERARBITER_H
+#define MC_CONTROL_CLUSTERARBITER_H
+
+#include <systemc>
+
+#include "model/Register.h"
+#include "model/request_target.h"
+#include "model/stride_descriptor.h"
+#include "util/defaults.h"
+#include "util/Quiescence.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace simd_model;
+using namespace std;
+using namespace simd_util;
+
+/** Number of DRAM cycles the grant handshake adds to every stride descriptor,
+ * compared to a SimdCluster connected directly to the StrideSequencer. */
+#define CLUSTER_ARB_GRANT_CYCLES 2
+
+namespace mc_control {
+
+/** Share a single memory controller between multiple SimdClusters.
+ *
+ * The arbiter grants the StrideSequencer to one cluster at a time, at stride
+ * descriptor granularity. Clusters with a pending descriptor are served in
+ * strict round-robin order, starting from the cluster after the one granted
+ * last. The grant is held until the StrideSequencer signals it finished the
+ * descriptor. Hence a descriptor waits for at most CLUSTERS-1 descriptors of
+ * other clusters, each taking no longer than the longest DRAM phase plus
+ * CLUSTER_ARB_GRANT_CYCLES, which is the bound used in WCET analysis.
+ *
+ * Signals the memory controller routes to a specific destination (enable,
+ * target, register, index push trigger, completion) are forwarded to the
+ * granted cluster only. Data, mask and ticket outputs of the granted cluster
+ * are multiplexed towards the memory controller. All other memory controller
+ * outputs can be broadcast to all clusters directly.
+ * @param BUS_WIDTH Number of 32-bit words in a burst.
+ * @param THREADS Number of work-items in a work-group.
+ * @param CLUSTERS Number of SimdClusters sharing the memory controller.
+ * @param CHANS Number of DRAM channels.
+ */
+template <unsigned int BUS_WIDTH, unsigned int THREADS = COMPUTE_THREADS,
+	unsigned int CLUSTERS = COMPUTE_CLUSTERS,
+	unsigned int CHANS = MC_DRAM_CHANS>
+class ClusterArbiter : public sc_module
+{
+private:
+	/** Cluster currently holding the grant. Retained while idle. */
+	sc_signal<unsigned int> grant;
+
+	/** State of the arbiter. */
+	enum {
+		ARB_ST_IDLE = 0,
+		ARB_ST_BUSY
+	} state = ARB_ST_IDLE;
+
+	/** Number of descriptors granted to each cluster. */
+	unsigned long grants[CLUSTERS];
+
+	/** Number of DRAM cycles each cluster had a descriptor pending without
+	 * holding the grant. */
+	unsigned long wait_cycles[CLUSTERS];
+
+	/** Quiescence client identifier. */
+	unsigned int q_id;
+
+public:
+	/** DRAM clock, SDR. */
+	sc_in<bool> in_clk{"in_clk"};
+
+	/** Stride descriptors from each cluster. */
+	sc_fifo_in<stride_descriptor> in_desc_fifo[CLUSTERS];
+
+	/** Kick signals from each cluster. Drained, the presence of a
+	 * descriptor suffices to request the grant. */
+	sc_fifo_in<bool> in_trigger[CLUSTERS];
+
+	/** Ticket number of the next descriptor of each cluster. */
+	sc_in<sc_uint<4> > in_ticket_pop[CLUSTERS];
+
+	/** CAM indexes from each cluster for index iteration. */
+	sc_fifo_in<idx_t<THREADS> > in_idx[CLUSTERS];
+
+	/** Store masks from each cluster, per DRAM channel. */
+	sc_in<sc_bv<BUS_WIDTH/4> > in_mask[CLUSTERS][CHANS];
+
+	/** Store data from each cluster. */
+	sc_in<sc_uint<32> > in_data[CLUSTERS][IF_SENTINEL][CHANS*BUS_WIDTH/4];
+
+	/** Granted stride descriptor to the StrideSequencer. */
+	sc_fifo_out<stride_descriptor> out_desc_fifo{"out_desc_fifo"};
+
+	/** Trigger for the StrideSequencer. */
+	sc_fifo_out<bool> out_trigger{"out_trigger"};
+
+	/** Ticket number of the granted cluster. */
+	sc_inout<sc_uint<4> > out_ticket_pop{"out_ticket_pop"};
+
+	/** CAM indexes of the granted cluster. */
+	sc_fifo_out<idx_t<THREADS> > out_idx{"out_idx"};
+
+	/** Store mask of the granted cluster, per DRAM channel. */
+	sc_inout<sc_bv<BUS_WIDTH/4> > out_mask[CHANS];
+
+	/** Store data of the granted cluster. */
+	sc_inout<sc_uint<32> > out_data[IF_SENTINEL][CHANS*BUS_WIDTH/4];
+
+	/** StrideSequencer finished all descriptors. */
+	sc_in<bool> in_done{"in_done"};
+
+	/** Memory controller completed a request. */
+	sc_fifo_in<RequestTarget> in_done_dst{"in_done_dst"};
+
+	/** Completed requests, per cluster. */
+	sc_fifo_out<RequestTarget> out_done_dst[CLUSTERS];
+
+	/** DRAM data transfer enable from the memory controller. */
+	sc_in<bool> in_enable{"in_enable"};
+
+	/** DRAM data transfer enable, per cluster. */
+	sc_inout<bool> out_enable[CLUSTERS];
+
+	/** Request target from the StrideSequencer. */
+	sc_in<RequestTarget> in_dst{"in_dst"};
+
+	/** Request target, per cluster. */
+	sc_inout<RequestTarget> out_dst[CLUSTERS];
+
+	/** Target register from the StrideSequencer. */
+	sc_in<AbstractRegister> in_dst_reg{"in_dst_reg"};
+
+	/** Target register, per cluster. */
+	sc_inout<AbstractRegister> out_dst_reg[CLUSTERS];
+
+	/** Index push trigger from the StrideSequencer. */
+	sc_in<bool> in_idx_push_trigger{"in_idx_push_trigger"};
+
+	/** Index push trigger, per cluster. */
+	sc_inout<bool> out_idx_push_trigger[CLUSTERS];
+
+	/** Construct thread. */
+	SC_CTOR(ClusterArbiter) : q_id(Quiescence::get().add_client())
+	{
+		unsigned int c, i, j;
+
+		for (c = 0; c < CLUSTERS; c++) {
+			grants[c] = 0ul;
+			wait_cycles[c] = 0ul;
+		}
+
+		SC_THREAD(thread_lt);
+		sensitive << in_clk.pos();
+
+		SC_METHOD(method_route);
+		sensitive << grant << in_enable << in_dst << in_dst_reg
+				<< in_idx_push_trigger;
+		for (c = 0; c < CLUSTERS; c++) {
+			sensitive << in_ticket_pop[c];
+			for (i = 0; i < CHANS; i++)
+				sensitive << in_mask[c][i];
+			for (i = 0; i < IF_SENTINEL; i++) {
+				for (j = 0; j < CHANS*BUS_WIDTH/4; j++)
+					sensitive << in_data[c][i][j];
+			}
+		}
+	}
+
+	/** Return the number of descriptors granted to a cluster.
+	 * @param c Cluster index.
+	 * @return Number of descriptors granted to cluster c. */
+	unsigned long
+	get_grants(unsigned int c) const
+	{
+		return grants[c];
+	}
+
+	/** Return the number of DRAM cycles a cluster waited for the grant.
+	 * @param c Cluster index.
+	 * @return Number of DRAM cycles cluster c had a descriptor pending
+	 * 	   while another cluster held the grant. */
+	unsigned long
+	get_wait_cycles(unsigned int c) const
+	{
+		return wait_cycles[c];
+	}
+
+private:
+	/** Route destination signals to the granted cluster, and multiplex the
+	 * outputs of the granted cluster towards the memory controller. */
+	void
+	method_route(void)
+	{
+		unsigned int c, i, j;
+		unsigned int g;
+
+		g = grant.read();
+
+		for (c = 0; c < CLUSTERS; c++) {
+			if (c == g) {
+				out_enable[c].write(in_enable.read());
+				out_dst[c].write(in_dst.read());
+				out_dst_reg[c].write(in_dst_reg.read());
+				out_idx_push_trigger[c].write(
+						in_idx_push_trigger.read());
+			} else {
+				out_enable[c].write(false);
+				out_dst[c].write(RequestTarget());
+				out_dst_reg[c].write(AbstractRegister());
+				out_idx_push_trigger[c].write(false);
+			}
+		}
+
+		out_ticket_pop.write(in_ticket_pop[g].read());
+		for (i = 0; i < CHANS; i++)
+			out_mask[i].write(in_mask[g][i].read());
+		for (i = 0; i < IF_SENTINEL; i++) {
+			for (j = 0; j < CHANS*BUS_WIDTH/4; j++)
+				out_data[i][j].write(in_data[g][i][j].read());
+		}
+	}
+
+	/** Forward completion notifications and CAM indexes between the
+	 * memory controller and the granted cluster.
+	 * @param g Granted cluster.
+	 * @return True iff any element was forwarded. */
+	bool
+	forward(unsigned int g)
+	{
+		RequestTarget dst;
+		idx_t<THREADS> idx;
+		bool fwd = false;
+
+		while (in_done_dst.num_available() &&
+		       out_done_dst[g].num_free()) {
+			dst = in_done_dst.read();
+			out_done_dst[g].write(dst);
+			fwd = true;
+		}
+
+		while (in_idx[g].num_available() && out_idx.num_free()) {
+			idx = in_idx[g].read();
+			out_idx.write(idx);
+			fwd = true;
+		}
+
+		return fwd;
+	}
+
+	/** Main thread. */
+	void
+	thread_lt(void)
+	{
+		unsigned int c, i;
+		unsigned int g;
+		stride_descriptor desc;
+		bool active;
+
+		g = 0;
+
+		while (true) {
+			active = false;
+
+			for (c = 0; c < CLUSTERS; c++) {
+				while (in_trigger[c].num_available()) {
+					in_trigger[c].read();
+					active = true;
+				}
+			}
+
+			active |= forward(g);
+
+			switch (state) {
+			case ARB_ST_BUSY:
+				if (!in_done.read())
+					break;
+
+				state = ARB_ST_IDLE;
+				active = true;
+				/* fall-through */
+			case ARB_ST_IDLE:
+				for (i = 1; i <= CLUSTERS; i++) {
+					c = (g + i) % CLUSTERS;
+					if (in_desc_fifo[c].num_available())
+						break;
+				}
+
+				if (i > CLUSTERS)
+					break;
+
+				g = c;
+				grant.write(g);
+				grants[g]++;
+
+				/* Blocking */
+				in_desc_fifo[g].read(desc);
+				out_desc_fifo.write(desc);
+				out_trigger.nb_write(true);
+
+				state = ARB_ST_BUSY;
+				active = true;
+				break;
+			}
+
+			/* Waiting clusters are accounted for every cycle, hence
+			 * the clock must not skip these. The memory controller
+			 * is busy serving the granted cluster anyway. */
+			for (c = 0; c < CLUSTERS; c++) {
+				if (c != g && in_desc_fifo[c].num_available()) {
+					wait_cycles[c]++;
+					active = true;
+				}
+			}
+
+			/* Waiting for a descriptor or for the StrideSequencer
+			 * to finish is only ended by an input changing. */
+			if (active)
+				Quiescence::get().busy(q_id);
+			else
+				Quiescence::get().idle(q_id);
+
+			wait();
+		}
+	}
+};
+
+}
+
+#endif /* MC_CONTROL_CLUSTERARBITER_H */
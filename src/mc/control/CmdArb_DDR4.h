@@ -38,6 +38,8 @@
 #include "mc/model/cmdarb_stats.h"
 #include "util/debug_output.h"
 #include "util/defaults.h"
+#include "util/Quiescence.h"
+#include "util/RingChannel.h"
 
 using namespace std;
 using namespace sc_core;
@@ -45,6 +47,7 @@ using namespace sc_dt;
 using namespace ramulator;
 using namespace mc_model;
 using namespace tlm;
+using namespace simd_util;
 
 namespace mc_control {
 
@@ -103,10 +106,10 @@ public:
 	sc_in<bool> in_clk{"in_clk"};
 
 	/** One FIFO per bank - CAS/Precharge commands
-	 * Using TLM FIFOs because they support inspecting its elements without
-	 * popping them off.
+	 * Bound through RingChannel_in_if because it supports inspecting its
+	 * elements without popping them off.
 	 * @todo FIFO depth? */
-	sc_port<tlm_fifo<cmd_DDR<BUS_WIDTH,THREADS> > > in_cmd_fifo[DRAM_BANKS];
+	sc_port<RingChannel_in_if<cmd_DDR<BUS_WIDTH,THREADS> > > in_cmd_fifo[DRAM_BANKS];
 
 	/** DQ reservation fifo */
 	sc_fifo_out<DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> >
@@ -133,20 +136,27 @@ public:
 
 	/** Construct thread */
 	SC_CTOR(CmdArb_DDR4) : ddr4_pwr(nullptr), memSpec(nullptr),
-			ddr4(nullptr), dram(nullptr), refi_count(0),
-			ref_enq(0), allpre_cycle(numeric_limits<long>::min()),
-			ref_fini_cycle(numeric_limits<long>::min())
+			ddr4(nullptr), dram(nullptr),
+			cmd_ready_min(numeric_limits<long>::max()),
+			cmd_ready_stale(true), refi_count(0),
+			refi_init(0), ref_enq(0),
+			allpre_cycle(numeric_limits<long>::min()),
+			ref_fini_cycle(numeric_limits<long>::min()), rst(false),
+			rr_bank(0u),
+			last_cycle(0l), clk_period(SC_ZERO_TIME),
+			q_id(Quiescence::get().add_client())
 	{
 		unsigned int i;
 
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_lt);
 		sensitive << in_clk.pos();
 
-		SC_THREAD(thread_status);
+		SC_METHOD(method_status);
 		sensitive << in_clk.pos();
 
 		for (i = 0; i < DRAM_BANKS; i++) {
 			cmd_valid[i] = 0;
+			cmd_ready[i] = 0;
 		}
 	}
 
@@ -195,6 +205,17 @@ public:
 		s.power = ddr4_pwr->getPower().average_power;
 	}
 
+	/** Return the running command counters. Unlike get_stats(), this does
+	 * not compute the energy, hence it may be called mid-simulation.
+	 * @param bytes Number of bytes transferred so far.
+	 * @param acts Number of activate commands issued so far. */
+	void
+	get_counters(unsigned long &bytes, unsigned long &acts)
+	{
+		bytes = stats.bytes;
+		acts = stats.act_c;
+	}
+
 	/** Return the exact clock period for our RAM organisation.
 	 * @return The clock period for the active DRAM organisation. */
 	double
@@ -229,6 +250,72 @@ public:
 		 * value and assume the user knows what they're doing.
 		 */
 		refi_count = refc;
+		refi_init = refc;
+	}
+
+	/** Return the refresh state, for checkpointing.
+	 * @param refc Number of DRAM cycles since the last refresh interval
+	 * 	       elapsed.
+	 * @param pending Number of refreshes enqueued but not yet issued. */
+	void
+	get_refresh_state(unsigned long &refc, unsigned int &pending) const
+	{
+		refc = refi_count;
+		pending = ref_enq;
+	}
+
+	/** Restore the refresh state from a checkpoint.
+	 * @param refc Number of DRAM cycles since the last refresh interval
+	 * 	       elapsed.
+	 * @param pending Number of refreshes enqueued but not yet issued. */
+	void
+	set_refresh_state(unsigned long refc, unsigned int pending)
+	{
+		set_refresh_counter(refc);
+		ref_enq = pending;
+	}
+
+	/** Restore the power-on state of this command arbiter.
+	 *
+	 * Replaces the ramulator DRAM state and DRAMPower objects by fresh
+	 * instances, resets the refresh counter to its initialisation value
+	 * and clears all statistics. Must only be called while the
+	 * simulation is paused with all command FIFOs drained. The main thread
+	 * idles for one cycle to pick up the reset. */
+	void
+	reset(void)
+	{
+		unsigned int i;
+
+		ram_ctor();
+
+		delete dram;
+		dram = new DRAM<DDR4>(ddr4, DDR4::Level::Channel);
+
+		delete ddr4_pwr;
+		ddr4_pwr = new libDRAMPower(*memSpec, 0);
+
+		stats = cmdarb_stats();
+		for (i = 0; i < DRAM_BANKS; i++)
+			cmd_valid[i] = 0;
+		cmd_ready_stale = true;
+
+		refi_count = refi_init;
+		ref_enq = 0;
+		allpre_cycle = numeric_limits<long>::min();
+		ref_fini_cycle = numeric_limits<long>::min();
+		dst = RequestTarget();
+		rst = true;
+		last_cycle = 0l;
+	}
+
+	/** Set the DRAM clock period, required to translate cycles into
+	 * quiescence wake-up times.
+	 * @param p DRAM clock period. */
+	void
+	set_clk_period(const sc_time &p)
+	{
+		clk_period = p;
 	}
 
 private:
@@ -254,9 +341,23 @@ private:
 	 * completely issued */
 	bool cmd_valid[DRAM_BANKS];
 
+	/** Earliest cycle at which the next command of each valid cmd entry
+	 * passes its timing checks. */
+	long cmd_ready[DRAM_BANKS];
+
+	/** Minimum of cmd_ready over all valid cmd entries. */
+	long cmd_ready_min;
+
+	/** True iff cmd_ready must be recomputed. Any command issued to DRAM
+	 * can shift the timing constraints of all banks. */
+	bool cmd_ready_stale;
+
 	/** Refresh cycle counter */
 	long refi_count;
 
+	/** Initialisation value of the refresh cycle counter. */
+	long refi_init;
+
 	/** Number of refreshes enqueued */
 	unsigned int ref_enq;
 
@@ -269,6 +370,21 @@ private:
 	/** Cached RequestTarget. */
 	RequestTarget dst;
 
+	/** True iff a reset is pending for the main process. */
+	bool rst;
+
+	/** Bank pair to continue the round-robin search for commands from. */
+	unsigned int rr_bank;
+
+	/** Cycle counter value observed in the previous cycle. */
+	long last_cycle;
+
+	/** DRAM clock period. */
+	sc_time clk_period;
+
+	/** Quiescence client identifier. */
+	unsigned int q_id;
+
 	/** Construct various RAM model objects.
 	 *
 	 * Cannot be called in the constructor, because the initialisation
@@ -283,7 +399,8 @@ private:
 	{
 		if (ddr4 == nullptr) {
 			ddr4 = new DDR4(MC_DRAM_ORG, MC_DRAM_SPEED);
-			ddr4->set_channel_number(MC_DRAM_CHANS);
+			/* Each CmdArb models a single channel. */
+			ddr4->set_channel_number(1);
 			ddr4->set_rank_number(1);
 			dram = new DRAM<DDR4>(ddr4, DDR4::Level::Channel);
 		}
@@ -346,6 +463,7 @@ private:
 
 				cmd[i] = in_cmd_fifo[i]->get();
 				cmd_valid[i] = 1;
+				cmd_ready_stale = true;
 			}
 		}
 	}
@@ -426,27 +544,30 @@ private:
 	 *                 -1 if no viable candiate found.
 	 * @param last_rw Pointer to a boolean, used to flag that there is
 	 * 		  exactly one read/write command on the heads of the
-	 * 		  input FIFOs. */
+	 * 		  input FIFOs. Only valid if rw_bank is a valid
+	 * 		  candidate. */
 	void
 	cmd_best_candidates(unsigned int bank, int *ppre_bank, int *act_bank,
 			int *rw_bank, int *p_bank, bool *last_rw)
 	{
 		unsigned int i;
 		int int_bank; /* Intermediate result for previous bank */
-		DDR4::Command rml_cmd;
-		vector<int> addr;
 		int pre_dist[DRAM_BANKS];
 		int act_fifo_entries = -1;
 		unsigned int rw_count = 0;
+		long cycle = in_cycle.read();
+		bool pre_dist_valid = false;
 
 		*ppre_bank = -1;
 		*act_bank = -1;
 		*rw_bank = -1;
 		*p_bank = -1;
+		*last_rw = false;
 
-		int_bank = DRAM_BANKS - bank;
+		if (cmd_ready_min > cycle)
+			return;
 
-		precharge_distance(pre_dist);
+		int_bank = DRAM_BANKS - bank;
 
 		for (i = 0; i < DRAM_BANKS; i++) {
 			if (!cmd_valid[i])
@@ -455,7 +576,10 @@ private:
 			if (cmd[i].read || cmd[i].write)
 				rw_count++;
 
-			xlat_addr_ramulator(cmd[i], i, addr);
+			/* Only banks whose head passes its timing checks
+			 * in this cycle are candidates. */
+			if (cmd_ready[i] > cycle)
+				continue;
 
 			/* This if-statement is a bit opaque and awkwardly
 			 * styled, but it tests that:
@@ -464,7 +588,6 @@ private:
 			 *    command-type, (||) or the bank with this command
 			 *    is closest to the bank used for the previous
 			 *    command (round-robin)
-			 * 3) The command is schedulable in this cycle
 			 *
 			 * For 2) the construction with adding DRAM_BANKS
 			 * modulo DRAM_BANKS ensures that we always get a
@@ -475,52 +598,38 @@ private:
 			 * of unsigned subtract.
 			 */
 			if (cmd[i].pre_pre) {
-				if ((*ppre_bank < 0 ||
+				if (*ppre_bank < 0 ||
 				   ((i + int_bank) % DRAM_BANKS) <
-				   ((*ppre_bank + int_bank) % DRAM_BANKS)) &&
-				   dram->check(DDR4::Command::PRE, addr.data(),
-						   in_cycle.read()))
+				   ((*ppre_bank + int_bank) % DRAM_BANKS))
 					*ppre_bank = i;
 			} else if (cmd[i].act) {
-				if ((*act_bank < 0 ||
+				/* Peeking into the FIFOs is costly, only do so
+				 * when an activate is issuable. */
+				if (!pre_dist_valid) {
+					precharge_distance(pre_dist);
+					pre_dist_valid = true;
+				}
+
+				if (*act_bank < 0 ||
 				   (pre_dist[i] > act_fifo_entries ||
 				   ((i + int_bank) % DRAM_BANKS) <
-				   ((*act_bank + int_bank) % DRAM_BANKS))) &&
-				   dram->check(DDR4::Command::ACT, addr.data(),
-						   in_cycle.read())) {
+				   ((*act_bank + int_bank) % DRAM_BANKS))) {
 					*act_bank = i;
 					act_fifo_entries = pre_dist[i];
 				}
 
 			} else if ((cmd[i].read || cmd[i].write)) {
-
 				if(*rw_bank >= 0 &&
 				   ((i + int_bank) % DRAM_BANKS) >=
 				   ((*rw_bank + int_bank) % DRAM_BANKS))
 					continue;
 
 				/** @todo Prioritise based on bank bundles */
-				if (cmd[i].read) {
-					rml_cmd = cmd[i].pre_post ?
-							DDR4::Command::RDA :
-							DDR4::Command::RD;
-				} else {
-					rml_cmd = cmd[i].pre_post ?
-							DDR4::Command::WRA :
-							DDR4::Command::WR;
-				}
-
-				/*assert(dram->check_row_hit(rml_cmd,
-						addr.data()));*/
-
-				if (dram->check(rml_cmd, addr.data(), in_cycle.read()))
-					*rw_bank = i;
+				*rw_bank = i;
 			} else if (cmd[i].pre_post &&
 				  (*p_bank < 0 ||
 				  ((i + int_bank) % DRAM_BANKS) <
-				  ((*p_bank + int_bank) % DRAM_BANKS)) &&
-				  dram->check(DDR4::Command::PRE, addr.data(),
-						  in_cycle.read())) {
+				  ((*p_bank + int_bank) % DRAM_BANKS))) {
 				*p_bank = i;
 			}
 		}
@@ -588,11 +697,99 @@ private:
 		dst = d;
 	}
 
-	/** Main thread */
+	/** Determine the first cycle at which the head of a command FIFO can
+	 * be issued.
+	 * @param i Bank of the command FIFO.
+	 * @return Earliest cycle at which the next command for bank i passes
+	 * 	   its timing checks. */
+	long
+	cmd_next_cycle(unsigned int i)
+	{
+		DDR4::Command rml_cmd;
+		vector<int> addr;
+
+		xlat_addr_ramulator(cmd[i], i, addr);
+
+		if (cmd[i].pre_pre)
+			rml_cmd = DDR4::Command::PRE;
+		else if (cmd[i].act)
+			rml_cmd = DDR4::Command::ACT;
+		else if (cmd[i].read)
+			rml_cmd = cmd[i].pre_post ? DDR4::Command::RDA :
+						    DDR4::Command::RD;
+		else if (cmd[i].write)
+			rml_cmd = cmd[i].pre_post ? DDR4::Command::WRA :
+						    DDR4::Command::WR;
+		else
+			rml_cmd = DDR4::Command::PRE;
+
+		return dram->get_next(rml_cmd, addr.data());
+	}
+
+	/** Recompute the earliest issue cycle of all valid cmd entries. */
 	void
-	thread_lt(void)
+	update_cmd_ready(void)
+	{
+		unsigned int i;
+
+		cmd_ready_min = numeric_limits<long>::max();
+
+		for (i = 0; i < DRAM_BANKS; i++) {
+			if (!cmd_valid[i])
+				continue;
+
+			cmd_ready[i] = cmd_next_cycle(i);
+			cmd_ready_min = min(cmd_ready_min, cmd_ready[i]);
+		}
+
+		cmd_ready_stale = false;
+	}
+
+	/** Declare the quiescence state of the command arbiter.
+	 *
+	 * Nothing changes until the first of: a command FIFO head passing
+	 * its timing checks, a pending refresh becoming issuable, the next
+	 * refresh being enqueued, or the allpre/refresh status outputs
+	 * toggling.
+	 * @param active True iff a command was issued or the refresh queue
+	 * 		 changed in this cycle. */
+	void
+	quiesce(bool active)
+	{
+		Quiescence &q = Quiescence::get();
+		long cycle = in_cycle.read();
+		long wake;
+
+		if (active || in_cmdgen_busy.read() || cycle == allpre_cycle ||
+		    cycle == allpre_cycle + 1 || cycle == ref_fini_cycle) {
+			q.busy(q_id);
+			return;
+		}
+
+		wake = cycle + (ddr4->speed_entry.nREFI - refi_count);
+		wake = min(wake, cmd_ready_min);
+
+		if (ref_enq && fifo_heads_empty())
+			wake = min(wake, dram->get_next(DDR4::Command::REF,
+					ref_addr));
+
+		if (allpre_cycle > cycle)
+			wake = min(wake, allpre_cycle);
+
+		if (ref_fini_cycle > cycle)
+			wake = min(wake, ref_fini_cycle);
+
+		if (wake <= cycle + 1)
+			q.busy(q_id);
+		else
+			q.idle_until(q_id, sc_time_stamp() +
+					clk_period * double(wake - cycle));
+	}
+
+	/** Main process, evaluated on every clock edge. */
+	void
+	method_lt(void)
 	{
-		unsigned int bank = 0;
 		unsigned int i;
 
 		int ppre_bank;
@@ -601,176 +798,197 @@ private:
 		int p_bank;
 
 		bool last_rw;
-
-		if (ddr4 == nullptr)
-			ram_ctor();
+		bool active;
+		unsigned int ref_enq_prev;
 
 		vector<int> addr;
 		DDR4::Command rml_cmd;
 		Data::MemCommand::cmds drp_cmd;
 		DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> res;
 
-		out_ref_pending.write(0);
-
-		while (1) {
-			/* Ramulator APIs force us to write this sequentially
-			 *
-			 * The following rules apply:
-			 * - Read/write always has priority over act
-			 * - But use the ~75% available cmdbus space to perform
-			 *   activates as early as possible
-			 * - Drain a bank-pair of its reads/writes prior to
-			 *   processing the r/w of other banks
-			 * - Skip to the next available bank-pair as soon as an
-			 *   implicit or explicit precharge is received
-			 * - Round-robin through the banks.
-			 */
+		if (ddr4 == nullptr)
+			ram_ctor();
 
-			/* Gather top-of-fifo commands */
-			fetch_fifo_heads();
-
-			/* Pick a candidate in each category */
-			cmd_best_candidates(bank, &ppre_bank, &act_bank,
-					&rw_bank, &p_bank, &last_rw);
-
-			/* Issue, prioritised based on command type */
-			if (rw_bank >= 0) {
-				xlat_addr_ramulator(cmd[rw_bank], rw_bank,
-						addr);
-				if (cmd[rw_bank].read) {
-					rml_cmd = cmd[rw_bank].pre_post ?
-							DDR4::Command::RDA :
-							DDR4::Command::RD;
-					drp_cmd = cmd[rw_bank].pre_post ?
-							Data::MemCommand::RDA :
-							Data::MemCommand::RD;
-				} else {
-					rml_cmd = cmd[rw_bank].pre_post ?
-							DDR4::Command::WRA :
-							DDR4::Command::WR;
-					drp_cmd = cmd[rw_bank].pre_post ?
-							Data::MemCommand::WRA :
-							Data::MemCommand::WR;
-				}
+		if (rst) {
+			rst = false;
+			rr_bank = 0;
+			Quiescence::get().busy(q_id);
+			return;
+		}
 
+		active = true;
+		ref_enq_prev = ref_enq;
+
+		/* Ramulator APIs force us to write this sequentially
+		 *
+		 * The following rules apply:
+		 * - Read/write always has priority over act
+		 * - But use the ~75% available cmdbus space to perform
+		 *   activates as early as possible
+		 * - Drain a bank-pair of its reads/writes prior to
+		 *   processing the r/w of other banks
+		 * - Skip to the next available bank-pair as soon as an
+		 *   implicit or explicit precharge is received
+		 * - Round-robin through the banks.
+		 */
 
-				print_cmd("RW ",rw_bank, &cmd[rw_bank]);
-
-				/* Mask off bit 0 to prioritise on bank pairs */
-				bank = rw_bank & ~0x1;
-				cmd_valid[rw_bank] = 0;
-				dram->update(rml_cmd, addr.data(), in_cycle.read());
-				ddr4_pwr->doCommand(drp_cmd, rw_bank, in_cycle.read());
-
-				if (cmd[rw_bank].pre_post)
-					update_lid(cmd[rw_bank].target);
-
-				res.bank = rw_bank;
-				res.col = cmd[rw_bank].col;
-				res.row = cmd[rw_bank].row;
-				res.wordmask = cmd[rw_bank].wordmask;
-				res.write = cmd[rw_bank].write;
-				res.sp_offset = cmd[rw_bank].sp_offset;
-				res.cycle = in_cycle.read();
-				res.target = cmd[rw_bank].target;
-				for (i = 0; i < BUS_WIDTH; i++)
-					res.reg_offset[i] = cmd[rw_bank].reg_offset[i];
-
-				if (res.write) {
-					/* -2 to account for scratchpad delay */
-					res.cycle += ddr4->speed_entry.nCWL - 2;
-					if (last_rw && !in_cmdgen_busy.read())
-						stats.lda = res.cycle + 5;
-				} else {
-					res.cycle += ddr4->speed_entry.nCL;
-					if (last_rw && !in_cmdgen_busy.read())
-						stats.lda = res.cycle + 3;
-				}
-				out_dq_fifo.write(res);
-
-				stats.cas_c++;
-				for (i = 0; i < BUS_WIDTH; i++)
-					if (res.wordmask[i])
-						stats.bytes += 4;
-			} else if (ppre_bank >= 0) {
-				/* These come late and combined with act, better
-				 * prioritise them over act */
-				xlat_addr_ramulator(cmd[ppre_bank], ppre_bank,
-						addr);
-				rml_cmd = DDR4::Command::PRE;
-
-				print_cmd("PRE", ppre_bank, &cmd[ppre_bank]);
-
-				cmd[ppre_bank].pre_pre = 0;
-						/* Keep for ACT/CAS/pre_post */
-				dram->update(rml_cmd, addr.data(), in_cycle.read());
-				ddr4_pwr->doCommand(Data::MemCommand::PRE,
-						ppre_bank, in_cycle.read());
-				stats.pre_c++;
-				update_lid(cmd[ppre_bank].target);
-			} else if (act_bank >= 0) {
-				xlat_addr_ramulator(cmd[act_bank], act_bank,
-						addr);
-				rml_cmd = DDR4::Command::ACT;
-
-				print_cmd("ACT", act_bank, &cmd[act_bank]);
-
-				cmd[act_bank].act = 0; /* Keep for CAS/pre */
-				dram->update(rml_cmd, addr.data(), in_cycle.read());
-				ddr4_pwr->doCommand(Data::MemCommand::ACT,
-						act_bank, in_cycle.read());
-				stats.act_c++;
-			} else if (p_bank >= 0) {
-				xlat_addr_ramulator(cmd[p_bank], p_bank, addr);
-				rml_cmd = DDR4::Command::PRE;
-
-				print_cmd("PRE", p_bank, &cmd[p_bank]);
-
-				cmd_valid[p_bank] = 0;
-				dram->update(rml_cmd, addr.data(), in_cycle.read());
-				ddr4_pwr->doCommand(Data::MemCommand::PRE,
-						p_bank, in_cycle.read());
-				stats.pre_c++;
-				update_lid(cmd[p_bank].target);
-			} else if (ref_enq && fifo_heads_empty() &&
-					!in_cmdgen_busy.read()){
-				/* I can schedule a refresh */
-				if (refresh()) {
-					print_cmd("REF", -1, nullptr);
-					ref_enq--;
-				}
+		/* Gather top-of-fifo commands */
+		fetch_fifo_heads();
+
+		if (cmd_ready_stale)
+			update_cmd_ready();
+
+		/* Pick a candidate in each category */
+		cmd_best_candidates(rr_bank, &ppre_bank, &act_bank,
+				&rw_bank, &p_bank, &last_rw);
+
+		/* Issue, prioritised based on command type. A full DQ
+		 * reservation FIFO holds the command bus until DQ
+		 * catches up. */
+		if (rw_bank >= 0 && !out_dq_fifo->num_free()) {
+			active = true;
+		} else if (rw_bank >= 0) {
+			xlat_addr_ramulator(cmd[rw_bank], rw_bank,
+					addr);
+			if (cmd[rw_bank].read) {
+				rml_cmd = cmd[rw_bank].pre_post ?
+						DDR4::Command::RDA :
+						DDR4::Command::RD;
+				drp_cmd = cmd[rw_bank].pre_post ?
+						Data::MemCommand::RDA :
+						Data::MemCommand::RD;
+			} else {
+				rml_cmd = cmd[rw_bank].pre_post ?
+						DDR4::Command::WRA :
+						DDR4::Command::WR;
+				drp_cmd = cmd[rw_bank].pre_post ?
+						Data::MemCommand::WRA :
+						Data::MemCommand::WR;
 			}
 
-			/* Update refresh counter and enqueue refresh */
-			refi_count++;
-			if (refi_count >= ddr4->speed_entry.nREFI) {
-				refi_count %= ddr4->speed_entry.nREFI;
-				ref_enq++;
-				assert(ref_enq <= 8); /* Per DDR4 specs */
-			}
 
-			out_ref_pending.write(ref_enq > 0);
+			print_cmd("RW ",rw_bank, &cmd[rw_bank]);
+
+			/* Mask off bit 0 to prioritise on bank pairs */
+			rr_bank = rw_bank & ~0x1;
+			cmd_valid[rw_bank] = 0;
+			dram->update(rml_cmd, addr.data(), in_cycle.read());
+			ddr4_pwr->doCommand(drp_cmd, rw_bank, in_cycle.read());
+
+			if (cmd[rw_bank].pre_post)
+				update_lid(cmd[rw_bank].target);
+
+			res.bank = rw_bank;
+			res.col = cmd[rw_bank].col;
+			res.row = cmd[rw_bank].row;
+			res.wordmask = cmd[rw_bank].wordmask;
+			res.write = cmd[rw_bank].write;
+			res.sp_offset = cmd[rw_bank].sp_offset;
+			res.cycle = in_cycle.read();
+			res.target = cmd[rw_bank].target;
+			for (i = 0; i < BUS_WIDTH; i++)
+				res.reg_offset[i] = cmd[rw_bank].reg_offset[i];
+
+			if (res.write) {
+				/* -2 to account for scratchpad delay */
+				res.cycle += ddr4->speed_entry.nCWL - 2;
+				if (last_rw && !in_cmdgen_busy.read())
+					stats.lda = res.cycle + 5;
+			} else {
+				res.cycle += ddr4->speed_entry.nCL;
+				if (last_rw && !in_cmdgen_busy.read())
+					stats.lda = res.cycle + 3;
+			}
+			out_dq_fifo.nb_write(res);
+
+			stats.cas_c++;
+			for (i = 0; i < BUS_WIDTH; i++)
+				if (res.wordmask[i])
+					stats.bytes += 4;
+		} else if (ppre_bank >= 0) {
+			/* These come late and combined with act, better
+			 * prioritise them over act */
+			xlat_addr_ramulator(cmd[ppre_bank], ppre_bank,
+					addr);
+			rml_cmd = DDR4::Command::PRE;
+
+			print_cmd("PRE", ppre_bank, &cmd[ppre_bank]);
+
+			cmd[ppre_bank].pre_pre = 0;
+					/* Keep for ACT/CAS/pre_post */
+			dram->update(rml_cmd, addr.data(), in_cycle.read());
+			ddr4_pwr->doCommand(Data::MemCommand::PRE,
+					ppre_bank, in_cycle.read());
+			stats.pre_c++;
+			update_lid(cmd[ppre_bank].target);
+		} else if (act_bank >= 0) {
+			xlat_addr_ramulator(cmd[act_bank], act_bank,
+					addr);
+			rml_cmd = DDR4::Command::ACT;
+
+			print_cmd("ACT", act_bank, &cmd[act_bank]);
+
+			cmd[act_bank].act = 0; /* Keep for CAS/pre */
+			dram->update(rml_cmd, addr.data(), in_cycle.read());
+			ddr4_pwr->doCommand(Data::MemCommand::ACT,
+					act_bank, in_cycle.read());
+			stats.act_c++;
+		} else if (p_bank >= 0) {
+			xlat_addr_ramulator(cmd[p_bank], p_bank, addr);
+			rml_cmd = DDR4::Command::PRE;
+
+			print_cmd("PRE", p_bank, &cmd[p_bank]);
+
+			cmd_valid[p_bank] = 0;
+			dram->update(rml_cmd, addr.data(), in_cycle.read());
+			ddr4_pwr->doCommand(Data::MemCommand::PRE,
+					p_bank, in_cycle.read());
+			stats.pre_c++;
+			update_lid(cmd[p_bank].target);
+		} else if (ref_enq && fifo_heads_empty() &&
+				!in_cmdgen_busy.read()){
+			/* I can schedule a refresh */
+			if (refresh()) {
+				print_cmd("REF", -1, nullptr);
+				ref_enq--;
+			} else {
+				active = false;
+			}
+		} else {
+			active = false;
+		}
 
-			wait();
+		if (active)
+			cmd_ready_stale = true;
+
+		/* Update refresh counter and enqueue refresh. Clock
+		 * edges skipped by a GatedClock still count. */
+		refi_count += max(in_cycle.read() - last_cycle, 1l);
+		last_cycle = in_cycle.read();
+		if (refi_count >= ddr4->speed_entry.nREFI) {
+			refi_count %= ddr4->speed_entry.nREFI;
+			ref_enq++;
+			assert(ref_enq <= 8); /* Per DDR4 specs */
 		}
+
+		out_ref_pending.write(ref_enq > 0);
+
+		if (Quiescence::get().is_enabled())
+			quiesce(active || ref_enq != ref_enq_prev);
 	}
 
-	/** Thread updating status bits. */
+	/** Clocked process updating status bits. */
 	void
-	thread_status(void)
+	method_status(void)
 	{
-		while (true) {
-			if (in_cycle.read() == allpre_cycle) {
-				out_allpre.write(true);
-				out_done_dst.write(dst);
-			} else {
-				out_allpre.write(false);
-			}
-
-			out_ref.write(in_cycle.read() < ref_fini_cycle);
-
-			wait();
+		if (in_cycle.read() == allpre_cycle) {
+			out_allpre.write(true);
+			out_done_dst.write(dst);
+		} else {
+			out_allpre.write(false);
 		}
+
+		out_ref.write(in_cycle.read() < ref_fini_cycle);
 	}
 };
 
@@ -19,12 +19,15 @@
 #ifndef MC_CONTROL_CMDGEN_DDR4_H
 #define MC_CONTROL_CMDGEN_DDR4_H
 
+#include <cassert>
 #include <cstdint>
 #include <array>
 #include <systemc>
 #include <tlm>
 
 #include "util/constmath.h"
+#include "util/Quiescence.h"
+#include "util/RingChannel.h"
 #include "mc/model/burst_request.h"
 #include "mc/model/cmd_DDR.h"
 
@@ -33,6 +36,7 @@ using namespace sc_core;
 using namespace sc_dt;
 using namespace mc_model;
 using namespace tlm;
+using namespace simd_util;
 
 namespace mc_control {
 
@@ -57,6 +61,44 @@ private:
 
 	/** Currently active row for each bank. */
 	sc_uint<const_log2(DRAM_ROWS) + 1> bank_active_row[DRAM_BANKS];
+
+	/** Quiescence client identifier. */
+	unsigned int q_id;
+
+	/** State of the command generator. */
+	enum {
+		CMDGEN_ST_RESET = 0,
+		CMDGEN_ST_IDLE,
+		CMDGEN_ST_PUT
+	} state;
+
+	/** Commands generated for the current burst request, waiting to be
+	 * put into the FIFO of their bank. Precharges to other banks precede
+	 * the command for the request itself. */
+	cmd_DDR<BUS_WIDTH,THREADS> put_cmd[DRAM_BANKS];
+
+	/** Bank of each command in put_cmd. */
+	sc_uint<const_log2(DRAM_BANKS)> put_bank[DRAM_BANKS];
+
+	/** Number of valid entries in put_cmd. */
+	unsigned int put_count;
+
+	/** Index of the next entry in put_cmd to put. */
+	unsigned int put_idx;
+
+	/** Queue a command to be put into the FIFO of a bank.
+	 * @param bank Bank.
+	 * @param cmd Command. */
+	void
+	queue_put(sc_uint<const_log2(DRAM_BANKS)> bank,
+			const cmd_DDR<BUS_WIDTH,THREADS> &cmd)
+	{
+		assert(put_count < DRAM_BANKS);
+
+		put_bank[put_count] = bank;
+		put_cmd[put_count] = cmd;
+		put_count++;
+	}
 public:
 	/** DRAM clock, SDR */
 	sc_in<bool> in_clk{"in_clk"};
@@ -66,18 +108,19 @@ public:
 
 	/** One FIFO per bank - CAS/Precharge commands
 	 * @todo FIFO depth? */
-	sc_port<tlm_fifo_put_if<cmd_DDR<BUS_WIDTH,THREADS> > >
+	sc_port<RingChannel_out_if<cmd_DDR<BUS_WIDTH,THREADS> > >
 						out_fifo[DRAM_BANKS];
 
 	/** True iff processing the current stride or set of indexes */
 	sc_inout<bool> out_busy{"out_busy"};
 
 	/** Construct thread, initialise LUT values */
-	SC_CTOR(CmdGen_DDR4)
+	SC_CTOR(CmdGen_DDR4) : q_id(Quiescence::get().add_client()),
+			state(CMDGEN_ST_RESET), put_count(0u), put_idx(0u)
 	{
 		unsigned int i;
 
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_lt);
 		sensitive << in_clk.pos();
 
 		for (i = 0; i < DRAM_BANKS; i++)
@@ -93,7 +136,7 @@ public:
 	 * 				  off
 	 * Row : addr[31:17]
 	 */
-	void
+	static void
 	address_translate(sc_uint<32> addr,
 			sc_uint<const_log2(DRAM_BANKS)> &bank,
 			sc_uint<const_log2(DRAM_ROWS)> &row,
@@ -160,7 +203,7 @@ public:
 					next_bank = (bank + i) % DRAM_BANKS;
 					if (bank_active_row[next_bank] != bank_inactive()) {
 						rwp_pre.target = req.target;
-						out_fifo[next_bank]->put(rwp_pre);
+						queue_put(next_bank, rwp_pre);
 						bank_active_row[next_bank] = bank_inactive();
 					}
 
@@ -181,7 +224,7 @@ public:
 				/**
 				 * @todo Assignment to bank_active_row is
 				 * sequential, conflicts with the activate logic
-				 * in thread_lt if this were an HDL.
+				 * in method_lt if this were an HDL.
 				 */
 				bank_active_row[bank] = bank_inactive();
 
@@ -189,7 +232,7 @@ public:
 						bank_inactive()) {
 
 					rwp_pre.target = req.target;
-					out_fifo[bank ^ 0x1]->put(rwp_pre);
+					queue_put(bank ^ 0x1, rwp_pre);
 					bank_active_row[bank ^ 0x1] =
 							bank_inactive();
 				}
@@ -198,32 +241,54 @@ public:
 		}
 	}
 
-private:
-	/** Reset logic. */
+	/** Reset logic.
+	 *
+	 * Also invoked between simulations when reusing the memory controller,
+	 * with all banks precharged and the input FIFO drained. */
 	void
 	reset(void)
 	{
+		unsigned int i;
+
+		for (i = 0; i < DRAM_BANKS; i++)
+			bank_active_row[i] = bank_inactive();
+
 		out_busy.write(false);
 	}
 
-	/** Main thread */
+private:
+	/** Main process, evaluated on every clock edge.
+	 *
+	 * Translates one burst request per cycle. While waiting for a request
+	 * or for space in a bank FIFO, the process is sensitive to the FIFO
+	 * event instead, picking up where a blocking read or put would have
+	 * continued. */
 	void
-	thread_lt(void)
+	method_lt(void)
 	{
 		unsigned int i;
 
 		burst_request<BUS_WIDTH,THREADS> req;
-		sc_uint<const_log2(DRAM_BANKS)> bank = 0;
-		sc_uint<const_log2(DRAM_ROWS)> row = 0;
-		sc_uint<const_log2(DRAM_COLS)> col = 0;
+		sc_uint<const_log2(DRAM_BANKS)> bank;
+		sc_uint<const_log2(DRAM_ROWS)> row;
+		sc_uint<const_log2(DRAM_COLS)> col;
 
 		cmd_DDR<BUS_WIDTH,THREADS> rwp;
 
-		reset();
+		switch (state) {
+		case CMDGEN_ST_RESET:
+			reset();
+			state = CMDGEN_ST_IDLE;
+			/* fall-through */
+		case CMDGEN_ST_IDLE:
+			/* Nothing changes until a request arrives. */
+			if (!in_req_fifo.nb_read(req)) {
+				Quiescence::get().idle(q_id);
+				next_trigger(in_req_fifo.data_written_event());
+				return;
+			}
 
-		while (true) {
-			/* blocking */
-			in_req_fifo.read(req);
+			Quiescence::get().busy(q_id);
 
 			out_busy.write(!req.last);
 
@@ -247,11 +312,26 @@ private:
 			for (i = 0; i < BUS_WIDTH; i++)
 				rwp.reg_offset[i] = req.reg_offset[i];
 
+			put_count = 0u;
+			put_idx = 0u;
 			precharge(req, &rwp);
+			queue_put(bank, rwp);
+
+			state = CMDGEN_ST_PUT;
+			/* fall-through */
+		case CMDGEN_ST_PUT:
+			for (; put_idx < put_count; put_idx++) {
+				if (!out_fifo[put_bank[put_idx]]->nb_can_put()) {
+					next_trigger(out_fifo[put_bank[put_idx]]->
+							data_read_event());
+					return;
+				}
 
-			out_fifo[bank]->put(rwp);
+				out_fifo[put_bank[put_idx]]->put(put_cmd[put_idx]);
+			}
 
-			wait();
+			state = CMDGEN_ST_IDLE;
+			break;
 		}
 	}
 };
@@ -25,12 +25,15 @@
 #include "model/Register.h"
 #include "mc/model/DQ_reservation.h"
 #include "mc/control/Storage.h"
+#include "util/Checkpoint.h"
+#include "util/Quiescence.h"
 
 using namespace sc_core;
 using namespace sc_dt;
 using namespace std;
 using namespace mc_model;
 using namespace simd_model;
+using namespace simd_util;
 
 namespace mc_control {
 
@@ -86,11 +89,66 @@ public:
 	/** Construct thread */
 	SC_CTOR(DQ)
 	{
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_lt);
 		sensitive << in_clk.pos();
 	}
 
 
+	/** Restore the idle state of the DQ scheduler between simulations.
+	 * Storage contents are retained. */
+	void
+	reset(void)
+	{
+		state = DQ_IDLE;
+		beat = 0;
+		pipeline[0].valid = 0;
+		pipeline[1].valid = 0;
+	}
+
+	/** Set the DRAM clock period, required to translate cycles into
+	 * quiescence wake-up times.
+	 * @param p DRAM clock period. */
+	void
+	set_clk_period(const sc_time &p)
+	{
+		clk_period = p;
+	}
+
+	/** Enable or disable timing-only mode of the storage back-end.
+	 * @param t True iff DRAM data should be discarded. */
+	void
+	set_timing_only(bool t)
+	{
+		store.set_timing_only(t);
+	}
+
+	/** Return whether the storage back-end is in timing-only mode.
+	 * @return True iff DRAM data is discarded. */
+	bool
+	is_timing_only(void) const
+	{
+		return store.is_timing_only();
+	}
+
+	/** Write the storage contents to a checkpoint.
+	 * @param w Checkpoint writer.
+	 * @param idx Index of this channel. */
+	void
+	checkpoint(CheckpointWriter &w, uint32_t idx)
+	{
+		store.checkpoint(w, idx);
+	}
+
+	/** Restore the storage contents from a checkpoint.
+	 * @param r Checkpoint reader.
+	 * @param idx Index of this channel.
+	 * @return False iff the checkpoint holds no valid DRAM image. */
+	bool
+	restore(const CheckpointReader &r, uint32_t idx)
+	{
+		return store.restore(r, idx);
+	}
+
 	/** Initialise a word in the storage back-end for testing and debugging
 	 * purposes ("upload data")
 	 * @param bank Bank.
@@ -110,6 +168,17 @@ public:
 					<< dq_word << ") " << val << endl;
 	}
 
+	/** Return the storage for a full DRAM row, for bulk uploads and
+	 * downloads.
+	 * @param bank Bank
+	 * @param row Row
+	 * @return Pointer to the DRAM_COLS * (BUS_WIDTH / 8) words of this row. */
+	uint32_t *
+	debug_store_row(sc_uint<const_log2(DRAM_BANKS)> bank, sc_uint<20> row)
+	{
+		return store.get_row(bank, row);
+	}
+
 	/** Read a word back from storage for debugging/testing purposes
 	 * (validation)
 	 * @param bank Bank
@@ -155,9 +224,21 @@ private:
 	 * scratchpad request. */
 	unsigned int beat = 0;
 
+	/** Reservation currently being processed. */
+	DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> DQ_res;
+
+	/** Scratchpad address of the current beat. */
+	unsigned int sp_addr = 0;
+
 	/** Storage back-end */
 	Storage<BUS_WIDTH, DRAM_BANKS, DRAM_COLS, DRAM_ROWS> store;
 
+	/** DRAM clock period. */
+	sc_time clk_period = SC_ZERO_TIME;
+
+	/** Quiescence client identifier. */
+	unsigned int q_id = Quiescence::get().add_client();
+
 	/** Perform a read-operation from DRAM and write-back to scratchpad or
 	 * the register file.
 	 *
@@ -169,15 +250,18 @@ private:
 	do_read(DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> &DQ_res,
 			unsigned int wordmask, unsigned int sp_addr)
 	{
-		sc_uint<32> data[BUS_WIDTH/4];
 		unsigned int i, j;
+		uint32_t m;
 		sc_bv<BUS_WIDTH/4> mask;
+		const uint32_t *row;
 
-		for (i = 0; i < BUS_WIDTH/4; i++) {
+		for (i = 0; i < BUS_WIDTH/4; i++)
 			out_data[i].write(0);
-			mask[i] = Log_0;
-		}
 
+		/* Look the row up once for the whole beat. */
+		row = store.peek_row(DQ_res.bank, DQ_res.row);
+
+		m = 0;
 		j = (sp_addr >> 2) & ((BUS_WIDTH/4)-1);
 		/* This rotation is superfluous for register writes, but let's
 		 * roll with it. */
@@ -188,17 +272,18 @@ private:
 			/* Shift this word into data
 			 * HW will have a series of muxes to
 			 * do this efficiently without mul */
-			out_data[j].write(store.get_word(DQ_res.bank, DQ_res.row,
+			out_data[j].write(row ? row[store.word_offset(
 					DQ_res.col | ((i & 0x2) >> 1) |
-					(beat << 1),
-					i & 0x1));
-			mask[j] = Log_1;
+					(beat << 1), i & 0x1)] : 0);
+			m |= 1u << j;
 
 			out_vreg_idx_w[j].write(DQ_res.reg_offset[i + (beat * BUS_WIDTH/4)]);
 
 			j = (j + 1) % (BUS_WIDTH/4);
 		}
 
+		mask.set_word(0, m);
+
 		out_sp_addr.write(sp_addr);
 		out_write.write(true);
 		out_enable.write(true);
@@ -244,15 +329,17 @@ private:
 		unsigned int lane;
 		unsigned int intf;
 		unsigned int data;
-		sc_bv<BUS_WIDTH/4> wm = 0;
-
-		wm.b_not();
+		uint32_t wm = ~0u;
+		uint32_t *row;
 
 		if (pipe.res.target.type == TARGET_SP)
 			/* sp_addr of previous cycle. */
 			j = (pipe.sp_addr >> 2) & ((BUS_WIDTH/4)-1);
 		else
-			wm = in_reg_mask_w.read();
+			wm = in_reg_mask_w.read().to_uint();
+
+		/* Look the row up once for the whole beat. */
+		row = store.write_row(pipe.res.bank, pipe.res.row);
 
 		intf = int(pipe.res.target.get_interface());
 
@@ -269,91 +356,112 @@ private:
 
 			data = in_data[intf][lane].read();
 
-			if (wm[i])
-				store.set_word(pipe.res.bank, pipe.res.row,
-					pipe.res.col | ((i & 0x2) >> 1) |
-					(pipe.beat << 1), i & 0x1, data);
+			if (row && (wm & (1u << i)))
+				row[store.word_offset(pipe.res.col |
+					((i & 0x2) >> 1) | (pipe.beat << 1),
+					i & 0x1)] = data;
 		}
 	}
 
-	/** Main thread */
+	/** Declare the quiescence state of the DQ scheduler.
+	 *
+	 * Idle while no reservation is pending, or until the data phase of
+	 * the pending reservation starts. Busy whenever data is in flight or
+	 * the data path outputs are about to drop. */
 	void
-	thread_lt(void)
+	quiesce(void)
 	{
-		unsigned int sp_addr;
-		DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> DQ_res;
+		Quiescence &q = Quiescence::get();
+
+		if (out_enable.read() || out_write.read() ||
+		    pipeline[0].valid || pipeline[1].valid) {
+			q.busy(q_id);
+			return;
+		}
+
+		if (state == DQ_IDLE && beat == 0)
+			q.idle(q_id);
+		else if (state == DQ_WAIT)
+			q.idle_until(q_id, sc_time_stamp() + clk_period *
+					double(DQ_res.cycle - in_cycle.read()));
+		else
+			q.busy(q_id);
+	}
 
+	/** Main clocked process, evaluated on every DRAM clock edge. */
+	void
+	method_lt(void)
+	{
 		unsigned int wordmask, words;
 
-		while (true) {
-			out_enable.write(false);
+		out_enable.write(false);
 
-			if (pipeline[1].valid) {
-				do_write_storage(pipeline[1]);
-			}
+		if (pipeline[1].valid) {
+			do_write_storage(pipeline[1]);
+		}
 
-			pipeline[1] = pipeline[0];
-			pipeline[0].valid = 0;
-
-			switch (state) {
-			case DQ_IDLE:
-				out_write.write(0);
-				beat = 0;
-				if (!in_fifo_DQ_res.num_available())
-					break;
-
-				in_fifo_DQ_res.read(DQ_res);
-
-				assert (DQ_res.target.type == TARGET_SP ||
-					DQ_res.sp_offset == 0);
-
-				sp_addr = DQ_res.sp_offset;
-				state = DQ_WAIT;
-
-				/* fall-through */
-			case DQ_WAIT:
-				assert(DQ_res.cycle >= in_cycle.read());
-				if (DQ_res.cycle != in_cycle.read())
-					break;
-
-				state = DQ_BUSY;
-				/* fall-through */
-			case DQ_BUSY:
-				wordmask = DQ_res.wordmask.to_uint();
-				wordmask >>= (beat * (BUS_WIDTH/4));
-				wordmask &= (BUS_WIDTH - 1);
-				words = __builtin_popcount(wordmask);
-
-				if (wordmask) {
-					if (DQ_res.write) {
-						/* This data will return in
-						 * two cycles */
-						do_write_req_sp(DQ_res,wordmask,
-								sp_addr);
-						pipeline[0].valid = 1;
-						pipeline[0].beat = beat;
-						pipeline[0].res = DQ_res;
-						pipeline[0].sp_addr = sp_addr;
-						pipeline[0].wordmask = wordmask;
-					} else {
-						do_read(DQ_res, wordmask,
-								sp_addr);
-					}
-				}
+		pipeline[1] = pipeline[0];
+		pipeline[0].valid = 0;
+
+		switch (state) {
+		case DQ_IDLE:
+			out_write.write(0);
+			beat = 0;
+			if (!in_fifo_DQ_res.num_available())
+				break;
 
-				if (beat == 3)
-					state = DQ_IDLE;
+			in_fifo_DQ_res.nb_read(DQ_res);
 
-				if (DQ_res.target.type == TARGET_SP)
-					sp_addr += (words << 2);
+			assert (DQ_res.target.type == TARGET_SP ||
+				DQ_res.sp_offset == 0);
 
-				beat++;
+			sp_addr = DQ_res.sp_offset;
+			state = DQ_WAIT;
 
+			/* fall-through */
+		case DQ_WAIT:
+			assert(DQ_res.cycle >= in_cycle.read());
+			if (DQ_res.cycle != in_cycle.read())
 				break;
+
+			state = DQ_BUSY;
+			/* fall-through */
+		case DQ_BUSY:
+			wordmask = DQ_res.wordmask.to_uint();
+			wordmask >>= (beat * (BUS_WIDTH/4));
+			wordmask &= (BUS_WIDTH - 1);
+			words = __builtin_popcount(wordmask);
+
+			if (wordmask) {
+				if (DQ_res.write) {
+					/* This data will return in
+					 * two cycles */
+					do_write_req_sp(DQ_res,wordmask,
+							sp_addr);
+					pipeline[0].valid = 1;
+					pipeline[0].beat = beat;
+					pipeline[0].res = DQ_res;
+					pipeline[0].sp_addr = sp_addr;
+					pipeline[0].wordmask = wordmask;
+				} else {
+					do_read(DQ_res, wordmask,
+							sp_addr);
+				}
 			}
 
-			wait();
+			if (beat == 3)
+				state = DQ_IDLE;
+
+			if (DQ_res.target.type == TARGET_SP)
+				sp_addr += (words << 2);
+
+			beat++;
+
+			break;
 		}
+
+		if (Quiescence::get().is_enabled())
+			quiesce();
 	}
 };
 
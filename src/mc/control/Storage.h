@@ -19,13 +19,20 @@
 #ifndef MC_CONTROL_STORAGE_H
 #define MC_CONTROL_STORAGE_H
 
+#include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
 
-#include "mc/model/storage_ll_elem.h"
+#include <systemc>
+
+#include "util/Checkpoint.h"
 #include "util/constmath.h"
 
 using namespace std;
-using namespace mc_model;
+using namespace sc_dt;
+using namespace simd_util;
 
 namespace mc_control {
 
@@ -34,8 +41,23 @@ namespace mc_control {
  * Ramulator does not seem to provide any storage solution alongside its
  * timing model, so we have to implement our own. We're dealing with a multi-GB
  * address space, which is more than often required during simulation.
- * As a trade-off between speed and storage, we implement a hash-table and
- * allocate the memory on demand at page granularity.
+ *
+ * Rows are allocated on demand and looked up through a two-level page table
+ * indexed by (bank, row): a directory of DRAM_BANKS * (DRAM_ROWS / LEAF_ROWS)
+ * entries, each pointing to a leaf of LEAF_ROWS row pointers. Lookup is two
+ * dependent loads regardless of the number of rows touched. Row data is carved
+ * out of anonymous mmap()ed slabs of SLAB_ROWS rows, which are zero-filled by
+ * the kernel, aligned to 2MiB and advised to be backed by transparent huge
+ * pages.
+ *
+ * For timing-only simulation (WCET sweeps, mc, mcIdx) data values are
+ * irrelevant. In timing-only mode, writes are discarded and reads return 0
+ * without allocating any rows.
+ *
+ * Checkpoints store the (bank, row) pair of every allocated row, followed by the
+ * row data. Upon restore, rows are pointed straight into the mapped checkpoint
+ * rather than copied, such that restoring a multi-GB image is instantaneous and
+ * rows are only paged in when accessed.
  */
 template <unsigned int BUS_WIDTH, unsigned int DRAM_BANKS,
 	unsigned int DRAM_COLS, unsigned int DRAM_ROWS>
@@ -43,96 +65,300 @@ template <unsigned int BUS_WIDTH, unsigned int DRAM_BANKS,
 class Storage
 {
 private:
-	/** Hashmap for the storage linked lists. */
-	storage_ll_elem *hashmap[DRAM_BANKS * 128];
+	/** Number of 32-bit words in a row.
+	 * BUS_WIDTH is expressed in n 32-bit words per burst, corresponds
+	 * with n/2 bytes per cycle, or n/8 words. */
+	static constexpr unsigned int ROW_WORDS = DRAM_COLS * (BUS_WIDTH / 8);
 
-	/** Allocate memory for a row of words.
-	 * @return A 32-bit integer array holding data for a full row. */
-	uint32_t *alloc_row()
+	/** Number of rows covered by a single page table leaf. */
+	static constexpr unsigned int LEAF_ROWS =
+			DRAM_ROWS < 1024 ? DRAM_ROWS : 1024;
+
+	/** Number of page table directory entries. */
+	static constexpr unsigned int DIR_ENTRIES =
+			DRAM_BANKS * (DRAM_ROWS / LEAF_ROWS);
+
+	/** Size and alignment of a transparent huge page. */
+	static constexpr size_t HUGE_PAGE = 2ul << 20;
+
+	/** Number of rows allocated at once, filling at least one huge
+	 * page. */
+	static constexpr unsigned int SLAB_ROWS =
+		ROW_WORDS * sizeof(uint32_t) >= HUGE_PAGE ? 1 :
+		HUGE_PAGE / (ROW_WORDS * sizeof(uint32_t));
+
+	/** Size of a slab in bytes, a multiple of HUGE_PAGE. */
+	static constexpr size_t SLAB_BYTES =
+		((SLAB_ROWS * ROW_WORDS * sizeof(uint32_t) + HUGE_PAGE - 1) /
+		HUGE_PAGE) * HUGE_PAGE;
+
+	/** Page table directory. Each entry points to a leaf of LEAF_ROWS row
+	 * pointers, or nullptr if no rows in its range were touched. */
+	uint32_t **dir[DIR_ENTRIES];
+
+	/** Slabs allocated for row storage. */
+	vector<uint32_t *> slabs;
+
+	/** Number of rows left in the last slab. */
+	unsigned int slab_free;
+
+	/** True iff data is discarded. */
+	bool timing_only;
+
+	/** Allocate a zero-filled slab of SLAB_BYTES, aligned to HUGE_PAGE.
+	 *
+	 * Transparent huge pages only back aligned 2MiB ranges. mmap() only
+	 * guarantees page alignment, hence a slab is carved out of a larger
+	 * mapping and the unaligned head and tail are returned.
+	 * @return Pointer to the slab. */
+	uint32_t *alloc_slab()
 	{
-		unsigned int size;
+		char *map;
+		char *slab;
+		size_t head;
+
+		map = (char *) mmap(NULL, SLAB_BYTES + HUGE_PAGE,
+				PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map == MAP_FAILED)
+			throw bad_alloc();
 
-		/* BUS_WIDTH is expressed in n 32-bit words per burst,
-		 * corresponds with n/2 bytes per cycle, or n/8 words. */
-		size = DRAM_COLS * (BUS_WIDTH / 8);
+		slab = (char *) (((uintptr_t) map + HUGE_PAGE - 1) &
+				~(HUGE_PAGE - 1));
+		head = slab - map;
 
-		return new uint32_t[size];
+		if (head)
+			munmap(map, head);
+		munmap(slab + SLAB_BYTES, HUGE_PAGE - head);
+
+#ifdef MADV_HUGEPAGE
+		madvise(slab, SLAB_BYTES, MADV_HUGEPAGE);
+#endif
+
+		return (uint32_t *) slab;
 	}
 
-	/** Add a new row to the desired hashmap ll.
-	 * @param hashmap_entry The index in the hashmap to store this elem
-	 * @param elem Linked list element to insert */
-	void insert(unsigned int hashmap_entry, storage_ll_elem *elem)
+	/** Allocate memory for a row of words.
+	 * @return A zero-initialised 32-bit integer array holding data for a
+	 * 	   full row. */
+	uint32_t *alloc_row()
 	{
-		if (hashmap[hashmap_entry] == nullptr)
-			hashmap[hashmap_entry] = elem;
-		else
-			hashmap[hashmap_entry]->insert_before(elem);
+		if (slab_free == 0) {
+			slabs.push_back(alloc_slab());
+			slab_free = SLAB_ROWS;
+		}
+
+		slab_free--;
+		return &slabs.back()[(SLAB_ROWS - slab_free - 1) * ROW_WORDS];
 	}
 
-	/** For given (bank, row), find the right ll element, allocate and
-	 * insert if it doesn't exist already.
+	/** For given (bank, row), find the row data, allocate it if it doesn't
+	 * exist already.
 	 * @param bank Bank
 	 * @param row Row
-	 * @return The linked list element referred to by the address */
-	storage_ll_elem *ensure_row(sc_uint<const_log2(DRAM_BANKS)> bank,
+	 * @return Pointer to the data of the row referred to by the address */
+	uint32_t *ensure_row(sc_uint<const_log2(DRAM_BANKS)> bank,
 			sc_uint<20> row)
 	{
-		unsigned int hashmap_entry;
-		storage_ll_elem *head, *ptr;
-		uint32_t *data;
+		unsigned int d;
+		unsigned int r;
+		uint32_t **leaf;
 
-		hashmap_entry = ((row & 0x7f) << const_log2(DRAM_BANKS)) | bank;
+		assert(row < DRAM_ROWS);
 
-		head = hashmap[hashmap_entry];
-		if (head != nullptr) {
-			ptr = head;
-			do {
-				if (ptr->get_row() == row)
-					return ptr;
+		d = (bank * (DRAM_ROWS / LEAF_ROWS)) + (row / LEAF_ROWS);
+		r = row % LEAF_ROWS;
 
-				ptr = ptr->get_next();
-			} while (ptr != head);
+		leaf = dir[d];
+		if (leaf == nullptr) {
+			leaf = new uint32_t *[LEAF_ROWS]();
+			dir[d] = leaf;
 		}
 
-		/* Not found */
-		data = alloc_row();
-
-		/* Each bank gets its own set of rows, so no need to encode
-		 * the bank in the storage_ll_elem */
-		ptr = new storage_ll_elem(row, data);
-		insert(hashmap_entry, ptr);
+		if (leaf[r] == nullptr)
+			leaf[r] = alloc_row();
 
-		return ptr;
+		return leaf[r];
 	}
 
 public:
 	/** Constructor */
-	Storage()
+	Storage() : slab_free(0), timing_only(false)
 	{
 		unsigned int i;
 
-		for (i = 0; i < DRAM_BANKS * 128; i++)
-			hashmap[i] = nullptr;
+		for (i = 0; i < DIR_ENTRIES; i++)
+			dir[i] = nullptr;
 	}
 
+	/** Storage owns its slabs, no copying. */
+	Storage(const Storage &) = delete;
+
 	~Storage()
 	{
 		unsigned int i;
-		storage_ll_elem *elem, *next;
-
-		for (i = 0; i < DRAM_BANKS * 128; i++) {
-			if (hashmap[i]) {
-				next = hashmap[i];
-				do {
-					elem = next;
-					next = elem->get_next();
-					elem->unlink();
-					delete elem;
-				} while (elem != next);
+
+		for (i = 0; i < DIR_ENTRIES; i++)
+			delete[] dir[i];
+
+		for (uint32_t *slab : slabs)
+			munmap(slab, SLAB_BYTES);
+	}
+
+	/** Enable or disable timing-only mode.
+	 * @param t True iff writes should be discarded and reads return 0. */
+	void set_timing_only(bool t)
+	{
+		timing_only = t;
+	}
+
+	/** Return whether this storage is in timing-only mode.
+	 * @return True iff data is discarded. */
+	bool is_timing_only(void) const
+	{
+		return timing_only;
+	}
+
+	/** Write all allocated rows to a checkpoint.
+	 * @param w Checkpoint writer.
+	 * @param idx Index of this storage among the checkpoint's DRAM
+	 * 	      sections. */
+	void checkpoint(CheckpointWriter &w, uint32_t idx)
+	{
+		vector<uint32_t> rows;
+		unsigned int d, r;
+
+		for (d = 0; d < DIR_ENTRIES; d++) {
+			if (dir[d] == nullptr)
+				continue;
+
+			for (r = 0; r < LEAF_ROWS; r++) {
+				if (dir[d][r] == nullptr)
+					continue;
+
+				rows.push_back(d / (DRAM_ROWS / LEAF_ROWS));
+				rows.push_back((d % (DRAM_ROWS / LEAF_ROWS)) *
+						LEAF_ROWS + r);
+			}
+		}
+
+		w.add_section(CKPT_DRAM_ROWS, idx, rows.data(),
+				rows.size() * sizeof(uint32_t));
+
+		w.begin_section(CKPT_DRAM_DATA, idx);
+		for (d = 0; d < DIR_ENTRIES; d++) {
+			if (dir[d] == nullptr)
+				continue;
+
+			for (r = 0; r < LEAF_ROWS; r++) {
+				if (dir[d][r] != nullptr)
+					w.write(dir[d][r],
+						ROW_WORDS * sizeof(uint32_t));
 			}
+		}
+	}
+
+	/** Restore rows from a checkpoint.
+	 *
+	 * Rows stored in the checkpoint replace the contents of the same rows
+	 * in this storage. The checkpoint must outlive this storage.
+	 * @param r Checkpoint reader.
+	 * @param idx Index of this storage among the checkpoint's DRAM
+	 * 	      sections.
+	 * @return False iff the DRAM sections are missing or inconsistent. */
+	bool restore(const CheckpointReader &r, uint32_t idx)
+	{
+		const uint32_t *rows;
+		uint32_t *data;
+		size_t rows_bytes;
+		size_t data_bytes;
+		size_t i, n;
+		unsigned int d;
+
+		rows = (const uint32_t *) r.section(CKPT_DRAM_ROWS, idx,
+				rows_bytes);
+		data = (uint32_t *) r.section(CKPT_DRAM_DATA, idx, data_bytes);
+		n = rows_bytes / (2 * sizeof(uint32_t));
+
+		if (rows_bytes && (!rows || !data))
+			return false;
+
+		if (data_bytes != n * ROW_WORDS * sizeof(uint32_t))
+			return false;
+
+		for (i = 0; i < n; i++) {
+			if (rows[2*i] >= DRAM_BANKS || rows[2*i+1] >= DRAM_ROWS)
+				return false;
 
+			d = (rows[2*i] * (DRAM_ROWS / LEAF_ROWS)) +
+					(rows[2*i+1] / LEAF_ROWS);
+			if (dir[d] == nullptr)
+				dir[d] = new uint32_t *[LEAF_ROWS]();
+
+			dir[d][rows[2*i+1] % LEAF_ROWS] = &data[i * ROW_WORDS];
 		}
+
+		return true;
+	}
+
+	/** Return the data of a full row, allocating it if needed.
+	 * Words are laid out by offset (col * (BUS_WIDTH / 8)) | dq_word.
+	 * @param bank Bank.
+	 * @param row Row.
+	 * @return Pointer to the data of this row. */
+	uint32_t *get_row(sc_uint<const_log2(DRAM_BANKS)> bank,
+			sc_uint<20> row)
+	{
+		return ensure_row(bank, row);
+	}
+
+	/** Return the data of a full row for reading, without allocating it.
+	 * Rows that were never written, and all rows in timing-only mode,
+	 * read as zero.
+	 * @param bank Bank.
+	 * @param row Row.
+	 * @return Pointer to the data of this row, nullptr if it reads as
+	 * 	   zero. */
+	const uint32_t *peek_row(sc_uint<const_log2(DRAM_BANKS)> bank,
+			sc_uint<20> row) const
+	{
+		uint32_t **leaf;
+		unsigned int d;
+
+		if (timing_only)
+			return nullptr;
+
+		assert(row < DRAM_ROWS);
+
+		d = (bank * (DRAM_ROWS / LEAF_ROWS)) + (row / LEAF_ROWS);
+		leaf = dir[d];
+		if (leaf == nullptr)
+			return nullptr;
+
+		return leaf[row % LEAF_ROWS];
+	}
+
+	/** Return the data of a full row for writing, allocating it if needed.
+	 * @param bank Bank.
+	 * @param row Row.
+	 * @return Pointer to the data of this row, nullptr in timing-only
+	 * 	   mode. */
+	uint32_t *write_row(sc_uint<const_log2(DRAM_BANKS)> bank,
+			sc_uint<20> row)
+	{
+		if (timing_only)
+			return nullptr;
+
+		return ensure_row(bank, row);
+	}
+
+	/** Return the offset of a word within its row.
+	 * @param col Column.
+	 * @param dq_word 32-bit subset index on the data lines.
+	 * @return Offset of this word in the data of its row. */
+	static uint32_t word_offset(unsigned int col, unsigned int dq_word)
+	{
+		return (col * (BUS_WIDTH / 8)) | dq_word;
 	}
 
 	/** Return the word stored at a given address.
@@ -145,13 +371,14 @@ public:
 			sc_uint<20> row, sc_uint<20> col, sc_uint<10> dq_word)
 	{
 		uint32_t offset;
-		storage_ll_elem *elem;
 
-		elem = ensure_row(bank, row);
+		if (timing_only)
+			return 0;
+
 		/* Translate col to offset... */
-		offset = (col * (BUS_WIDTH / 8)) | dq_word;
+		offset = word_offset(col, dq_word);
 
-		return elem->get_data(offset);
+		return ensure_row(bank, row)[offset];
 	}
 
 	/** Store a word at a given address.
@@ -165,13 +392,14 @@ public:
 			uint32_t val)
 	{
 		uint32_t offset;
-		storage_ll_elem *elem;
 
-		elem = ensure_row(bank, row);
+		if (timing_only)
+			return;
+
 		/* Translate col to offset... */
-		offset = (col * (BUS_WIDTH / 8)) | dq_word;
+		offset = word_offset(col, dq_word);
 
-		elem->set_data(offset, val);
+		ensure_row(bank, row)[offset] = val;
 	}
 };
 
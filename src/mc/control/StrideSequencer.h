@@ -26,85 +26,58 @@
 #include "model/Register.h"
 #include "model/stride_descriptor.h"
 #include "mc/model/burst_request.h"
+#include "mc/model/dram_channel.h"
+#include "mc/control/StrideIterator.h"
 #include "util/debug_output.h"
 #include "util/defaults.h"
 #include "util/sched_opts.h"
+#include "util/Quiescence.h"
 
 using namespace sc_core;
 using namespace sc_dt;
 using namespace mc_model;
 using namespace simd_model;
 using namespace std;
+using namespace simd_util;
 
 namespace mc_control {
 
 /**
  * Convert a large DRAM request (1D/2D strides or iterative indexed) to a stream
  * of DRAM commands.
+ * With multiple DRAM channels, the stream of burst requests is split into one
+ * stream per channel. Addresses are translated to channel-local addresses.
  * @image html mc/StrideSequencer.png
  * @param BUS_WIDTH Number of 32-bit words in a burst.
+ * @param CHANS Number of DRAM channels.
  * @todo This component should really be called FrontEnd, as it also contains
  * 	 the IndexIterator submodule code.
  */
 template <unsigned int BUS_WIDTH,
-	unsigned int THREADS = COMPUTE_THREADS, unsigned int LANES = COMPUTE_FPUS>
+	unsigned int THREADS = COMPUTE_THREADS, unsigned int LANES = COMPUTE_FPUS,
+	unsigned int CHANS = MC_DRAM_CHANS>
 class StrideSequencer : public sc_module
 {
 private:
-	/** Look-up table for increment values for small periods, such that
-	 * no more than a single overflow occurs. */
-	unsigned int increment_lut[BUS_WIDTH];
-
-	/** Another lookup table for small period "line" increments. */
-	unsigned int line_increment_lut[BUS_WIDTH];
-
-	/** Phase of each word-lane wrt period. */
-	sc_uint<22> phase[BUS_WIDTH];
-
-	/** Period number we're in */
-	sc_int<32> line[BUS_WIDTH];
+	/** Address generation datapath for strided requests. */
+	StrideIterator<BUS_WIDTH,THREADS> iter;
 
 	/** Current descriptor register. */
 	stride_descriptor desc;
 
-	/** Address iterator, runs from in_addr to end_addr. */
-	sc_uint<32> global_addr;
-
-	/** Local address iterator, runs from dst_offset. Provides indexes
-	 * (offsets in a given buffer) for CAM transfers. */
-	sc_uint<32> local_idx;
-
-	/** in_addr + (in_period * in_period_count). */
-	sc_uint<32> end_addr;
-
-	/** When the period is much larger than the word count, we can skip over
-	 * regions that will contain just zeroes. skip contains the minimum
-	 * size of such a region, aligned to BUS_WIDTH words. Can be negative
-	 * -BUS_WIDTH if skips shouldn't occur
-	 * (e.g. when period - words < BUS_WIDTH). */
-	int skip;
-
-	/** In some special cases, we can skip over one full line extra. Cache
-	 * the sum to reduce critical path length. */
-	unsigned int skip_bw;
-
-	/** This value will help determine which the special cases are for which
-	 * we can skip over skip_bw words rather than just skip. */
-	unsigned int skip_rest;
-
-	/** The base increment of line on every cycle, 0 for any period larger
-	 * than BUS_WIDTH. */
-	unsigned int line_increment;
-
-	/** Scratchpad address increment when advancing to the next period. */
-	unsigned int sp_line_addr_increment;
-
 	/** First cycle of execution for the current request. */
 	unsigned long cycle_start;
 
 	/** Last cycle this request is executing. */
 	unsigned long cycle_end;
 
+	/** Burst request held back per channel until the address of the next
+	 * request for the same channel is known. */
+	burst_request<BUS_WIDTH,THREADS> chan_req[CHANS];
+
+	/** True iff chan_req holds a request for given channel. */
+	bool chan_req_valid[CHANS];
+
 	/** State of the command generator.
 	 *
 	 * The front-end is designed as a state machine, with init, run, drain
@@ -118,6 +91,16 @@ private:
 		CMDGEN_ST_WAIT_ALLPRE
 	} state = CMDGEN_ST_IDLE;
 
+	/** True iff a reset is pending for the main thread. */
+	bool rst;
+
+	/** True iff WSS_STOP_DRAM_FINI should pause rather than stop the
+	 * simulation. */
+	bool pause_fini;
+
+	/** Quiescence client identifier. */
+	unsigned int q_id;
+
 public:
 	/** DRAM clock, SDR. */
 	sc_in<bool> in_clk{"in_clk"};
@@ -132,8 +115,12 @@ public:
 	/** Is a refresh in progress or pending? */
 	sc_in<bool> in_ref_pending{"in_ref_pending"};
 
-	/** Generated burst-sized requests. */
-	sc_fifo_out<burst_request<BUS_WIDTH,THREADS> > out_req_fifo{"out_req_fifo"};
+	/** Generated burst-sized requests, per DRAM channel. */
+	sc_fifo_out<burst_request<BUS_WIDTH,THREADS> > out_req_fifo[CHANS];
+
+	/** DRAM channels that received burst requests for the most recent
+	 * descriptor. Only driven if CHANS > 1. */
+	sc_inout<sc_bv<CHANS> > out_chans{"out_chans"};
 
 	/** Ready to accept next descriptor. */
 	sc_inout<bool> out_done{"out_done"};
@@ -164,197 +151,52 @@ public:
 	/** Ticket number that's ready to pop. */
 	sc_in<sc_uint<4> > in_ticket_pop{"in_ticket_pop"};
 
-	/** Construct thread, initialise LUT values. */
-	SC_CTOR(StrideSequencer) : skip(0), skip_bw(0), skip_rest(0),
-			cycle_start(0ul), cycle_end(0ul)
-	{
-		unsigned int i;
-		SC_THREAD(thread_lt);
-		sensitive << in_clk.pos();
-
-		increment_lut[0] = 0;
-		for (i = 1; i < BUS_WIDTH; i++) {
-			increment_lut[i] = BUS_WIDTH % i;
-			line_increment_lut[i] = (BUS_WIDTH - 1) / i;
-		}
-	}
-
-private:
-	/** Modulo operation (mod desc.period) for situations in which
-	 * increment is guaranteed to only overflow cur_phase once.
-	 * @param cur_phase Phase of this word line.
-	 * @param increment Value to increment the current phase with.
-	 * @param overflew Pointer to a bool where the overflow bit can be
-	 * 		   stored.
-	 * @return The new phase value.
-	 */
-	sc_uint<22>
-	single_overflow_modulo(sc_uint<22> cur_phase, sc_uint<22> increment,
-			bool *overflew = nullptr)
-	{
-		sc_uint<22> out = cur_phase + increment;
-		if (out >= desc.period) {
-			if (overflew != nullptr)
-				*overflew = true;
-			out -= desc.period;
-		} else {
-			if (overflew != nullptr)
-				*overflew = false;
-		}
-
-		return out;
-	}
-
-	/** For given word lane, determine whether this word needs to be
-	 * transferred
-	 * @param lane Word lane
-	 * @return True iff this word must be read, false otherwise. */
-	bool
-	word_mask_select(unsigned int lane)
-	{
-		sc_uint<32> addr;
-
-		addr = global_addr | (lane << 2);
-
-		if (phase[lane] < desc.words && end_addr > addr &&
-				desc.addr <= addr)
-			return true;
-
-		return false;
-	}
-
-	/** When the phase exceeds the number of words, increment global_address
-	 * such that we skip over all addresses that generate a word mask of 0.
-	 * @param phase Phase value for the last word lane.
-	 * @return Number of words the global address should be incremented
-	 * with. */
-	sc_uint<22>
-	address_increment(sc_uint<22> phase)
+	/** Construct thread. */
+	SC_CTOR(StrideSequencer) : cycle_start(0ul), cycle_end(0ul),
+			rst(false), pause_fini(false),
+			q_id(Quiescence::get().add_client())
 	{
-		if (phase < (desc.words - 1) || desc.period < BUS_WIDTH)
-			return BUS_WIDTH;
-
-		if (phase < skip_rest)
-			return skip_bw + BUS_WIDTH;
-
-		return skip + BUS_WIDTH;
-	}
+		unsigned int c;
 
-	/** For given address increment, find the accompanying phase increment.
-	 * When the period is small, look up the right value in the LUT,
-	 * otherwise perform a single overflow modulo to bound the phase
-	 * increment to period.
-	 * @param addr_increment The calculated address increment.
-	 * @return Number of words the phase for each lane should be incremented
-	 * with. */
-	sc_uint<22>
-	phase_increment(sc_uint<22> addr_increment)
-	{
-		if (desc.period < BUS_WIDTH)
-			return increment_lut[desc.period];
+		for (c = 0; c < CHANS; c++)
+			chan_req_valid[c] = false;
 
-		return single_overflow_modulo(0, addr_increment);
+		SC_THREAD(thread_lt);
+		sensitive << in_clk.pos();
 	}
 
-	/** Check preconditions of the stride descriptor.
+	/** Pause instead of stop the simulation upon WSS_STOP_DRAM_FINI.
 	 *
-	 * Since these errors tend to be user errors, throw an exception when
-	 * any precondition is violated.
-	 * @param d Stride descriptor to validate. */
+	 * A paused simulation can be resumed with sc_start() after resetting
+	 * the memory controller, permitting many simulations in a single
+	 * process.
+	 * @param p True iff sc_pause() should be used rather than sc_stop(). */
 	void
-	validate_sd(stride_descriptor &d)
+	set_pause_fini(bool p)
 	{
-		if (d.period == 0)
-			throw invalid_argument("Period must be larger than 0.");
-
-		switch (d.dst.type) {
-		case TARGET_REG:
-			if (!is_pot(d.dst_period))
-				throw invalid_argument("Destination period must be "
-					"power-of-two when targeting (vector) register file");
-			break;
-		case TARGET_SP:
-			if (d.words != d.dst_period && d.period < d.words + BUS_WIDTH)
-				throw invalid_argument("Non-contiguous writes to scratchpad "
-					"period n+1 of at least " + to_string(BUS_WIDTH) + " words.");
-			break;
-		default:
-			break;
-		}
-		return;
+		pause_fini = p;
 	}
 
-	/** Given a descriptor in the "global" descriptor "desc", initialise
-	 * the internal values used for iterators or to break long paths. */
+	/** Restore the power-on state of the sequencer.
+	 *
+	 * Must only be called while the simulation is paused in the idle state.
+	 * The main thread idles for one cycle to pick up the reset, after
+	 * which it behaves as it did in the first cycle of simulation. */
 	void
-	init_request_regs(void)
+	reset(void)
 	{
-		unsigned int i;
-		unsigned int word;
-		unsigned int it;
-		int l;
-		int addr_diff;
-
-		try {
-			validate_sd(desc);
-		} catch (invalid_argument &e) {
-			cerr << e.what() << endl;
-			throw;
-		}
+		unsigned int c;
 
-		skip = desc.period - (desc.words + (BUS_WIDTH - 1));
-		skip_rest = (skip & (BUS_WIDTH-1)) + desc.words - 1;
-
-		skip &= ~(BUS_WIDTH-1);
-		skip_bw = skip + BUS_WIDTH;
-
-		/** @todo I don't think we'd want a multiplier here in a
-		 * real arch. Can we re-use the mul of the compute unit
-		 * connected to this DRAM controller? */
-		end_addr = desc.addr +
-		    ((desc.words + (desc.period * (desc.period_count - 1))) << 2);
-		global_addr = desc.addr & ~((BUS_WIDTH << 2) - 1);
-		addr_diff = global_addr - desc.addr;
-		local_idx = desc.dst_offset + (addr_diff >> 2);
-
-		/* Round-up division. We negate l two lines down. For
-		 * desc.period >= BUS_WIDTH, l should always represent 0 or -1.
-		 * We probably don't need a full divider for this, we can get
-		 * away with the much used single-modulo-divider and a LUT.
-		 * If not, move division to the compute resource in a real
-		 * implementation. */
-		l = ((-addr_diff >> 2) + (desc.period.to_int() - 1))
-				/ desc.period.to_int();
-		l = desc.dst_off_y - l;
-
-		if (desc.period < BUS_WIDTH)
-			line_increment = line_increment_lut[desc.period];
-		else
-			line_increment = 0;
-
-		if (desc.dst.type == TARGET_SP && desc.dst_period >= desc.words)
-			sp_line_addr_increment = (desc.dst_period - desc.words) << 2;
-		else
-			sp_line_addr_increment = 0;
-
-		/** @todo Likewise, a real modulo is way too expensive. A
-		 * hardware implementation would use a small LUT and a
-		 * single-overflow-modulo for initialising the line and phase
-		 * values. */
-		word = (desc.addr >> 2) & (BUS_WIDTH - 1);
-		it = (desc.period - word) % desc.period;
-		for (i = 0; i < BUS_WIDTH; i++) {
-			phase[i] = it;
-			line[i] = l;
-
-			it = (it + 1);
-			if ((it % desc.period) != it) {
-				l++;
-				it = it % desc.period;
-			}
-		}
+		for (c = 0; c < CHANS; c++)
+			chan_req_valid[c] = false;
+
+		state = CMDGEN_ST_IDLE;
+		cycle_start = 0ul;
+		cycle_end = 0ul;
+		rst = true;
 	}
 
+private:
 	/** Debug: print the time a stride request took to finish to stdout.
 	 * @param sd Stride descriptor to print
 	 * @param cycles Number of cycles, calculated from the cycles_end
@@ -366,44 +208,74 @@ private:
 			cout << sd << " " << cycles << " cycles" << endl;
 	}
 
-	/** Translate a StrideSequencer lane ID to a register offset ID.
-	 * @param t Register type (CAM or regular VGPR)
-	 * @param i Index of StrideSequencer lane
-	 * @return Register offset ID. */
-	inline reg_offset_t<THREADS>
-	regIdx(req_dest_type_t t, unsigned int i)
+	/** Forward the target register from the stride descriptor onto the
+	 * designated output signal. */
+	void
+	processTargetReg(void)
+	{
+		out_dst_reg.write(desc.getTargetReg());
+	}
+
+	/** Return whether all burst request FIFOs are drained.
+	 * @return True iff no burst requests are waiting in any channel. */
+	bool
+	req_fifos_empty(void)
 	{
-		unsigned int phase_shift;
-		unsigned int phase_mask;
-		unsigned int p;
-		unsigned int lane;
-		unsigned int row;
-
-		if (t == TARGET_CAM) {
-			return reg_offset_t<THREADS>(local_idx + i);
-		} else {
-			phase_shift = int(desc.idx_transform);
-			phase_mask = (1 << int(desc.idx_transform)) - 1;
-			p = phase[i] + desc.dst_off_x;
-
-			/* dst_period guaranteed power-of-two. */
-			lane = (line[i] * desc.dst_period) | (p >> phase_shift);
-			row = p & phase_mask;
-
-			return reg_offset_t<THREADS>(lane, row);
+		unsigned int c;
+
+		for (c = 0; c < CHANS; c++) {
+			if (out_req_fifo[c].num_free() != MC_BURSTREQ_FIFO_DEPTH)
+				return false;
 		}
+
+		return true;
 	}
 
-	/** Forward the target register from the stride descriptor onto the
-	 * designated output signal. */
+	/** Send a burst request to the channel storing its address.
+	 *
+	 * With multiple channels, a request is held back until the next
+	 * request for the same channel is generated, as the precharge policy
+	 * relies on the next address in the stream of its own channel. The
+	 * last request of a descriptor flushes the held requests of all
+	 * channels.
+	 * @param req Burst request, addressed with global DRAM addresses. */
 	void
-	processTargetReg(void)
+	push_req(burst_request<BUS_WIDTH,THREADS> &req)
 	{
-		AbstractRegister *reg;
+		unsigned int c;
+		sc_bv<CHANS> chans = 0;
+
+		if (CHANS == 1) {
+			out_req_fifo[0].write(req);
+			return;
+		}
+
+		c = dram_chan<CHANS>(req.addr);
+		if (chan_req_valid[c]) {
+			chan_req[c].addr_next = dram_chan_addr<CHANS>(req.addr);
+			chan_req[c].last = false;
+			out_req_fifo[c].write(chan_req[c]);
+		}
+
+		chan_req[c] = req;
+		chan_req[c].addr = dram_chan_addr<CHANS>(req.addr);
+		chan_req_valid[c] = true;
 
-		reg = desc.getTargetReg();
-		out_dst_reg.write(*reg);
-		delete reg;
+		if (!req.last)
+			return;
+
+		for (c = 0; c < CHANS; c++) {
+			if (!chan_req_valid[c])
+				continue;
+
+			chan_req[c].addr_next = 0xffffffff;
+			chan_req[c].last = true;
+			out_req_fifo[c].write(chan_req[c]);
+			chan_req_valid[c] = false;
+			chans[c] = Log_1;
+		}
+
+		out_chans.write(chans);
 	}
 
 	/** Main thread */
@@ -411,19 +283,29 @@ private:
 	thread_lt(void)
 	{
 		unsigned int i;
-		sc_uint<22> ph_inc;
-		sc_uint<22> addr_inc;
 		burst_request<BUS_WIDTH,THREADS> req;
-		unsigned int words;
 
-		bool overflew;
 		stride_descriptor d;
 		sc_uint<32> addr;
 		idx_t<THREADS> idx;
+		unsigned int prev_state;
 
 		while (true) {
+			if (rst) {
+				rst = false;
+				req = burst_request<BUS_WIDTH,THREADS>();
+				Quiescence::get().busy(q_id);
+				wait();
+				continue;
+			}
+
+			/* Dropping out_done changes an output, which counts as
+			 * a state transition for quiescence purposes. */
+			prev_state = state;
+			if (out_done.read())
+				prev_state = CMDGEN_ST_FETCH;
+
 			out_done.write(0);
-			words = 0;
 
 			switch (state) {
 			case CMDGEN_ST_IDLE:
@@ -438,12 +320,15 @@ private:
 					in_trigger.read();
 
 				if (!in_desc_fifo.num_available()) {
-					if (out_req_fifo.num_free() == MC_BURSTREQ_FIFO_DEPTH) {
+					if (req_fifos_empty()) {
 						state = CMDGEN_ST_IDLE;
 						out_done.write(1);
 
 						if (in_sched_opts.read()[WSS_STOP_DRAM_FINI]) {
-							sc_stop();
+							if (pause_fini)
+								sc_pause();
+							else
+								sc_stop();
 						}
 					}
 
@@ -477,7 +362,7 @@ private:
 					if (desc.getTargetType() != TARGET_SP) {
 						processTargetReg();
 					}
-					init_request_regs();
+					iter.init(desc);
 				} else {
 					state = CMDGEN_ST_RUNNING_IDXIT;
 					req.pre_pol = PRECHARGE_ALAP;
@@ -496,54 +381,10 @@ private:
 				}
 				break;
 			case CMDGEN_ST_RUNNING_STRIDE:
-				for (i = 0; i < BUS_WIDTH; i++) {
-					req.wordmask[i] = word_mask_select(i);
-					if (req.wordmask[i]) {
-						words++;
-						req.reg_offset[i] =
-							regIdx(desc.getTargetType(), i);
-					}
-				}
-
-				addr_inc = address_increment(phase[BUS_WIDTH - 1]);
-				ph_inc = phase_increment(addr_inc);
-
-				for (i = 0; i < BUS_WIDTH; i++) {
-					line[i] += line_increment;
-					phase[i] = single_overflow_modulo(
-							phase[i], ph_inc,
-							&overflew);
-					if (overflew || ph_inc == 0)
-						line[i]++;
-				}
-
-				req.addr = global_addr;
-				req.write = desc.write;
-				req.target = desc.dst;
-				if (req.target.type == TARGET_SP) {
-					req.sp_offset = desc.dst_offset;
-					desc.dst_offset += (words << 2);
-					/* Overflew contains value of last
-					 * iteration in the previous for-loop.*/
-					if ((overflew || ph_inc == 0) &&
-							line[BUS_WIDTH - 1] > 0)
-						desc.dst_offset +=
-							sp_line_addr_increment;
-				}
-
-				global_addr += (addr_inc << 2);
-				local_idx += addr_inc;
-
-				if (global_addr >= end_addr) {
-					req.addr_next = 0xffffffff;
-					req.last = true;
-					out_req_fifo.write(req);
+				if (iter.next(req))
 					state = CMDGEN_ST_WAIT_ALLPRE;
-				} else {
-					req.addr_next = global_addr;
-					req.last = false;
-					out_req_fifo.write(req);
-				}
+
+				push_req(req);
 				break;
 			case CMDGEN_ST_RUNNING_IDXIT:
 				out_idx_push_trigger.write(false);
@@ -567,13 +408,13 @@ private:
 					if (idx.dummy_last) {
 						req.addr_next = 0xffffffff;
 						req.last = true;
-						out_req_fifo.write(req);
+						push_req(req);
 						state = CMDGEN_ST_WAIT_ALLPRE;
 					} else {
 						addr = desc.addr + (idx.dram_off << 2);
 						req.addr_next = addr & (~((BUS_WIDTH << 2)-1));
 						req.last = false;
-						out_req_fifo.write(req);
+						push_req(req);
 					}
 				}
 				/* Else we don't commit yet, re-process same
@@ -590,6 +431,14 @@ private:
 				break;
 			}
 
+			/* Waiting for a trigger or for all banks to precharge
+			 * is only ended by an input changing. */
+			if (state == prev_state && (state == CMDGEN_ST_IDLE ||
+			    state == CMDGEN_ST_WAIT_ALLPRE))
+				Quiescence::get().idle(q_id);
+			else
+				Quiescence::get().busy(q_id);
+
 			wait();
 		}
 	}
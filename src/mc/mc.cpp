@@ -18,6 +18,7 @@
 
 #include <systemc>
 #include <list>
+#include <cstdlib>
 
 #include <ramulator/DDR4.h>
 
@@ -65,12 +66,20 @@ public:
 	sc_inout<sc_uint<4> > out_ticket_pop{"out_ticket_pop"};
 
 	/** Construct test thread */
-	SC_CTOR(Test_mc)
+	SC_CTOR(Test_mc) : rst(false)
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
 	}
 
+	/** Re-issue the trigger and scheduling options after a memory
+	 * controller reset. Only valid while the simulation is paused. */
+	void
+	reset(void)
+	{
+		rst = true;
+	}
+
 	/** Enqueue a stride descriptor on the in-fifo.
 	 * @param desc stride_descriptor to enqueue.*/
 	void
@@ -80,22 +89,35 @@ public:
 	}
 
 private:
+	/** True iff a reset is pending for the main thread. */
+	bool rst;
+
 	/** Main thread */
 	void
 	thread_lt(void)
 	{
 		sc_bv<WSS_SENTINEL> sched_opts;
 
-		sched_opts = 0;
-		sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
+		while (1) {
+			sched_opts = 0;
+			sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
+
+			out_trigger.write(1);
+			out_sched_opts.write(sched_opts);
+			out_ticket_pop.write(0);
+			wait();
 
-		out_trigger.write(1);
-		out_sched_opts.write(sched_opts);
-		out_ticket_pop.write(0);
-		wait();
+			while (!rst) {
+				if (in_mc_done_dst.num_available())
+					in_mc_done_dst.read();
 
-		while (1) {
-			if (in_mc_done_dst.num_available())
+				wait();
+			}
+
+			/* Idle for the cycle in which the memory controller
+			 * picks up the reset. */
+			rst = false;
+			while (in_mc_done_dst.num_available())
 				in_mc_done_dst.read();
 
 			wait();
@@ -111,17 +133,26 @@ using namespace ramulator;
 
 static int sweep_alignment = false;
 
+/** True iff all alignments are simulated in a single SystemC session,
+ * resetting the memory controller in between. Otherwise a process is forked
+ * per alignment. */
+static bool reuse_sim = true;
+
+/** Number of alignments to sweep, 0 for all of them. */
+static unsigned int sweep_count = 0;
+
 /* SystemC: Full system */
 static sc_clock *clk;
 
 static Test_mc test("test");
 static mc_control::StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS> sseq("sseq");
 static Backend<MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS,MC_BUS_WIDTH,COMPUTE_THREADS> mc("mc");
-static sp_control::Scratchpad<0,MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,1024> sp("sp");
+static sp_control::Scratchpad<MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,1024> sp("sp");
 
 /* StrideSequencer -> CmdGen */
 static sc_fifo<stride_descriptor> desc_fifo;
-static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > req_fifo(MC_BURSTREQ_FIFO_DEPTH);
+static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > *req_fifo[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_DRAM_CHANS> > strseq_chans;
 static sc_signal<bool> dangle_strseq_done;
 static sc_fifo<bool> strseq_trigger(2);
 static sc_signal<RequestTarget> strseq_dst;
@@ -133,17 +164,17 @@ static sc_fifo<RequestTarget> mc_done_dst;
 static sc_signal<bool> mc_allpre;
 static sc_signal<AbstractRegister> sseq_vreg_reg_w;
 static sc_signal<bool> mc_enable;
-static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_BUS_WIDTH/4];
+static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
-static sc_signal<sc_uint<32> > mc_out_data[MC_BUS_WIDTH/4];
+static sc_signal<sc_uint<32> > mc_out_data[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 static sc_signal<bool> mc_write;
-static sc_signal<sc_uint<18> > mc_sp_addr;
+static sc_signal<sc_uint<18> > mc_sp_addr[MC_DRAM_CHANS];
 static sc_signal<sc_uint<2> > mc_sp_words;
 static sc_signal<long> mc_cycle;
 static sc_signal<bool> dangle_mc_ref;
 
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w;
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w;
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w[MC_DRAM_CHANS];
 static sc_signal<sc_uint<32> > sp_data_mc[SP_BUS_WIDTH];
 
 static sc_signal<bool> dangle_sseq_idx_push_trigger;
@@ -151,19 +182,19 @@ static sc_fifo<idx_t<COMPUTE_THREADS> > dangle_sseq_idx;
 
 static sc_fifo<stride_descriptor> dangle_sp_desc_fifo;
 static sc_fifo<bool> dangle_sp_trigger(2);
-static sc_fifo<sc_uint<1> > dangle_sp_wg_done;
+static sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > dangle_sp_wg_done;
 static sc_signal<bool> dangle_sp_rf_enable;
 static sc_signal<bool> dangle_sp_rf_write;
 static sc_signal<AbstractRegister> dangle_sp_rf_reg;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_sp_rf_mask;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_in_sp_rf_mask;
 static sc_signal<reg_offset_t<COMPUTE_THREADS> > dangle_sp_rf_idx[SP_BUS_WIDTH];
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_BUS_WIDTH/4)];
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_DRAM_CHANS*MC_BUS_WIDTH/4)];
 #endif
 static sc_signal<sc_uint<32> > dangle_regfile_store_data[SP_BUS_WIDTH];
 
-static sc_signal<sc_uint<32> > dangle_data_mc[2][SP_BUS_WIDTH];
+static sc_signal<sc_uint<32> > dangle_data_mc[IF_SENTINEL - 1][SP_BUS_WIDTH];
 
 /** Wire up the design. */
 void
@@ -187,7 +218,7 @@ elaborate()
 	sseq.in_desc_fifo(desc_fifo);
 	sseq.in_ref_pending(ref_pending);
 	sseq.in_trigger(strseq_trigger);
-	sseq.out_req_fifo(req_fifo);
+	sseq.out_chans(strseq_chans);
 	sseq.out_done(dangle_strseq_done);
 	sseq.in_DQ_allpre(mc_allpre);
 	sseq.out_dst(strseq_dst);
@@ -199,22 +230,30 @@ elaborate()
 	sseq.in_ticket_pop(test_ticket_pop);
 
 	mc.in_clk(*clk);
-	mc.in_req_fifo(req_fifo);
+	mc.in_chans(strseq_chans);
 	mc.out_ref_pending(ref_pending);
 	mc.out_allpre(mc_allpre);
 	mc.out_ref(dangle_mc_ref);
-	mc.in_mask_w(mc_imask_w);
-	mc.out_sp_addr(mc_sp_addr);
 	mc.out_enable(mc_enable);
 	mc.out_write(mc_write);
-	mc.out_mask_w(mc_mask_w);
 	mc.out_done_dst(mc_done_dst);
 	mc.out_cycle(mc_cycle);
-	for (unsigned int i = 0; i < 4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		req_fifo[i] = new sc_fifo<burst_request<MC_BUS_WIDTH,
+				COMPUTE_THREADS> >(MC_BURSTREQ_FIFO_DEPTH);
+		sseq.out_req_fifo[i](*req_fifo[i]);
+		mc.in_req_fifo[i](*req_fifo[i]);
+
+		mc.in_mask_w[i](mc_imask_w[i]);
+		mc.out_sp_addr[i](mc_sp_addr[i]);
+		mc.out_mask_w[i](mc_mask_w[i]);
+	}
+
+	for (unsigned int i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		mc.out_data[i](mc_out_data[i]);
 		mc.in_data[IF_SP_WG0][i](sp_data_mc[i]);
-		mc.in_data[IF_SP_WG1][i](dangle_data_mc[0][i]);
-		mc.in_data[IF_RF][i](dangle_data_mc[1][i]);
+		for (unsigned int j = IF_SP_WG0 + 1; j < IF_SENTINEL; j++)
+			mc.in_data[j][i](dangle_data_mc[j - 1][i]);
 		mc.out_vreg_idx_w[i](mc_vreg_idx_w[i]);
 	}
 
@@ -232,10 +271,13 @@ elaborate()
 	sp.in_dram_enable(mc_enable);
 	sp.in_dram_dst(strseq_dst);
 	sp.in_dram_write(mc_write);
-	sp.in_dram_addr(mc_sp_addr);
-	sp.in_dram_mask(mc_mask_w);
 
-	for (i = 0; i < MC_BUS_WIDTH/4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		sp.in_dram_addr[i](mc_sp_addr[i]);
+		sp.in_dram_mask[i](mc_mask_w[i]);
+	}
+
+	for (i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		sp.out_data[i](sp_data_mc[i]);
 		sp.in_dram_data[i](mc_out_data[i]);
 	}
@@ -245,9 +287,9 @@ elaborate()
 		sp.in_rf_data[i](dangle_regfile_store_data[i]);
 	}
 
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	for (i = 0; i < SP_BUS_WIDTH - (MC_BUS_WIDTH/4); i++)
-		sp.out_data[(MC_BUS_WIDTH/4)+i](sp_out_data[i]);
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	for (i = 0; i < SP_BUS_WIDTH - (MC_DRAM_CHANS*MC_BUS_WIDTH/4); i++)
+		sp.out_data[(MC_DRAM_CHANS*MC_BUS_WIDTH/4)+i](sp_out_data[i]);
 #endif
 	sp.elaborate();
 }
@@ -287,6 +329,17 @@ do_sim(list<stride_descriptor *> descs, cmdarb_stats *stats)
 	}
 }
 
+/** Restore the memory controller and test driver to their power-on state, such
+ * that the next do_sim() call behaves as if run in a fresh process. Only valid
+ * after do_sim() returned. */
+void
+reset_sim(void)
+{
+	mc.reset();
+	sseq.reset();
+	test.reset();
+}
+
 /** Document the parameters accepted by this binary.
  * @param Program name binary name used to invoke this program. */
 void
@@ -304,6 +357,10 @@ help(char *program_name)
 	cout << "\t-p:\t\tOutput (CmdArb) summary." << endl;
 	cout << "\t-S:\t\tSweep DRAM address over all possible alignments."
 			<< endl;
+	cout << "\t-F:\t\tFork a process per alignment, rather than resetting"
+			<< endl;
+	cout << "\t\t\tthe memory controller between alignments." << endl;
+	cout << "\t-n [count]:\tSweep only the first [count] alignments." << endl;
 	cout << std::endl;
 	cout << "[fmt]: <addr>,<words>,<period>,<period_count>,"
 			"<sp_offset>,<write>" << std::endl;
@@ -323,7 +380,7 @@ parse_parameters(int argc, char* argv[], list<stride_descriptor *> *descs)
 	stride_descriptor *desc;
 
 	/* Take stride patterns from the command line */
-	while ( (c = getopt(argc, argv, "s:f:tpn:S")) != -1) {
+	while ( (c = getopt(argc, argv, "s:f:tpn:SF")) != -1) {
 		switch (c) {
 		case 's':
 			desc = stride_descriptor::from_csv_string(optarg);
@@ -357,6 +414,12 @@ parse_parameters(int argc, char* argv[], list<stride_descriptor *> *descs)
 		case 'S':
 			sweep_alignment = true;
 			break;
+		case 'F':
+			reuse_sim = false;
+			break;
+		case 'n':
+			sweep_count = strtoul(optarg, nullptr, 0);
+			break;
 		default:
 			help(argv[0]);
 			exit(1);
@@ -386,18 +449,31 @@ sc_main(int argc, char* argv[])
 	/* MC_DRAM_COLS * 2 for number of words, * 2 for interleaved banks */
 	if (sweep_alignment)
 		i_max = MC_DRAM_COLS * 4;
+	if (sweep_count && sweep_count < (unsigned int) i_max)
+		i_max = sweep_count;
 
 	elaborate();
+	/* Only command timing is of interest, don't store data. */
+	mc.set_timing_only(true);
 	stats = mc.allocate_cmdarb_stats();
 
+	if (reuse_sim)
+		sseq.set_pause_fini(true);
+
 	for (i = 0; i < i_max; i++) {
-		pid = fork();
-		if (pid == 0) {
+		if (reuse_sim) {
+			if (i)
+				reset_sim();
 			do_sim(descs, stats);
-			exit(0);
-		}
+		} else {
+			pid = fork();
+			if (pid == 0) {
+				do_sim(descs, stats);
+				exit(0);
+			}
 
-	        waitpid(pid, NULL, 0);
+			waitpid(pid, NULL, 0);
+		}
 
 		for (stride_descriptor *desc: descs) {
 			desc->addr += 4;
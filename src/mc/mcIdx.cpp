@@ -18,6 +18,7 @@
 
 #include <systemc>
 #include <list>
+#include <cstdlib>
 #include <cstdio>
 
 #include <ramulator/DDR4.h>
@@ -40,12 +41,6 @@ using namespace std;
 using namespace sc_core;
 using namespace sc_dt;
 
-enum {
-	STATS_MIN = 0,
-	STATS_MAX,
-	STATS_AGG
-};
-
 namespace mc_test {
 
 /** Unit test for mc */
@@ -56,6 +51,9 @@ private:
 
 	sc_uint<32> base_addr;
 
+	/** True iff a reset is pending for the main thread. */
+	bool rst;
+
 public:
 	/** DRAM clock, SDR */
 	sc_in<bool> in_clk{"in_clk"};
@@ -81,7 +79,7 @@ public:
 	sc_inout<sc_uint<4> > out_ticket_pop{"out_ticket_pop"};
 
 	/** Construct test thread */
-	SC_CTOR(Test_mc) : write(0)
+	SC_CTOR(Test_mc) : write(0), rst(false)
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
@@ -109,6 +107,14 @@ public:
 		write = w;
 	}
 
+	/** Re-issue the index iterator descriptor and trigger after a memory
+	 * controller reset. Only valid while the simulation is paused. */
+	void
+	reset(void)
+	{
+		rst = true;
+	}
+
 private:
 	/** Main thread */
 	void
@@ -118,24 +124,34 @@ private:
 		AbstractRegister t(0,REGISTER_VGPR,0);
 		stride_descriptor idxdesc(t);
 
-		idxdesc.type = stride_descriptor::IDXIT;
-		idxdesc.addr = base_addr;
-		idxdesc.write = write;
-		idxdesc.dst_offset = 0;
-		out_desc.write(idxdesc);
+		while (1) {
+			idxdesc.type = stride_descriptor::IDXIT;
+			idxdesc.addr = base_addr;
+			idxdesc.write = write;
+			idxdesc.dst_offset = 0;
+			out_desc.write(idxdesc);
+
+			sched_opts = 0;
+			sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
 
-		sched_opts = 0;
-		sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
+			out_sched_opts.write(sched_opts);
+			out_ticket_pop.write(0);
 
-		out_sched_opts.write(sched_opts);
-		out_ticket_pop.write(0);
+			out_trigger.write(1);
+			wait();
+			out_trigger.write(0);
 
-		out_trigger.write(1);
-		wait();
-		out_trigger.write(0);
+			while (!rst) {
+				if (in_done_dst.num_available())
+					in_done_dst.read();
 
-		while (1) {
-			if (in_done_dst.num_available())
+				wait();
+			}
+
+			/* Idle for the cycle in which the memory controller
+			 * picks up the reset. */
+			rst = false;
+			while (in_done_dst.num_available())
 				in_done_dst.read();
 
 			wait();
@@ -151,17 +167,26 @@ using namespace ramulator;
 
 static int sweep_alignment = false;
 
+/** True iff all alignments are simulated in a single SystemC session,
+ * resetting the memory controller in between. Otherwise a process is forked
+ * per alignment. */
+static bool reuse_sim = true;
+
+/** Number of alignments to sweep, 0 for all of them. */
+static unsigned int sweep_count = 0;
+
 /* SystemC: Full system */
 static sc_clock *clk;
 
 static Test_mc test("test");
 static mc_control::StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS> sseq("sseq");
 static Backend<MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS> mc("mc");
-static sp_control::Scratchpad<0,MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,COMPUTE_THREADS> sp("sp");
+static sp_control::Scratchpad<MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,COMPUTE_THREADS> sp("sp");
 
 /* IdxIterator -> CmdGen */
 static sc_fifo<stride_descriptor> desc_fifo;
-static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > req_fifo(MC_BURSTREQ_FIFO_DEPTH);
+static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > *req_fifo[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_DRAM_CHANS> > strseq_chans;
 static sc_signal<bool> dangle_strseq_done;
 static sc_fifo<bool> strseq_trigger(2);
 static sc_signal<RequestTarget> strseq_dst;
@@ -173,39 +198,39 @@ static sc_fifo<RequestTarget> mc_done_dst;
 static sc_signal<bool> mc_allpre;
 static sc_signal<AbstractRegister> sseq_vreg_reg_w;
 static sc_signal<bool> mc_enable;
-static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_BUS_WIDTH/4];
+static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
 static sc_signal<bool> sseq_idx_push_trigger;
 static sc_fifo<idx_t<COMPUTE_THREADS> > sseq_idx(32);
 
 static sc_signal<bool> mc_vreg_rw;
 
-static sc_signal<sc_uint<32> > mc_out_data[MC_BUS_WIDTH/4];
+static sc_signal<sc_uint<32> > mc_out_data[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 static sc_signal<bool> mc_write;
-static sc_signal<sc_uint<18> > mc_sp_addr;
+static sc_signal<sc_uint<18> > mc_sp_addr[MC_DRAM_CHANS];
 static sc_signal<sc_uint<2> > mc_sp_words;
 static sc_signal<long> mc_cycle;
 static sc_signal<bool> dangle_mc_ref;
 
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w;
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w;
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w[MC_DRAM_CHANS];
 static sc_signal<sc_uint<32> > sp_data_mc[SP_BUS_WIDTH];
 
 static sc_fifo<stride_descriptor> dangle_sp_desc_fifo;
 static sc_fifo<bool> dangle_sp_trigger(2);
-static sc_fifo<sc_uint<1> > dangle_sp_wg_done;
+static sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > dangle_sp_wg_done;
 static sc_signal<bool> dangle_sp_rf_enable;
 static sc_signal<bool> dangle_sp_rf_write;
 static sc_signal<AbstractRegister> dangle_sp_rf_reg;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_sp_rf_mask;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_sp_in_rf_mask;
 static sc_signal<reg_offset_t<COMPUTE_THREADS> > dangle_sp_rf_idx[SP_BUS_WIDTH];
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_BUS_WIDTH/4)];
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_DRAM_CHANS*MC_BUS_WIDTH/4)];
 #endif
 static sc_signal<sc_uint<32> > dangle_regfile_store_data[SP_BUS_WIDTH];
 
-static sc_signal<sc_uint<32> > dangle_data_mc[2][SP_BUS_WIDTH];
+static sc_signal<sc_uint<32> > dangle_data_mc[IF_SENTINEL - 1][SP_BUS_WIDTH];
 
 /** Wire up the design
  */
@@ -228,7 +253,7 @@ elaborate()
 	sseq.in_desc_fifo(desc_fifo);
 	sseq.in_ref_pending(ref_pending);
 	sseq.in_trigger(strseq_trigger);
-	sseq.out_req_fifo(req_fifo);
+	sseq.out_chans(strseq_chans);
 	sseq.out_done(dangle_strseq_done);
 	sseq.in_DQ_allpre(mc_allpre);
 	sseq.out_dst(strseq_dst);
@@ -240,22 +265,30 @@ elaborate()
 	sseq.in_ticket_pop(test_ticket_pop);
 
 	mc.in_clk(*clk);
-	mc.in_req_fifo(req_fifo);
+	mc.in_chans(strseq_chans);
 	mc.out_ref_pending(ref_pending);
 	mc.out_allpre(mc_allpre);
 	mc.out_ref(dangle_mc_ref);
-	mc.in_mask_w(mc_imask_w);
-	mc.out_sp_addr(mc_sp_addr);
 	mc.out_enable(mc_enable);
 	mc.out_write(mc_write);
-	mc.out_mask_w(mc_mask_w);
 	mc.out_done_dst(mc_done_dst);
 	mc.out_cycle(mc_cycle);
-	for (unsigned int i = 0; i < 4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		req_fifo[i] = new sc_fifo<burst_request<MC_BUS_WIDTH,
+				COMPUTE_THREADS> >(MC_BURSTREQ_FIFO_DEPTH);
+		sseq.out_req_fifo[i](*req_fifo[i]);
+		mc.in_req_fifo[i](*req_fifo[i]);
+
+		mc.in_mask_w[i](mc_imask_w[i]);
+		mc.out_sp_addr[i](mc_sp_addr[i]);
+		mc.out_mask_w[i](mc_mask_w[i]);
+	}
+
+	for (unsigned int i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		mc.out_data[i](mc_out_data[i]);
 		mc.in_data[IF_SP_WG0][i](sp_data_mc[i]);
-		mc.in_data[IF_SP_WG1][i](dangle_data_mc[0][i]);
-		mc.in_data[IF_RF][i](dangle_data_mc[1][i]);
+		for (unsigned int j = IF_SP_WG0 + 1; j < IF_SENTINEL; j++)
+			mc.in_data[j][i](dangle_data_mc[j - 1][i]);
 		mc.out_vreg_idx_w[i](mc_vreg_idx_w[i]);
 	}
 
@@ -274,10 +307,13 @@ elaborate()
 	sp.in_dram_enable(mc_enable);
 	sp.in_dram_dst(strseq_dst);
 	sp.in_dram_write(mc_write);
-	sp.in_dram_addr(mc_sp_addr);
-	sp.in_dram_mask(mc_mask_w);
 
-	for (i = 0; i < MC_BUS_WIDTH/4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		sp.in_dram_addr[i](mc_sp_addr[i]);
+		sp.in_dram_mask[i](mc_mask_w[i]);
+	}
+
+	for (i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		sp.out_data[i](sp_data_mc[i]);
 		sp.in_dram_data[i](mc_out_data[i]);
 	}
@@ -287,9 +323,9 @@ elaborate()
 		sp.in_rf_data[i](dangle_regfile_store_data[i]);
 	}
 
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	for (i = 0; i < SP_BUS_WIDTH - (MC_BUS_WIDTH/4); i++)
-		sp.out_data[(MC_BUS_WIDTH/4)+i](sp_out_data[i]);
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	for (i = 0; i < SP_BUS_WIDTH - (MC_DRAM_CHANS*MC_BUS_WIDTH/4); i++)
+		sp.out_data[(MC_DRAM_CHANS*MC_BUS_WIDTH/4)+i](sp_out_data[i]);
 #endif
 	sp.elaborate();
 }
@@ -323,6 +359,17 @@ do_sim(list<idx_t<COMPUTE_THREADS> *> idxs, cmdarb_stats *stats)
 	}
 }
 
+/** Restore the memory controller and test driver to their power-on state, such
+ * that the next do_sim() call behaves as if run in a fresh process. Only valid
+ * after do_sim() returned. */
+void
+reset_sim(void)
+{
+	mc.reset();
+	sseq.reset();
+	test.reset();
+}
+
 /** Document the parameters accepted by this binary.
  * @param Program name binary name used to invoke this program. */
 void
@@ -341,6 +388,10 @@ help(char *program_name)
 	cout << "\t-b [addr]:\tBase address (default: 0x0)." << endl;
 	cout << "\t-S:\t\tSweep DRAM address over all possible alignments."
 			<< endl;
+	cout << "\t-F:\t\tFork a process per alignment, rather than resetting"
+			<< endl;
+	cout << "\t\t\tthe memory controller between alignments." << endl;
+	cout << "\t-n [count]:\tSweep only the first [count] alignments." << endl;
 	cout << "\t-h:\t\tThis help." << endl;
 }
 
@@ -362,7 +413,7 @@ parse_parameters(int argc, char* argv[], list<idx_t<COMPUTE_THREADS> *> *idxs,
 	list<idx_t<COMPUTE_THREADS> >::reverse_iterator xit;
 
 	/* Take stride patterns from the command line */
-	while ( (c = getopt(argc, argv, "f:tpb:Sw")) != -1) {
+	while ( (c = getopt(argc, argv, "f:tpb:SwFn:")) != -1) {
 		switch (c) {
 		case 'f':
 			if (optarg[0] == '-')
@@ -401,6 +452,12 @@ parse_parameters(int argc, char* argv[], list<idx_t<COMPUTE_THREADS> *> *idxs,
 		case 'w':
 			*write = true;
 			break;
+		case 'F':
+			reuse_sim = false;
+			break;
+		case 'n':
+			sweep_count = strtoul(optarg, nullptr, 0);
+			break;
 		default:
 			help(argv[0]);
 			exit(1);
@@ -429,12 +486,27 @@ sc_main(int argc, char* argv[])
 	/* MC_DRAM_COLS * 2 for number of words, * 2 for interleaved banks */
 	if (sweep_alignment)
 		i_max = MC_DRAM_COLS * 4;
+	if (sweep_count && sweep_count < (unsigned int) i_max)
+		i_max = sweep_count;
 
 	elaborate();
+	/* Only command timing is of interest, don't store data. */
+	mc.set_timing_only(true);
 	test.set_write(write);
 	stats = mc.allocate_cmdarb_stats();
 
+	if (reuse_sim)
+		sseq.set_pause_fini(true);
+
 	for (i = 0; i < i_max; i++) {
+		if (reuse_sim) {
+			if (i)
+				reset_sim();
+			test.set_base_addr(base_addr + (i * 4));
+			do_sim(idxs, stats);
+			continue;
+		}
+
 		pid = fork();
 		if (pid == 0) {
 			test.set_base_addr(base_addr + (i * 4));
@@ -86,7 +86,7 @@ public:
 	 * 	    read.
 	 * @param wg Destination work-group slot.
 	 * @param sp Scratchpad destination address. */
-	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<1> wg,
+	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<COMPUTE_WG_WIDTH> wg,
 			sc_uint<32> sp)
 	: addr(a), wordmask(wm), write(w), pre_pol(PRECHARGE_LINEAR),
 	  target(wg,TARGET_SP), sp_offset(sp), last(false) {}
@@ -102,7 +102,7 @@ public:
 	 * @param wg Destination work-group slot.
 	 * @param tg Type of the destination register.
 	 * @param ri Array of vector register columns. */
-	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<1> wg,
+	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<COMPUTE_WG_WIDTH> wg,
 			req_dest_type_t tg, array<unsigned int,BUS_WIDTH> ri)
 	: addr(a), wordmask(wm), write(w), pre_pol(PRECHARGE_LINEAR),
 	  target(wg,tg), sp_offset(0), last(false)
@@ -130,7 +130,7 @@ public:
 	 * @param tg Type of the destination register.
 	 * @param ri Array of vector register lanes (columns).
 	 * @param rr Array of vector register rows. */
-	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<1> wg,
+	burst_request(sc_uint<32> a, sc_bv<BUS_WIDTH> wm, bool w, sc_uint<COMPUTE_WG_WIDTH> wg,
 			req_dest_type_t tg, array<unsigned int,BUS_WIDTH> ri,
 			array<unsigned int,BUS_WIDTH> rr)
 	: addr(a), wordmask(wm), write(w), pre_pol(PRECHARGE_LINEAR),
@@ -60,3 +60,67 @@ cmdarb_stats::aggregate(cmdarb_stats &s) {
 	energy += s.energy;
 	bytes += s.bytes;
 }
+
+void
+cmdarb_stats::merge_channel(cmdarb_stats &s, unsigned int chans) {
+	/* All channels share the bus width and simulated time, hence the
+	 * utilisation of the aggregate bus is the mean over the channels. */
+	dq_util = (dq_util * (chans - 1) + s.dq_util) / chans;
+
+	act_c += s.act_c;
+	pre_c += s.pre_c;
+	cas_c += s.cas_c;
+	ref_c += s.ref_c;
+	lda = std::max(lda, s.lda);
+	lid = std::max(lid, s.lid);
+	power += s.power;
+	energy += s.energy;
+	bytes += s.bytes;
+}
+
+void
+cmdarb_stats::resume(cmdarb_stats &s, unsigned long offset,
+		unsigned long cycles) {
+	/* Rates are weighted by the duration of both simulations. */
+	if (offset + cycles) {
+		power = (power * cycles + s.power * offset) /
+				(offset + cycles);
+		dq_util = (dq_util * cycles + s.dq_util * offset) /
+				(offset + cycles);
+	}
+
+	/* Timestamps of this simulation start at the checkpoint. Retain
+	 * those of the preceding simulation if no command followed. */
+	lda = lda ? lda + offset : s.lda;
+	lid = lid ? lid + (long) offset : s.lid;
+
+	act_c += s.act_c;
+	pre_c += s.pre_c;
+	cas_c += s.cas_c;
+	ref_c += s.ref_c;
+	energy += s.energy;
+	bytes += s.bytes;
+}
+
+void
+cmdarb_stats::scale(double f, unsigned long cycles, unsigned long est_cycles) {
+	double r;
+
+	act_c = (unsigned int) (act_c * f);
+	pre_c = (unsigned int) (pre_c * f);
+	cas_c = (unsigned int) (cas_c * f);
+	ref_c = (unsigned int) (ref_c * f);
+	energy *= f;
+	bytes = (unsigned long) (bytes * f);
+
+	/* Timestamps move with the end of the simulation. */
+	lda += est_cycles - cycles;
+	lid += (long) est_cycles - (long) cycles;
+
+	/* Rates follow the scaled totals over the estimated time. */
+	if (est_cycles) {
+		r = (f * cycles) / est_cycles;
+		power *= r;
+		dq_util *= r;
+	}
+}
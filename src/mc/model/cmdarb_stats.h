@@ -26,6 +26,14 @@ using namespace std;
 
 namespace mc_model {
 
+/** Indexes into an array of aggregate cmdarb_stats objects, as allocated by
+ * mc_control::Backend::allocate_cmdarb_stats(). */
+enum {
+	STATS_MIN = 0,
+	STATS_MAX,
+	STATS_AGG
+};
+
 /** Object containing performance counter and power estimate values for a given
  * memory controller simulation. These values are generated as the command
  * arbiter issues new commands.
@@ -84,6 +92,29 @@ public:
 	void max(cmdarb_stats &s);
 	/** Aggregate provided statistics into this object. */
 	void aggregate(cmdarb_stats &s);
+	/** Merge the statistics of a concurrently operating DRAM channel into
+	 * this object.
+	 * @param s Statistics of the channel to merge.
+	 * @param chans Number of channels merged, including s. */
+	void merge_channel(cmdarb_stats &s, unsigned int chans);
+	/** Accumulate the statistics of the simulation preceding a checkpoint
+	 * this simulation resumed from.
+	 * @param s Statistics up to the checkpoint.
+	 * @param offset DRAM cycle of the checkpoint, relative to the cycle
+	 * 		 this simulation finished loading the program.
+	 * @param cycles DRAM cycles simulated by this simulation. */
+	void resume(cmdarb_stats &s, unsigned long offset,
+			unsigned long cycles);
+	/** Extrapolate from a sample of the work-groups to all work-groups.
+	 *
+	 * Counters, energy and bytes are scaled by f. The lda and lid
+	 * timestamps are moved by the difference between the estimated and
+	 * simulated time. Power and utilisation are recomputed for the scaled
+	 * totals over the estimated time.
+	 * @param f Scaling factor.
+	 * @param cycles DRAM cycles simulated, the span the rates are over.
+	 * @param est_cycles Estimated DRAM cycles of a full simulation. */
+	void scale(double f, unsigned long cycles, unsigned long est_cycles);
 };
 
 }
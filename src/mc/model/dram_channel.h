@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MC_MODEL_DRAM_CHANNEL_H
+#define MC_MODEL_DRAM_CHANNEL_H
+
+#include <cstdint>
+
+#include "util/constmath.h"
+#include "util/defaults.h"
+
+/** Number of DRAM cycles joining the per-channel completion signals adds to
+ * every stride descriptor, compared to a single-channel memory controller. */
+#define DRAM_CHAN_JOIN_CYCLES 1
+
+namespace mc_model {
+
+/** Determine the DRAM channel storing a given address.
+ *
+ * Blocks of INTERLEAVE bytes are distributed round-robin over the channels.
+ * @param CHANS Number of DRAM channels.
+ * @param INTERLEAVE Channel interleaving granularity in bytes.
+ * @param addr Global DRAM address.
+ * @return Channel storing addr. */
+template <unsigned int CHANS = MC_DRAM_CHANS,
+	unsigned int INTERLEAVE = MC_DRAM_CHAN_INTERLEAVE>
+inline unsigned int
+dram_chan(uint32_t addr)
+{
+	return (addr >> const_log2(INTERLEAVE)) & (CHANS - 1);
+}
+
+/** Translate a global DRAM address into an address within its channel.
+ *
+ * The channel bits are removed, such that each channel sees a contiguous
+ * address space. The "no next address" marker 0xffffffff is retained.
+ * @param CHANS Number of DRAM channels.
+ * @param INTERLEAVE Channel interleaving granularity in bytes.
+ * @param addr Global DRAM address.
+ * @return Address within the channel returned by dram_chan(). */
+template <unsigned int CHANS = MC_DRAM_CHANS,
+	unsigned int INTERLEAVE = MC_DRAM_CHAN_INTERLEAVE>
+inline uint32_t
+dram_chan_addr(uint32_t addr)
+{
+	if (CHANS == 1 || addr == 0xffffffff)
+		return addr;
+
+	return ((addr >> const_log2(INTERLEAVE * CHANS)) <<
+			const_log2(INTERLEAVE)) | (addr & (INTERLEAVE - 1));
+}
+
+}
+
+#endif /* MC_MODEL_DRAM_CHANNEL_H */
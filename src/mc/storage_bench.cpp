@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <systemc>
+#include <chrono>
+#include <iostream>
+#include <unistd.h>
+
+#include "mc/control/Storage.h"
+#include "mc/control/CmdGen_DDR4.h"
+#include "util/defaults.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+using namespace mc_control;
+
+typedef Storage<MC_BUS_WIDTH,MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS>
+		storage_t;
+typedef CmdGen_DDR4<MC_BUS_WIDTH,MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS,
+		COMPUTE_THREADS> cmdgen_t;
+
+/** Number of words to access per pattern. */
+static unsigned long words = 1ul << 24;
+
+/** Stride in words for the strided access pattern. */
+static unsigned long stride = MC_DRAM_COLS * 2;
+
+/** Access words DRAM words starting at address 0, each stride words apart,
+ * first writing then reading them back, and print the throughput.
+ * @param s Storage to access.
+ * @param name Name of this access pattern.
+ * @param str Stride in words. */
+static void
+bench(storage_t &s, const char *name, unsigned long str)
+{
+	sc_uint<const_log2(MC_DRAM_BANKS)> bank;
+	sc_uint<const_log2(MC_DRAM_ROWS)> row;
+	sc_uint<const_log2(MC_DRAM_COLS)> col;
+	chrono::steady_clock::time_point start;
+	chrono::duration<double> wr, rd;
+	unsigned long i;
+	unsigned long addr;
+	uint32_t sum = 0;
+
+	start = chrono::steady_clock::now();
+	for (i = 0, addr = 0; i < words; i++, addr += (str << 2)) {
+		cmdgen_t::address_translate(addr, bank, row, col);
+		s.set_word(bank, row, col | ((addr >> 3) & 0x7),
+				(addr >> 2) & 0x1, i);
+	}
+	wr = chrono::steady_clock::now() - start;
+
+	start = chrono::steady_clock::now();
+	for (i = 0, addr = 0; i < words; i++, addr += (str << 2)) {
+		cmdgen_t::address_translate(addr, bank, row, col);
+		sum += s.get_word(bank, row, col | ((addr >> 3) & 0x7),
+				(addr >> 2) & 0x1);
+	}
+	rd = chrono::steady_clock::now() - start;
+
+	cout << name << ": write " << (words / wr.count()) << " words/s, read "
+			<< (words / rd.count()) << " words/s (checksum "
+			<< sum << ")" << endl;
+}
+
+/** Document the parameters accepted by this binary.
+ * @param program_name Binary name used to invoke this program. */
+static void
+help(char *program_name)
+{
+	cout << program_name << " [options]" << endl;
+	cout << "Measure DRAM storage back-end throughput." << endl;
+	cout << endl;
+	cout << "Options:" << endl;
+	cout << "\t-n [words]:\tNumber of words accessed per pattern." << endl;
+	cout << "\t-s [words]:\tStride for the strided access pattern." << endl;
+}
+
+/** Main SystemC thread.
+ * @param argc Number of strings in argv.
+ * @param argv Command-line parameters.
+ * @return 0 iff program ended successfully.
+ */
+int
+sc_main(int argc, char *argv[])
+{
+	int c;
+	storage_t *seq;
+	storage_t *str;
+
+	while ((c = getopt(argc, argv, "n:s:")) != -1) {
+		switch (c) {
+		case 'n':
+			words = stoul(optarg);
+			break;
+		case 's':
+			stride = stoul(optarg);
+			break;
+		default:
+			help(argv[0]);
+			exit(1);
+		}
+	}
+
+	/* Wrap around at 4GiB, address_translate() takes 32-bit addresses. */
+	if (words == 0 || stride == 0 || (words * stride) > (1ul << 30)) {
+		help(argv[0]);
+		exit(1);
+	}
+
+	seq = new storage_t();
+	bench(*seq, "Sequential", 1);
+	delete seq;
+
+	str = new storage_t();
+	bench(*str, "Strided", stride);
+	delete str;
+
+	return 0;
+}
@@ -0,0 +1,341 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mc/control/ClusterArbiter.h"
+#include "util/SimdTest.h"
+#include "util/defaults.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace mc_control;
+using namespace simd_test;
+
+namespace mc_test {
+
+/** Unit test for mc_control::ClusterArbiter
+ *
+ * Takes the role of both the SimdClusters and the StrideSequencer/Backend. */
+template <unsigned int BUS_WIDTH, unsigned int THREADS, unsigned int CLUSTERS>
+class Test_ClusterArbiter : public SimdTest
+{
+public:
+	/** DRAM clock, SDR */
+	sc_in<bool> in_clk{"in_clk"};
+
+	/** Stride descriptors from each cluster. */
+	sc_fifo_out<stride_descriptor> out_desc_fifo[CLUSTERS];
+
+	/** Kick signals from each cluster. */
+	sc_fifo_out<bool> out_trigger[CLUSTERS];
+
+	/** Ticket number of each cluster. */
+	sc_inout<sc_uint<4> > out_ticket_pop[CLUSTERS];
+
+	/** CAM indexes from each cluster. */
+	sc_fifo_out<idx_t<THREADS> > out_idx[CLUSTERS];
+
+	/** Store mask of each cluster. */
+	sc_inout<sc_bv<BUS_WIDTH/4> > out_mask[CLUSTERS];
+
+	/** Store data of each cluster. */
+	sc_inout<sc_uint<32> > out_data[CLUSTERS][IF_SENTINEL][BUS_WIDTH/4];
+
+	/** Granted descriptor. */
+	sc_fifo_in<stride_descriptor> in_desc_fifo{"in_desc_fifo"};
+
+	/** Trigger for the StrideSequencer. */
+	sc_fifo_in<bool> in_trigger{"in_trigger"};
+
+	/** Ticket of the granted cluster. */
+	sc_in<sc_uint<4> > in_ticket_pop{"in_ticket_pop"};
+
+	/** CAM indexes of the granted cluster. */
+	sc_fifo_in<idx_t<THREADS> > in_idx{"in_idx"};
+
+	/** Store mask of the granted cluster. */
+	sc_in<sc_bv<BUS_WIDTH/4> > in_mask{"in_mask"};
+
+	/** Store data of the granted cluster. */
+	sc_in<sc_uint<32> > in_data[IF_SENTINEL][BUS_WIDTH/4];
+
+	/** StrideSequencer done. */
+	sc_inout<bool> out_done{"out_done"};
+
+	/** Completed request. */
+	sc_fifo_out<RequestTarget> out_done_dst{"out_done_dst"};
+
+	/** Completed requests per cluster. */
+	sc_fifo_in<RequestTarget> in_done_dst[CLUSTERS];
+
+	/** DRAM enable. */
+	sc_inout<bool> out_enable{"out_enable"};
+
+	/** DRAM enable per cluster. */
+	sc_in<bool> in_enable[CLUSTERS];
+
+	/** Request target. */
+	sc_inout<RequestTarget> out_dst{"out_dst"};
+
+	/** Request target per cluster. */
+	sc_in<RequestTarget> in_dst[CLUSTERS];
+
+	/** Target register. */
+	sc_inout<AbstractRegister> out_dst_reg{"out_dst_reg"};
+
+	/** Target register per cluster. */
+	sc_in<AbstractRegister> in_dst_reg[CLUSTERS];
+
+	/** Index push trigger. */
+	sc_inout<bool> out_idx_push_trigger{"out_idx_push_trigger"};
+
+	/** Index push trigger per cluster. */
+	sc_in<bool> in_idx_push_trigger[CLUSTERS];
+
+	/** Construct test thread */
+	SC_CTOR(Test_ClusterArbiter)
+	{
+		SC_THREAD(thread_lt);
+		sensitive << in_clk.pos();
+	}
+
+private:
+	/** Enqueue a descriptor on behalf of a cluster.
+	 * @param c Cluster index.
+	 * @param addr DRAM address identifying the descriptor. */
+	void
+	enqueue(unsigned int c, unsigned int addr)
+	{
+		stride_descriptor desc;
+
+		desc.addr = addr;
+		desc.words = 16;
+		desc.period = 16;
+		desc.period_count = 1;
+		desc.dst_period = 16;
+
+		out_desc_fifo[c].write(desc);
+		out_trigger[c].nb_write(true);
+	}
+
+	/** Take the role of the StrideSequencer for one granted descriptor.
+	 * @param c Cluster expected to hold the grant.
+	 * @param addr Expected DRAM address of the descriptor. */
+	void
+	serve(unsigned int c, unsigned int addr)
+	{
+		stride_descriptor desc;
+		RequestTarget dst;
+		unsigned int i;
+
+		while (!in_desc_fifo.num_available())
+			wait();
+
+		in_desc_fifo.read(desc);
+		assert(desc.addr == addr);
+		assert(in_trigger.num_available());
+		in_trigger.read();
+
+		/* Wait a cycle for the grant to settle. */
+		wait();
+		assert(in_ticket_pop.read() == c);
+		assert(in_data[IF_RF][0].read() == 0xc0de0000 + c);
+		assert(in_mask.read() == sc_bv<BUS_WIDTH/4>(1 << c));
+
+		/* Indexes are forwarded from the granted cluster only. */
+		out_idx[c].write(idx_t<THREADS>(c, addr));
+		wait();
+		wait();
+		assert(in_idx.num_available() == 1);
+		assert(in_idx.read().dram_off == addr);
+
+		out_enable.write(true);
+		out_dst.write(RequestTarget(0, TARGET_REG));
+		out_idx_push_trigger.write(true);
+		wait();
+		wait();
+		for (i = 0; i < CLUSTERS; i++) {
+			assert(in_enable[i].read() == (i == c));
+			assert(in_idx_push_trigger[i].read() == (i == c));
+			assert(in_dst[i].read().type ==
+					(i == c ? TARGET_REG : TARGET_NONE));
+		}
+
+		/* No descriptor is granted while this one is in flight. */
+		assert(!in_desc_fifo.num_available());
+
+		out_enable.write(false);
+		out_dst.write(RequestTarget());
+		out_idx_push_trigger.write(false);
+		out_done_dst.write(RequestTarget(0, TARGET_REG));
+		wait();
+		wait();
+		for (i = 0; i < CLUSTERS; i++) {
+			assert(in_done_dst[i].num_available() == (i == c));
+			if (i == c)
+				in_done_dst[i].read(dst);
+		}
+
+		out_done.write(true);
+		wait();
+		out_done.write(false);
+	}
+
+	/** Main thread. */
+	void
+	thread_lt(void)
+	{
+		unsigned int c;
+
+		for (c = 0; c < CLUSTERS; c++) {
+			out_ticket_pop[c].write(c);
+			out_mask[c].write(sc_bv<BUS_WIDTH/4>(1 << c));
+			out_data[c][IF_RF][0].write(0xc0de0000 + c);
+		}
+		out_done.write(false);
+
+		/* Test one: all clusters request simultaneously. Served in
+		 * round-robin order, starting after cluster 0. */
+		for (c = 0; c < CLUSTERS; c++)
+			enqueue(c, 0x1000 * c);
+
+		for (c = 1; c <= CLUSTERS; c++)
+			serve(c % CLUSTERS, 0x1000 * (c % CLUSTERS));
+
+		/* Test two: a cluster with two pending descriptors is served
+		 * once before the next cluster. */
+		enqueue(1, 0x100);
+		enqueue(1, 0x140);
+		enqueue(2, 0x200);
+		serve(1, 0x100);
+		serve(2, 0x200);
+		serve(1, 0x140);
+
+		test_finish();
+	}
+};
+
+}
+
+using namespace mc_control;
+using namespace mc_test;
+
+int
+sc_main(int argc, char* argv[])
+{
+	unsigned int c, i, j;
+
+	sc_fifo<stride_descriptor> c_desc_fifo[3];
+	sc_fifo<bool> c_trigger[3];
+	sc_signal<sc_uint<4> > c_ticket_pop[3];
+	sc_fifo<idx_t<COMPUTE_THREADS> > c_idx[3];
+	sc_signal<sc_bv<MC_BUS_WIDTH/4> > c_mask[3];
+	sc_signal<sc_uint<32> > c_data[3][IF_SENTINEL][MC_BUS_WIDTH/4];
+	sc_fifo<RequestTarget> c_done_dst[3];
+	sc_signal<bool> c_enable[3];
+	sc_signal<RequestTarget> c_dst[3];
+	sc_signal<AbstractRegister> c_dst_reg[3];
+	sc_signal<bool> c_idx_push_trigger[3];
+
+	sc_fifo<stride_descriptor> desc_fifo;
+	sc_fifo<bool> trigger(2);
+	sc_signal<sc_uint<4> > ticket_pop;
+	sc_fifo<idx_t<COMPUTE_THREADS> > idx;
+	sc_signal<sc_bv<MC_BUS_WIDTH/4> > mask;
+	sc_signal<sc_uint<32> > data[IF_SENTINEL][MC_BUS_WIDTH/4];
+	sc_signal<bool> done;
+	sc_fifo<RequestTarget> done_dst;
+	sc_signal<bool> enable;
+	sc_signal<RequestTarget> dst;
+	sc_signal<AbstractRegister> dst_reg;
+	sc_signal<bool> idx_push_trigger;
+
+	sc_clock clk("clk", sc_time(10./12., SC_NS));
+
+	ClusterArbiter<MC_BUS_WIDTH,COMPUTE_THREADS,3,1> my_arb("my_arb");
+	Test_ClusterArbiter<MC_BUS_WIDTH,COMPUTE_THREADS,3> my_arb_test("my_arb_test");
+
+	my_arb.in_clk(clk);
+	my_arb.out_desc_fifo(desc_fifo);
+	my_arb.out_trigger(trigger);
+	my_arb.out_ticket_pop(ticket_pop);
+	my_arb.out_idx(idx);
+	my_arb.out_mask[0](mask);
+	my_arb.in_done(done);
+	my_arb.in_done_dst(done_dst);
+	my_arb.in_enable(enable);
+	my_arb.in_dst(dst);
+	my_arb.in_dst_reg(dst_reg);
+	my_arb.in_idx_push_trigger(idx_push_trigger);
+
+	my_arb_test.in_clk(clk);
+	my_arb_test.in_desc_fifo(desc_fifo);
+	my_arb_test.in_trigger(trigger);
+	my_arb_test.in_ticket_pop(ticket_pop);
+	my_arb_test.in_idx(idx);
+	my_arb_test.in_mask(mask);
+	my_arb_test.out_done(done);
+	my_arb_test.out_done_dst(done_dst);
+	my_arb_test.out_enable(enable);
+	my_arb_test.out_dst(dst);
+	my_arb_test.out_dst_reg(dst_reg);
+	my_arb_test.out_idx_push_trigger(idx_push_trigger);
+
+	for (i = 0; i < IF_SENTINEL; i++) {
+		for (j = 0; j < MC_BUS_WIDTH/4; j++) {
+			my_arb.out_data[i][j](data[i][j]);
+			my_arb_test.in_data[i][j](data[i][j]);
+		}
+	}
+
+	for (c = 0; c < 3; c++) {
+		my_arb.in_desc_fifo[c](c_desc_fifo[c]);
+		my_arb.in_trigger[c](c_trigger[c]);
+		my_arb.in_ticket_pop[c](c_ticket_pop[c]);
+		my_arb.in_idx[c](c_idx[c]);
+		my_arb.in_mask[c][0](c_mask[c]);
+		my_arb.out_done_dst[c](c_done_dst[c]);
+		my_arb.out_enable[c](c_enable[c]);
+		my_arb.out_dst[c](c_dst[c]);
+		my_arb.out_dst_reg[c](c_dst_reg[c]);
+		my_arb.out_idx_push_trigger[c](c_idx_push_trigger[c]);
+
+		my_arb_test.out_desc_fifo[c](c_desc_fifo[c]);
+		my_arb_test.out_trigger[c](c_trigger[c]);
+		my_arb_test.out_ticket_pop[c](c_ticket_pop[c]);
+		my_arb_test.out_idx[c](c_idx[c]);
+		my_arb_test.out_mask[c](c_mask[c]);
+		my_arb_test.in_done_dst[c](c_done_dst[c]);
+		my_arb_test.in_enable[c](c_enable[c]);
+		my_arb_test.in_dst[c](c_dst[c]);
+		my_arb_test.in_dst_reg[c](c_dst_reg[c]);
+		my_arb_test.in_idx_push_trigger[c](c_idx_push_trigger[c]);
+
+		for (i = 0; i < IF_SENTINEL; i++) {
+			for (j = 0; j < MC_BUS_WIDTH/4; j++) {
+				my_arb.in_data[c][i][j](c_data[c][i][j]);
+				my_arb_test.out_data[c][i][j](c_data[c][i][j]);
+			}
+		}
+	}
+
+	sc_core::sc_start(500, SC_NS);
+
+	assert(my_arb_test.has_finished());
+
+	return 0;
+}
@@ -76,7 +76,7 @@ public:
 	sc_in<bool> in_clk{"in_clk"};
 
 	/** Command FIFOs, one per bank */
-	sc_port<tlm_fifo_put_if<cmd_DDR<BUS_WIDTH,THREADS> > > out_cmd_fifo[DRAM_BANKS];
+	sc_port<RingChannel_out_if<cmd_DDR<BUS_WIDTH,THREADS> > > out_cmd_fifo[DRAM_BANKS];
 
 	/** DQ reservation FIFO */
 	sc_fifo_in<DQ_reservation<BUS_WIDTH,DRAM_BANKS,THREADS> >
@@ -171,7 +171,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<bool> allpre;
 	sc_signal<bool> ref;
 	sc_fifo<RequestTarget> done_dst(1);
-	std::vector<tlm_fifo<cmd_DDR<16,1024> > *> fifo_cmd(MC_DRAM_BANKS);
+	std::vector<RingChannel<cmd_DDR<16,1024> > *> fifo_cmd(MC_DRAM_BANKS);
 
 	sc_set_time_resolution(1, SC_PS);
 	sc_clock clk("clk", sc_time(10./16., SC_NS));
@@ -195,7 +195,7 @@ sc_main(int argc, char* argv[])
 	my_cmdarb_test.in_done_dst(done_dst);
 
 	for (unsigned int i = 0; i < MC_DRAM_BANKS; i++) {
-		fifo_cmd[i] = new tlm_fifo<cmd_DDR<16,1024> >(sc_gen_unique_name("fifo_rwp"));
+		fifo_cmd[i] = new RingChannel<cmd_DDR<16,1024> >(sc_gen_unique_name("fifo_rwp"), 1);
 		my_cmdarb.in_cmd_fifo[i](*fifo_cmd[i]);
 		my_cmdarb_test.out_cmd_fifo[i](*fifo_cmd[i]);
 	}
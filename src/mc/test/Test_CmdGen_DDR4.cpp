@@ -73,7 +73,7 @@ public:
 
 	/** One FIFO per bank - CAS/Precharge commands
 	 * @todo FIFO depth? */
-	sc_port<tlm_fifo<cmd_DDR<BUS_WIDTH,THREADS> > > in_fifo_rwp[DRAM_BANKS];
+	sc_port<RingChannel_in_if<cmd_DDR<BUS_WIDTH,THREADS> > > in_fifo_rwp[DRAM_BANKS];
 
 	sc_in<bool> in_busy{"in_busy"};
 
@@ -160,7 +160,7 @@ sc_main(int argc, char* argv[])
 {
 	sc_fifo<burst_request<16,1024> > req_fifo("req_fifo");
 	sc_signal<bool> busy;
-	std::vector<tlm_fifo<cmd_DDR<16,1024> > *> fifo_rwp(MC_DRAM_BANKS);
+	std::vector<RingChannel<cmd_DDR<16,1024> > *> fifo_rwp(MC_DRAM_BANKS);
 
 	sc_set_time_resolution(1, SC_PS);
 	sc_clock clk("clk", sc_time(10, SC_NS));
@@ -175,7 +175,7 @@ sc_main(int argc, char* argv[])
 	my_cmdgen_test.in_busy(busy);
 
 	for (unsigned int i = 0; i < MC_DRAM_BANKS; i++) {
-		fifo_rwp[i] = new tlm_fifo<cmd_DDR<16,1024> >(sc_gen_unique_name("fifo_rwp"));
+		fifo_rwp[i] = new RingChannel<cmd_DDR<16,1024> >(sc_gen_unique_name("fifo_rwp"), 1);
 		my_cmdgen.out_fifo[i](*fifo_rwp[i]);
 
 		my_cmdgen_test.in_fifo_rwp[i](*fifo_rwp[i]);
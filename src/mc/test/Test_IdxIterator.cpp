@@ -205,13 +205,15 @@ sc_main(int argc, char* argv[])
 	sc_signal<long> cycle;
 	sc_signal<sc_bv<WSS_SENTINEL> > sched_opts;
 	sc_signal<sc_uint<4> > ticket_pop;
+	sc_signal<sc_bv<1> > chans;
 
-	StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS,128> my_cmdgen("my_cmdgen");
+	StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS,128,1> my_cmdgen("my_cmdgen");
 	my_cmdgen.in_clk(clk);
 	my_cmdgen.in_desc_fifo(desc_fifo);
 	my_cmdgen.in_trigger(trigger);
 	my_cmdgen.in_ref_pending(ref_pending);
-	my_cmdgen.out_req_fifo(req_fifo);
+	my_cmdgen.out_req_fifo[0](req_fifo);
+	my_cmdgen.out_chans(chans);
 	my_cmdgen.out_done(done);
 	my_cmdgen.in_DQ_allpre(dq_allpre);
 	my_cmdgen.out_dst(dst);
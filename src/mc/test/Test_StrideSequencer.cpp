@@ -17,6 +17,7 @@
  */
 
 #include "mc/control/StrideSequencer.h"
+#include "mc/model/dram_channel.h"
 #include "util/SimdTest.h"
 #include "util/defaults.h"
 
@@ -198,7 +199,7 @@ private:
 		wait();
 
 		if (desc.getTargetType() == TARGET_REG)
-			assert(*(desc.getTargetReg()) == in_dst_reg.read());
+			assert(desc.getTargetReg() == in_dst_reg.read());
 
 		i = 0;
 
@@ -319,18 +320,20 @@ sc_main(int argc, char* argv[])
 	sc_signal<long> cycle;
 	sc_signal<sc_bv<WSS_SENTINEL> > sched_opts;
 	sc_signal<sc_uint<4> > ticket_pop;
+	sc_signal<sc_bv<1> > chans;
 
 	sc_fifo<stride_descriptor> desc_fifo("desc_fifo");
 	sc_fifo<burst_request<16,COMPUTE_THREADS> > req_fifo("req_fifo");
 
 	sc_clock clk("clk", sc_time(10./12., SC_NS));
 
-	StrideSequencer<16,COMPUTE_THREADS> my_sseq("my_sseq");
+	StrideSequencer<16,COMPUTE_THREADS,COMPUTE_FPUS,1> my_sseq("my_sseq");
 	my_sseq.in_clk(clk);
 	my_sseq.in_desc_fifo(desc_fifo);
 	my_sseq.in_trigger(trigger);
 	my_sseq.in_ref_pending(ref_pending);
-	my_sseq.out_req_fifo(req_fifo);
+	my_sseq.out_req_fifo[0](req_fifo);
+	my_sseq.out_chans(chans);
 	my_sseq.out_done(done);
 	my_sseq.in_DQ_allpre(dq_allpre);
 	my_sseq.out_dst(dst);
@@ -361,5 +364,15 @@ sc_main(int argc, char* argv[])
 
 	assert(my_sseq_test.has_finished());
 
+	/* Two channels, interleaved at 256B granularity. */
+	assert((dram_chan<2,256>(0x140000) == 0));
+	assert((dram_chan<2,256>(0x140100) == 1));
+	assert((dram_chan<2,256>(0x140240) == 0));
+	assert((dram_chan_addr<2,256>(0x140100) == 0xa0000));
+	assert((dram_chan_addr<2,256>(0x140240) == 0xa0140));
+	assert((dram_chan_addr<2,256>(0x1403c0) == 0xa01c0));
+	assert((dram_chan_addr<2,256>(0xffffffff) == 0xffffffff));
+	assert((dram_chan_addr<1,256>(0x140240) == 0x140240));
+
 	return 0;
 }
@@ -0,0 +1,298 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "model/BufferStore.h"
+#include "util/constmath.h"
+#include "util/csv.h"
+#include "util/npy.h"
+
+using namespace std;
+using namespace simd_util;
+
+namespace simd_model {
+
+BufferStore::~BufferStore(void)
+{
+}
+
+bool
+BufferStore::read_bin_file(string filename, vector<uint32_t> &buf,
+		size_t max_words)
+{
+	ifstream fs(filename, ios_base::in | ios_base::binary);
+
+	if (!fs.is_open())
+		return false;
+
+	buf.resize(max_words);
+	fs.read((char *) buf.data(), max_words * sizeof(uint32_t));
+	buf.resize(fs.gcount() / sizeof(uint32_t));
+
+	return true;
+}
+
+void
+BufferStore::upload_buffer(const ProgramBuffer &pb)
+{
+	int64_t words;
+	float *fbuf = nullptr;
+	vector<uint32_t> buf;
+	npy_view v;
+
+	if (!pb.hasDataInputFile())
+		return;
+
+	switch (pb.getDataInputType()) {
+	case DECIMAL_CSV:
+		words = csv_file_read_float(pb.getDataInputFile().c_str(), &fbuf);
+		if (words < 0)
+			throw invalid_argument("Could not read CSV file " +
+					pb.getDataInputFile());
+
+		bulk_copy(pb.getAddress(), (uint32_t *) fbuf, words, true);
+
+		if (fbuf)
+			delete[] fbuf;
+		break;
+	case BINARY:
+		if (!read_bin_file(pb.getDataInputFile(), buf,
+				pb.dims[0] * pb.dims[1]))
+			throw invalid_argument("Could not read binary file " +
+					pb.getDataInputFile());
+
+		/* A short file leaves the remainder of the buffer zeroed. */
+		buf.resize(pb.dims[0] * pb.dims[1], 0);
+
+		bulk_copy(pb.getAddress(), buf.data(), buf.size(), true);
+		break;
+	case NUMPY:
+		if (npy_map(pb.getDataInputFile().c_str(), &v) < 0)
+			throw invalid_argument("Could not read .npy file " +
+					pb.getDataInputFile());
+
+		if (!npy_match_dims(&v, pb.dims[0], pb.dims[1])) {
+			npy_unmap(&v);
+			throw invalid_argument("Dimensions of .npy file " +
+				pb.getDataInputFile() + " do not match buffer "
+				"dimensions");
+		}
+
+		bulk_copy(pb.getAddress(), v.data, v.elems, true);
+		npy_unmap(&v);
+		break;
+	default:
+		throw invalid_argument("Unimplemented buffer type");
+	}
+}
+
+void
+BufferStore::download_buffer_bin(const ProgramBuffer &pb, string filename)
+{
+	vector<uint32_t> buf;
+	ofstream fs;
+
+	if (!pb.valid)
+		return;
+
+	buf.resize(pb.dims[0] * pb.dims[1]);
+	bulk_copy(pb.getAddress(), buf.data(), buf.size(), false);
+
+	fs.open(filename, ios_base::out | ios_base::trunc | ios_base::binary);
+	fs.write((char *) buf.data(), buf.size() * sizeof(uint32_t));
+	fs.close();
+}
+
+void
+BufferStore::download_buffer_npy(const ProgramBuffer &pb, string filename)
+{
+	npy_view v;
+
+	if (!pb.valid)
+		return;
+
+	if (npy_create(filename.c_str(), pb.dims[0], pb.dims[1], &v) < 0) {
+		cerr << "Error: could not create file " << filename <<
+			" for buffer download." << endl;
+		return;
+	}
+
+	bulk_copy(pb.getAddress(), v.data, v.elems, false);
+	npy_unmap(&v);
+}
+
+void
+BufferStore::download_buffer_csv(const ProgramBuffer &pb, string filename)
+{
+	vector<uint32_t> buf;
+	bfloat elem;
+	ofstream fs;
+
+	if (!pb.valid)
+		return;
+
+	buf.resize(pb.dims[0] * pb.dims[1]);
+	bulk_copy(pb.getAddress(), buf.data(), buf.size(), false);
+
+	fs.open(filename, ios_base::out | ios_base::trunc);
+	for (uint32_t w : buf) {
+		elem.b = w;
+		fs << elem.f << ", ";
+	}
+	fs.close();
+}
+
+bool
+BufferStore::compare_buffer(const ProgramBuffer &pb, const float *gold,
+		size_t words, float delta, bool dfrac, cmp_stats *stats)
+{
+	vector<uint32_t> buf;
+	cmp_stats s;
+	unsigned int i;
+	size_t idx;
+
+	words = min(words, size_t(pb.dims[0] * pb.dims[1]));
+	buf.resize(words);
+	bulk_copy(pb.getAddress(), buf.data(), words, false);
+
+	cmp_float_buffers((float *) buf.data(), gold, words, delta, dfrac, &s);
+
+	for (i = 0; i < s.reported; i++) {
+		idx = s.mismatch_idx[i];
+		cerr << hex << (pb.getAddress() + (idx * 4)) << dec <<
+			": MISMATCH " << ((float *) buf.data())[idx] <<
+			" != " << gold[idx] << endl;
+	}
+
+	if (s.mismatches > s.reported)
+		cerr << (s.mismatches - s.reported) <<
+			" more mismatches not shown." << endl;
+
+	if (s.mismatches == 0)
+		cout << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
+		<< s.words << " words, " << s.mismatches << " errors." << endl;
+	else
+		cerr << "Buffer at 0x" << hex << pb.addr << dec << ": compared "
+		<< s.words << " words, " << s.mismatches << " errors." << endl;
+
+	cmp_print(cout, s);
+
+	if (stats)
+		*stats = s;
+
+	return (s.mismatches == 0);
+}
+
+bool
+BufferStore::compare_buffer_bin(const ProgramBuffer &pb, string filename,
+		float delta, bool dfrac, cmp_stats *stats)
+{
+	vector<uint32_t> gold;
+
+	if (!read_bin_file(filename, gold, pb.dims[0] * pb.dims[1])) {
+		cerr << "Error: could not open file " << filename <<
+			" for buffer comparison." << endl;
+		cmp_set_error(stats, "could not open file");
+		return false;
+	}
+
+	if (!pb.valid) {
+		cerr << "Error: attempting to compare against invalid buffer"
+			<< endl;
+		cmp_set_error(stats, "invalid buffer");
+		return false;
+	}
+
+	return compare_buffer(pb, (float *) gold.data(), gold.size(), delta,
+			dfrac, stats);
+}
+
+bool
+BufferStore::compare_buffer_npy(const ProgramBuffer &pb, string filename,
+		float delta, bool dfrac, cmp_stats *stats)
+{
+	npy_view v;
+	bool ret = false;
+
+	if (npy_map(filename.c_str(), &v) < 0) {
+		cerr << "Error: could not open .npy file " << filename <<
+			" for buffer comparison." << endl;
+		cmp_set_error(stats, "could not open file");
+		return false;
+	}
+
+	if (!pb.valid) {
+		cerr << "Error: attempting to compare against invalid buffer"
+			<< endl;
+		cmp_set_error(stats, "invalid buffer");
+	} else if (!v.is_float) {
+		cerr << "Error: .npy file " << filename << " does not "
+			"contain 32-bit floats." << endl;
+		cmp_set_error(stats, "not a float32 file");
+	} else if (!npy_match_dims(&v, pb.dims[0], pb.dims[1])) {
+		cerr << "Error: dimensions of .npy file " << filename <<
+			" do not match buffer dimensions." << endl;
+		cmp_set_error(stats, "dimension mismatch");
+	} else {
+		ret = compare_buffer(pb, (float *) v.data, v.elems, delta,
+				dfrac, stats);
+	}
+
+	npy_unmap(&v);
+
+	return ret;
+}
+
+bool
+BufferStore::compare_buffer_csv(const ProgramBuffer &pb, string filename,
+		float delta, bool dfrac, cmp_stats *stats)
+{
+	int64_t words;
+	float *gold = nullptr;
+	bool ret;
+
+	words = csv_file_read_float(filename.c_str(), &gold);
+	if (words < 0) {
+		cerr << "Error: could not open file " << filename <<
+			" for buffer comparison." << endl;
+		cmp_set_error(stats, "could not open file");
+		return false;
+	}
+
+	if (!pb.valid) {
+		cerr << "Error: attempting to compare against invalid buffer"
+			<< endl;
+		cmp_set_error(stats, "invalid buffer");
+		ret = false;
+		goto cmpbuf_out;
+	}
+
+	ret = compare_buffer(pb, gold, words, delta, dfrac, stats);
+
+cmpbuf_out:
+	if (gold)
+		delete[] gold;
+
+	return ret;
+}
+
+}
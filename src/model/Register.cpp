@@ -24,7 +24,7 @@ AbstractRegister::AbstractRegister(void) : type(REGISTER_NONE), wg(0), row(0)
 {
 }
 
-AbstractRegister::AbstractRegister(sc_uint<1> workgroup, RegisterType t,
+AbstractRegister::AbstractRegister(sc_uint<COMPUTE_WG_WIDTH> workgroup, RegisterType t,
 			sc_uint<const_log2(64)> r)
 	: type(t), wg(workgroup), row(r) {}
 
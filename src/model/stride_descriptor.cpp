@@ -41,7 +41,7 @@ operator<<(ostream &os, stride_descriptor const &v)
 		break;
 	case TARGET_REG:
 	case TARGET_CAM:
-		os << "REG " << *(v.dst_reg);
+		os << "REG " << v.dst_reg;
 		break;
 	default:
 		os << "INVALID";
@@ -56,7 +56,7 @@ operator<<(ostream &os, stride_descriptor const &v)
 }
 
 stride_descriptor::stride_descriptor()
-: dst_reg(nullptr), type(STRIDE), dst_period(32), write(false),
+: type(STRIDE), dst_period(32), write(false),
   idx_transform(IDX_TRANSFORM_UNIT)
 {
 	dst.type = TARGET_SP;
@@ -64,43 +64,23 @@ stride_descriptor::stride_descriptor()
 }
 
 stride_descriptor::stride_descriptor(AbstractRegister &reg)
-: type(STRIDE), dst_period(32), write(false), idx_transform(IDX_TRANSFORM_UNIT)
+: dst_reg(reg), type(STRIDE), dst_period(32), write(false),
+  idx_transform(IDX_TRANSFORM_UNIT)
 {
-	dst_reg = reg.clone();
 	dst.type = reg.type == REGISTER_VSP ? TARGET_CAM : TARGET_REG;
 	dst.wg = reg.wg;
 }
 
-stride_descriptor::stride_descriptor(const stride_descriptor &v)
-: ticket(v.ticket), type(v.type), addr(v.addr), words(v.words), period(v.period),
-  period_count(v.period_count), dst(v.dst), dst_offset(v.dst_offset),
-  dst_period(v.dst_period), dst_off_x(v.dst_off_x), dst_off_y(v.dst_off_y),
-  write(v.write), idx_transform(v.idx_transform)
-{
-	if (v.dst_reg != nullptr)
-		dst_reg = v.dst_reg->clone();
-	else
-		dst_reg = nullptr;
-}
-
-stride_descriptor::~stride_descriptor()
-{
-	if (dst_reg != nullptr) {
-		delete dst_reg;
-		dst_reg = nullptr;
-	}
-}
-
 req_dest_type_t
 stride_descriptor::getTargetType(void) const
 {
 	return dst.type;
 }
 
-AbstractRegister *
+const AbstractRegister &
 stride_descriptor::getTargetReg(void) const
 {
-	return dst_reg->clone();
+	return dst_reg;
 }
 
 stride_descriptor *
@@ -40,9 +40,11 @@ namespace sp_control {
  * @param BUS_WIDTH number of (32-bit) word outputs per cycle.
  * @param SIZE_BYTES size of the scratchpad in bytes.
  * @param THREADS Number of threads in a work-group.
+ * @param DRAM_CHANS Number of DRAM channels.
  */
-template <unsigned int WG, unsigned int BUS_WIDTH_DRAM, unsigned int BUS_WIDTH,
-	unsigned int SIZE_BYTES,unsigned int THREADS>
+template <unsigned int BUS_WIDTH_DRAM, unsigned int BUS_WIDTH,
+	unsigned int SIZE_BYTES,unsigned int THREADS,
+	unsigned int DRAM_CHANS = MC_DRAM_CHANS>
 class Scratchpad : public sc_module
 {
 public:
@@ -67,7 +69,7 @@ public:
 
 	/** True iff transfer is completed. FIFO to easily handle crossing
 	 * clock domains. */
-	sc_fifo_out<sc_uint<1> > out_wg_done{"out_wg_done"};
+	sc_fifo_out<sc_uint<COMPUTE_WG_WIDTH> > out_wg_done{"out_wg_done"};
 
 	/** R/W enable bit. */
 	sc_inout<bool> out_rf_enable{"out_rf_enable"};
@@ -101,14 +103,14 @@ public:
 	/** True iff operation is a write op */
 	sc_in<bool> in_dram_write{"in_dram_write"};
 
-	/** Address to manipulate */
-	sc_in<sc_uint<18> > in_dram_addr{"in_dram_addr"};
+	/** Address to manipulate, per DRAM channel. */
+	sc_in<sc_uint<18> > in_dram_addr[DRAM_CHANS];
 
-	/** Data bus for write data */
-	sc_in<sc_uint<32> > in_dram_data[BUS_WIDTH_DRAM];
+	/** Data bus for write data, BUS_WIDTH_DRAM lanes per DRAM channel. */
+	sc_in<sc_uint<32> > in_dram_data[DRAM_CHANS*BUS_WIDTH_DRAM];
 
-	/** Write mask, aligned to in_data. */
-	sc_in<sc_bv<BUS_WIDTH_DRAM> > in_dram_mask{"in_dram_mask"};
+	/** Write mask, aligned to in_data, per DRAM channel. */
+	sc_in<sc_bv<BUS_WIDTH_DRAM> > in_dram_mask[DRAM_CHANS];
 
 	/** Constructor. */
 	SC_CTOR(Scratchpad)
@@ -121,6 +123,17 @@ public:
 		sensitive << in_clk.pos();
 	}
 
+	/** Set the work-group slot served by this scratchpad.
+	 *
+	 * Must be called prior to simulation. Defaults to slot 0.
+	 * @param w Work-group slot. */
+	void
+	set_wg(unsigned int w)
+	{
+		stridesequencer.set_wg(w);
+		storagearray.set_wg(w);
+	}
+
 	/** Elaborate design. */
 	void
 	elaborate(void)
@@ -153,10 +166,13 @@ public:
 		storagearray.in_dram_enable(in_dram_enable);
 		storagearray.in_dram_dst(in_dram_dst);
 		storagearray.in_dram_write(in_dram_write);
-		storagearray.in_dram_addr(in_dram_addr);
-		storagearray.in_dram_mask(in_dram_mask);
 		storagearray.in_rf_mask(in_rf_mask);
-		for (i = 0; i < BUS_WIDTH_DRAM; i++) {
+		for (i = 0; i < DRAM_CHANS; i++) {
+			storagearray.in_dram_addr[i](in_dram_addr[i]);
+			storagearray.in_dram_mask[i](in_dram_mask[i]);
+		}
+
+		for (i = 0; i < DRAM_CHANS*BUS_WIDTH_DRAM; i++) {
 			storagearray.in_dram_data[i](in_dram_data[i]);
 		}
 
@@ -178,15 +194,23 @@ public:
 		storagearray.debug_upload_test_pattern(addr, words);
 	}
 
+	/** Return the raw scratchpad data, for checkpointing.
+	 * @return Pointer to SIZE_BYTES of scratchpad data. */
+	uint32_t *
+	debug_sp_image(void)
+	{
+		return storagearray.debug_sp_image();
+	}
+
 private:
 	/** The stride descriptor front-end. */
-	StrideSequencer<WG,BUS_WIDTH,THREADS> stridesequencer;
+	StrideSequencer<BUS_WIDTH,THREADS> stridesequencer;
 
 	/** An idle pipeline stage to wait for register file data. */
 	DQ<BUS_WIDTH,THREADS> dq;
 
 	/** The storage array. */
-	StorageArray<WG,BUS_WIDTH_DRAM, BUS_WIDTH,SIZE_BYTES> storagearray;
+	StorageArray<BUS_WIDTH_DRAM,BUS_WIDTH,SIZE_BYTES,DRAM_CHANS> storagearray;
 
 	/** FIFO from stride sequencer to DQ scheduler */
 	sc_fifo<sp_model::DQ_reservation<BUS_WIDTH,THREADS> >
@@ -20,10 +20,13 @@
 #define SP_CONTROL_STORAGEARRAY_H
 
 #include <systemc>
+#include <cassert>
 #include <cstdint>
+#include <cstring>
 
 #include "model/Register.h"
 #include "util/constmath.h"
+#include "util/defaults.h"
 #include "sp/model/DQ_reservation.h"
 
 using namespace sc_dt;
@@ -36,8 +39,12 @@ namespace sp_control {
 /** Simulation model for a scratchpad.
  * This assumes a hardware solution for unaligned accesses, like described in
  * US patent 6256253 "Memory device with support for unaligned access".
+ *
+ * Each DRAM channel uses its own group of BUS_WIDTH_DRAM data lanes, address
+ * and mask. Bank conflicts between DRAM channels are not modelled.
  */
-template<unsigned int WG, unsigned int BUS_WIDTH_DRAM, unsigned int BUS_WIDTH, unsigned int SIZE_BYTES>
+template<unsigned int BUS_WIDTH_DRAM, unsigned int BUS_WIDTH, unsigned int SIZE_BYTES,
+	unsigned int DRAM_CHANS = MC_DRAM_CHANS>
 class StorageArray : public sc_module
 {
 public:
@@ -68,17 +75,17 @@ public:
 	/** True iff operation is a write op */
 	sc_in<bool> in_dram_write{"in_dram_write"};
 
-	/** Address to manipulate */
-	sc_in<sc_uint<18> > in_dram_addr{"in_dram_addr"};
+	/** Address to manipulate, per DRAM channel. */
+	sc_in<sc_uint<18> > in_dram_addr[DRAM_CHANS];
 
-	/** Data bus for write data */
-	sc_in<sc_uint<32> > in_dram_data[BUS_WIDTH_DRAM];
+	/** Data bus for write data, BUS_WIDTH_DRAM lanes per DRAM channel. */
+	sc_in<sc_uint<32> > in_dram_data[DRAM_CHANS*BUS_WIDTH_DRAM];
 
-	/** Write mask, aligned to in_data. */
-	sc_in<sc_bv<BUS_WIDTH_DRAM> > in_dram_mask{"in_dram_mask"};
+	/** Write mask, aligned to in_data, per DRAM channel. */
+	sc_in<sc_bv<BUS_WIDTH_DRAM> > in_dram_mask[DRAM_CHANS];
 
 	/** Constructor */
-	SC_CTOR(StorageArray)
+	SC_CTOR(StorageArray) : wg(0)
 	{
 		SC_THREAD(thread);
 		sensitive << in_clk.pos();
@@ -90,7 +97,8 @@ public:
 	uint32_t
 	debug_sp_read(sc_uint<18> addr)
 	{
-		return sp[(addr & 0xc) >> 2][(addr & 0x3fff0) >> 4];
+		return sp[addr >> const_log2(BUS_WIDTH*4)]
+				[(addr >> 2) & (BUS_WIDTH-1)];
 	}
 
 	/** Directly write a value to scratchpad, for testing/debugging
@@ -100,7 +108,8 @@ public:
 	void
 	debug_sp_write(sc_uint<18> addr, uint32_t val)
 	{
-		sp[(addr & 0xc) >> 2][(addr & 0x3fff0) >> 4] = val;
+		sp[addr >> const_log2(BUS_WIDTH*4)]
+				[(addr >> 2) & (BUS_WIDTH-1)] = val;
 	}
 
 
@@ -138,13 +147,38 @@ public:
 			debug_sp_write(i, i - addr);
 	}
 
+	/** Return the raw scratchpad data, for checkpointing.
+	 * @return Pointer to SIZE_BYTES of scratchpad data. */
+	uint32_t *
+	debug_sp_image(void)
+	{
+		return &sp[0][0];
+	}
+
+	/** Set the work-group slot served by this storage array.
+	 * @param w Work-group slot. */
+	void
+	set_wg(unsigned int w)
+	{
+		wg = w;
+	}
+
 private:
-	/** Scratchpad data storage */
-	uint32_t sp[BUS_WIDTH][SIZE_BYTES/(4*BUS_WIDTH)];
+	/** Work-group slot served by this storage array. */
+	unsigned int wg;
 
-	/** Perform a single read */
+	/** Number of rows in the scratchpad. */
+	static constexpr unsigned int ROWS = SIZE_BYTES/(4*BUS_WIDTH);
+
+	/** Scratchpad data storage, one row of BUS_WIDTH banks per index.
+	 * Rows are contiguous, such that the image is linear in the address
+	 * and a row is read or written with a single copy. */
+	alignas(64) uint32_t sp[ROWS][BUS_WIDTH];
+
+	/** Perform a single read
+	 * @param c DRAM channel. */
 	void
-	dram_read(void)
+	dram_read(unsigned int c)
 	{
 		sc_uint<18> addr;
 		unsigned int align_phase;
@@ -152,10 +186,11 @@ private:
 		unsigned int i;
 		unsigned int bank;
 		unsigned int lbank;
-		unsigned int lidx;
-		uint32_t sp_entry;
+		unsigned int lane;
+		const uint32_t *row;
+		const uint32_t *next;
 
-		addr = in_dram_addr.read();
+		addr = in_dram_addr[c].read();
 		/** @todo This test was bogus. Should be replaced with something
 		 * meaningful iff in_mask is truly transmitted for reads */
 		//assert(addr + ((in_words.read() +  1) * 4) < SIZE_BYTES);
@@ -164,63 +199,75 @@ private:
 		bank = align_phase & ~(BUS_WIDTH_DRAM-1);
 		idx = addr >> const_log2(BUS_WIDTH*4);
 
+		/* The next row only exists below the last row. Beats that need
+		 * it past the end of the scratchpad trip the assert below. */
+		assert(idx < ROWS);
+		row = sp[idx];
+		next = (idx + 1 < ROWS) ? sp[idx + 1] : nullptr;
+
 		for (i = 0; i < BUS_WIDTH_DRAM; i++) {
 			lbank = bank + i;
-			lidx = idx;
 			if (lbank < align_phase)
 				lbank += (BUS_WIDTH_DRAM);
 
+			lane = c * BUS_WIDTH_DRAM + i;
 			if (lbank >= BUS_WIDTH) {
-				lbank = i;
-				lidx = idx + 1;
-			}
-
-			/** @todo could lead to out-of-bounds read */
-			sp_entry = sp[lbank][lidx];
-			out_data[i].write(sp_entry);
+				assert(next);
+				out_data[lane].write(next[i]);
+			} else
+				out_data[lane].write(row[lbank]);
 		}
 	}
 
-	/** Perform a single write */
+	/** Perform a single write
+	 * @param c DRAM channel. */
 	void
-	dram_write(void)
+	dram_write(unsigned int c)
 	{
 		sc_uint<18> addr;
 		unsigned int align_phase;
 		unsigned int bank;
 		unsigned int idx;
 		unsigned int lbank;
-		unsigned int lidx;
+		unsigned int lane;
 		unsigned int i;
-		sc_bv<BUS_WIDTH_DRAM> mask;
+		uint32_t mask;
+		uint32_t *row;
+		uint32_t *next;
 
-		addr = in_dram_addr.read();
-		mask = in_dram_mask.read();
-		assert(addr + (__builtin_popcount(mask.to_uint()) * 4) < SIZE_BYTES);
+		addr = in_dram_addr[c].read();
+		mask = in_dram_mask[c].read().to_uint();
+		assert(addr + (__builtin_popcount(mask) * 4) < SIZE_BYTES);
 
 		align_phase = (addr >> 2) & ((BUS_WIDTH)-1);
 		bank = align_phase & ~(BUS_WIDTH_DRAM-1);
 		idx = addr >> const_log2(BUS_WIDTH*4);
 
+		assert(idx < ROWS);
+		row = sp[idx];
+		next = (idx + 1 < ROWS) ? sp[idx + 1] : nullptr;
+
 		for (i = 0; i < BUS_WIDTH_DRAM; i++) {
-			if (!mask[i])
+			if (!(mask & (1u << i)))
 				continue;
 
 			lbank = bank + i;
-			lidx = idx;
 			if (lbank < align_phase)
 				lbank += (BUS_WIDTH_DRAM);
 
+			lane = c * BUS_WIDTH_DRAM + i;
 			if (lbank >= BUS_WIDTH) {
-				lbank = i;
-				lidx = idx + 1;
-			}
-
-			sp[lbank][lidx] = in_dram_data[i].read();
+				assert(next);
+				next[i] = in_dram_data[lane].read();
+			} else
+				row[lbank] = in_dram_data[lane].read();
 		}
 	}
 
 	/** Perform a single read.
+	 *
+	 * Lanes below the alignment phase come from the next row, hence the
+	 * data is copied out of the two rows in two contiguous runs.
 	 * @param psa StorageArray command. */
 	void
 	rf_read(dq_pipe_sa<BUS_WIDTH> &psa)
@@ -229,7 +276,7 @@ private:
 		unsigned int align_phase;
 		unsigned int idx;
 		unsigned int i;
-		uint32_t sp_entry;
+		uint32_t data[BUS_WIDTH];
 
 		addr = psa.addr;
 		/** @todo This test was bogus. Should be replaced with something
@@ -239,11 +286,16 @@ private:
 		align_phase = (addr >> 2) & ((BUS_WIDTH)-1);
 		idx = addr >> const_log2(BUS_WIDTH*4);
 
-		for (i = 0; i < BUS_WIDTH; i++) {
-			/** @todo could lead to out-of-bounds read */
-			sp_entry = sp[i][(i < align_phase ? idx + 1 : idx)];
-			out_data[i].write(sp_entry);
+		assert(idx < ROWS);
+		memcpy(&data[align_phase], &sp[idx][align_phase],
+				(BUS_WIDTH - align_phase) * sizeof(uint32_t));
+		if (align_phase) {
+			assert(idx + 1 < ROWS);
+			memcpy(data, sp[idx + 1], align_phase * sizeof(uint32_t));
 		}
+
+		for (i = 0; i < BUS_WIDTH; i++)
+			out_data[i].write(data[i]);
 	}
 
 	/** Perform a single write.
@@ -255,19 +307,48 @@ private:
 		unsigned int align_phase;
 		unsigned int idx;
 		unsigned int i;
-		sc_bv<BUS_WIDTH> mask;
+		uint32_t mask;
+		uint32_t *row;
+		uint32_t *next;
 
 		addr = psa.addr;
-		mask = psa.mask_w & in_rf_mask.read();
-		assert(addr + (__builtin_popcount(mask.to_uint()) * 4) < SIZE_BYTES);
+		mask = (psa.mask_w & in_rf_mask.read()).to_uint();
+		assert(addr + (__builtin_popcount(mask) * 4) < SIZE_BYTES);
 
 		align_phase = (addr >> 2) & ((BUS_WIDTH)-1);
 		idx = addr >> const_log2(BUS_WIDTH*4);
 
+		assert(idx < ROWS);
+		row = sp[idx];
+		next = (idx + 1 < ROWS) ? sp[idx + 1] : nullptr;
+
 		for (i = 0; i < BUS_WIDTH; i++) {
-			if (mask[i])
-				sp[i][(i < align_phase ? idx + 1 : idx)] =
-						in_rf_data[i].read();
+			if (!(mask & (1u << i)))
+				continue;
+
+			if (i < align_phase) {
+				assert(next);
+				next[i] = in_rf_data[i].read();
+			} else
+				row[i] = in_rf_data[i].read();
+		}
+	}
+
+	/** Perform a DRAM read or write for each DRAM channel transferring
+	 * data. A channel with an empty mask is idle. */
+	void
+	dram_rw(void)
+	{
+		unsigned int c;
+
+		for (c = 0; c < DRAM_CHANS; c++) {
+			if (DRAM_CHANS > 1 && !in_dram_mask[c].read().or_reduce())
+				continue;
+
+			if (in_dram_write.read())
+				dram_write(c);
+			else
+				dram_read(c);
 		}
 	}
 
@@ -282,16 +363,13 @@ private:
 			psa = in_dq_cmd.read();
 			dst = in_dram_dst.read();
 
-			if (in_dram_enable.read() && dst == RequestTarget(WG,TARGET_SP)) {
+			if (in_dram_enable.read() && dst == RequestTarget(wg,TARGET_SP)) {
 				assert(!psa.rw);
 
-				if (in_dram_write.read())
-					dram_write();
-				else
-					dram_read();
+				dram_rw();
 			} else if (psa.rw) {
 				assert(!(in_dram_enable.read() &&
-					dst == RequestTarget(WG,TARGET_SP)));
+					dst == RequestTarget(wg,TARGET_SP)));
 
 				if (psa.write_w)
 					rf_write(psa);
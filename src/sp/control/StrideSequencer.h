@@ -42,10 +42,13 @@ namespace sp_control {
  * @param BUS_WIDTH Number of 32-bit words in a burst.
  * @param THREADS Number of threads in a work-group.
  */
-template <unsigned int WG, unsigned int BUS_WIDTH, unsigned int THREADS>
+template <unsigned int BUS_WIDTH, unsigned int THREADS>
 class StrideSequencer : public sc_module
 {
 private:
+	/** Work-group slot served by this scratchpad. */
+	unsigned int wg;
+
 	/** Look-up table for increment values for small periods, such that
 	 * no more than a single overflow occurs. */
 	unsigned int increment_lut[BUS_WIDTH];
@@ -97,9 +100,13 @@ private:
 		DQ_ST_FETCH,
 		DQ_ST_INIT_STATE,
 		DQ_ST_RUNNING,
-		DQ_ST_WAIT_DONE
+		DQ_ST_WAIT_DONE,
+		DQ_ST_SIGNAL_DONE
 	} state = DQ_ST_IDLE;
 
+	/** Work-group targeted by the current descriptor. */
+	sc_uint<COMPUTE_WG_WIDTH> desc_wg;
+
 public:
 	/** DRAM clock, SDR. */
 	sc_in<bool> in_clk{"in_clk"};
@@ -113,7 +120,7 @@ public:
 
 	/** Ready to accept next descriptor. FIFO to handle crossing clock
 	 * domains. */
-	sc_fifo_out<sc_uint<1> > out_wg_done{"out_wg_done"};
+	sc_fifo_out<sc_uint<COMPUTE_WG_WIDTH> > out_wg_done{"out_wg_done"};
 
 	/** DQ finished the last transfer. */
 	sc_in<bool> in_dq_done{"in_dq_done"};
@@ -136,10 +143,11 @@ public:
 	sc_in<sc_uint<4> > in_ticket_pop{"in_ticket_pop"};
 
 	/** Construct thread, initialise LUT values. */
-	SC_CTOR(StrideSequencer) : skip(0), skip_bw(0), skip_rest(0)
+	SC_CTOR(StrideSequencer) : wg(0), skip(0), skip_bw(0), skip_rest(0),
+			desc_wg(0)
 	{
 		unsigned int i;
-		SC_THREAD(thread_lt);
+		SC_METHOD(method_lt);
 		sensitive << in_clk.pos();
 
 		increment_lut[0] = 0;
@@ -149,6 +157,14 @@ public:
 		}
 	}
 
+	/** Set the work-group slot reported upon completing a descriptor.
+	 * @param w Work-group slot. */
+	void
+	set_wg(unsigned int w)
+	{
+		wg = w;
+	}
+
 private:
 	/** Modulo operation (mod desc.period) for situations in which
 	 * increment is guaranteed to only overflow cur_phase once.
@@ -347,116 +363,120 @@ private:
 		}
 	}
 
-	/** Main thread */
+	/** Main process, evaluated on every clock edge.
+	 *
+	 * While waiting for a trigger or for space in an output FIFO, the
+	 * process is sensitive to the FIFO event instead, picking up where a
+	 * blocking read or write would have continued. */
 	void
-	thread_lt(void)
+	method_lt(void)
 	{
 		unsigned int i;
 		sc_uint<22> ph_inc;
 		sc_uint<22> addr_inc;
 		sp_model::DQ_reservation<BUS_WIDTH,THREADS> req;
 		unsigned int words;
-		AbstractRegister *reg;
 		bool overflew;
-		stride_descriptor d;
+		bool trigger;
 
 		sc_bv<BUS_WIDTH> wm;
 		array<reg_offset_t<THREADS>,BUS_WIDTH> ridx;
 
-		sc_uint<1> wg;
+		words = 0;
 
-		while (true) {
-			words = 0;
+		switch (state) {
+		case DQ_ST_IDLE:
+			if (!in_trigger.nb_read(trigger)) {
+				next_trigger(in_trigger.data_written_event());
+				return;
+			}
 
-			switch (state) {
-			case DQ_ST_IDLE:
-				/* Blocking FIFO. */
-				in_trigger.read();
+			state = DQ_ST_FETCH;
+			/* fall-through */
+		case DQ_ST_FETCH:
+			if (!in_desc_fifo.num_available()) {
+				if (out_dq_fifo.num_free() == 1) {
+					state = DQ_ST_IDLE;
+				}
 
-				state = DQ_ST_FETCH;
-				/* fall-through */
-			case DQ_ST_FETCH:
-				if (!in_desc_fifo.num_available()) {
-					if (out_dq_fifo.num_free() == 1) {
-						state = DQ_ST_IDLE;
-					}
+				break;
+			}
 
-					break;
-				}
+			state = DQ_ST_INIT_STATE;
+			in_desc_fifo.nb_read(desc);
+			/* fall-through */
+		case DQ_ST_INIT_STATE:
+			if (in_sched_opts.read()[WSS_NO_PARALLEL_DRAM_SP] &&
+			    in_ticket_pop.read() != desc.ticket)
+				break;
 
-				state = DQ_ST_INIT_STATE;
-				in_desc_fifo.read(desc);
-				/* fall-through */
-			case DQ_ST_INIT_STATE:
-				if (in_sched_opts.read()[WSS_NO_PARALLEL_DRAM_SP] &&
-				    in_ticket_pop.read() != desc.ticket)
-					break;
+			state = DQ_ST_RUNNING;
 
-				state = DQ_ST_RUNNING;
-				d = desc;
-				req.sp_offset = 0;
-				req.rw = true;
+			assert(desc.getTargetType() != TARGET_SP);
 
-				assert(desc.getTargetType() != TARGET_SP);
+			desc_wg = desc.getTargetReg().wg;
+			out_rf_reg_w.write(desc.getTargetReg());
 
-				reg = desc.getTargetReg();
-				wg = reg->wg;
-				out_rf_reg_w.write(*reg);
-				delete reg;
-				reg = nullptr;
+			out_write.write(!desc.write);
 
-				out_write.write(!d.write);
+			init_request_regs();
+			break;
+		case DQ_ST_RUNNING:
+			if (!out_dq_fifo.num_free()) {
+				next_trigger(out_dq_fifo.data_read_event());
+				return;
+			}
 
-				init_request_regs();
-				break;
-			case DQ_ST_RUNNING:
-				for (i = 0; i < BUS_WIDTH; i++) {
-					wm[i] = word_mask_select(i);
-					if (wm[i]) {
-						words++;
-						ridx[i] = regIdx(desc.getTargetType(), i);
-					}
+			for (i = 0; i < BUS_WIDTH; i++) {
+				wm[i] = word_mask_select(i);
+				if (wm[i]) {
+					words++;
+					ridx[i] = regIdx(desc.getTargetType(), i);
 				}
+			}
 
-				addr_inc = address_increment(phase[BUS_WIDTH - 1]);
-				ph_inc = phase_increment(addr_inc);
+			addr_inc = address_increment(phase[BUS_WIDTH - 1]);
+			ph_inc = phase_increment(addr_inc);
 
-				for (i = 0; i < BUS_WIDTH; i++) {
-					line[i] += line_increment;
-					phase[i] = single_overflow_modulo(
-							phase[i], ph_inc,
-							&overflew);
-					if (overflew || ph_inc == 0)
-						line[i]++;
-				}
+			for (i = 0; i < BUS_WIDTH; i++) {
+				line[i] += line_increment;
+				phase[i] = single_overflow_modulo(phase[i], ph_inc,
+						&overflew);
+				if (overflew || ph_inc == 0)
+					line[i]++;
+			}
 
-				req = sp_model::DQ_reservation<BUS_WIDTH,THREADS>(
-						global_addr,wm,desc.write,
-						desc.getTargetType(),ridx);
+			req = sp_model::DQ_reservation<BUS_WIDTH,THREADS>(
+					global_addr,wm,desc.write,
+					desc.getTargetType(),ridx);
 
-				global_addr += (addr_inc << 2);
-				local_idx += addr_inc;
+			global_addr += (addr_inc << 2);
+			local_idx += addr_inc;
 
-				if (global_addr >= end_addr) {
-					req.last = true;
-					out_dq_fifo.write(req);
-					state = DQ_ST_WAIT_DONE;
-				} else {
-					req.last = false;
-					out_dq_fifo.write(req);
-				}
-				break;
-			case DQ_ST_WAIT_DONE:
-				if (in_dq_done.read()) {
-					state = DQ_ST_FETCH;
-					out_wg_done.write(WG);
-					out_rf_reg_w.write(AbstractRegister());
-					//debug_print_fe(d, cycle_end - cycle_start);
-				}
+			if (global_addr >= end_addr) {
+				req.last = true;
+				out_dq_fifo.nb_write(req);
+				state = DQ_ST_WAIT_DONE;
+			} else {
+				req.last = false;
+				out_dq_fifo.nb_write(req);
+			}
+			break;
+		case DQ_ST_WAIT_DONE:
+			if (!in_dq_done.read())
 				break;
+
+			state = DQ_ST_SIGNAL_DONE;
+			/* fall-through */
+		case DQ_ST_SIGNAL_DONE:
+			if (!out_wg_done.nb_write(desc_wg)) {
+				next_trigger(out_wg_done.data_read_event());
+				return;
 			}
 
-			wait();
+			state = DQ_ST_FETCH;
+			out_rf_reg_w.write(AbstractRegister());
+			break;
 		}
 	}
 };
@@ -55,7 +55,7 @@ public:
 	sc_fifo_out<bool> out_trigger{"out_trigger"};
 
 	/** True iff transfer is completed. */
-	sc_fifo_in<sc_uint<1> > in_wg_done{"in_wg_done"};
+	sc_fifo_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg_done{"in_wg_done"};
 
 	/** R/W enable bit. */
 	sc_in<bool> in_rf_enable{"in_rf_enable"};
@@ -131,7 +131,7 @@ main(int argc, char **argv)
 	sc_signal<sc_uint<32> > data[4];
 	sc_fifo<stride_descriptor> desc_fifo(1);
 	sc_fifo<bool> trigger(2);
-	sc_fifo<sc_uint<1> > wg_done;
+	sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > wg_done;
 	sc_signal<bool> rf_enable;
 	sc_signal<bool> rf_write;
 	sc_signal<AbstractRegister> rf_reg;
@@ -147,7 +147,7 @@ main(int argc, char **argv)
 	sc_signal<sc_uint<32> > dram_data[4];
 	sc_signal<sc_bv<4> > dram_mask;
 
-	Scratchpad<0,4,4,16384,1024> sp("sp");
+	Scratchpad<4,4,16384,1024,1> sp("sp");
 	Test_Scratchpad<4,16384,1024> sp_test("sp_test");
 
 	sp.in_clk(clk);
@@ -164,8 +164,8 @@ main(int argc, char **argv)
 	sp.in_dram_enable(dram_enable);
 	sp.in_dram_dst(dram_dst);
 	sp.in_dram_write(dram_write);
-	sp.in_dram_addr(dram_addr);
-	sp.in_dram_mask(dram_mask);
+	sp.in_dram_addr[0](dram_addr);
+	sp.in_dram_mask[0](dram_mask);
 
 	sp_test.in_clk(clk);
 	sp_test.out_sched_opts(sched_opts);
@@ -250,7 +250,7 @@ sc_main(int argc, char* argv[])
 	sc_signal<sc_uint<18> > addr;
 	sc_signal<sc_bv<4> > mask;
 
-	StorageArray<0,4,4,131072> sa("my_sp");
+	StorageArray<4,4,131072,1> sa("my_sp");
 	Test_StorageArray<0,4,131072> sa_test("my_sp_test");
 
 	sa.in_clk(clk);
@@ -259,8 +259,8 @@ sc_main(int argc, char* argv[])
 	sa.in_dram_enable(enable);
 	sa.in_dram_dst(dram_dst);
 	sa.in_dram_write(write);
-	sa.in_dram_addr(addr);
-	sa.in_dram_mask(mask);
+	sa.in_dram_addr[0](addr);
+	sa.in_dram_mask[0](mask);
 
 	sa_test.in_clk(clk);
 	sa_test.out_dq_cmd(dq_cmd);
@@ -127,7 +127,7 @@ public:
 	sc_fifo_out<bool> out_trigger{"out_trigger"};
 
 	/** Ready to accept next descriptor */
-	sc_fifo_in<sc_uint<1> > in_wg_done{"in_wg_done"};
+	sc_fifo_in<sc_uint<COMPUTE_WG_WIDTH> > in_wg_done{"in_wg_done"};
 
 	/** DQ finished the last transfer. */
 	sc_inout<bool> out_dq_done{"out_dq_done"};
@@ -170,7 +170,7 @@ private:
 		wait();
 
 		if (desc.getTargetType() == TARGET_REG)
-			assert(*(desc.getTargetReg()) == in_rf_reg_w.read());
+			assert(desc.getTargetReg() == in_rf_reg_w.read());
 
 		i = 0;
 
@@ -268,7 +268,7 @@ sc_main(int argc, char* argv[])
 	sc_fifo<bool> trigger(2);
 	sc_signal<sc_uint<32> > addr;
 	sc_signal<sc_bv<4> > wordmask;
-	sc_fifo<sc_uint<1> > wg_done;
+	sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > wg_done;
 	sc_signal<bool> dq_done;
 	sc_signal<bool> write;
 	sc_signal<AbstractRegister> rf_reg_w;
@@ -281,7 +281,7 @@ sc_main(int argc, char* argv[])
 
 	sc_clock clk("clk", sc_time(10./16., SC_NS));
 
-	StrideSequencer<0,4,COMPUTE_THREADS> my_sseq("my_sseq");
+	StrideSequencer<4,COMPUTE_THREADS> my_sseq("my_sseq");
 	my_sseq.in_clk(clk);
 	my_sseq.in_desc_fifo(desc_fifo);
 	my_sseq.in_trigger(trigger);
@@ -0,0 +1,249 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "util/compare.h"
+
+using namespace std;
+
+/** Minimum number of words per thread, avoids spawning threads for small
+ * buffers. */
+#define CMP_MIN_CHUNK 65536
+
+/** Map a float onto an integer, such that the difference between two mapped
+ * values is their distance in ULPs.
+ * @param f Float.
+ * @return Ordered integer representation of f. */
+static inline int64_t
+cmp_ordered(float f)
+{
+	int32_t i;
+
+	memcpy(&i, &f, sizeof(i));
+
+	return (i < 0) ? int64_t(INT32_MIN) - i : i;
+}
+
+/** Return the histogram bucket for a given ULP distance.
+ * @param ulp ULP distance.
+ * @return Bucket index. */
+static inline unsigned int
+cmp_bucket(uint64_t ulp)
+{
+	if (ulp == 0)
+		return 0;
+
+	return min(64u - __builtin_clzll(ulp), (unsigned int)
+			(CMP_ULP_BUCKETS - 1));
+}
+
+/** Compare a chunk of words.
+ * @param res Result buffer, offset to the start of the chunk.
+ * @param gold Golden values, offset to the start of the chunk.
+ * @param words Number of words in this chunk.
+ * @param base Index of the first word in this chunk.
+ * @param delta Tolerated error.
+ * @param dfrac True iff delta is relative.
+ * @param s Statistics object for this chunk. */
+static void
+cmp_chunk(const float *res, const float *gold, size_t words, size_t base,
+		float delta, bool dfrac, cmp_stats *s)
+{
+	size_t i;
+	float abs_err, rel_err, err;
+	float max_abs = 0.f, max_rel = 0.f;
+	uint64_t ulp;
+	bool nan;
+
+	memset(s, 0, sizeof(*s));
+	s->words = words;
+
+	/* Error maxima. Kept free of branches and calls such that the
+	 * compiler can vectorise it. */
+	for (i = 0; i < words; i++) {
+		abs_err = fabsf(gold[i] - res[i]);
+		rel_err = fabsf((res[i] / gold[i]) - 1.f);
+		max_abs = abs_err > max_abs ? abs_err : max_abs;
+		max_rel = rel_err > max_rel ? rel_err : max_rel;
+	}
+	s->max_abs = max_abs;
+	s->max_rel = max_rel;
+
+	for (i = 0; i < words; i++) {
+		nan = isnan(res[i]) || isnan(gold[i]);
+		ulp = llabs(cmp_ordered(res[i]) - cmp_ordered(gold[i]));
+		s->ulp_hist[nan ? CMP_ULP_BUCKETS - 1 : cmp_bucket(ulp)]++;
+
+		if (dfrac)
+			err = fabsf((res[i] / gold[i]) - 1.f);
+		else
+			err = fabsf(gold[i] - res[i]);
+
+		/* A NaN error (e.g. NaN results, or 0/0 for relative
+		 * errors) only counts as a mismatch if the words differ. */
+		if (ulp != 0 && !(err <= delta)) {
+			if (s->reported < CMP_MAX_REPORT)
+				s->mismatch_idx[s->reported++] = base + i;
+			s->mismatches++;
+		}
+	}
+}
+
+void
+cmp_float_buffers(const float *res, const float *gold, size_t words,
+		float delta, bool dfrac, cmp_stats *s, unsigned int threads)
+{
+	vector<cmp_stats> cs;
+	vector<thread> ts;
+	size_t chunk;
+	unsigned int t, i, j;
+
+	if (threads == 0)
+		threads = max(1l, sysconf(_SC_NPROCESSORS_ONLN));
+
+	threads = max(1ul, min(size_t(threads), words / CMP_MIN_CHUNK));
+	chunk = (words + threads - 1) / threads;
+	cs.resize(threads);
+
+	for (t = 0; t < threads; t++) {
+		size_t b = min(words, t * chunk);
+		size_t n = min(words - b, chunk);
+
+		ts.emplace_back(cmp_chunk, res + b, gold + b, n, b, delta,
+				dfrac, &cs[t]);
+	}
+
+	memset(s, 0, sizeof(*s));
+
+	/* Merge in chunk order, keeping the lowest mismatch indexes. */
+	for (t = 0; t < threads; t++) {
+		ts[t].join();
+
+		s->words += cs[t].words;
+		s->mismatches += cs[t].mismatches;
+		s->max_abs = max(s->max_abs, cs[t].max_abs);
+		s->max_rel = max(s->max_rel, cs[t].max_rel);
+
+		for (i = 0; i < CMP_ULP_BUCKETS; i++)
+			s->ulp_hist[i] += cs[t].ulp_hist[i];
+
+		for (j = 0; j < cs[t].reported &&
+				s->reported < CMP_MAX_REPORT; j++)
+			s->mismatch_idx[s->reported++] = cs[t].mismatch_idx[j];
+	}
+}
+
+void
+cmp_print(ostream &os, const cmp_stats &s)
+{
+	unsigned int i;
+
+	os << "  Max abs. error: " << s.max_abs << ", max rel. error: " <<
+		s.max_rel << endl;
+	os << "  ULP distance histogram:" << endl;
+
+	for (i = 0; i < CMP_ULP_BUCKETS; i++) {
+		if (!s.ulp_hist[i])
+			continue;
+
+		if (i == 0)
+			os << "    0\t\t: ";
+		else if (i == CMP_ULP_BUCKETS - 1)
+			os << "    >= 2^" << (i - 1) << "/NaN\t: ";
+		else
+			os << "    < 2^" << i << "\t: ";
+
+		os << s.ulp_hist[i] << endl;
+	}
+}
+
+/** Print a string as a JSON string literal.
+ * @param os Output stream.
+ * @param str String to print. */
+static void
+cmp_json_string(ostream &os, const string &str)
+{
+	static const char hexdigits[] = "0123456789abcdef";
+	unsigned char c;
+
+	os << '"';
+	for (char ch : str) {
+		c = (unsigned char) ch;
+		if (c == '"' || c == '\\')
+			os << '\\' << ch;
+		else if (c == '\n')
+			os << "\\n";
+		else if (c == '\t')
+			os << "\\t";
+		else if (c < 0x20)
+			os << "\\u00" << hexdigits[c >> 4] << hexdigits[c & 0xf];
+		else
+			os << ch;
+	}
+	os << '"';
+}
+
+/** Print a double as a JSON number, or null if it is not finite.
+ * @param os Output stream.
+ * @param d Value to print. */
+static void
+cmp_json_double(ostream &os, double d)
+{
+	if (isfinite(d))
+		os << d;
+	else
+		os << "null";
+}
+
+void
+cmp_print_json(ostream &os, const cmp_stats &s, const string &name)
+{
+	unsigned int i;
+
+	os << "{\"name\": ";
+	cmp_json_string(os, name);
+	os << ", \"ok\": " << (!s.error && !s.mismatches ? "true" : "false") <<
+		", \"error\": ";
+	if (s.error)
+		cmp_json_string(os, s.error);
+	else
+		os << "null";
+
+	os << ", \"words\": " << s.words << ", \"mismatches\": " <<
+		s.mismatches << ", \"max_abs_error\": ";
+	cmp_json_double(os, s.max_abs);
+	os << ", \"max_rel_error\": ";
+	cmp_json_double(os, s.max_rel);
+	os << ", \"ulp_histogram\": [";
+
+	for (i = 0; i < CMP_ULP_BUCKETS; i++)
+		os << (i ? ", " : "") << s.ulp_hist[i];
+
+	os << "], \"first_mismatches\": [";
+
+	for (i = 0; i < s.reported; i++)
+		os << (i ? ", " : "") << s.mismatch_idx[i];
+
+	os << "]}";
+}
@@ -20,98 +20,171 @@
 #include <cstdint>
 #include <cerrno>
 #include <cinttypes>
-
-int64_t csv_file_count(const char *file)
+#include <cstring>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/** Initial number of elements allocated for a parse buffer. */
+#define CSV_BUF_INIT 4096
+
+/** Map a file into memory, read-only.
+ * @param file Path to the file.
+ * @param len Pointer to store the length of the file in.
+ * @return Pointer to the file contents, nullptr for an empty file, or
+ * 	   MAP_FAILED if the file could not be opened or mapped. */
+static const char *
+csv_map(const char *file, size_t *len)
 {
-	int64_t c = 0;
-	float tmp;
-	FILE *fp;
-
-	fp = fopen(file, "r");
-	if (!fp) {
+	int fd;
+	struct stat st;
+	void *map;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		if (fd >= 0)
+			close(fd);
 		fprintf(stderr, "Could not open csv file %s\n", file);
-		return -EINVAL;
+		return (const char *) MAP_FAILED;
 	}
 
-	while (fscanf(fp, "%f%*[, ]", &tmp) > 0) {
-		c++;
+	*len = st.st_size;
+	if (*len == 0) {
+		close(fd);
+		return nullptr;
+	}
+
+	map = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Could not map csv file %s\n", file);
+		return (const char *) MAP_FAILED;
 	}
 
-	fclose(fp);
+	madvise(map, *len, MADV_SEQUENTIAL);
 
-	return c;
+	return (const char *) map;
 }
 
-int64_t csv_file_read(char *file, int **buf)
+/** Parse the next value in a mapped CSV file.
+ *
+ * Leading separators (whitespace, commas) are skipped. Equivalent to
+ * fscanf(fp, "%f%*[, ]") (resp. "%d"), except that a leading '+' is the only
+ * sign accepted besides '-', and hexadecimal floats are not supported.
+ * @param p Pointer to the current position, advanced past the value.
+ * @param end End of the mapped file.
+ * @param val Reference to store the parsed value in.
+ * @return True iff a value was parsed. */
+template <typename T>
+static bool
+csv_next(const char **p, const char *end, T &val)
 {
-	int64_t count, i;
-	int tmp;
-	FILE *fp;
+	const char *c = *p;
+	from_chars_result r;
 
-	count = csv_file_count(file);
-	if (count < 0)
-		return -1;
+	while (c < end && (*c == ',' || *c == ' ' || *c == '\n' ||
+			*c == '\r' || *c == '\t'))
+		c++;
 
-	*buf = new int[count];
-	if (!*buf) {
-		fprintf(stderr, "Could not allocate memory for data buffer\n");
-		return -1;
-	}
+	if (c < end && *c == '+')
+		c++;
 
-	fp = fopen(file, "r");
-	if (!fp) {
-		delete[] *buf;
-		*buf = nullptr;
+	if (c >= end)
+		return false;
 
-		fprintf(stderr, "Could not open csv file %s\n", file);
+	r = from_chars(c, end, val);
+	if (r.ec != errc())
+		return false;
+
+	*p = r.ptr;
+	return true;
+}
+
+/** Read all values in a CSV file in a single pass.
+ * @param file Path to the file.
+ * @param buf Pointer to store a new[]-allocated buffer of values in. May be
+ * 	      larger than the number of values returned. Set to nullptr if
+ * 	      count_only is true.
+ * @param count_only True iff values should only be counted, not stored.
+ * @return The number of values read, negative on error. */
+template <typename T>
+static int64_t
+csv_parse(const char *file, T **buf, bool count_only = false)
+{
+	const char *map, *p, *end;
+	size_t len = 0;
+	int64_t count = 0;
+	int64_t size = 0;
+	T val;
+	T *nbuf;
+
+	*buf = nullptr;
+
+	map = csv_map(file, &len);
+	if (map == (const char *) MAP_FAILED)
 		return -EINVAL;
+
+	p = map;
+	end = map + len;
+
+	if (!count_only) {
+		size = CSV_BUF_INIT;
+		*buf = new T[size];
 	}
 
-	for (i = 0; i < count; i++) {
-		tmp = fscanf(fp, "%d%*[, ]", *buf+i);
-		if (tmp <= 0)
-			break;
+	while (map && csv_next(&p, end, val)) {
+		if (!count_only) {
+			if (count == size) {
+				size *= 2;
+				nbuf = new T[size];
+				memcpy(nbuf, *buf, count * sizeof(T));
+				delete[] *buf;
+				*buf = nbuf;
+			}
+
+			(*buf)[count] = val;
+		}
+		count++;
 	}
 
-	fclose(fp);
+	if (map)
+		munmap((void *) map, len);
 
-	return i;
+	return count;
 }
 
-int64_t csv_file_read_float(const char *file, float **buf)
+int64_t csv_file_count(const char *file)
 {
-	int64_t count, i;
-	int tmp;
-	FILE *fp;
+	float *buf;
 
-	count = csv_file_count(file);
-	if (count < 0)
-		return -1;
+	return csv_parse<float>(file, &buf, true);
+}
 
-	*buf = new float[count];
-	if (!*buf) {
-		fprintf(stderr, "Could not allocate memory for data buffer\n");
-		return -1;
-	}
+int64_t csv_file_read(char *file, int **buf)
+{
+	int64_t count;
 
-	fp = fopen(file, "r");
-	if (!fp) {
-		delete[] *buf;
-		*buf = nullptr;
+	count = csv_parse<int>(file, buf);
+	if (count < 0)
+		return -1;
 
-		fprintf(stderr, "Could not open csv file %s\n", file);
-		return -EINVAL;
-	}
+	return count;
+}
 
-	for (i = 0; i < count; i++) {
-		tmp = fscanf(fp, "%f%*[, ]", *buf+i);
-		if (tmp <= 0)
-			break;
-	}
+int64_t csv_file_read_float(const char *file, float **buf)
+{
+	int64_t count;
 
-	fclose(fp);
+	count = csv_parse<float>(file, buf);
+	if (count < 0)
+		return -1;
 
-	return i;
+	return count;
 }
 
 /*
@@ -120,56 +193,32 @@ int64_t csv_file_read_float(const char *file, float **buf)
 int64_t csv_file_read_float_n(char *file, int n, float ***buf)
 {
 	int64_t count, i;
-	int tmp;
-	FILE *fp;
+	float *vals;
 
-	count = csv_file_count(file);
+	count = csv_parse<float>(file, &vals);
 	if (count < 0)
 		return -1;
 
 	if (count % n != 0) {
 		fprintf(stderr, "Incomplete n-tuple found %" PRIu64 "\n", count);
+		delete[] vals;
 		return -1;
 	}
 
 	*buf = new float*[n];
-	if (!*buf) {
-		fprintf(stderr, "Could not allocate memory for data buffer\n");
-		return -1;
-	}
 
 	/* Make one large contiguous buffer for easier param passing */
 	(*buf)[0] = new float[count];
-	if (!(*buf)[0]) {
-		delete[] *buf;
-		*buf = nullptr;
-
-		fprintf(stderr, "Could not allocate memory for data "
-				"buffer\n");
-		return -1;
-	}
 
 	for (i = 1; i < n; i++) {
 		(*buf)[i] = (*buf)[0] + i * (count / n);
 	}
 
-	fp = fopen(file, "r");
-	if (!fp) {
-		delete[] *buf[0];
-		delete[] *buf;
-		*buf = nullptr;
-
-		fprintf(stderr, "Could not open csv file %s\n", file);
-		return -EINVAL;
-	}
-
-	for (i = 0; i < count; i++) {
-		tmp = fscanf(fp, "%f%*[, ]", (*buf)[i % n]+(i / n));
-		if (tmp <= 0)
-			break;
-	}
+	/* Transpose the "array of structs" file into "struct of arrays". */
+	for (i = 0; i < count; i++)
+		(*buf)[i % n][i / n] = vals[i];
 
-	fclose(fp);
+	delete[] vals;
 
-	return i/n;
+	return count/n;
 }
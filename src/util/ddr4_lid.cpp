@@ -189,6 +189,25 @@ bursts(const dram_timing *dram, size_t request_length, int aligned)
 	return bursts;
 }
 
+size_t
+chan_bursts(const dram_timing *dram, size_t request_length, int aligned,
+		unsigned int chans, unsigned int interleave)
+{
+	size_t b = bursts(dram, request_length, aligned);
+	size_t chunk = interleave / (dram->BL * dram->buswidth_B);
+	size_t chunks;
+
+	if (chans == 1 || chunk == 0)
+		return b;
+
+	/* An unaligned transfer can touch one more interleaving chunk. */
+	chunks = (b + chunk - 1) / chunk;
+	if (!aligned)
+		chunks++;
+
+	return min(b, ((chunks + chans - 1) / chans) * chunk);
+}
+
 uint32_t
 least_issue_delay_rd_ddr4(const dram_timing *dram, size_t bursts, int aligned)
 {
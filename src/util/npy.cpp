@@ -0,0 +1,254 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2020 Roy Spliet, University of Cambridge
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "util/npy.h"
+
+using namespace std;
+
+/** Length of the .npy magic string, "\x93NUMPY". */
+#define NPY_MAGIC_LEN 6
+
+/** Alignment of the data section. */
+#define NPY_ALIGN 64
+
+/** Find the value of a key in a .npy header dictionary.
+ * @param hdr Header dictionary string.
+ * @param key Key, without quotes.
+ * @param val Reference to store the remainder of the header after the colon
+ * 	      in, leading whitespace stripped.
+ * @return True iff the key was found. */
+static bool
+npy_dict_find(const string &hdr, const char *key, string &val)
+{
+	string::size_type pos;
+
+	pos = hdr.find(string("'") + key + "'");
+	if (pos == string::npos)
+		return false;
+
+	pos = hdr.find(':', pos);
+	if (pos == string::npos)
+		return false;
+
+	pos = hdr.find_first_not_of(" \t", pos + 1);
+	if (pos == string::npos)
+		return false;
+
+	val = hdr.substr(pos);
+	return true;
+}
+
+/** Parse a .npy header dictionary.
+ * @param hdr Header dictionary string.
+ * @param v View to store shape and type information in.
+ * @return True iff the header describes a supported array. */
+static bool
+npy_parse_header(const string &hdr, npy_view *v)
+{
+	string val;
+	const char *p;
+	char *end;
+	unsigned long dim;
+
+	if (!npy_dict_find(hdr, "descr", val))
+		return false;
+
+	if (val.compare(0, 5, "'<f4'") == 0)
+		v->is_float = true;
+	else if (val.compare(0, 5, "'<i4'") == 0 ||
+		 val.compare(0, 5, "'<u4'") == 0)
+		v->is_float = false;
+	else
+		return false;
+
+	if (!npy_dict_find(hdr, "fortran_order", val) ||
+	    val.compare(0, 5, "False") != 0)
+		return false;
+
+	if (!npy_dict_find(hdr, "shape", val) || val[0] != '(')
+		return false;
+
+	v->ndims = 0;
+	v->elems = 1;
+	p = val.c_str() + 1;
+	while (true) {
+		while (*p == ' ')
+			p++;
+
+		if (*p == ')')
+			break;
+
+		dim = strtoul(p, &end, 10);
+		if (end == p || v->ndims == 2)
+			return false;
+
+		v->shape[v->ndims++] = dim;
+		v->elems *= dim;
+
+		p = end;
+		while (*p == ' ')
+			p++;
+		if (*p == ',')
+			p++;
+	}
+
+	return (v->ndims > 0);
+}
+
+int
+npy_map(const char *file, npy_view *v)
+{
+	int fd;
+	struct stat st;
+	const unsigned char *b;
+	size_t hdr_len, data_off;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	if (fstat(fd, &st) < 0 || st.st_size < NPY_MAGIC_LEN + 4) {
+		close(fd);
+		return -EINVAL;
+	}
+
+	v->map_len = st.st_size;
+	v->map = mmap(NULL, v->map_len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (v->map == MAP_FAILED)
+		return -errno;
+
+	b = (const unsigned char *) v->map;
+	if (memcmp(b, "\x93NUMPY", NPY_MAGIC_LEN) != 0)
+		goto npy_inval;
+
+	if (b[6] == 1) {
+		hdr_len = b[8] | (b[9] << 8);
+		data_off = 10 + hdr_len;
+	} else if (b[6] == 2 || b[6] == 3) {
+		/* Version 2+ has a 4-byte header length. */
+		if (v->map_len < NPY_MAGIC_LEN + 6)
+			goto npy_inval;
+
+		hdr_len = b[8] | (b[9] << 8) | (b[10] << 16) |
+				((size_t) b[11] << 24);
+		data_off = 12 + hdr_len;
+	} else {
+		goto npy_inval;
+	}
+
+	if (data_off > v->map_len ||
+	    !npy_parse_header(string((const char *) &b[data_off - hdr_len],
+	    hdr_len), v))
+		goto npy_inval;
+
+	if (data_off + v->elems * sizeof(uint32_t) > v->map_len)
+		goto npy_inval;
+
+	v->data = (uint32_t *) &b[data_off];
+	madvise(v->map, v->map_len, MADV_SEQUENTIAL);
+
+	return 0;
+
+npy_inval:
+	munmap(v->map, v->map_len);
+	v->map = nullptr;
+	return -EINVAL;
+}
+
+int
+npy_create(const char *file, size_t dim_x, size_t dim_y, npy_view *v)
+{
+	int fd;
+	string hdr;
+	size_t data_off;
+	unsigned char *b;
+
+	hdr = "{'descr': '<f4', 'fortran_order': False, 'shape': (" +
+		to_string(dim_y) + ", " + to_string(dim_x) + "), }";
+
+	/* Pad with spaces and a terminating newline, such that data is
+	 * aligned. */
+	data_off = (10 + hdr.size() + 1 + NPY_ALIGN - 1) & ~(NPY_ALIGN - 1);
+	hdr.append(data_off - 10 - hdr.size() - 1, ' ');
+	hdr.append("\n");
+
+	v->ndims = 2;
+	v->shape[0] = dim_y;
+	v->shape[1] = dim_x;
+	v->elems = dim_x * dim_y;
+	v->is_float = true;
+	v->map_len = data_off + v->elems * sizeof(uint32_t);
+
+	fd = open(file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return -errno;
+
+	if (ftruncate(fd, v->map_len) < 0) {
+		close(fd);
+		return -errno;
+	}
+
+	v->map = mmap(NULL, v->map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	close(fd);
+
+	if (v->map == MAP_FAILED)
+		return -errno;
+
+	b = (unsigned char *) v->map;
+	memcpy(b, "\x93NUMPY", NPY_MAGIC_LEN);
+	b[6] = 1;
+	b[7] = 0;
+	b[8] = hdr.size() & 0xff;
+	b[9] = (hdr.size() >> 8) & 0xff;
+	memcpy(&b[10], hdr.c_str(), hdr.size());
+
+	v->data = (uint32_t *) &b[data_off];
+
+	return 0;
+}
+
+bool
+npy_match_dims(const npy_view *v, size_t dim_x, size_t dim_y)
+{
+	if (v->ndims == 1)
+		return v->shape[0] == dim_x * dim_y;
+
+	return (v->shape[0] == dim_y && v->shape[1] == dim_x);
+}
+
+void
+npy_unmap(npy_view *v)
+{
+	if (v->map && v->map != MAP_FAILED)
+		munmap(v->map, v->map_len);
+
+	v->map = nullptr;
+	v->data = nullptr;
+}
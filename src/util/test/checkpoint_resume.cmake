@@ -0,0 +1,76 @@
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Copyright (C) 2020 Roy Spliet, University of Cambridge
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or (at your option) any later
+# version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+# Regression test for checkpoint and resume of main. Runs CMD with ARGS three
+# times: once plainly, once stopping at work-group WG with -C, and once resuming
+# from that checkpoint with -R. Fails unless the plain and the resumed run
+# leave identical contents in each buffer listed in BUFFERS. Timing may
+# legitimately differ, as DRAM rows left open at the checkpoint are not saved,
+# so only the final buffer contents are compared.
+#
+# Usage: cmake -DCMD=<binary> "-DARGS=<arg;arg;...>" -DWG=<wg>
+#              "-DBUFFERS=<buf;buf;...>" -DWORKDIR=<dir> -DTMPDIR=<dir>
+#              -P checkpoint_resume.cmake
+
+if (NOT DEFINED CMD OR NOT DEFINED WG OR NOT DEFINED BUFFERS OR
+    NOT DEFINED WORKDIR OR NOT DEFINED TMPDIR)
+	message(FATAL_ERROR "checkpoint_resume: CMD, WG, BUFFERS, WORKDIR and "
+		"TMPDIR are required")
+endif ()
+
+file(MAKE_DIRECTORY ${TMPDIR})
+set(ckpt ${TMPDIR}/resume.ckpt)
+file(REMOVE ${ckpt})
+
+foreach (mode plain checkpoint resume)
+	set(mode_args)
+	if (mode STREQUAL "checkpoint")
+		list(APPEND mode_args -C ${WG},${ckpt})
+	else ()
+		if (mode STREQUAL "resume")
+			list(APPEND mode_args -R ${ckpt})
+		endif ()
+		foreach (buf ${BUFFERS})
+			list(APPEND mode_args -o ${buf},${TMPDIR}/${mode}_${buf}.bin)
+		endforeach ()
+	endif ()
+
+	execute_process(COMMAND ${CMD} ${mode_args} ${ARGS}
+		WORKING_DIRECTORY ${WORKDIR}
+		OUTPUT_VARIABLE out
+		RESULT_VARIABLE res)
+	if (NOT res EQUAL 0)
+		message(FATAL_ERROR "checkpoint_resume: ${mode} run failed (${res})\n"
+			"${out}")
+	endif ()
+endforeach ()
+
+if (NOT EXISTS ${ckpt})
+	message(FATAL_ERROR "checkpoint_resume: no checkpoint written at "
+		"work-group ${WG}")
+endif ()
+
+foreach (buf ${BUFFERS})
+	execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files
+			${TMPDIR}/plain_${buf}.bin ${TMPDIR}/resume_${buf}.bin
+		RESULT_VARIABLE res)
+	if (NOT res EQUAL 0)
+		message(FATAL_ERROR "checkpoint_resume: buffer ${buf} differs "
+			"between the plain and the resumed run")
+	endif ()
+endforeach ()
@@ -0,0 +1,57 @@
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Copyright (C) 2020 Roy Spliet, University of Cambridge
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or (at your option) any later
+# version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+# Regression test for command-line flags that must not change the results of a
+# simulation, like -F (fork a process per alignment) of the mc, mcIdx and
+# wcet binaries, or -Q (skip quiescent clock edges) of main. Runs CMD with ARGS
+# once as-is and once with FLAG prepended, and fails unless both print
+# identical results from the line MARKER onwards. Output preceding MARKER, like
+# SystemC banners and stop messages, may legitimately differ.
+#
+# Usage: cmake -DCMD=<binary> "-DARGS=<arg;arg;...>" -DFLAG=<flag>
+#              "-DMARKER=<line>" -P compare_flag.cmake
+
+if (NOT DEFINED CMD OR NOT DEFINED FLAG OR NOT DEFINED MARKER)
+	message(FATAL_ERROR "compare_flag: CMD, FLAG and MARKER are required")
+endif ()
+
+foreach (mode without with)
+	if (mode STREQUAL "with")
+		set(mode_args ${FLAG})
+	else ()
+		set(mode_args)
+	endif ()
+
+	execute_process(COMMAND ${CMD} ${mode_args} ${ARGS}
+		OUTPUT_VARIABLE out
+		RESULT_VARIABLE res)
+	if (NOT res EQUAL 0)
+		message(FATAL_ERROR "compare_flag: run ${mode} ${FLAG} failed (${res})")
+	endif ()
+
+	string(FIND "${out}" "${MARKER}" pos)
+	if (pos EQUAL -1)
+		message(FATAL_ERROR "compare_flag: run ${mode} ${FLAG} printed no \"${MARKER}\"")
+	endif ()
+	string(SUBSTRING "${out}" ${pos} -1 result_${mode})
+endforeach ()
+
+if (NOT result_without STREQUAL result_with)
+	message(FATAL_ERROR "compare_flag: ${FLAG} changes the results\n"
+		"--- without ${FLAG}\n${result_without}\n"
+		"--- with ${FLAG}\n${result_with}")
+endif ()
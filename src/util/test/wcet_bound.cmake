@@ -0,0 +1,96 @@
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Copyright (C) 2020 Roy Spliet, University of Cambridge
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or (at your option) any later
+# version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+# Regression test for the safety of the WCET bound. Runs the wcet and main
+# binaries on the same kernel with the same ARGS, and fails unless the latency
+# simulated by main does not exceed the WCET bound. The bound taken is the
+# larger of the "SP as DRAM" and "SP as compute" columns, as the simulated
+# hardware may behave like either.
+#
+# When SOURCE_DIR is given, both binaries are first built in BINARY_DIR from
+# that tree, configured with the cache entries in CONFIG. This tests a
+# configuration other than the one of the enclosing build, e.g. a different
+# number of DRAM channels.
+#
+# Usage: cmake -DWCET=<binary> -DMAIN=<binary> "-DARGS=<arg;arg;...>"
+#              -DKERNEL=<.sas> -DWORKDIR=<dir> -P wcet_bound.cmake
+#    or: cmake -DSOURCE_DIR=<tree> -DBINARY_DIR=<dir> "-DCONFIG=<-Dvar=val;...>"
+#              "-DARGS=<arg;arg;...>" -DKERNEL=<.sas> -DWORKDIR=<dir>
+#              -P wcet_bound.cmake
+
+if (NOT DEFINED KERNEL OR NOT DEFINED WORKDIR)
+	message(FATAL_ERROR "wcet_bound: KERNEL and WORKDIR are required")
+endif ()
+
+if (DEFINED SOURCE_DIR)
+	execute_process(COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR}
+			-B ${BINARY_DIR} ${CONFIG}
+		RESULT_VARIABLE res)
+	if (NOT res EQUAL 0)
+		message(FATAL_ERROR "wcet_bound: configuring ${BINARY_DIR} failed (${res})")
+	endif ()
+
+	execute_process(COMMAND ${CMAKE_COMMAND} --build ${BINARY_DIR}
+			--target wcet main
+		RESULT_VARIABLE res)
+	if (NOT res EQUAL 0)
+		message(FATAL_ERROR "wcet_bound: building ${BINARY_DIR} failed (${res})")
+	endif ()
+
+	set(WCET ${BINARY_DIR}/wcet)
+	set(MAIN ${BINARY_DIR}/main)
+elseif (NOT DEFINED WCET OR NOT DEFINED MAIN)
+	message(FATAL_ERROR "wcet_bound: WCET and MAIN, or SOURCE_DIR are required")
+endif ()
+
+execute_process(COMMAND ${WCET} ${ARGS} ${KERNEL}
+	WORKING_DIRECTORY ${WORKDIR}
+	OUTPUT_VARIABLE out
+	RESULT_VARIABLE res)
+if (NOT res EQUAL 0)
+	message(FATAL_ERROR "wcet_bound: wcet failed (${res})")
+endif ()
+
+string(REGEX MATCH "WCET[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)"
+	match "${out}")
+if (NOT match)
+	message(FATAL_ERROR "wcet_bound: wcet printed no WCET\n${out}")
+endif ()
+set(bound ${CMAKE_MATCH_3})
+if (CMAKE_MATCH_4 GREATER bound)
+	set(bound ${CMAKE_MATCH_4})
+endif ()
+
+execute_process(COMMAND ${MAIN} ${ARGS} ${KERNEL}
+	WORKING_DIRECTORY ${WORKDIR}
+	OUTPUT_VARIABLE out
+	RESULT_VARIABLE res)
+if (NOT res EQUAL 0)
+	message(FATAL_ERROR "wcet_bound: main failed (${res})")
+endif ()
+
+string(REGEX MATCH "Program latency[ \t]*:[ \t]*([0-9]+)" match "${out}")
+if (NOT match)
+	message(FATAL_ERROR "wcet_bound: main printed no program latency\n${out}")
+endif ()
+set(latency ${CMAKE_MATCH_1})
+
+if (latency GREATER bound)
+	message(FATAL_ERROR "wcet_bound: simulated latency ${latency} exceeds "
+		"the WCET bound ${bound}")
+endif ()
+message(STATUS "wcet_bound: simulated latency ${latency}, bound ${bound}")
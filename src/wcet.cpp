@@ -18,11 +18,19 @@
 
 #include <systemc>
 #include <list>
+#include <map>
+#include <vector>
+#include <getopt.h>
+#include <unistd.h>
 
 #include <ramulator/DDR4.h>
 
 #include "mc/control/Backend.h"
+#include "mc/control/ClusterArbiter.h"
 #include "mc/control/StrideSequencer.h"
+#include "mc/control/StrideIterator.h"
+#include "mc/control/CmdGen_DDR4.h"
+#include "mc/model/dram_channel.h"
 
 #include "sp/control/Scratchpad.h"
 
@@ -33,6 +41,7 @@
 
 #include "isa/analysis/CycleSim.h"
 #include "isa/analysis/DRAMSim.h"
+#include "isa/analysis/StrideCache.h"
 #include "isa/analysis/ControlFlow.h"
 #include "isa/analysis/TimingDAG.h"
 
@@ -78,12 +87,20 @@ public:
 	sc_inout<sc_uint<4> > out_ticket_pop{"out_ticket_pop"};
 
 	/** Construct test thread */
-	SC_CTOR(Test_mc)
+	SC_CTOR(Test_mc) : rst(false)
 	{
 		SC_THREAD(thread_lt);
 		sensitive << in_clk.pos();
 	}
 
+	/** Re-issue the trigger and scheduling options after a memory
+	 * controller reset. Only valid while the simulation is paused. */
+	void
+	reset(void)
+	{
+		rst = true;
+	}
+
 	/** Enqueue a stride descriptor on the in-fifo.
 	 * @param desc stride_descriptor to enqueue.*/
 	void
@@ -93,22 +110,35 @@ public:
 	}
 
 private:
+	/** True iff a reset is pending for the main thread. */
+	bool rst;
+
 	/** Main thread */
 	void
 	thread_lt(void)
 	{
 		sc_bv<WSS_SENTINEL> sched_opts;
 
-		sched_opts = 0;
-		sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
+		while (1) {
+			sched_opts = 0;
+			sched_opts[WSS_STOP_DRAM_FINI] = Log_1;
 
-		out_trigger.write(1);
-		out_sched_opts.write(sched_opts);
-		out_ticket_pop.write(0);
-		wait();
+			out_trigger.write(1);
+			out_sched_opts.write(sched_opts);
+			out_ticket_pop.write(0);
+			wait();
 
-		while (1) {
-			if (in_mc_done_dst.num_available())
+			while (!rst) {
+				if (in_mc_done_dst.num_available())
+					in_mc_done_dst.read();
+
+				wait();
+			}
+
+			/* Idle for the cycle in which the memory controller
+			 * picks up the reset. */
+			rst = false;
+			while (in_mc_done_dst.num_available())
 				in_mc_done_dst.read();
 
 			wait();
@@ -131,6 +161,20 @@ static IDecode_impl idec_impl = IDECODE_1S;
 static unsigned int iexec_pipe_length = 3;
 static unsigned long dims[2];
 static bool dims_provided = false;
+/** Maximum number of concurrent DRAM simulation worker processes. */
+static unsigned int jobs = 0;
+/** True iff stride simulation results may be taken from/stored in the on-disk
+ * cache. */
+static bool use_cache = true;
+/** True iff every DRAM alignment must be simulated, rather than a single
+ * representative of each alignment class. */
+static bool exhaustive = false;
+/** True iff each worker simulates all its alignments in a single SystemC
+ * session, resetting the memory controller in between, rather than forking
+ * a process per alignment. */
+static bool reuse_sim = true;
+/** Number of SimdClusters sharing the DRAM. */
+static unsigned int clusters = COMPUTE_CLUSTERS;
 
 static Program prg;
 
@@ -142,11 +186,12 @@ static mc_control::StrideSequencer<MC_BUS_WIDTH,COMPUTE_THREADS> sseq("sseq");
 static Backend<MC_DRAM_BANKS,MC_DRAM_COLS,MC_DRAM_ROWS,MC_BUS_WIDTH,COMPUTE_THREADS> mc("mc");
 /** XXX: We may have to grow this SP to something unreasonably large to deal
  * with WCET derivation of full buffer indexed transfers. */
-static sp_control::Scratchpad<0,MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,1024> sp("sp");
+static sp_control::Scratchpad<MC_BUS_WIDTH/4,SP_BUS_WIDTH,131072,1024> sp("sp");
 
 /* StrideSequencer -> CmdGen */
 static sc_fifo<stride_descriptor> desc_fifo;
-static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > req_fifo(MC_BURSTREQ_FIFO_DEPTH);
+static sc_fifo<burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> > *req_fifo[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_DRAM_CHANS> > strseq_chans;
 static sc_signal<bool> dangle_strseq_done;
 static sc_fifo<bool> strseq_trigger(2);
 static sc_signal<RequestTarget> strseq_dst;
@@ -158,17 +203,17 @@ static sc_fifo<RequestTarget> mc_done_dst;
 static sc_signal<bool> mc_allpre;
 static sc_signal<AbstractRegister> sseq_vreg_reg_w;
 static sc_signal<bool> mc_enable;
-static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_BUS_WIDTH/4];
+static sc_signal<reg_offset_t<COMPUTE_THREADS> > mc_vreg_idx_w[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 
-static sc_signal<sc_uint<32> > mc_out_data[MC_BUS_WIDTH/4];
+static sc_signal<sc_uint<32> > mc_out_data[MC_DRAM_CHANS*MC_BUS_WIDTH/4];
 static sc_signal<bool> mc_write;
-static sc_signal<sc_uint<18> > mc_sp_addr;
+static sc_signal<sc_uint<18> > mc_sp_addr[MC_DRAM_CHANS];
 static sc_signal<sc_uint<2> > mc_sp_words;
 static sc_signal<long> mc_cycle;
 static sc_signal<bool> dangle_mc_ref;
 
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w;
-static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w;
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_mask_w[MC_DRAM_CHANS];
+static sc_signal<sc_bv<MC_BUS_WIDTH/4> > mc_imask_w[MC_DRAM_CHANS];
 static sc_signal<sc_uint<32> > sp_data_mc[SP_BUS_WIDTH];
 
 static sc_signal<bool> dangle_sseq_idx_push_trigger;
@@ -176,19 +221,19 @@ static sc_fifo<idx_t<COMPUTE_THREADS> > dangle_sseq_idx;
 
 static sc_fifo<stride_descriptor> dangle_sp_desc_fifo;
 static sc_fifo<bool> dangle_sp_trigger(2);
-static sc_fifo<sc_uint<1> > dangle_sp_wg_done;
+static sc_fifo<sc_uint<COMPUTE_WG_WIDTH> > dangle_sp_wg_done;
 static sc_signal<bool> dangle_sp_rf_enable;
 static sc_signal<bool> dangle_sp_rf_write;
 static sc_signal<AbstractRegister> dangle_sp_rf_reg;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_sp_rf_mask;
 static sc_signal<sc_bv<SP_BUS_WIDTH> > dangle_in_sp_rf_mask;
 static sc_signal<reg_offset_t<COMPUTE_THREADS> > dangle_sp_rf_idx[SP_BUS_WIDTH];
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_BUS_WIDTH/4)];
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	sc_signal<sc_uint<32> > sp_out_data[SP_BUS_WIDTH-(MC_DRAM_CHANS*MC_BUS_WIDTH/4)];
 #endif
 static sc_signal<sc_uint<32> > dangle_regfile_store_data[SP_BUS_WIDTH];
 
-static sc_signal<sc_uint<32> > dangle_data_mc[2][SP_BUS_WIDTH];
+static sc_signal<sc_uint<32> > dangle_data_mc[IF_SENTINEL - 1][SP_BUS_WIDTH];
 
 typedef enum {
 	WCET_BC = 0,
@@ -226,7 +271,7 @@ elaborate()
 	sseq.in_desc_fifo(desc_fifo);
 	sseq.in_ref_pending(ref_pending);
 	sseq.in_trigger(strseq_trigger);
-	sseq.out_req_fifo(req_fifo);
+	sseq.out_chans(strseq_chans);
 	sseq.out_done(dangle_strseq_done);
 	sseq.in_DQ_allpre(mc_allpre);
 	sseq.out_dst(strseq_dst);
@@ -238,22 +283,30 @@ elaborate()
 	sseq.in_ticket_pop(test_ticket_pop);
 
 	mc.in_clk(*clk);
-	mc.in_req_fifo(req_fifo);
+	mc.in_chans(strseq_chans);
 	mc.out_ref_pending(ref_pending);
 	mc.out_allpre(mc_allpre);
 	mc.out_ref(dangle_mc_ref);
-	mc.in_mask_w(mc_imask_w);
-	mc.out_sp_addr(mc_sp_addr);
 	mc.out_enable(mc_enable);
 	mc.out_write(mc_write);
-	mc.out_mask_w(mc_mask_w);
 	mc.out_done_dst(mc_done_dst);
 	mc.out_cycle(mc_cycle);
-	for (unsigned int i = 0; i < MC_BUS_WIDTH/4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		req_fifo[i] = new sc_fifo<burst_request<MC_BUS_WIDTH,
+				COMPUTE_THREADS> >(MC_BURSTREQ_FIFO_DEPTH);
+		sseq.out_req_fifo[i](*req_fifo[i]);
+		mc.in_req_fifo[i](*req_fifo[i]);
+
+		mc.in_mask_w[i](mc_imask_w[i]);
+		mc.out_sp_addr[i](mc_sp_addr[i]);
+		mc.out_mask_w[i](mc_mask_w[i]);
+	}
+
+	for (unsigned int i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		mc.out_data[i](mc_out_data[i]);
 		mc.in_data[IF_SP_WG0][i](sp_data_mc[i]);
-		mc.in_data[IF_SP_WG1][i](dangle_data_mc[0][i]);
-		mc.in_data[IF_RF][i](dangle_data_mc[1][i]);
+		for (unsigned int j = IF_SP_WG0 + 1; j < IF_SENTINEL; j++)
+			mc.in_data[j][i](dangle_data_mc[j - 1][i]);
 		mc.out_vreg_idx_w[i](mc_vreg_idx_w[i]);
 	}
 
@@ -271,10 +324,13 @@ elaborate()
 	sp.in_dram_enable(mc_enable);
 	sp.in_dram_dst(strseq_dst);
 	sp.in_dram_write(mc_write);
-	sp.in_dram_addr(mc_sp_addr);
-	sp.in_dram_mask(mc_mask_w);
 
-	for (i = 0; i < MC_BUS_WIDTH/4; i++) {
+	for (i = 0; i < MC_DRAM_CHANS; i++) {
+		sp.in_dram_addr[i](mc_sp_addr[i]);
+		sp.in_dram_mask[i](mc_mask_w[i]);
+	}
+
+	for (i = 0; i < MC_DRAM_CHANS*MC_BUS_WIDTH/4; i++) {
 		sp.out_data[i](sp_data_mc[i]);
 		sp.in_dram_data[i](mc_out_data[i]);
 	}
@@ -284,21 +340,20 @@ elaborate()
 		sp.in_rf_data[i](dangle_regfile_store_data[i]);
 	}
 
-#if SP_BUS_WIDTH != (MC_BUS_WIDTH/4)
-	for (i = 0; i < SP_BUS_WIDTH - (MC_BUS_WIDTH/4); i++)
-		sp.out_data[(MC_BUS_WIDTH/4)+i](sp_out_data[i]);
+#if SP_BUS_WIDTH != (MC_DRAM_CHANS*MC_BUS_WIDTH/4)
+	for (i = 0; i < SP_BUS_WIDTH - (MC_DRAM_CHANS*MC_BUS_WIDTH/4); i++)
+		sp.out_data[(MC_DRAM_CHANS*MC_BUS_WIDTH/4)+i](sp_out_data[i]);
 #endif
 	sp.elaborate();
 }
 
 /** Execute simulation
- * @param descs List of descriptors to pre-load the fifo with
+ * @param sd Stride descriptor to pre-load the fifo with.
+ * @param s Reference to cmdarb_stats object to store results of this run in.
  */
 void
-do_sim(stride_descriptor *sd, cmdarb_stats *stats)
+do_sim(stride_descriptor *sd, cmdarb_stats &s)
 {
-	cmdarb_stats s;
-
 	/* Enqueue stride patterns */
 	test.enqueue_stride_desc(sd);
 
@@ -314,10 +369,17 @@ do_sim(stride_descriptor *sd, cmdarb_stats *stats)
 	//dram_print_range(0x140000, 1536, &cmdgen, &dq);
 	//sp.debug_print_range(0x0, 256);
 	mc.get_cmdarb_stats(s);
-	mc.aggregate_cmdarb_stats(stats, s);
-	if (debug_output[DEBUG_CMD_STATS]) {
-		cout << s << endl;
-	}
+}
+
+/** Restore the memory controller and test driver to their power-on state, such
+ * that the next do_sim() call behaves as if run in a fresh process. Only valid
+ * after do_sim() returned. */
+void
+reset_sim(void)
+{
+	mc.reset();
+	sseq.reset();
+	test.reset();
 }
 
 /** Document the parameters accepted by this binary.
@@ -335,6 +397,13 @@ help(char *program_name)
 	cout << "  -w [t]\t\t     : Workgroup width, t a power-of-two > 32." << endl;
 	cout << "  -P [stages]\t\t     : Number of execute pipeline stages (default: 1)." << endl;
 	cout << "  -3\t\t\t     : Enable three-stage IDecode phase." << endl;
+	cout << "  -j [jobs]\t\t     : Number of parallel DRAM simulations (default: #cores)." << endl;
+	cout << "  -C [clusters]\t\t     : Number of SimdClusters sharing the DRAM (default: " << COMPUTE_CLUSTERS << ")." << endl;
+	cout << "  -N\t\t\t     : Do not use the on-disk DRAM simulation cache." << endl;
+	cout << "  -F\t\t\t     : Fork a process per alignment, rather than reusing a" << endl;
+	cout << "\t\t\t       single simulation per worker." << endl;
+	cout << "  -E, --exhaustive\t     : Simulate every DRAM alignment, rather than one per" << endl;
+	cout << "\t\t\t       alignment class." << endl;
 	cout << "  -D dbgopt[,dbgopt[,..]]    : Enable debugging output options." << endl;
 
 	cout << endl;
@@ -368,11 +437,16 @@ parse_parameters(int argc, char* argv[])
 	string dbgopt;
 	string::size_type sz;
 	unsigned int bufno;
+	static const struct option long_opts[] = {
+		{"exhaustive", no_argument, nullptr, 'E'},
+		{nullptr, 0, nullptr, 0}
+	};
 
 	program = string(argv[argc-1]);
 
 	/* Take stride patterns from the command line */
-	while ( (c = getopt(argc - 1, argv, "w:P:d:3D:")) != -1) {
+	while ( (c = getopt_long(argc - 1, argv, "w:P:d:3D:j:C:NFE", long_opts,
+			nullptr)) != -1) {
 		switch (c) {
 		case 'w':
 			i = sscanf(optarg, "%i", &wg_width);
@@ -416,6 +490,33 @@ parse_parameters(int argc, char* argv[])
 		case '3':
 			idec_impl = IDECODE_3S;
 			break;
+		case 'j':
+			i = sscanf(optarg, "%u", &jobs);
+			if (i != 1 || jobs == 0) {
+				cout << "Error: Invalid number of jobs"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+			break;
+		case 'C':
+			i = sscanf(optarg, "%u", &clusters);
+			if (i != 1 || clusters == 0) {
+				cout << "Error: Invalid number of clusters"
+						<< endl << endl;
+				help(argv[0]);
+				exit(1);
+			}
+			break;
+		case 'N':
+			use_cache = false;
+			break;
+		case 'F':
+			reuse_sim = false;
+			break;
+		case 'E':
+			exhaustive = true;
+			break;
 		case 'D':
 			oa = string(optarg);
 
@@ -450,15 +551,147 @@ parse_parameters(int argc, char* argv[])
 		help(argv[0]);
 		exit(1);
 	}
+
+	if (jobs == 0)
+		jobs = max(1l, sysconf(_SC_NPROCESSORS_ONLN));
 }
 
-unsigned long
-sim_DRAM_stride(stride_descriptor &sd, bool sweep)
+/** Reap a single finished DRAM simulation worker.
+ * @return False iff the worker did not terminate successfully. */
+static bool
+reap_worker(void)
 {
-	cmdarb_stats *stats;
+	int status;
+
+	if (wait(&status) < 0)
+		return false;
+
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/** Compute the alignment class signature of a stride descriptor.
+ *
+ * The signature is the sequence of burst requests generated by the
+ * StrideSequencer for this descriptor, with DRAM addresses replaced by their
+ * channel, the bank within that channel, and the channel-local row and column
+ * renamed to the order of first occurrence. Under the closed-page policy,
+ * CmdGen, CmdArb and the ramulator and DRAMPower models only consider the
+ * channel, bank, row and column equality of a burst, hence two descriptors
+ * with equal signatures result in an identical sequence of commands and
+ * identical cmdarb_stats. Channels and banks are not renamed, as bank groups
+ * and the round-robin arbitration order depend on their index.
+ * @param sd Stride descriptor.
+ * @param sig Vector to store the signature in. */
+static void
+alignment_signature(stride_descriptor &sd, vector<unsigned long> &sig)
+{
+	StrideIterator<MC_BUS_WIDTH,COMPUTE_THREADS> iter;
+	burst_request<MC_BUS_WIDTH,COMPUTE_THREADS> req;
+	map<pair<unsigned int, unsigned long>, unsigned long> rows;
+	map<pair<unsigned long, unsigned long>, unsigned long> cols;
+	sc_uint<const_log2(MC_DRAM_BANKS)> bank;
+	sc_uint<const_log2(MC_DRAM_ROWS)> row;
+	sc_uint<const_log2(MC_DRAM_COLS)> col;
+	unsigned int i;
+	unsigned int c;
+	unsigned long r;
+	bool last;
+
+	sig.clear();
+	iter.init(sd);
+
+	do {
+		last = iter.next(req);
+
+		c = dram_chan<MC_DRAM_CHANS>(req.addr);
+		CmdGen_DDR4<MC_BUS_WIDTH,MC_DRAM_BANKS,MC_DRAM_COLS,
+			MC_DRAM_ROWS,COMPUTE_THREADS>::address_translate(
+				dram_chan_addr<MC_DRAM_CHANS>(req.addr),
+				bank, row, col);
+		r = rows.insert(make_pair(make_pair(c, (unsigned long) row),
+				rows.size())).first->second;
+		cols.insert(make_pair(make_pair(r, (unsigned long) col),
+				cols.size()));
+
+		sig.push_back(c);
+		sig.push_back(bank);
+		sig.push_back(r);
+		sig.push_back(cols[make_pair(r, (unsigned long) col)]);
+		sig.push_back(req.wordmask.to_uint64());
+		sig.push_back(req.write);
+		sig.push_back(req.last);
+		sig.push_back(req.target.type);
+		sig.push_back(req.target.wg);
+
+		if (req.target.type == TARGET_SP) {
+			sig.push_back(req.sp_offset);
+		} else {
+			for (i = 0; i < MC_BUS_WIDTH; i++) {
+				if (req.wordmask[i])
+					sig.push_back(req.reg_offset[i].idx);
+			}
+		}
+	} while (!last);
+}
+
+/** Partition the DRAM alignments of a sweep into alignment classes.
+ * @param sd Stride descriptor for the first alignment.
+ * @param alignments Number of alignments, each 4 bytes apart.
+ * @param cls Vector to store the representative alignment of each alignment
+ * 	      in. The representative is the lowest alignment of its class.
+ * @return The number of alignment classes. */
+static unsigned int
+alignment_classes(stride_descriptor sd, unsigned int alignments,
+		vector<unsigned int> &cls)
+{
+	map<vector<unsigned long>, unsigned int> classes;
+	vector<unsigned long> sig;
 	unsigned int i;
+
+	cls.resize(alignments);
+
+	for (i = 0; i < alignments; i++, sd.addr += 4) {
+		alignment_signature(sd, sig);
+		cls[i] = classes.insert(make_pair(sig, i)).first->second;
+	}
+
+	return classes.size();
+}
+
+/** Simulate a stride descriptor, optionally for all DRAM alignments.
+ *
+ * Alignments are simulated in forked workers, as SystemC cannot be
+ * re-elaborated. Up to #jobs workers run concurrently. Every worker stores its
+ * results in a private slot of a shared results array, which the parent
+ * aggregates in alignment order once all workers finished. Hence the outcome
+ * is identical to that of a serial sweep regardless of scheduling order.
+ *
+ * Unless exhaustive is set, only one representative of each alignment class
+ * is simulated. Its results are aggregated once for every member of the
+ * class, in alignment order.
+ *
+ * By default (reuse_sim), at most #jobs workers are forked, each simulating an
+ * interleaved share of the representatives back-to-back in one SystemC
+ * session. The memory controller is reset between alignments, rather than
+ * paying for a fork and a copy-on-write address space for each. With -F, a
+ * worker is forked per alignment instead.
+ * @param sd Stride descriptor to simulate.
+ * @param sweep True iff all DRAM alignments must be simulated.
+ * @param res Array of three cmdarb_stats objects to store the min/max/agg
+ * 	      results in. */
+void
+sim_DRAM_stride(stride_descriptor &sd, bool sweep, cmdarb_stats *res)
+{
+	cmdarb_stats *stats;
+	cmdarb_stats *runs;
+	vector<unsigned int> cls;
+	vector<unsigned int> reps;
+	stride_descriptor rsd;
+	unsigned int i, j;
+	unsigned int running = 0;
+	unsigned int classes;
 	int pid;
-	unsigned long lda;
+	bool ok = true;
 	unsigned int loop_bound;
 
 	stats = mc.allocate_cmdarb_stats();
@@ -468,25 +701,96 @@ sim_DRAM_stride(stride_descriptor &sd, bool sweep)
 	else
 		loop_bound = 1;
 
-	/* Tighter upper bound on i based on buffer properties. */
+	if (exhaustive || loop_bound == 1) {
+		cls.resize(loop_bound);
+		for (i = 0; i < loop_bound; i++)
+			cls[i] = i;
+		classes = loop_bound;
+	} else {
+		classes = alignment_classes(sd, loop_bound, cls);
+	}
+
+	if (debug_output[DEBUG_WCET_PROGRESS] && sweep)
+		cout << "    - Alignment classes: " << classes << "/" <<
+			loop_bound << endl;
+
+	runs = (cmdarb_stats *) mmap(NULL, loop_bound * sizeof(*runs),
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (runs == MAP_FAILED) {
+		cerr << "Error: could not allocate DRAM simulation results."
+				<< endl;
+		exit(1);
+	}
+
 	for (i = 0; i < loop_bound; i++) {
+		if (cls[i] == i)
+			reps.push_back(i);
+	}
+
+	for (j = 0; reuse_sim && j < min(jobs, (unsigned int) reps.size()); j++) {
+		pid = fork();
+		if (pid == 0) {
+			sseq.set_pause_fini(true);
+			for (i = j; i < reps.size(); i += jobs) {
+				if (i != j)
+					reset_sim();
+
+				rsd = sd;
+				rsd.addr += 4 * reps[i];
+				do_sim(&rsd, runs[reps[i]]);
+			}
+			exit(0);
+		} else if (pid < 0) {
+			cerr << "Error: could not fork DRAM simulation worker."
+					<< endl;
+			exit(1);
+		}
+
+		running++;
+	}
+
+	/* Tighter upper bound on i based on buffer properties. */
+	for (i = 0; !reuse_sim && i < loop_bound; i++, sd.addr += 4) {
+		if (cls[i] != i)
+			continue;
+
+		if (running == jobs) {
+			ok &= reap_worker();
+			running--;
+		}
+
 		pid = fork();
 		if (pid == 0) {
-			do_sim(&sd, stats);
+			do_sim(&sd, runs[i]);
 			exit(0);
+		} else if (pid < 0) {
+			cerr << "Error: could not fork DRAM simulation worker."
+					<< endl;
+			exit(1);
 		}
 
-		waitpid(pid, NULL, 0);
+		running++;
+	}
+
+	for (; running > 0; running--)
+		ok &= reap_worker();
+
+	if (!ok) {
+		cerr << "Error: DRAM simulation worker failed." << endl;
+		exit(1);
+	}
 
-		sd.addr += 4;
+	for (i = 0; i < loop_bound; i++) {
+		mc.aggregate_cmdarb_stats(stats, runs[cls[i]]);
+		if (debug_output[DEBUG_CMD_STATS])
+			cout << runs[cls[i]] << endl;
 	}
 
-	/* WCET based on least-issue delay. */
-	lda = stats[STATS_MAX].lid;
+	for (i = STATS_MIN; i <= STATS_AGG; i++)
+		res[i] = stats[i];
 
+	munmap((void *)runs, loop_bound * sizeof(*runs));
 	mc.free_cmdarb_stats(stats);
-
-	return lda;
 }
 
 unsigned long
@@ -504,11 +808,30 @@ workgroups(void)
 	return wgs;
 }
 
+/** Return the number of work-groups executed by the busiest SimdCluster.
+ *
+ * The WorkScheduler distributes work-groups in round-robin order.
+ * @return Upper bound on the number of work-groups per cluster. */
+unsigned long
+cluster_workgroups(void)
+{
+	return div_round_up(workgroups(), clusters);
+}
+
+/** Return the cost of the ClusterArbiter grant handshake.
+ * @param dram DRAM timing parameters.
+ * @return Grant handshake cost in compute cycles. */
+unsigned long
+arbiter_grant_cycles(const dram_timing *dram)
+{
+	return div_round_up(CLUSTER_ARB_GRANT_CYCLES * 1000, dram->clkMHz);
+}
+
 void
 wcet(WCETStats &s, ProgramPhaseList *ppl, unsigned long prg_upload_cycles,
 		const dram_timing *dram)
 {
-	s.wcet = ppl->WCET(workgroups()) + prg_upload_cycles;
+	s.wcet = ppl->WCET(cluster_workgroups(), COMPUTE_WG_SLOTS) + prg_upload_cycles;
 	s.wcet = inflate_refresh(dram, s.wcet);
 	s.program_phases = ppl->countPhases();
 }
@@ -563,6 +886,7 @@ sc_main(int argc, char* argv[])
 	ProgramPhaseList *ppl;
 	unsigned long wcet_lb_pp;
 	unsigned long wcet_lb_db;
+	StrideCache cache;
 
 	/* Suppress frequent "simulation stopped by user" messages */
 	sc_report_handler::set_verbosity_level(SC_LOW);
@@ -588,6 +912,8 @@ sc_main(int argc, char* argv[])
 	}
 
 	elaborate();
+	/* Only command timing is of interest, don't store data. */
+	mc.set_timing_only(true);
 	dram = getTiming(MC_DRAM_SPEED, MC_DRAM_ORG, MC_DRAM_BANKS / 4);
 
 	fs = fstream(program);
@@ -605,19 +931,23 @@ sc_main(int argc, char* argv[])
 	/* Analysis passes. */
 	ControlFlow(prg);
 	DRAMSim(prg, workgroup_width(min(int(wg_width),int(WG_WIDTH_SENTINEL))),
-			dram, sim_DRAM_stride);
+			dram, sim_DRAM_stride, use_cache ? &cache : nullptr);
+	if (use_cache && debug_output[DEBUG_WCET_PROGRESS])
+		cout << "  Stride cache: " << cache.getHits() << " hits, " <<
+			cache.getMisses() << " misses" << endl;
 	prg_upload_cycles = ProgramUploadTime(prg, dram);
 	CycleSim(prg, idec_impl, iexec_pipe_length);
 	dag = TimingDAG(prg);
 
 	critPath = criticalPath(dag);
 	ppl = new ProgramPhaseList(critPath, pipe_depth);
-	wcet_lb_pp = ppl->PerfectParallelismWCETLB(dram, workgroups()) + prg_upload_cycles;
-	wcet_lb_db = inflate_refresh(dram, ppl->DoubleBufferedWCETLB(workgroups())) + prg_upload_cycles;
+	wcet_lb_pp = ppl->PerfectParallelismWCETLB(dram, workgroups(), clusters) + prg_upload_cycles;
+	wcet_lb_db = inflate_refresh(dram, ppl->DoubleBufferedWCETLB(cluster_workgroups())) + prg_upload_cycles;
 	s[WCET_BC].wcet = max(wcet_lb_pp,wcet_lb_db);
 	s[WCET_BC].program_phases = ppl->countPhases();
 
-	s[WCET_SINGLE_BUFFER].wcet = ppl->SingleBufferedWCET(workgroups()) + prg_upload_cycles;
+	ppl->arbitrate(clusters, arbiter_grant_cycles(dram));
+	s[WCET_SINGLE_BUFFER].wcet = ppl->SingleBufferedWCET(cluster_workgroups()) + prg_upload_cycles;
 	s[WCET_SINGLE_BUFFER].wcet = inflate_refresh(dram, s[WCET_SINGLE_BUFFER].wcet);
 	s[WCET_SINGLE_BUFFER].program_phases = ppl->countPhases();
 
@@ -625,6 +955,7 @@ sc_main(int argc, char* argv[])
 
 	critPath = criticalPath(dag, true);
 	ppl = new ProgramPhaseList(critPath, pipe_depth);
+	ppl->arbitrate(clusters, arbiter_grant_cycles(dram));
 	wcet(s[WCET_SP_AS_EXECUTE], ppl, prg_upload_cycles, dram);
 
 	if (debug_output[DEBUG_WCET_PROGRESS])